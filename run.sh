@@ -1481,6 +1481,8 @@ function usage_bench()
     echo "                             fillrandom_pegasus       --pegasus write N random values with random keys list"
     echo "                             readrandom_pegasus       --pegasus read N times with random keys list"
     echo "                             deleterandom_pegasus     --pegasus delete N entries with random keys list"
+    echo "                             fillrandom_async_pegasus --pegasus async write N random values, whose writes"
+    echo "                                                        are batched if write_batch_delay_ms is set in config"
     echo "                             Comma-separated list of operations is going to run in the specified order."
     echo "                             default is 'fillrandom_pegasus,readrandom_pegasus,deleterandom_pegasus'"
     echo "   --num <num>               number of key/value pairs, default is 10000"
@@ -94,4 +94,18 @@ const std::string SPLIT_VALIDATE_PARTITION_HASH("replica.split.validate_partitio
 
 /// json string which represents user specified compaction
 const std::string USER_SPECIFIED_COMPACTION("user_specified_compaction");
+
+/// true means incr is written as a rocksdb merge operand without reading the old value, and the
+/// new value is not returned to the client, otherwise false
+const std::string INCR_MERGE_ENABLED("replica.incr_merge_enabled");
+
+/// hash keys separated by ',', whose rows are cached by the hotkey read cache
+const std::string HOTKEY_READ_CACHE_HASH_KEYS("replica.hotkey_read_cache.hash_keys");
+
+/// true means the key column family is created along with the rocksdb instance of each replica,
+/// which makes the scans and counts without values needn't read the values, at the cost of an
+/// extra small write per put/remove. The incr merge and bulk load are not supported by the tables
+/// with it. It only takes effect on the creation of the rocksdb instances, so it should be set
+/// when the table is created and never changed
+const std::string ROCKSDB_SEPARATE_KEY_CF("replica.rocksdb_separate_key_cf");
 } // namespace pegasus
@@ -66,4 +66,10 @@ extern const std::string ROCKSDB_ITERATION_THRESHOLD_TIME_MS;
 extern const std::string SPLIT_VALIDATE_PARTITION_HASH;
 
 extern const std::string USER_SPECIFIED_COMPACTION;
+
+extern const std::string INCR_MERGE_ENABLED;
+
+extern const std::string HOTKEY_READ_CACHE_HASH_KEYS;
+
+extern const std::string ROCKSDB_SEPARATE_KEY_CF;
 } // namespace pegasus
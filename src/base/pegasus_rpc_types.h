@@ -43,6 +43,9 @@ using duplicate_rpc = dsn::apps::duplicate_rpc;
 using check_and_mutate_rpc =
     dsn::rpc_holder<dsn::apps::check_and_mutate_request, dsn::apps::check_and_mutate_response>;
 
+using batch_write_rpc =
+    dsn::rpc_holder<dsn::apps::batch_write_request, dsn::apps::update_response>;
+
 using ingestion_rpc =
     dsn::rpc_holder<dsn::replication::ingestion_request, dsn::replication::ingestion_response>;
 
@@ -89,6 +89,50 @@ pegasus_extract_user_data(uint32_t version, std::string &&raw_value, ::dsn::blob
     user_data.assign(std::move(buf), 0, static_cast<unsigned int>(view.length()));
 }
 
+/// Extracts user value from a pinned rocksdb value.
+/// The pinned data (usually a block in block cache or a memtable entry) is referenced
+/// directly by `user_data` without any copy, and it will be released together with
+/// `user_data`.
+/// \param user_data: the result.
+inline void pegasus_extract_user_data(uint32_t version,
+                                      std::unique_ptr<rocksdb::PinnableSlice> raw_value,
+                                      ::dsn::blob &user_data)
+{
+    dassert_f(version <= PEGASUS_DATA_VERSION_MAX,
+              "data version({}) must be <= {}",
+              version,
+              PEGASUS_DATA_VERSION_MAX);
+
+    auto *s = raw_value.release();
+    dsn::data_input input(dsn::string_view(s->data(), s->size()));
+    input.skip(sizeof(uint32_t));
+    if (version == 1) {
+        input.skip(sizeof(uint64_t));
+    }
+    dsn::string_view view = input.read_str();
+
+    std::shared_ptr<char> buf(const_cast<char *>(view.data()), [s](char *) { delete s; });
+    user_data.assign(std::move(buf), 0, static_cast<unsigned int>(view.length()));
+}
+
+/// Extracts user value from a raw rocksdb value without taking the ownership.
+/// The returned view is only valid while `raw_value` is.
+inline dsn::string_view pegasus_extract_user_data_view(uint32_t version,
+                                                       dsn::string_view raw_value)
+{
+    dassert_f(version <= PEGASUS_DATA_VERSION_MAX,
+              "data version({}) must be <= {}",
+              version,
+              PEGASUS_DATA_VERSION_MAX);
+
+    dsn::data_input input(raw_value);
+    input.skip(sizeof(uint32_t));
+    if (version == 1) {
+        input.skip(sizeof(uint64_t));
+    }
+    return input.read_str();
+}
+
 /// Extracts timetag from a v1 value.
 inline uint64_t pegasus_extract_timetag(int version, dsn::string_view value)
 {
@@ -17,11 +17,17 @@ namespace apps {
 int _kfilter_typeValues[] = {filter_type::FT_NO_FILTER,
                              filter_type::FT_MATCH_ANYWHERE,
                              filter_type::FT_MATCH_PREFIX,
-                             filter_type::FT_MATCH_POSTFIX};
-const char *_kfilter_typeNames[] = {
-    "FT_NO_FILTER", "FT_MATCH_ANYWHERE", "FT_MATCH_PREFIX", "FT_MATCH_POSTFIX"};
+                             filter_type::FT_MATCH_POSTFIX,
+                             filter_type::FT_MATCH_REGEX,
+                             filter_type::FT_MATCH_MULTI_PATTERN};
+const char *_kfilter_typeNames[] = {"FT_NO_FILTER",
+                                    "FT_MATCH_ANYWHERE",
+                                    "FT_MATCH_PREFIX",
+                                    "FT_MATCH_POSTFIX",
+                                    "FT_MATCH_REGEX",
+                                    "FT_MATCH_MULTI_PATTERN"};
 const std::map<int, const char *> _filter_type_VALUES_TO_NAMES(
-    ::apache::thrift::TEnumIterator(4, _kfilter_typeValues, _kfilter_typeNames),
+    ::apache::thrift::TEnumIterator(6, _kfilter_typeValues, _kfilter_typeNames),
     ::apache::thrift::TEnumIterator(-1, NULL, NULL));
 
 int _kcas_check_typeValues[] = {cas_check_type::CT_NO_CHECK,
@@ -70,6 +76,14 @@ const std::map<int, const char *> _mutate_operation_VALUES_TO_NAMES(
     ::apache::thrift::TEnumIterator(2, _kmutate_operationValues, _kmutate_operationNames),
     ::apache::thrift::TEnumIterator(-1, NULL, NULL));
 
+int _kscan_aggregate_typeValues[] = {scan_aggregate_type::SA_NONE,
+                                     scan_aggregate_type::SA_COUNT,
+                                     scan_aggregate_type::SA_INT_STATS};
+const char *_kscan_aggregate_typeNames[] = {"SA_NONE", "SA_COUNT", "SA_INT_STATS"};
+const std::map<int, const char *> _scan_aggregate_type_VALUES_TO_NAMES(
+    ::apache::thrift::TEnumIterator(3, _kscan_aggregate_typeValues, _kscan_aggregate_typeNames),
+    ::apache::thrift::TEnumIterator(-1, NULL, NULL));
+
 update_request::~update_request() throw() {}
 
 void update_request::__set_key(const ::dsn::blob &val) { this->key = val; }
@@ -1956,6 +1970,12 @@ void multi_get_response::__set_partition_index(const int32_t val) { this->partit
 
 void multi_get_response::__set_server(const std::string &val) { this->server = val; }
 
+void multi_get_response::__set_last_sortkey(const ::dsn::blob &val)
+{
+    this->last_sortkey = val;
+    __isset.last_sortkey = true;
+}
+
 uint32_t multi_get_response::read(::apache::thrift::protocol::TProtocol *iprot)
 {
 
@@ -2026,6 +2046,14 @@ uint32_t multi_get_response::read(::apache::thrift::protocol::TProtocol *iprot)
                 xfer += iprot->skip(ftype);
             }
             break;
+        case 7:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->last_sortkey.read(iprot);
+                this->__isset.last_sortkey = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
         default:
             xfer += iprot->skip(ftype);
             break;
@@ -2072,6 +2100,11 @@ uint32_t multi_get_response::write(::apache::thrift::protocol::TProtocol *oprot)
     xfer += oprot->writeString(this->server);
     xfer += oprot->writeFieldEnd();
 
+    if (this->__isset.last_sortkey) {
+        xfer += oprot->writeFieldBegin("last_sortkey", ::apache::thrift::protocol::T_STRUCT, 7);
+        xfer += this->last_sortkey.write(oprot);
+        xfer += oprot->writeFieldEnd();
+    }
     xfer += oprot->writeFieldStop();
     xfer += oprot->writeStructEnd();
     return xfer;
@@ -2085,6 +2118,7 @@ void swap(multi_get_response &a, multi_get_response &b)
     swap(a.app_id, b.app_id);
     swap(a.partition_index, b.partition_index);
     swap(a.server, b.server);
+    swap(a.last_sortkey, b.last_sortkey);
     swap(a.__isset, b.__isset);
 }
 
@@ -2095,6 +2129,7 @@ multi_get_response::multi_get_response(const multi_get_response &other65)
     app_id = other65.app_id;
     partition_index = other65.partition_index;
     server = other65.server;
+    last_sortkey = other65.last_sortkey;
     __isset = other65.__isset;
 }
 multi_get_response::multi_get_response(multi_get_response &&other66)
@@ -2104,6 +2139,7 @@ multi_get_response::multi_get_response(multi_get_response &&other66)
     app_id = std::move(other66.app_id);
     partition_index = std::move(other66.partition_index);
     server = std::move(other66.server);
+    last_sortkey = std::move(other66.last_sortkey);
     __isset = std::move(other66.__isset);
 }
 multi_get_response &multi_get_response::operator=(const multi_get_response &other67)
@@ -2113,6 +2149,7 @@ multi_get_response &multi_get_response::operator=(const multi_get_response &othe
     app_id = other67.app_id;
     partition_index = other67.partition_index;
     server = other67.server;
+    last_sortkey = other67.last_sortkey;
     __isset = other67.__isset;
     return *this;
 }
@@ -2123,6 +2160,7 @@ multi_get_response &multi_get_response::operator=(multi_get_response &&other68)
     app_id = std::move(other68.app_id);
     partition_index = std::move(other68.partition_index);
     server = std::move(other68.server);
+    last_sortkey = std::move(other68.last_sortkey);
     __isset = std::move(other68.__isset);
     return *this;
 }
@@ -2139,6 +2177,9 @@ void multi_get_response::printTo(std::ostream &out) const
         << "partition_index=" << to_string(partition_index);
     out << ", "
         << "server=" << to_string(server);
+    out << ", "
+        << "last_sortkey=";
+    (__isset.last_sortkey ? (out << to_string(last_sortkey)) : (out << "<null>"));
     out << ")";
 }
 
@@ -3666,6 +3707,227 @@ void check_and_mutate_response::printTo(std::ostream &out) const
     out << ")";
 }
 
+scan_aggregate_result::~scan_aggregate_result() throw() {}
+
+void scan_aggregate_result::__set_row_count(const int64_t val) { this->row_count = val; }
+
+void scan_aggregate_result::__set_key_bytes(const int64_t val) { this->key_bytes = val; }
+
+void scan_aggregate_result::__set_value_bytes(const int64_t val) { this->value_bytes = val; }
+
+void scan_aggregate_result::__set_int_count(const int64_t val) { this->int_count = val; }
+
+void scan_aggregate_result::__set_int_sum(const int64_t val) { this->int_sum = val; }
+
+void scan_aggregate_result::__set_int_min(const int64_t val) { this->int_min = val; }
+
+void scan_aggregate_result::__set_int_max(const int64_t val) { this->int_max = val; }
+
+uint32_t scan_aggregate_result::read(::apache::thrift::protocol::TProtocol *iprot)
+{
+
+    apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+    uint32_t xfer = 0;
+    std::string fname;
+    ::apache::thrift::protocol::TType ftype;
+    int16_t fid;
+
+    xfer += iprot->readStructBegin(fname);
+
+    using ::apache::thrift::protocol::TProtocolException;
+
+    while (true) {
+        xfer += iprot->readFieldBegin(fname, ftype, fid);
+        if (ftype == ::apache::thrift::protocol::T_STOP) {
+            break;
+        }
+        switch (fid) {
+        case 1:
+            if (ftype == ::apache::thrift::protocol::T_I64) {
+                xfer += iprot->readI64(this->row_count);
+                this->__isset.row_count = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 2:
+            if (ftype == ::apache::thrift::protocol::T_I64) {
+                xfer += iprot->readI64(this->key_bytes);
+                this->__isset.key_bytes = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 3:
+            if (ftype == ::apache::thrift::protocol::T_I64) {
+                xfer += iprot->readI64(this->value_bytes);
+                this->__isset.value_bytes = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 4:
+            if (ftype == ::apache::thrift::protocol::T_I64) {
+                xfer += iprot->readI64(this->int_count);
+                this->__isset.int_count = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 5:
+            if (ftype == ::apache::thrift::protocol::T_I64) {
+                xfer += iprot->readI64(this->int_sum);
+                this->__isset.int_sum = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 6:
+            if (ftype == ::apache::thrift::protocol::T_I64) {
+                xfer += iprot->readI64(this->int_min);
+                this->__isset.int_min = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 7:
+            if (ftype == ::apache::thrift::protocol::T_I64) {
+                xfer += iprot->readI64(this->int_max);
+                this->__isset.int_max = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        default:
+            xfer += iprot->skip(ftype);
+            break;
+        }
+        xfer += iprot->readFieldEnd();
+    }
+
+    xfer += iprot->readStructEnd();
+
+    return xfer;
+}
+
+uint32_t scan_aggregate_result::write(::apache::thrift::protocol::TProtocol *oprot) const
+{
+    uint32_t xfer = 0;
+    apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+    xfer += oprot->writeStructBegin("scan_aggregate_result");
+
+    xfer += oprot->writeFieldBegin("row_count", ::apache::thrift::protocol::T_I64, 1);
+    xfer += oprot->writeI64(this->row_count);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("key_bytes", ::apache::thrift::protocol::T_I64, 2);
+    xfer += oprot->writeI64(this->key_bytes);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("value_bytes", ::apache::thrift::protocol::T_I64, 3);
+    xfer += oprot->writeI64(this->value_bytes);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("int_count", ::apache::thrift::protocol::T_I64, 4);
+    xfer += oprot->writeI64(this->int_count);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("int_sum", ::apache::thrift::protocol::T_I64, 5);
+    xfer += oprot->writeI64(this->int_sum);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("int_min", ::apache::thrift::protocol::T_I64, 6);
+    xfer += oprot->writeI64(this->int_min);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("int_max", ::apache::thrift::protocol::T_I64, 7);
+    xfer += oprot->writeI64(this->int_max);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldStop();
+    xfer += oprot->writeStructEnd();
+    return xfer;
+}
+
+void swap(scan_aggregate_result &a, scan_aggregate_result &b)
+{
+    using ::std::swap;
+    swap(a.row_count, b.row_count);
+    swap(a.key_bytes, b.key_bytes);
+    swap(a.value_bytes, b.value_bytes);
+    swap(a.int_count, b.int_count);
+    swap(a.int_sum, b.int_sum);
+    swap(a.int_min, b.int_min);
+    swap(a.int_max, b.int_max);
+    swap(a.__isset, b.__isset);
+}
+
+scan_aggregate_result::scan_aggregate_result(const scan_aggregate_result &other162)
+{
+    row_count = other162.row_count;
+    key_bytes = other162.key_bytes;
+    value_bytes = other162.value_bytes;
+    int_count = other162.int_count;
+    int_sum = other162.int_sum;
+    int_min = other162.int_min;
+    int_max = other162.int_max;
+    __isset = other162.__isset;
+}
+scan_aggregate_result::scan_aggregate_result(scan_aggregate_result &&other163)
+{
+    row_count = std::move(other163.row_count);
+    key_bytes = std::move(other163.key_bytes);
+    value_bytes = std::move(other163.value_bytes);
+    int_count = std::move(other163.int_count);
+    int_sum = std::move(other163.int_sum);
+    int_min = std::move(other163.int_min);
+    int_max = std::move(other163.int_max);
+    __isset = std::move(other163.__isset);
+}
+scan_aggregate_result &scan_aggregate_result::operator=(const scan_aggregate_result &other164)
+{
+    row_count = other164.row_count;
+    key_bytes = other164.key_bytes;
+    value_bytes = other164.value_bytes;
+    int_count = other164.int_count;
+    int_sum = other164.int_sum;
+    int_min = other164.int_min;
+    int_max = other164.int_max;
+    __isset = other164.__isset;
+    return *this;
+}
+scan_aggregate_result &scan_aggregate_result::operator=(scan_aggregate_result &&other165)
+{
+    row_count = std::move(other165.row_count);
+    key_bytes = std::move(other165.key_bytes);
+    value_bytes = std::move(other165.value_bytes);
+    int_count = std::move(other165.int_count);
+    int_sum = std::move(other165.int_sum);
+    int_min = std::move(other165.int_min);
+    int_max = std::move(other165.int_max);
+    __isset = std::move(other165.__isset);
+    return *this;
+}
+void scan_aggregate_result::printTo(std::ostream &out) const
+{
+    using ::apache::thrift::to_string;
+    out << "scan_aggregate_result(";
+    out << "row_count=" << to_string(row_count);
+    out << ", "
+        << "key_bytes=" << to_string(key_bytes);
+    out << ", "
+        << "value_bytes=" << to_string(value_bytes);
+    out << ", "
+        << "int_count=" << to_string(int_count);
+    out << ", "
+        << "int_sum=" << to_string(int_sum);
+    out << ", "
+        << "int_min=" << to_string(int_min);
+    out << ", "
+        << "int_max=" << to_string(int_max);
+    out << ")";
+}
+
 get_scanner_request::~get_scanner_request() throw() {}
 
 void get_scanner_request::__set_start_key(const ::dsn::blob &val) { this->start_key = val; }
@@ -3712,6 +3974,12 @@ void get_scanner_request::__set_return_expire_ts(const bool val)
     __isset.return_expire_ts = true;
 }
 
+void get_scanner_request::__set_aggregate_type(const scan_aggregate_type::type val)
+{
+    this->aggregate_type = val;
+    __isset.aggregate_type = true;
+}
+
 uint32_t get_scanner_request::read(::apache::thrift::protocol::TProtocol *iprot)
 {
 
@@ -3831,6 +4099,16 @@ uint32_t get_scanner_request::read(::apache::thrift::protocol::TProtocol *iprot)
                 xfer += iprot->skip(ftype);
             }
             break;
+        case 13:
+            if (ftype == ::apache::thrift::protocol::T_I32) {
+                int32_t ecast167;
+                xfer += iprot->readI32(ecast167);
+                this->aggregate_type = (scan_aggregate_type::type)ecast167;
+                this->__isset.aggregate_type = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
         default:
             xfer += iprot->skip(ftype);
             break;
@@ -3902,6 +4180,11 @@ uint32_t get_scanner_request::write(::apache::thrift::protocol::TProtocol *oprot
         xfer += oprot->writeBool(this->return_expire_ts);
         xfer += oprot->writeFieldEnd();
     }
+    if (this->__isset.aggregate_type) {
+        xfer += oprot->writeFieldBegin("aggregate_type", ::apache::thrift::protocol::T_I32, 13);
+        xfer += oprot->writeI32((int32_t)this->aggregate_type);
+        xfer += oprot->writeFieldEnd();
+    }
     xfer += oprot->writeFieldStop();
     xfer += oprot->writeStructEnd();
     return xfer;
@@ -3922,6 +4205,7 @@ void swap(get_scanner_request &a, get_scanner_request &b)
     swap(a.sort_key_filter_pattern, b.sort_key_filter_pattern);
     swap(a.validate_partition_hash, b.validate_partition_hash);
     swap(a.return_expire_ts, b.return_expire_ts);
+    swap(a.aggregate_type, b.aggregate_type);
     swap(a.__isset, b.__isset);
 }
 
@@ -3939,6 +4223,7 @@ get_scanner_request::get_scanner_request(const get_scanner_request &other108)
     sort_key_filter_pattern = other108.sort_key_filter_pattern;
     validate_partition_hash = other108.validate_partition_hash;
     return_expire_ts = other108.return_expire_ts;
+    aggregate_type = other108.aggregate_type;
     __isset = other108.__isset;
 }
 get_scanner_request::get_scanner_request(get_scanner_request &&other109)
@@ -3955,6 +4240,7 @@ get_scanner_request::get_scanner_request(get_scanner_request &&other109)
     sort_key_filter_pattern = std::move(other109.sort_key_filter_pattern);
     validate_partition_hash = std::move(other109.validate_partition_hash);
     return_expire_ts = std::move(other109.return_expire_ts);
+    aggregate_type = std::move(other109.aggregate_type);
     __isset = std::move(other109.__isset);
 }
 get_scanner_request &get_scanner_request::operator=(const get_scanner_request &other110)
@@ -3971,6 +4257,7 @@ get_scanner_request &get_scanner_request::operator=(const get_scanner_request &o
     sort_key_filter_pattern = other110.sort_key_filter_pattern;
     validate_partition_hash = other110.validate_partition_hash;
     return_expire_ts = other110.return_expire_ts;
+    aggregate_type = other110.aggregate_type;
     __isset = other110.__isset;
     return *this;
 }
@@ -3988,6 +4275,7 @@ get_scanner_request &get_scanner_request::operator=(get_scanner_request &&other1
     sort_key_filter_pattern = std::move(other111.sort_key_filter_pattern);
     validate_partition_hash = std::move(other111.validate_partition_hash);
     return_expire_ts = std::move(other111.return_expire_ts);
+    aggregate_type = std::move(other111.aggregate_type);
     __isset = std::move(other111.__isset);
     return *this;
 }
@@ -4021,6 +4309,9 @@ void get_scanner_request::printTo(std::ostream &out) const
     out << ", "
         << "return_expire_ts=";
     (__isset.return_expire_ts ? (out << to_string(return_expire_ts)) : (out << "<null>"));
+    out << ", "
+        << "aggregate_type=";
+    (__isset.aggregate_type ? (out << to_string(aggregate_type)) : (out << "<null>"));
     out << ")";
 }
 
@@ -4133,6 +4424,12 @@ void scan_response::__set_partition_index(const int32_t val) { this->partition_i
 
 void scan_response::__set_server(const std::string &val) { this->server = val; }
 
+void scan_response::__set_aggregate(const scan_aggregate_result &val)
+{
+    this->aggregate = val;
+    __isset.aggregate = true;
+}
+
 uint32_t scan_response::read(::apache::thrift::protocol::TProtocol *iprot)
 {
 
@@ -4211,6 +4508,14 @@ uint32_t scan_response::read(::apache::thrift::protocol::TProtocol *iprot)
                 xfer += iprot->skip(ftype);
             }
             break;
+        case 7:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->aggregate.read(iprot);
+                this->__isset.aggregate = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
         default:
             xfer += iprot->skip(ftype);
             break;
@@ -4261,6 +4566,11 @@ uint32_t scan_response::write(::apache::thrift::protocol::TProtocol *oprot) cons
     xfer += oprot->writeString(this->server);
     xfer += oprot->writeFieldEnd();
 
+    if (this->__isset.aggregate) {
+        xfer += oprot->writeFieldBegin("aggregate", ::apache::thrift::protocol::T_STRUCT, 7);
+        xfer += this->aggregate.write(oprot);
+        xfer += oprot->writeFieldEnd();
+    }
     xfer += oprot->writeFieldStop();
     xfer += oprot->writeStructEnd();
     return xfer;
@@ -4275,6 +4585,7 @@ void swap(scan_response &a, scan_response &b)
     swap(a.app_id, b.app_id);
     swap(a.partition_index, b.partition_index);
     swap(a.server, b.server);
+    swap(a.aggregate, b.aggregate);
     swap(a.__isset, b.__isset);
 }
 
@@ -4286,6 +4597,7 @@ scan_response::scan_response(const scan_response &other122)
     app_id = other122.app_id;
     partition_index = other122.partition_index;
     server = other122.server;
+    aggregate = other122.aggregate;
     __isset = other122.__isset;
 }
 scan_response::scan_response(scan_response &&other123)
@@ -4296,6 +4608,7 @@ scan_response::scan_response(scan_response &&other123)
     app_id = std::move(other123.app_id);
     partition_index = std::move(other123.partition_index);
     server = std::move(other123.server);
+    aggregate = std::move(other123.aggregate);
     __isset = std::move(other123.__isset);
 }
 scan_response &scan_response::operator=(const scan_response &other124)
@@ -4306,6 +4619,7 @@ scan_response &scan_response::operator=(const scan_response &other124)
     app_id = other124.app_id;
     partition_index = other124.partition_index;
     server = other124.server;
+    aggregate = other124.aggregate;
     __isset = other124.__isset;
     return *this;
 }
@@ -4317,6 +4631,7 @@ scan_response &scan_response::operator=(scan_response &&other125)
     app_id = std::move(other125.app_id);
     partition_index = std::move(other125.partition_index);
     server = std::move(other125.server);
+    aggregate = std::move(other125.aggregate);
     __isset = std::move(other125.__isset);
     return *this;
 }
@@ -4335,6 +4650,9 @@ void scan_response::printTo(std::ostream &out) const
         << "partition_index=" << to_string(partition_index);
     out << ", "
         << "server=" << to_string(server);
+    out << ", "
+        << "aggregate=";
+    (__isset.aggregate ? (out << to_string(aggregate)) : (out << "<null>"));
     out << ")";
 }
 
@@ -4674,5 +4992,969 @@ void duplicate_response::printTo(std::ostream &out) const
     (__isset.error_hint ? (out << to_string(error_hint)) : (out << "<null>"));
     out << ")";
 }
+
+full_key::~full_key() throw() {}
+
+void full_key::__set_hash_key(const ::dsn::blob &val) { this->hash_key = val; }
+
+void full_key::__set_sort_key(const ::dsn::blob &val) { this->sort_key = val; }
+
+uint32_t full_key::read(::apache::thrift::protocol::TProtocol *iprot)
+{
+
+    apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+    uint32_t xfer = 0;
+    std::string fname;
+    ::apache::thrift::protocol::TType ftype;
+    int16_t fid;
+
+    xfer += iprot->readStructBegin(fname);
+
+    using ::apache::thrift::protocol::TProtocolException;
+
+    while (true) {
+        xfer += iprot->readFieldBegin(fname, ftype, fid);
+        if (ftype == ::apache::thrift::protocol::T_STOP) {
+            break;
+        }
+        switch (fid) {
+        case 1:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->hash_key.read(iprot);
+                this->__isset.hash_key = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 2:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->sort_key.read(iprot);
+                this->__isset.sort_key = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        default:
+            xfer += iprot->skip(ftype);
+            break;
+        }
+        xfer += iprot->readFieldEnd();
+    }
+
+    xfer += iprot->readStructEnd();
+
+    return xfer;
+}
+
+uint32_t full_key::write(::apache::thrift::protocol::TProtocol *oprot) const
+{
+    uint32_t xfer = 0;
+    apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+    xfer += oprot->writeStructBegin("full_key");
+
+    xfer += oprot->writeFieldBegin("hash_key", ::apache::thrift::protocol::T_STRUCT, 1);
+    xfer += this->hash_key.write(oprot);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("sort_key", ::apache::thrift::protocol::T_STRUCT, 2);
+    xfer += this->sort_key.write(oprot);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldStop();
+    xfer += oprot->writeStructEnd();
+    return xfer;
+}
+
+void swap(full_key &a, full_key &b)
+{
+    using ::std::swap;
+    swap(a.hash_key, b.hash_key);
+    swap(a.sort_key, b.sort_key);
+    swap(a.__isset, b.__isset);
+}
+
+full_key::full_key(const full_key &other134)
+{
+    hash_key = other134.hash_key;
+    sort_key = other134.sort_key;
+    __isset = other134.__isset;
+}
+full_key::full_key(full_key &&other135)
+{
+    hash_key = std::move(other135.hash_key);
+    sort_key = std::move(other135.sort_key);
+    __isset = std::move(other135.__isset);
+}
+full_key &full_key::operator=(const full_key &other136)
+{
+    hash_key = other136.hash_key;
+    sort_key = other136.sort_key;
+    __isset = other136.__isset;
+    return *this;
+}
+full_key &full_key::operator=(full_key &&other137)
+{
+    hash_key = std::move(other137.hash_key);
+    sort_key = std::move(other137.sort_key);
+    __isset = std::move(other137.__isset);
+    return *this;
+}
+void full_key::printTo(std::ostream &out) const
+{
+    using ::apache::thrift::to_string;
+    out << "full_key(";
+    out << "hash_key=" << to_string(hash_key);
+    out << ", "
+        << "sort_key=" << to_string(sort_key);
+    out << ")";
+}
+
+batch_get_request::~batch_get_request() throw() {}
+
+void batch_get_request::__set_keys(const std::vector<full_key> &val) { this->keys = val; }
+
+uint32_t batch_get_request::read(::apache::thrift::protocol::TProtocol *iprot)
+{
+
+    apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+    uint32_t xfer = 0;
+    std::string fname;
+    ::apache::thrift::protocol::TType ftype;
+    int16_t fid;
+
+    xfer += iprot->readStructBegin(fname);
+
+    using ::apache::thrift::protocol::TProtocolException;
+
+    while (true) {
+        xfer += iprot->readFieldBegin(fname, ftype, fid);
+        if (ftype == ::apache::thrift::protocol::T_STOP) {
+            break;
+        }
+        switch (fid) {
+        case 1:
+            if (ftype == ::apache::thrift::protocol::T_LIST) {
+                {
+                    this->keys.clear();
+                    uint32_t _size138;
+                    ::apache::thrift::protocol::TType _etype141;
+                    xfer += iprot->readListBegin(_etype141, _size138);
+                    this->keys.resize(_size138);
+                    uint32_t _i142;
+                    for (_i142 = 0; _i142 < _size138; ++_i142) {
+                        xfer += this->keys[_i142].read(iprot);
+                    }
+                    xfer += iprot->readListEnd();
+                }
+                this->__isset.keys = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        default:
+            xfer += iprot->skip(ftype);
+            break;
+        }
+        xfer += iprot->readFieldEnd();
+    }
+
+    xfer += iprot->readStructEnd();
+
+    return xfer;
+}
+
+uint32_t batch_get_request::write(::apache::thrift::protocol::TProtocol *oprot) const
+{
+    uint32_t xfer = 0;
+    apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+    xfer += oprot->writeStructBegin("batch_get_request");
+
+    xfer += oprot->writeFieldBegin("keys", ::apache::thrift::protocol::T_LIST, 1);
+    {
+        xfer += oprot->writeListBegin(::apache::thrift::protocol::T_STRUCT,
+                                      static_cast<uint32_t>(this->keys.size()));
+        std::vector<full_key>::const_iterator _iter143;
+        for (_iter143 = this->keys.begin(); _iter143 != this->keys.end(); ++_iter143) {
+            xfer += (*_iter143).write(oprot);
+        }
+        xfer += oprot->writeListEnd();
+    }
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldStop();
+    xfer += oprot->writeStructEnd();
+    return xfer;
+}
+
+void swap(batch_get_request &a, batch_get_request &b)
+{
+    using ::std::swap;
+    swap(a.keys, b.keys);
+    swap(a.__isset, b.__isset);
+}
+
+batch_get_request::batch_get_request(const batch_get_request &other144)
+{
+    keys = other144.keys;
+    __isset = other144.__isset;
+}
+batch_get_request::batch_get_request(batch_get_request &&other145)
+{
+    keys = std::move(other145.keys);
+    __isset = std::move(other145.__isset);
+}
+batch_get_request &batch_get_request::operator=(const batch_get_request &other146)
+{
+    keys = other146.keys;
+    __isset = other146.__isset;
+    return *this;
+}
+batch_get_request &batch_get_request::operator=(batch_get_request &&other147)
+{
+    keys = std::move(other147.keys);
+    __isset = std::move(other147.__isset);
+    return *this;
+}
+void batch_get_request::printTo(std::ostream &out) const
+{
+    using ::apache::thrift::to_string;
+    out << "batch_get_request(";
+    out << "keys=" << to_string(keys);
+    out << ")";
+}
+
+full_data::~full_data() throw() {}
+
+void full_data::__set_hash_key(const ::dsn::blob &val) { this->hash_key = val; }
+
+void full_data::__set_sort_key(const ::dsn::blob &val) { this->sort_key = val; }
+
+void full_data::__set_value(const ::dsn::blob &val) { this->value = val; }
+
+uint32_t full_data::read(::apache::thrift::protocol::TProtocol *iprot)
+{
+
+    apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+    uint32_t xfer = 0;
+    std::string fname;
+    ::apache::thrift::protocol::TType ftype;
+    int16_t fid;
+
+    xfer += iprot->readStructBegin(fname);
+
+    using ::apache::thrift::protocol::TProtocolException;
+
+    while (true) {
+        xfer += iprot->readFieldBegin(fname, ftype, fid);
+        if (ftype == ::apache::thrift::protocol::T_STOP) {
+            break;
+        }
+        switch (fid) {
+        case 1:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->hash_key.read(iprot);
+                this->__isset.hash_key = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 2:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->sort_key.read(iprot);
+                this->__isset.sort_key = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 3:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->value.read(iprot);
+                this->__isset.value = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        default:
+            xfer += iprot->skip(ftype);
+            break;
+        }
+        xfer += iprot->readFieldEnd();
+    }
+
+    xfer += iprot->readStructEnd();
+
+    return xfer;
+}
+
+uint32_t full_data::write(::apache::thrift::protocol::TProtocol *oprot) const
+{
+    uint32_t xfer = 0;
+    apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+    xfer += oprot->writeStructBegin("full_data");
+
+    xfer += oprot->writeFieldBegin("hash_key", ::apache::thrift::protocol::T_STRUCT, 1);
+    xfer += this->hash_key.write(oprot);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("sort_key", ::apache::thrift::protocol::T_STRUCT, 2);
+    xfer += this->sort_key.write(oprot);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("value", ::apache::thrift::protocol::T_STRUCT, 3);
+    xfer += this->value.write(oprot);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldStop();
+    xfer += oprot->writeStructEnd();
+    return xfer;
+}
+
+void swap(full_data &a, full_data &b)
+{
+    using ::std::swap;
+    swap(a.hash_key, b.hash_key);
+    swap(a.sort_key, b.sort_key);
+    swap(a.value, b.value);
+    swap(a.__isset, b.__isset);
+}
+
+full_data::full_data(const full_data &other148)
+{
+    hash_key = other148.hash_key;
+    sort_key = other148.sort_key;
+    value = other148.value;
+    __isset = other148.__isset;
+}
+full_data::full_data(full_data &&other149)
+{
+    hash_key = std::move(other149.hash_key);
+    sort_key = std::move(other149.sort_key);
+    value = std::move(other149.value);
+    __isset = std::move(other149.__isset);
+}
+full_data &full_data::operator=(const full_data &other150)
+{
+    hash_key = other150.hash_key;
+    sort_key = other150.sort_key;
+    value = other150.value;
+    __isset = other150.__isset;
+    return *this;
+}
+full_data &full_data::operator=(full_data &&other151)
+{
+    hash_key = std::move(other151.hash_key);
+    sort_key = std::move(other151.sort_key);
+    value = std::move(other151.value);
+    __isset = std::move(other151.__isset);
+    return *this;
+}
+void full_data::printTo(std::ostream &out) const
+{
+    using ::apache::thrift::to_string;
+    out << "full_data(";
+    out << "hash_key=" << to_string(hash_key);
+    out << ", "
+        << "sort_key=" << to_string(sort_key);
+    out << ", "
+        << "value=" << to_string(value);
+    out << ")";
+}
+
+batch_get_response::~batch_get_response() throw() {}
+
+void batch_get_response::__set_error(const int32_t val) { this->error = val; }
+
+void batch_get_response::__set_data(const std::vector<full_data> &val) { this->data = val; }
+
+void batch_get_response::__set_app_id(const int32_t val) { this->app_id = val; }
+
+void batch_get_response::__set_partition_index(const int32_t val) { this->partition_index = val; }
+
+void batch_get_response::__set_server(const std::string &val) { this->server = val; }
+
+uint32_t batch_get_response::read(::apache::thrift::protocol::TProtocol *iprot)
+{
+
+    apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+    uint32_t xfer = 0;
+    std::string fname;
+    ::apache::thrift::protocol::TType ftype;
+    int16_t fid;
+
+    xfer += iprot->readStructBegin(fname);
+
+    using ::apache::thrift::protocol::TProtocolException;
+
+    while (true) {
+        xfer += iprot->readFieldBegin(fname, ftype, fid);
+        if (ftype == ::apache::thrift::protocol::T_STOP) {
+            break;
+        }
+        switch (fid) {
+        case 1:
+            if (ftype == ::apache::thrift::protocol::T_I32) {
+                xfer += iprot->readI32(this->error);
+                this->__isset.error = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 2:
+            if (ftype == ::apache::thrift::protocol::T_LIST) {
+                {
+                    this->data.clear();
+                    uint32_t _size152;
+                    ::apache::thrift::protocol::TType _etype155;
+                    xfer += iprot->readListBegin(_etype155, _size152);
+                    this->data.resize(_size152);
+                    uint32_t _i156;
+                    for (_i156 = 0; _i156 < _size152; ++_i156) {
+                        xfer += this->data[_i156].read(iprot);
+                    }
+                    xfer += iprot->readListEnd();
+                }
+                this->__isset.data = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 3:
+            if (ftype == ::apache::thrift::protocol::T_I32) {
+                xfer += iprot->readI32(this->app_id);
+                this->__isset.app_id = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 4:
+            if (ftype == ::apache::thrift::protocol::T_I32) {
+                xfer += iprot->readI32(this->partition_index);
+                this->__isset.partition_index = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 6:
+            if (ftype == ::apache::thrift::protocol::T_STRING) {
+                xfer += iprot->readString(this->server);
+                this->__isset.server = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        default:
+            xfer += iprot->skip(ftype);
+            break;
+        }
+        xfer += iprot->readFieldEnd();
+    }
+
+    xfer += iprot->readStructEnd();
+
+    return xfer;
+}
+
+uint32_t batch_get_response::write(::apache::thrift::protocol::TProtocol *oprot) const
+{
+    uint32_t xfer = 0;
+    apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+    xfer += oprot->writeStructBegin("batch_get_response");
+
+    xfer += oprot->writeFieldBegin("error", ::apache::thrift::protocol::T_I32, 1);
+    xfer += oprot->writeI32(this->error);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("data", ::apache::thrift::protocol::T_LIST, 2);
+    {
+        xfer += oprot->writeListBegin(::apache::thrift::protocol::T_STRUCT,
+                                      static_cast<uint32_t>(this->data.size()));
+        std::vector<full_data>::const_iterator _iter157;
+        for (_iter157 = this->data.begin(); _iter157 != this->data.end(); ++_iter157) {
+            xfer += (*_iter157).write(oprot);
+        }
+        xfer += oprot->writeListEnd();
+    }
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("app_id", ::apache::thrift::protocol::T_I32, 3);
+    xfer += oprot->writeI32(this->app_id);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("partition_index", ::apache::thrift::protocol::T_I32, 4);
+    xfer += oprot->writeI32(this->partition_index);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("server", ::apache::thrift::protocol::T_STRING, 6);
+    xfer += oprot->writeString(this->server);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldStop();
+    xfer += oprot->writeStructEnd();
+    return xfer;
+}
+
+void swap(batch_get_response &a, batch_get_response &b)
+{
+    using ::std::swap;
+    swap(a.error, b.error);
+    swap(a.data, b.data);
+    swap(a.app_id, b.app_id);
+    swap(a.partition_index, b.partition_index);
+    swap(a.server, b.server);
+    swap(a.__isset, b.__isset);
+}
+
+batch_get_response::batch_get_response(const batch_get_response &other158)
+{
+    error = other158.error;
+    data = other158.data;
+    app_id = other158.app_id;
+    partition_index = other158.partition_index;
+    server = other158.server;
+    __isset = other158.__isset;
+}
+batch_get_response::batch_get_response(batch_get_response &&other159)
+{
+    error = std::move(other159.error);
+    data = std::move(other159.data);
+    app_id = std::move(other159.app_id);
+    partition_index = std::move(other159.partition_index);
+    server = std::move(other159.server);
+    __isset = std::move(other159.__isset);
+}
+batch_get_response &batch_get_response::operator=(const batch_get_response &other160)
+{
+    error = other160.error;
+    data = other160.data;
+    app_id = other160.app_id;
+    partition_index = other160.partition_index;
+    server = other160.server;
+    __isset = other160.__isset;
+    return *this;
+}
+batch_get_response &batch_get_response::operator=(batch_get_response &&other161)
+{
+    error = std::move(other161.error);
+    data = std::move(other161.data);
+    app_id = std::move(other161.app_id);
+    partition_index = std::move(other161.partition_index);
+    server = std::move(other161.server);
+    __isset = std::move(other161.__isset);
+    return *this;
+}
+void batch_get_response::printTo(std::ostream &out) const
+{
+    using ::apache::thrift::to_string;
+    out << "batch_get_response(";
+    out << "error=" << to_string(error);
+    out << ", "
+        << "data=" << to_string(data);
+    out << ", "
+        << "app_id=" << to_string(app_id);
+    out << ", "
+        << "partition_index=" << to_string(partition_index);
+    out << ", "
+        << "server=" << to_string(server);
+    out << ")";
+}
+
+sortkey_count_request::~sortkey_count_request() throw() {}
+
+void sortkey_count_request::__set_hash_key(const ::dsn::blob &val) { this->hash_key = val; }
+
+void sortkey_count_request::__set_approximate(const bool val) { this->approximate = val; }
+
+uint32_t sortkey_count_request::read(::apache::thrift::protocol::TProtocol *iprot)
+{
+
+    apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+    uint32_t xfer = 0;
+    std::string fname;
+    ::apache::thrift::protocol::TType ftype;
+    int16_t fid;
+
+    xfer += iprot->readStructBegin(fname);
+
+    using ::apache::thrift::protocol::TProtocolException;
+
+    while (true) {
+        xfer += iprot->readFieldBegin(fname, ftype, fid);
+        if (ftype == ::apache::thrift::protocol::T_STOP) {
+            break;
+        }
+        switch (fid) {
+        case 1:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->hash_key.read(iprot);
+                this->__isset.hash_key = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 2:
+            if (ftype == ::apache::thrift::protocol::T_BOOL) {
+                xfer += iprot->readBool(this->approximate);
+                this->__isset.approximate = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        default:
+            xfer += iprot->skip(ftype);
+            break;
+        }
+        xfer += iprot->readFieldEnd();
+    }
+
+    xfer += iprot->readStructEnd();
+
+    return xfer;
+}
+
+uint32_t sortkey_count_request::write(::apache::thrift::protocol::TProtocol *oprot) const
+{
+    uint32_t xfer = 0;
+    apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+    xfer += oprot->writeStructBegin("sortkey_count_request");
+
+    xfer += oprot->writeFieldBegin("hash_key", ::apache::thrift::protocol::T_STRUCT, 1);
+    xfer += this->hash_key.write(oprot);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("approximate", ::apache::thrift::protocol::T_BOOL, 2);
+    xfer += oprot->writeBool(this->approximate);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldStop();
+    xfer += oprot->writeStructEnd();
+    return xfer;
+}
+
+void swap(sortkey_count_request &a, sortkey_count_request &b)
+{
+    using ::std::swap;
+    swap(a.hash_key, b.hash_key);
+    swap(a.approximate, b.approximate);
+    swap(a.__isset, b.__isset);
+}
+
+sortkey_count_request::sortkey_count_request(const sortkey_count_request &other167)
+{
+    hash_key = other167.hash_key;
+    approximate = other167.approximate;
+    __isset = other167.__isset;
+}
+sortkey_count_request::sortkey_count_request(sortkey_count_request &&other168)
+{
+    hash_key = std::move(other168.hash_key);
+    approximate = std::move(other168.approximate);
+    __isset = std::move(other168.__isset);
+}
+sortkey_count_request &sortkey_count_request::operator=(const sortkey_count_request &other169)
+{
+    hash_key = other169.hash_key;
+    approximate = other169.approximate;
+    __isset = other169.__isset;
+    return *this;
+}
+sortkey_count_request &sortkey_count_request::operator=(sortkey_count_request &&other170)
+{
+    hash_key = std::move(other170.hash_key);
+    approximate = std::move(other170.approximate);
+    __isset = std::move(other170.__isset);
+    return *this;
+}
+void sortkey_count_request::printTo(std::ostream &out) const
+{
+    using ::apache::thrift::to_string;
+    out << "sortkey_count_request(";
+    out << "hash_key=" << to_string(hash_key);
+    out << ", "
+        << "approximate=" << to_string(approximate);
+    out << ")";
+}
+
+batch_write_operation::~batch_write_operation() throw() {}
+
+void batch_write_operation::__set_operation(const mutate_operation::type val)
+{
+    this->operation = val;
+}
+
+void batch_write_operation::__set_key(const ::dsn::blob &val) { this->key = val; }
+
+void batch_write_operation::__set_value(const ::dsn::blob &val) { this->value = val; }
+
+void batch_write_operation::__set_expire_ts_seconds(const int32_t val)
+{
+    this->expire_ts_seconds = val;
+}
+
+uint32_t batch_write_operation::read(::apache::thrift::protocol::TProtocol *iprot)
+{
+
+    apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+    uint32_t xfer = 0;
+    std::string fname;
+    ::apache::thrift::protocol::TType ftype;
+    int16_t fid;
+
+    xfer += iprot->readStructBegin(fname);
+
+    using ::apache::thrift::protocol::TProtocolException;
+
+    while (true) {
+        xfer += iprot->readFieldBegin(fname, ftype, fid);
+        if (ftype == ::apache::thrift::protocol::T_STOP) {
+            break;
+        }
+        switch (fid) {
+        case 1:
+            if (ftype == ::apache::thrift::protocol::T_I32) {
+                int32_t ecast171;
+                xfer += iprot->readI32(ecast171);
+                this->operation = (mutate_operation::type)ecast171;
+                this->__isset.operation = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 2:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->key.read(iprot);
+                this->__isset.key = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 3:
+            if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+                xfer += this->value.read(iprot);
+                this->__isset.value = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        case 4:
+            if (ftype == ::apache::thrift::protocol::T_I32) {
+                xfer += iprot->readI32(this->expire_ts_seconds);
+                this->__isset.expire_ts_seconds = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        default:
+            xfer += iprot->skip(ftype);
+            break;
+        }
+        xfer += iprot->readFieldEnd();
+    }
+
+    xfer += iprot->readStructEnd();
+
+    return xfer;
+}
+
+uint32_t batch_write_operation::write(::apache::thrift::protocol::TProtocol *oprot) const
+{
+    uint32_t xfer = 0;
+    apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+    xfer += oprot->writeStructBegin("batch_write_operation");
+
+    xfer += oprot->writeFieldBegin("operation", ::apache::thrift::protocol::T_I32, 1);
+    xfer += oprot->writeI32((int32_t)this->operation);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("key", ::apache::thrift::protocol::T_STRUCT, 2);
+    xfer += this->key.write(oprot);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("value", ::apache::thrift::protocol::T_STRUCT, 3);
+    xfer += this->value.write(oprot);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldBegin("expire_ts_seconds", ::apache::thrift::protocol::T_I32, 4);
+    xfer += oprot->writeI32(this->expire_ts_seconds);
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldStop();
+    xfer += oprot->writeStructEnd();
+    return xfer;
+}
+
+void swap(batch_write_operation &a, batch_write_operation &b)
+{
+    using ::std::swap;
+    swap(a.operation, b.operation);
+    swap(a.key, b.key);
+    swap(a.value, b.value);
+    swap(a.expire_ts_seconds, b.expire_ts_seconds);
+    swap(a.__isset, b.__isset);
+}
+
+batch_write_operation::batch_write_operation(const batch_write_operation &other172)
+{
+    operation = other172.operation;
+    key = other172.key;
+    value = other172.value;
+    expire_ts_seconds = other172.expire_ts_seconds;
+    __isset = other172.__isset;
+}
+batch_write_operation::batch_write_operation(batch_write_operation &&other173)
+{
+    operation = std::move(other173.operation);
+    key = std::move(other173.key);
+    value = std::move(other173.value);
+    expire_ts_seconds = std::move(other173.expire_ts_seconds);
+    __isset = std::move(other173.__isset);
+}
+batch_write_operation &batch_write_operation::operator=(const batch_write_operation &other174)
+{
+    operation = other174.operation;
+    key = other174.key;
+    value = other174.value;
+    expire_ts_seconds = other174.expire_ts_seconds;
+    __isset = other174.__isset;
+    return *this;
+}
+batch_write_operation &batch_write_operation::operator=(batch_write_operation &&other175)
+{
+    operation = std::move(other175.operation);
+    key = std::move(other175.key);
+    value = std::move(other175.value);
+    expire_ts_seconds = std::move(other175.expire_ts_seconds);
+    __isset = std::move(other175.__isset);
+    return *this;
+}
+void batch_write_operation::printTo(std::ostream &out) const
+{
+    using ::apache::thrift::to_string;
+    out << "batch_write_operation(";
+    out << "operation=" << to_string(operation);
+    out << ", "
+        << "key=" << to_string(key);
+    out << ", "
+        << "value=" << to_string(value);
+    out << ", "
+        << "expire_ts_seconds=" << to_string(expire_ts_seconds);
+    out << ")";
+}
+
+batch_write_request::~batch_write_request() throw() {}
+
+void batch_write_request::__set_operations(const std::vector<batch_write_operation> &val)
+{
+    this->operations = val;
+}
+
+uint32_t batch_write_request::read(::apache::thrift::protocol::TProtocol *iprot)
+{
+
+    apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+    uint32_t xfer = 0;
+    std::string fname;
+    ::apache::thrift::protocol::TType ftype;
+    int16_t fid;
+
+    xfer += iprot->readStructBegin(fname);
+
+    using ::apache::thrift::protocol::TProtocolException;
+
+    while (true) {
+        xfer += iprot->readFieldBegin(fname, ftype, fid);
+        if (ftype == ::apache::thrift::protocol::T_STOP) {
+            break;
+        }
+        switch (fid) {
+        case 1:
+            if (ftype == ::apache::thrift::protocol::T_LIST) {
+                {
+                    this->operations.clear();
+                    uint32_t _size176;
+                    ::apache::thrift::protocol::TType _etype179;
+                    xfer += iprot->readListBegin(_etype179, _size176);
+                    this->operations.resize(_size176);
+                    uint32_t _i180;
+                    for (_i180 = 0; _i180 < _size176; ++_i180) {
+                        xfer += this->operations[_i180].read(iprot);
+                    }
+                    xfer += iprot->readListEnd();
+                }
+                this->__isset.operations = true;
+            } else {
+                xfer += iprot->skip(ftype);
+            }
+            break;
+        default:
+            xfer += iprot->skip(ftype);
+            break;
+        }
+        xfer += iprot->readFieldEnd();
+    }
+
+    xfer += iprot->readStructEnd();
+
+    return xfer;
+}
+
+uint32_t batch_write_request::write(::apache::thrift::protocol::TProtocol *oprot) const
+{
+    uint32_t xfer = 0;
+    apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+    xfer += oprot->writeStructBegin("batch_write_request");
+
+    xfer += oprot->writeFieldBegin("operations", ::apache::thrift::protocol::T_LIST, 1);
+    {
+        xfer += oprot->writeListBegin(::apache::thrift::protocol::T_STRUCT,
+                                      static_cast<uint32_t>(this->operations.size()));
+        std::vector<batch_write_operation>::const_iterator _iter181;
+        for (_iter181 = this->operations.begin(); _iter181 != this->operations.end(); ++_iter181) {
+            xfer += (*_iter181).write(oprot);
+        }
+        xfer += oprot->writeListEnd();
+    }
+    xfer += oprot->writeFieldEnd();
+
+    xfer += oprot->writeFieldStop();
+    xfer += oprot->writeStructEnd();
+    return xfer;
+}
+
+void swap(batch_write_request &a, batch_write_request &b)
+{
+    using ::std::swap;
+    swap(a.operations, b.operations);
+    swap(a.__isset, b.__isset);
+}
+
+batch_write_request::batch_write_request(const batch_write_request &other182)
+{
+    operations = other182.operations;
+    __isset = other182.__isset;
+}
+batch_write_request::batch_write_request(batch_write_request &&other183)
+{
+    operations = std::move(other183.operations);
+    __isset = std::move(other183.__isset);
+}
+batch_write_request &batch_write_request::operator=(const batch_write_request &other184)
+{
+    operations = other184.operations;
+    __isset = other184.__isset;
+    return *this;
+}
+batch_write_request &batch_write_request::operator=(batch_write_request &&other185)
+{
+    operations = std::move(other185.operations);
+    __isset = std::move(other185.__isset);
+    return *this;
+}
+void batch_write_request::printTo(std::ostream &out) const
+{
+    using ::apache::thrift::to_string;
+    out << "batch_write_request(";
+    out << "operations=" << to_string(operations);
+    out << ")";
+}
 }
 } // namespace
@@ -26,9 +26,12 @@
 #include <dsn/tool-api/group_address.h>
 #include <dsn/dist/replication/replication_other_types.h>
 #include <dsn/cpp/serialization_helper/dsn.layer2_types.h>
+#include <dsn/utility/smart_pointers.h>
 #include <rrdb/rrdb.code.definition.h>
 #include <pegasus/error.h>
 #include "pegasus_client_impl.h"
+#include "pegasus_write_batcher.h"
+#include "pegasus_read_hedger.h"
 #include "base/pegasus_const.h"
 
 using namespace ::dsn;
@@ -52,9 +55,16 @@ pegasus_client_impl::pegasus_client_impl(const char *cluster_name, const char *a
     _meta_server.group_address()->add_list(meta_servers);
 
     _client = new ::dsn::apps::rrdb_client(cluster_name, meta_servers, app_name);
+    _write_batcher = dsn::make_unique<pegasus_write_batcher>(
+        _client, [this]() { _partition_count.store(0); });
+    _read_hedger = dsn::make_unique<pegasus_read_hedger>(_cluster_name, _app_name, _meta_server);
 }
 
-pegasus_client_impl::~pegasus_client_impl() { delete _client; }
+pegasus_client_impl::~pegasus_client_impl()
+{
+    _write_batcher.reset();
+    delete _client;
+}
 
 const char *pegasus_client_impl::get_cluster_name() const { return _cluster_name.c_str(); }
 
@@ -75,7 +85,14 @@ int pegasus_client_impl::set(const std::string &hash_key,
             (*info) = std::move(_info);
         op_completed.notify();
     };
-    async_set(hash_key, sort_key, value, std::move(callback), timeout_milliseconds, ttl_seconds);
+    // the sync writes are never batched, which would add the batch delay to their latency.
+    async_set_internal(hash_key,
+                       sort_key,
+                       value,
+                       std::move(callback),
+                       timeout_milliseconds,
+                       ttl_seconds,
+                       false /*allow_batch*/);
     op_completed.wait();
     return ret;
 }
@@ -86,6 +103,23 @@ void pegasus_client_impl::async_set(const std::string &hash_key,
                                     async_set_callback_t &&callback,
                                     int timeout_milliseconds,
                                     int ttl_seconds)
+{
+    async_set_internal(hash_key,
+                       sort_key,
+                       value,
+                       std::move(callback),
+                       timeout_milliseconds,
+                       ttl_seconds,
+                       true /*allow_batch*/);
+}
+
+void pegasus_client_impl::async_set_internal(const std::string &hash_key,
+                                             const std::string &sort_key,
+                                             const std::string &value,
+                                             async_set_callback_t &&callback,
+                                             int timeout_milliseconds,
+                                             int ttl_seconds,
+                                             bool allow_batch)
 {
     // check params
     if (hash_key.size() >= UINT16_MAX) {
@@ -104,6 +138,15 @@ void pegasus_client_impl::async_set(const std::string &hash_key,
         req.expire_ts_seconds = ttl_seconds + utils::epoch_now();
 
     auto partition_hash = pegasus_key_hash(req.key);
+    if (allow_batch && try_batch_write(::dsn::apps::mutate_operation::MO_PUT,
+                                       req.key,
+                                       req.value,
+                                       req.expire_ts_seconds,
+                                       partition_hash,
+                                       callback,
+                                       timeout_milliseconds)) {
+        return;
+    }
 
     // wrap the user defined callback function, generate a new callback function.
     auto new_callback = [user_callback = std::move(callback)](
@@ -277,10 +320,17 @@ void pegasus_client_impl::async_get(const std::string &hash_key,
             get_client_error(err == ERR_OK ? get_rocksdb_server_error(response.error) : int(err));
         user_callback(ret, std::move(value), std::move(info));
     };
-    _client->get(req,
-                 std::move(new_callback),
-                 std::chrono::milliseconds(timeout_milliseconds),
-                 partition_hash);
+    _read_hedger->call(RPC_RRDB_RRDB_GET,
+                       req,
+                       partition_hash,
+                       timeout_milliseconds,
+                       std::move(new_callback),
+                       [&](auto &&cb) {
+                           _client->get(req,
+                                        std::forward<decltype(cb)>(cb),
+                                        std::chrono::milliseconds(timeout_milliseconds),
+                                        partition_hash);
+                       });
 }
 
 int pegasus_client_impl::multi_get(const std::string &hash_key,
@@ -367,10 +417,17 @@ void pegasus_client_impl::async_multi_get(const std::string &hash_key,
             get_client_error(err == ERR_OK ? get_rocksdb_server_error(response.error) : int(err));
         user_callback(ret, std::move(values), std::move(info));
     };
-    _client->multi_get(req,
+    _read_hedger->call(RPC_RRDB_RRDB_MULTI_GET,
+                       req,
+                       partition_hash,
+                       timeout_milliseconds,
                        std::move(new_callback),
-                       std::chrono::milliseconds(timeout_milliseconds),
-                       partition_hash);
+                       [&](auto &&cb) {
+                           _client->multi_get(req,
+                                              std::forward<decltype(cb)>(cb),
+                                              std::chrono::milliseconds(timeout_milliseconds),
+                                              partition_hash);
+                       });
 }
 
 int pegasus_client_impl::multi_get(const std::string &hash_key,
@@ -467,10 +524,267 @@ void pegasus_client_impl::async_multi_get(const std::string &hash_key,
             get_client_error(err == ERR_OK ? get_rocksdb_server_error(response.error) : int(err));
         user_callback(ret, std::move(values), std::move(info));
     };
-    _client->multi_get(req,
+    _read_hedger->call(RPC_RRDB_RRDB_MULTI_GET,
+                       req,
+                       partition_hash,
+                       timeout_milliseconds,
                        std::move(new_callback),
-                       std::chrono::milliseconds(timeout_milliseconds),
-                       partition_hash);
+                       [&](auto &&cb) {
+                           _client->multi_get(req,
+                                              std::forward<decltype(cb)>(cb),
+                                              std::chrono::milliseconds(timeout_milliseconds),
+                                              partition_hash);
+                       });
+}
+
+int pegasus_client_impl::batch_get(
+    const std::vector<std::pair<std::string, std::string>> &keys,
+    std::map<std::pair<std::string, std::string>, std::string> &values,
+    int timeout_milliseconds)
+{
+    ::dsn::utils::notify_event op_completed;
+    int ret = -1;
+    auto callback = [&](int err,
+                        std::map<std::pair<std::string, std::string>, std::string> &&_values) {
+        ret = err;
+        values = std::move(_values);
+        op_completed.notify();
+    };
+    async_batch_get(keys, std::move(callback), timeout_milliseconds);
+    op_completed.wait();
+    return ret;
+}
+
+void pegasus_client_impl::async_batch_get(
+    const std::vector<std::pair<std::string, std::string>> &keys,
+    async_batch_get_callback_t &&callback,
+    int timeout_milliseconds)
+{
+    // check params
+    for (const auto &key : keys) {
+        if (key.first.size() >= UINT16_MAX) {
+            derror("invalid hash key: hash key length should be less than UINT16_MAX, but %d",
+                   (int)key.first.size());
+            if (callback != nullptr)
+                callback(PERR_INVALID_HASH_KEY,
+                         std::map<std::pair<std::string, std::string>, std::string>());
+            return;
+        }
+    }
+    if (keys.empty()) {
+        if (callback != nullptr)
+            callback(PERR_OK, std::map<std::pair<std::string, std::string>, std::string>());
+        return;
+    }
+
+    int partition_count = _partition_count.load();
+    if (partition_count > 0) {
+        async_batch_get_by_partition(
+            keys, partition_count, std::move(callback), timeout_milliseconds);
+        return;
+    }
+
+    // the partition count is unknown, query it from meta server first
+    async_query_partition_count(
+        timeout_milliseconds,
+        [ this, keys, user_callback = std::move(callback), timeout_milliseconds ](
+            int err, int count) mutable {
+            if (err != PERR_OK) {
+                if (user_callback != nullptr)
+                    user_callback(err,
+                                  std::map<std::pair<std::string, std::string>, std::string>());
+                return;
+            }
+            _partition_count.store(count);
+            async_batch_get_by_partition(
+                keys, count, std::move(user_callback), timeout_milliseconds);
+        });
+}
+
+void pegasus_client_impl::async_batch_get_by_partition(
+    const std::vector<std::pair<std::string, std::string>> &keys,
+    int partition_count,
+    async_batch_get_callback_t &&callback,
+    int timeout_milliseconds,
+    bool retry)
+{
+    struct batch_get_context
+    {
+        ::dsn::zlock lock;
+        int error{PERR_OK};
+        std::map<std::pair<std::string, std::string>, std::string> values;
+        std::atomic<int> pending_count{0};
+        async_batch_get_callback_t user_callback;
+
+        void on_partition_done(int err,
+                               std::map<std::pair<std::string, std::string>, std::string> &&kvs)
+        {
+            {
+                ::dsn::zauto_lock l(lock);
+                if (err == PERR_OK) {
+                    for (auto &kv : kvs) {
+                        values.emplace(kv.first, std::move(kv.second));
+                    }
+                } else if (error == PERR_OK) {
+                    error = err;
+                }
+            }
+            if (--pending_count == 0 && user_callback != nullptr) {
+                user_callback(error, std::move(values));
+            }
+        }
+    };
+
+    // group the keys by partition, the partition is decided the same way as the partition
+    // resolver does, so that all the keys of a request are routed to the same partition.
+    std::map<int, ::dsn::apps::batch_get_request> requests;
+    std::map<int, uint64_t> partition_hashes;
+    std::map<int, std::vector<std::pair<std::string, std::string>>> partition_keys;
+    for (const auto &key : keys) {
+        ::dsn::blob raw_key;
+        pegasus_generate_key(raw_key, key.first, key.second);
+        uint64_t partition_hash = pegasus_key_hash(raw_key);
+        int partition_index =
+            static_cast<int>(partition_hash % static_cast<uint64_t>(partition_count));
+        partition_hashes.emplace(partition_index, partition_hash);
+
+        ::dsn::apps::full_key full_key;
+        full_key.hash_key = ::dsn::blob(key.first.data(), 0, key.first.size());
+        full_key.sort_key = ::dsn::blob(key.second.data(), 0, key.second.size());
+        requests[partition_index].keys.emplace_back(std::move(full_key));
+        partition_keys[partition_index].emplace_back(key);
+    }
+
+    auto context = std::make_shared<batch_get_context>();
+    context->pending_count.store(static_cast<int>(requests.size()));
+    context->user_callback = std::move(callback);
+    for (const auto &kv : requests) {
+        auto new_callback = [
+            this,
+            context,
+            retry,
+            timeout_milliseconds,
+            retry_keys = std::move(partition_keys[kv.first])
+        ](::dsn::error_code err, dsn::message_ex * req, dsn::message_ex * resp) mutable
+        {
+            ::dsn::apps::batch_get_response response;
+            if (err == ::dsn::ERR_OK) {
+                ::dsn::unmarshall(resp, response);
+            }
+            int ret = get_client_error(err == ERR_OK ? get_rocksdb_server_error(response.error)
+                                                     : int(err));
+            if (ret == PERR_INVALID_ARGUMENT) {
+                // some keys don't belong to the partition, the partition count may be changed
+                // (e.g. by partition split), so it should be queried again.
+                _partition_count.store(0);
+                if (retry) {
+                    async_query_partition_count(
+                        timeout_milliseconds,
+                        [ this, context, timeout_milliseconds, keys = std::move(retry_keys) ](
+                            int err, int count) {
+                            if (err != PERR_OK) {
+                                context->on_partition_done(err, {});
+                                return;
+                            }
+                            _partition_count.store(count);
+                            async_batch_get_by_partition(
+                                keys,
+                                count,
+                                [context](int err, std::map<std::pair<std::string, std::string>,
+                                                            std::string> &&values) {
+                                    context->on_partition_done(err, std::move(values));
+                                },
+                                timeout_milliseconds,
+                                false);
+                        });
+                    return;
+                }
+            }
+
+            std::map<std::pair<std::string, std::string>, std::string> values;
+            if (ret == PERR_OK) {
+                for (auto &data : response.data) {
+                    values.emplace(
+                        std::make_pair(std::string(data.hash_key.data(), data.hash_key.length()),
+                                       std::string(data.sort_key.data(), data.sort_key.length())),
+                        std::string(data.value.data(), data.value.length()));
+                }
+            }
+            context->on_partition_done(ret, std::move(values));
+        };
+        _client->batch_get(kv.second,
+                           std::move(new_callback),
+                           std::chrono::milliseconds(timeout_milliseconds),
+                           partition_hashes[kv.first]);
+    }
+}
+
+void pegasus_client_impl::async_query_partition_count(
+    int timeout_milliseconds, std::function<void(int /*error_code*/, int /*count*/)> &&cb)
+{
+    auto new_callback = [user_callback = std::move(cb)](
+        ::dsn::error_code err, dsn::message_ex * req, dsn::message_ex * resp)
+    {
+        configuration_query_by_index_response response;
+        int count = 0;
+        if (err == ERR_OK) {
+            ::dsn::unmarshall(resp, response);
+            if (response.err == ERR_OK) {
+                count = response.partition_count;
+            }
+        }
+        user_callback(get_client_error(err == ERR_OK ? int(response.err) : int(err)), count);
+    };
+
+    configuration_query_by_index_request req;
+    req.app_name = _app_name;
+    ::dsn::rpc::call(_meta_server,
+                     RPC_CM_QUERY_PARTITION_CONFIG_BY_INDEX,
+                     req,
+                     nullptr,
+                     new_callback,
+                     std::chrono::milliseconds(timeout_milliseconds),
+                     0,
+                     0);
+}
+
+bool pegasus_client_impl::try_batch_write(::dsn::apps::mutate_operation::type operation,
+                                          const ::dsn::blob &key,
+                                          const ::dsn::blob &value,
+                                          int32_t expire_ts_seconds,
+                                          uint64_t partition_hash,
+                                          async_set_callback_t &callback,
+                                          int timeout_milliseconds)
+{
+    if (!pegasus_write_batcher::enabled()) {
+        return false;
+    }
+
+    int partition_count = _partition_count.load();
+    if (partition_count <= 0) {
+        // the writes are sent one by one until the partition count is known.
+        bool expected = false;
+        if (_querying_partition_count.compare_exchange_strong(expected, true)) {
+            async_query_partition_count(timeout_milliseconds, [this](int err, int count) {
+                if (err == PERR_OK) {
+                    _partition_count.store(count);
+                }
+                _querying_partition_count.store(false);
+            });
+        }
+        return false;
+    }
+
+    ::dsn::apps::batch_write_operation op;
+    op.operation = operation;
+    op.key = key;
+    op.value = value;
+    op.expire_ts_seconds = expire_ts_seconds;
+    int partition_index =
+        static_cast<int>(partition_hash % static_cast<uint64_t>(partition_count));
+    _write_batcher->add(
+        partition_index, partition_hash, std::move(op), std::move(callback), timeout_milliseconds);
+    return true;
 }
 
 int pegasus_client_impl::multi_get_sortkeys(const std::string &hash_key,
@@ -545,10 +859,17 @@ void pegasus_client_impl::async_multi_get_sortkeys(const std::string &hash_key,
             get_client_error(err == ERR_OK ? get_rocksdb_server_error(response.error) : int(err));
         user_callback(ret, std::move(sort_keys), std::move(info));
     };
-    _client->multi_get(req,
+    _read_hedger->call(RPC_RRDB_RRDB_MULTI_GET,
+                       req,
+                       partition_hash,
+                       timeout_milliseconds,
                        std::move(new_callback),
-                       std::chrono::milliseconds(timeout_milliseconds),
-                       partition_hash);
+                       [&](auto &&cb) {
+                           _client->multi_get(req,
+                                              std::forward<decltype(cb)>(cb),
+                                              std::chrono::milliseconds(timeout_milliseconds),
+                                              partition_hash);
+                       });
 }
 
 int pegasus_client_impl::exist(const std::string &hash_key,
@@ -564,6 +885,23 @@ int pegasus_client_impl::sortkey_count(const std::string &hash_key,
                                        int64_t &count,
                                        int timeout_milliseconds,
                                        internal_info *info)
+{
+    return sortkey_count_internal(hash_key, false, count, timeout_milliseconds, info);
+}
+
+int pegasus_client_impl::approximate_sortkey_count(const std::string &hash_key,
+                                                   int64_t &count,
+                                                   int timeout_milliseconds,
+                                                   internal_info *info)
+{
+    return sortkey_count_internal(hash_key, true, count, timeout_milliseconds, info);
+}
+
+int pegasus_client_impl::sortkey_count_internal(const std::string &hash_key,
+                                                bool approximate,
+                                                int64_t &count,
+                                                int timeout_milliseconds,
+                                                internal_info *info)
 {
     // check params
     if (hash_key.size() == 0) {
@@ -579,9 +917,64 @@ int pegasus_client_impl::sortkey_count(const std::string &hash_key,
     ::dsn::blob tmp_key;
     pegasus_generate_key(tmp_key, hash_key, std::string());
     auto partition_hash = pegasus_key_hash(tmp_key);
-    auto pr = _client->sortkey_count_sync(::dsn::blob(hash_key.data(), 0, hash_key.length()),
-                                          std::chrono::milliseconds(timeout_milliseconds),
-                                          partition_hash);
+    std::pair<::dsn::error_code, ::dsn::apps::count_response> pr;
+    if (!pegasus_read_hedger::enabled()) {
+        // the sync rpcs are used as before if the reads are not hedged.
+        if (approximate) {
+            // the old rpc is still used by the exact count, which is supported by the old
+            // servers.
+            ::dsn::apps::sortkey_count_request req;
+            req.hash_key = ::dsn::blob(hash_key.data(), 0, hash_key.length());
+            req.approximate = true;
+            pr = _client->sortkey_count_v2_sync(
+                req, std::chrono::milliseconds(timeout_milliseconds), partition_hash);
+        } else {
+            pr = _client->sortkey_count_sync(::dsn::blob(hash_key.data(), 0, hash_key.length()),
+                                             std::chrono::milliseconds(timeout_milliseconds),
+                                             partition_hash);
+        }
+    } else {
+        ::dsn::utils::notify_event op_completed;
+        auto callback = [&](::dsn::error_code err, dsn::message_ex *, dsn::message_ex *resp) {
+            pr.first = err;
+            if (err == ERR_OK) {
+                ::dsn::unmarshall(resp, pr.second);
+            }
+            op_completed.notify();
+        };
+        if (approximate) {
+            ::dsn::apps::sortkey_count_request req;
+            req.hash_key = ::dsn::blob(hash_key.data(), 0, hash_key.length());
+            req.approximate = true;
+            _read_hedger->call(RPC_RRDB_RRDB_SORTKEY_COUNT_V2,
+                               req,
+                               partition_hash,
+                               timeout_milliseconds,
+                               std::move(callback),
+                               [&](auto &&cb) {
+                                   _client->sortkey_count_v2(
+                                       req,
+                                       std::forward<decltype(cb)>(cb),
+                                       std::chrono::milliseconds(timeout_milliseconds),
+                                       partition_hash);
+                               });
+        } else {
+            ::dsn::blob req(hash_key.data(), 0, hash_key.length());
+            _read_hedger->call(RPC_RRDB_RRDB_SORTKEY_COUNT,
+                               req,
+                               partition_hash,
+                               timeout_milliseconds,
+                               std::move(callback),
+                               [&](auto &&cb) {
+                                   _client->sortkey_count(
+                                       req,
+                                       std::forward<decltype(cb)>(cb),
+                                       std::chrono::milliseconds(timeout_milliseconds),
+                                       partition_hash);
+                               });
+        }
+        op_completed.wait();
+    }
     if (pr.first == ERR_OK && pr.second.error == 0) {
         count = pr.second.count;
     }
@@ -614,7 +1007,8 @@ int pegasus_client_impl::del(const std::string &hash_key,
             (*info) = std::move(_info);
         op_completed.notify();
     };
-    async_del(hash_key, sort_key, std::move(callback), timeout_milliseconds);
+    async_del_internal(
+        hash_key, sort_key, std::move(callback), timeout_milliseconds, false /*allow_batch*/);
     op_completed.wait();
     return ret;
 }
@@ -623,6 +1017,16 @@ void pegasus_client_impl::async_del(const std::string &hash_key,
                                     const std::string &sort_key,
                                     async_del_callback_t &&callback,
                                     int timeout_milliseconds)
+{
+    async_del_internal(
+        hash_key, sort_key, std::move(callback), timeout_milliseconds, true /*allow_batch*/);
+}
+
+void pegasus_client_impl::async_del_internal(const std::string &hash_key,
+                                             const std::string &sort_key,
+                                             async_del_callback_t &&callback,
+                                             int timeout_milliseconds,
+                                             bool allow_batch)
 {
     // check params
     if (hash_key.size() >= UINT16_MAX) {
@@ -636,6 +1040,15 @@ void pegasus_client_impl::async_del(const std::string &hash_key,
     ::dsn::blob req;
     pegasus_generate_key(req, hash_key, sort_key);
     auto partition_hash = pegasus_key_hash(req);
+    if (allow_batch && try_batch_write(::dsn::apps::mutate_operation::MO_DELETE,
+                                       req,
+                                       ::dsn::blob(),
+                                       0,
+                                       partition_hash,
+                                       callback,
+                                       timeout_milliseconds)) {
+        return;
+    }
 
     auto new_callback = [user_callback = std::move(callback)](
         ::dsn::error_code err, dsn::message_ex * req, dsn::message_ex * resp)
@@ -1091,8 +1504,33 @@ int pegasus_client_impl::ttl(const std::string &hash_key,
     ::dsn::blob req;
     pegasus_generate_key(req, hash_key, sort_key);
     auto partition_hash = pegasus_key_hash(req);
-    auto pr =
-        _client->ttl_sync(req, std::chrono::milliseconds(timeout_milliseconds), partition_hash);
+    std::pair<::dsn::error_code, ::dsn::apps::ttl_response> pr;
+    if (!pegasus_read_hedger::enabled()) {
+        // the sync rpc is used as before if the reads are not hedged.
+        pr = _client->ttl_sync(
+            req, std::chrono::milliseconds(timeout_milliseconds), partition_hash);
+    } else {
+        ::dsn::utils::notify_event op_completed;
+        auto callback = [&](::dsn::error_code err, dsn::message_ex *, dsn::message_ex *resp) {
+            pr.first = err;
+            if (err == ERR_OK) {
+                ::dsn::unmarshall(resp, pr.second);
+            }
+            op_completed.notify();
+        };
+        _read_hedger->call(RPC_RRDB_RRDB_TTL,
+                           req,
+                           partition_hash,
+                           timeout_milliseconds,
+                           std::move(callback),
+                           [&](auto &&cb) {
+                               _client->ttl(req,
+                                            std::forward<decltype(cb)>(cb),
+                                            std::chrono::milliseconds(timeout_milliseconds),
+                                            partition_hash);
+                           });
+        op_completed.wait();
+    }
     if (pr.first == ERR_OK && pr.second.error == 0) {
         ttl_seconds = pr.second.ttl_seconds;
     }
@@ -1184,9 +1622,6 @@ int pegasus_client_impl::get_scanner(const std::string &hash_key,
     return PERR_OK;
 }
 
-DEFINE_TASK_CODE_RPC(RPC_CM_QUERY_PARTITION_CONFIG_BY_INDEX,
-                     TASK_PRIORITY_COMMON,
-                     ::dsn::THREAD_POOL_DEFAULT)
 void pegasus_client_impl::async_get_unordered_scanners(
     int max_split_count,
     const scan_options &options,
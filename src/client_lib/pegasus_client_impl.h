@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <pegasus/client.h>
 #include <rrdb/rrdb.client.h>
@@ -27,8 +28,24 @@
 #include "base/pegasus_utils.h"
 
 namespace pegasus {
+
+struct pegasus_client::scan_batch::rows
+{
+    std::vector<::dsn::apps::key_value> kvs;
+};
+
 namespace client {
 
+// the rpc to query the partition configuration of an app from meta server, which is handled
+// by the default thread pool on the client side.
+DEFINE_TASK_CODE_RPC(RPC_CM_QUERY_PARTITION_CONFIG_BY_INDEX,
+                     TASK_PRIORITY_COMMON,
+                     ::dsn::THREAD_POOL_DEFAULT)
+
+class pegasus_write_batcher;
+class pegasus_read_hedger;
+class pegasus_parallel_scan_executor;
+
 class pegasus_client_impl : public pegasus_client
 {
 public:
@@ -110,6 +127,14 @@ public:
                                  int max_fetch_size = 1000000,
                                  int timeout_milliseconds = 5000) override;
 
+    virtual int batch_get(const std::vector<std::pair<std::string, std::string>> &keys,
+                          std::map<std::pair<std::string, std::string>, std::string> &values,
+                          int timeout_milliseconds = 5000) override;
+
+    virtual void async_batch_get(const std::vector<std::pair<std::string, std::string>> &keys,
+                                 async_batch_get_callback_t &&callback = nullptr,
+                                 int timeout_milliseconds = 5000) override;
+
     virtual int multi_get_sortkeys(const std::string &hashkey,
                                    std::set<std::string> &sortkeys,
                                    int max_fetch_count = 100,
@@ -133,6 +158,11 @@ public:
                               int timeout_milliseconds = 5000,
                               internal_info *info = nullptr) override;
 
+    virtual int approximate_sortkey_count(const std::string &hashkey,
+                                          int64_t &count,
+                                          int timeout_milliseconds = 5000,
+                                          internal_info *info = nullptr) override;
+
     virtual int del(const std::string &hashkey,
                     const std::string &sortkey,
                     int timeout_milliseconds = 5000,
@@ -257,6 +287,19 @@ public:
 
         void async_next(async_scan_next_callback_t &&) override;
 
+        int next_batch(scan_batch &batch, internal_info *info = nullptr) override;
+
+        void async_next_batch(async_scan_next_batch_callback_t &&callback) override;
+
+        int aggregate(scan_aggregate_type type, scan_aggregate_result &result) override;
+
+        void async_aggregate(scan_aggregate_type type,
+                             async_scan_aggregate_callback_t &&callback) override;
+
+        void async_scan_batches(int partition_concurrency,
+                                int max_pending_batches,
+                                async_scan_batches_callback_t &&callback) override;
+
         bool safe_destructible() const override;
 
         pegasus_scanner_wrapper get_smart_wrapper() override;
@@ -289,14 +332,25 @@ public:
         int64_t _context;
         mutable ::dsn::zlock _lock;
         std::list<async_scan_next_callback_t> _queue;
+        // set by async_next_batch() until the batch is got, exclusive with _queue.
+        async_scan_next_batch_callback_t _batch_callback;
         volatile bool _rpc_started;
         bool _validate_partition_hash;
+        // set by async_aggregate() before any rpc is sent, and never changed then.
+        scan_aggregate_type _aggregate_type;
+        async_scan_aggregate_callback_t _aggregate_callback;
+        // set by async_scan_batches(), which takes over all the partitions of the scanner.
+        std::shared_ptr<pegasus_parallel_scan_executor> _batch_executor;
 
         void _async_next_internal();
+        void _async_next_batch_internal();
+        void _async_aggregate_internal();
         void _start_scan();
         void _next_batch();
         void _on_scan_response(::dsn::error_code, dsn::message_ex *, dsn::message_ex *);
         void _split_reset();
+        // fill the request except the start key.
+        void _fill_get_scanner_request(::dsn::apps::get_scanner_request &req) const;
 
     private:
         static const char _holder[];
@@ -324,13 +378,84 @@ private:
         {
             return _p->next(hashkey, sortkey, value, info);
         }
+
+        void async_next_batch(async_scan_next_batch_callback_t &&callback) override;
+
+        int next_batch(scan_batch &batch, internal_info *info) override
+        {
+            return _p->next_batch(batch, info);
+        }
+
+        void async_aggregate(scan_aggregate_type type,
+                             async_scan_aggregate_callback_t &&callback) override;
+
+        int aggregate(scan_aggregate_type type, scan_aggregate_result &result) override
+        {
+            return _p->aggregate(type, result);
+        }
+
+        void async_scan_batches(int partition_concurrency,
+                                int max_pending_batches,
+                                async_scan_batches_callback_t &&callback) override;
     };
 
+private:
+    void async_set_internal(const std::string &hash_key,
+                            const std::string &sort_key,
+                            const std::string &value,
+                            async_set_callback_t &&callback,
+                            int timeout_milliseconds,
+                            int ttl_seconds,
+                            bool allow_batch);
+
+    void async_del_internal(const std::string &hash_key,
+                            const std::string &sort_key,
+                            async_del_callback_t &&callback,
+                            int timeout_milliseconds,
+                            bool allow_batch);
+
+    // buffer the write into _write_batcher if the writes are batched and the partition count
+    // is known, in which case the callback is moved and true is returned.
+    bool try_batch_write(::dsn::apps::mutate_operation::type operation,
+                         const ::dsn::blob &key,
+                         const ::dsn::blob &value,
+                         int32_t expire_ts_seconds,
+                         uint64_t partition_hash,
+                         async_set_callback_t &callback,
+                         int timeout_milliseconds);
+
+    // query the partition count of the app from meta server.
+    void async_query_partition_count(int timeout_milliseconds,
+                                     std::function<void(int /*error_code*/, int /*count*/)> &&cb);
+
+    // the keys rejected by the server because of a stale `partition_count` are regrouped by
+    // the refreshed partition count and retried once if `retry` is true.
+    void async_batch_get_by_partition(const std::vector<std::pair<std::string, std::string>> &keys,
+                                      int partition_count,
+                                      async_batch_get_callback_t &&callback,
+                                      int timeout_milliseconds,
+                                      bool retry = true);
+
+    // the count is estimated by the server if `approximate` is true and the hash key is too
+    // large, otherwise the exact count is returned.
+    int sortkey_count_internal(const std::string &hash_key,
+                               bool approximate,
+                               int64_t &count,
+                               int timeout_milliseconds,
+                               internal_info *info);
+
 private:
     std::string _cluster_name;
     std::string _app_name;
     ::dsn::rpc_address _meta_server;
     ::dsn::apps::rrdb_client *_client;
+    // the cached partition count of the app, 0 means unknown.
+    // it is used to group the keys of batch_get by partition, and will be reset if the
+    // partition count is changed (e.g. by partition split).
+    std::atomic<int> _partition_count{0};
+    std::atomic<bool> _querying_partition_count{false};
+    std::unique_ptr<pegasus_write_batcher> _write_batcher;
+    std::unique_ptr<pegasus_read_hedger> _read_hedger;
 
     ///
     /// \brief _client_error_to_string
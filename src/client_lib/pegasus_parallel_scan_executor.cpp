@@ -0,0 +1,279 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "pegasus_parallel_scan_executor.h"
+
+#include "pegasus_client_impl.h"
+#include "base/pegasus_const.h"
+
+namespace pegasus {
+namespace client {
+
+pegasus_parallel_scan_executor::pegasus_parallel_scan_executor(
+    ::dsn::apps::rrdb_client *client,
+    std::vector<uint64_t> &&partition_hashes,
+    const ::dsn::apps::get_scanner_request &request,
+    int timeout_ms,
+    int partition_concurrency,
+    int max_pending_batches,
+    callback_t &&callback)
+    : _client(client),
+      _request(request),
+      _timeout_ms(timeout_ms),
+      _partition_concurrency(partition_concurrency),
+      _max_pending_batches(max_pending_batches),
+      _callback(std::move(callback)),
+      _partition_hashes(std::move(partition_hashes)),
+      _active_count(0),
+      _in_flight_count(0),
+      _pending_batch_count(0),
+      _delivering(false),
+      _stopped(false),
+      _terminated(false),
+      _error(PERR_OK)
+{
+}
+
+void pegasus_parallel_scan_executor::start()
+{
+    std::vector<partition_scan_ptr> to_send;
+    {
+        ::dsn::zauto_lock l(_lock);
+        schedule(to_send);
+    }
+    for (const auto &p : to_send) {
+        send(p);
+    }
+    // the scan completes immediately if there is no partition.
+    deliver();
+}
+
+bool pegasus_parallel_scan_executor::terminated() const
+{
+    ::dsn::zauto_lock l(_lock);
+    return _terminated;
+}
+
+void pegasus_parallel_scan_executor::schedule(std::vector<partition_scan_ptr> &to_send)
+{
+    // _lock is locked when called
+    if (_stopped) {
+        return;
+    }
+    while (_active_count < _partition_concurrency && !_partition_hashes.empty()) {
+        auto p = std::make_shared<partition_scan>();
+        p->hash = _partition_hashes.back();
+        p->context_id = SCAN_CONTEXT_ID_NOT_EXIST;
+        _partition_hashes.pop_back();
+        _paused.emplace_back(std::move(p));
+        _active_count++;
+    }
+    // each rpc in flight will produce a batch, so it's counted in the pending batches.
+    while (!_paused.empty() && _in_flight_count + _pending_batch_count < _max_pending_batches) {
+        to_send.emplace_back(std::move(_paused.front()));
+        _paused.pop_front();
+        _in_flight_count++;
+    }
+}
+
+void pegasus_parallel_scan_executor::send(const partition_scan_ptr &p)
+{
+    auto self = shared_from_this();
+    if (p->context_id == SCAN_CONTEXT_ID_NOT_EXIST) {
+        ::dsn::apps::get_scanner_request req = _request;
+        if (p->last_key.length() > 0) {
+            req.start_key = p->last_key;
+            req.start_inclusive = false;
+        }
+        _client->get_scanner(
+            req,
+            [self, p](::dsn::error_code err, dsn::message_ex *req, dsn::message_ex *resp) {
+                self->on_response(p, err, resp, true);
+            },
+            std::chrono::milliseconds(_timeout_ms),
+            p->hash);
+    } else {
+        ::dsn::apps::scan_request req;
+        req.context_id = p->context_id;
+        _client->scan(
+            req,
+            [self, p](::dsn::error_code err, dsn::message_ex *req, dsn::message_ex *resp) {
+                self->on_response(p, err, resp, false);
+            },
+            std::chrono::milliseconds(_timeout_ms),
+            p->hash);
+    }
+}
+
+void pegasus_parallel_scan_executor::on_response(const partition_scan_ptr &p,
+                                                 ::dsn::error_code err,
+                                                 dsn::message_ex *resp,
+                                                 bool is_get_scanner)
+{
+    ::dsn::apps::scan_response response;
+    batch b;
+    int ret = PERR_OK;
+    if (err == ::dsn::ERR_OK) {
+        ::dsn::unmarshall(resp, response);
+        b.info.app_id = response.app_id;
+        b.info.partition_index = response.partition_index;
+        b.info.decree = -1;
+        b.info.server = response.server;
+        ret = pegasus_client_impl::get_client_error(
+            pegasus_client_impl::get_rocksdb_server_error(response.error));
+    } else {
+        ret = pegasus_client_impl::get_client_error(int(err));
+    }
+
+    std::vector<partition_scan_ptr> to_send;
+    std::vector<partition_scan_ptr> to_clear;
+    {
+        ::dsn::zauto_lock l(_lock);
+        _in_flight_count--;
+        if (ret == PERR_OK) {
+            if (!response.kvs.empty()) {
+                p->last_key = response.kvs.back().key;
+            }
+            p->context_id = response.context_id;
+            if (_stopped) {
+                if (p->context_id >= SCAN_CONTEXT_ID_VALID_MIN) {
+                    to_clear.emplace_back(p);
+                }
+            } else {
+                if (!response.kvs.empty()) {
+                    // the blobs of the k-v pairs refer to the buffer of the response.
+                    b.rows = std::make_shared<pegasus_client::scan_batch::rows>();
+                    b.rows->kvs = std::move(response.kvs);
+                    _ready.emplace_back(std::move(b));
+                    _pending_batch_count++;
+                }
+                if (p->context_id == SCAN_CONTEXT_ID_COMPLETED) {
+                    _active_count--;
+                } else {
+                    _paused.emplace_back(p);
+                }
+            }
+        } else if (ret == PERR_NOT_FOUND && !is_get_scanner) {
+            // the context is lost (e.g. evicted or the replica is moved), restart the scan of
+            // the partition from the last key got.
+            if (!_stopped) {
+                p->context_id = SCAN_CONTEXT_ID_NOT_EXIST;
+                _paused.emplace_back(p);
+            }
+        } else if (!_stopped) {
+            _error = ret;
+            _error_info = b.info;
+            stop(to_clear);
+        }
+        schedule(to_send);
+    }
+
+    clear_contexts(to_clear);
+    for (const auto &next : to_send) {
+        send(next);
+    }
+    deliver();
+}
+
+void pegasus_parallel_scan_executor::stop(std::vector<partition_scan_ptr> &to_clear)
+{
+    // _lock is locked when called
+    _stopped = true;
+    for (const auto &p : _paused) {
+        if (p->context_id >= SCAN_CONTEXT_ID_VALID_MIN) {
+            to_clear.emplace_back(p);
+        }
+    }
+    _paused.clear();
+    _partition_hashes.clear();
+    _pending_batch_count -= static_cast<int>(_ready.size());
+    _ready.clear();
+}
+
+void pegasus_parallel_scan_executor::clear_contexts(const std::vector<partition_scan_ptr> &to_clear)
+{
+    for (const auto &p : to_clear) {
+        _client->clear_scanner(p->context_id, p->hash);
+    }
+}
+
+void pegasus_parallel_scan_executor::release()
+{
+    std::vector<partition_scan_ptr> to_send;
+    {
+        ::dsn::zauto_lock l(_lock);
+        _pending_batch_count--;
+        schedule(to_send);
+    }
+    for (const auto &p : to_send) {
+        send(p);
+    }
+    deliver();
+}
+
+void pegasus_parallel_scan_executor::deliver()
+{
+    // the executor may be released by the final callback.
+    auto self = shared_from_this();
+    std::vector<partition_scan_ptr> to_clear;
+
+    _lock.lock();
+    if (_delivering || _terminated) {
+        // the batches will be delivered by the thread which is delivering.
+        _lock.unlock();
+        return;
+    }
+    _delivering = true;
+    while (!_ready.empty() && !_stopped) {
+        batch b = std::move(_ready.front());
+        _ready.pop_front();
+        _lock.unlock();
+        bool go_on = _callback(PERR_OK,
+                               pegasus_client::scan_batch(std::move(b.rows)),
+                               std::move(b.info),
+                               [self]() { self->release(); });
+        _lock.lock();
+        if (!go_on && !_stopped) {
+            stop(to_clear);
+        }
+    }
+    _delivering = false;
+
+    callback_t final_callback;
+    int ret = PERR_SCAN_COMPLETE;
+    pegasus_client::internal_info info;
+    if (_in_flight_count == 0 && _pending_batch_count == 0 &&
+        (_stopped || (_partition_hashes.empty() && _active_count == 0))) {
+        _terminated = true;
+        final_callback = std::move(_callback);
+        if (_error != PERR_OK) {
+            ret = _error;
+            info = _error_info;
+        }
+    }
+    _lock.unlock();
+
+    clear_contexts(to_clear);
+    if (final_callback) {
+        final_callback(ret, pegasus_client::scan_batch(), std::move(info), []() {});
+    }
+}
+
+} // namespace client
+} // namespace pegasus
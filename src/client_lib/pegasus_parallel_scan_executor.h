@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <pegasus/client.h>
+#include <rrdb/rrdb.client.h>
+#include <dsn/tool-api/zlocks.h>
+
+namespace pegasus {
+namespace client {
+
+// Scans a set of partitions with at most `partition_concurrency` partitions in flight, and
+// delivers the k-v pairs of each scan rpc as one batch, see
+// pegasus_client::abstract_pegasus_scanner::async_scan_batches().
+// At most `max_pending_batches` batches are fetched or being fetched but not released by the
+// caller, the partitions are paused once it's reached.
+class pegasus_parallel_scan_executor
+    : public std::enable_shared_from_this<pegasus_parallel_scan_executor>
+{
+public:
+    typedef pegasus_client::async_scan_batches_callback_t callback_t;
+
+    // `request` is the get_scanner request of each partition, whose start key is replaced with
+    // the last key got if the scan context of the partition is lost.
+    pegasus_parallel_scan_executor(::dsn::apps::rrdb_client *client,
+                                   std::vector<uint64_t> &&partition_hashes,
+                                   const ::dsn::apps::get_scanner_request &request,
+                                   int timeout_ms,
+                                   int partition_concurrency,
+                                   int max_pending_batches,
+                                   callback_t &&callback);
+
+    void start();
+
+    // whether the final callback is called, after which no rpc is in flight.
+    bool terminated() const;
+
+private:
+    struct partition_scan
+    {
+        uint64_t hash;
+        int64_t context_id;
+        // the last key got, from which the scan is restarted if the context is lost
+        ::dsn::blob last_key;
+    };
+    typedef std::shared_ptr<partition_scan> partition_scan_ptr;
+
+    struct batch
+    {
+        // the k-v pairs are handed over to the scan_batch without being copied.
+        std::shared_ptr<pegasus_client::scan_batch::rows> rows;
+        pegasus_client::internal_info info;
+    };
+
+    // pick the partitions whose rpcs could be sent now.
+    void schedule(std::vector<partition_scan_ptr> &to_send);
+    void send(const partition_scan_ptr &p);
+    void on_response(const partition_scan_ptr &p,
+                     ::dsn::error_code err,
+                     dsn::message_ex *resp,
+                     bool is_get_scanner);
+    // stop scanning and collect the contexts to clear.
+    void stop(std::vector<partition_scan_ptr> &to_clear);
+    void clear_contexts(const std::vector<partition_scan_ptr> &to_clear);
+    void release();
+    // deliver the ready batches, and call the final callback if all done.
+    void deliver();
+
+    ::dsn::apps::rrdb_client *_client;
+    const ::dsn::apps::get_scanner_request _request;
+    const int _timeout_ms;
+    const int _partition_concurrency;
+    const int _max_pending_batches;
+    callback_t _callback;
+
+    mutable ::dsn::zlock _lock;
+    // the partitions not started yet
+    std::vector<uint64_t> _partition_hashes;
+    // the started partitions whose next rpc is not sent yet
+    std::deque<partition_scan_ptr> _paused;
+    // the number of started partitions which are not completed
+    int _active_count;
+    int _in_flight_count;
+    std::deque<batch> _ready;
+    // the batches ready or delivered but not released
+    int _pending_batch_count;
+    bool _delivering;
+    bool _stopped;
+    bool _terminated;
+    int _error;
+    pegasus_client::internal_info _error_info;
+};
+
+} // namespace client
+} // namespace pegasus
@@ -0,0 +1,356 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "pegasus_read_hedger.h"
+
+#include <algorithm>
+#include <dsn/tool-api/async_calls.h>
+#include <dsn/utility/flags.h>
+#include <dsn/utility/rand.h>
+#include <fmt/format.h>
+
+#include "pegasus_client_impl.h"
+
+namespace pegasus {
+namespace client {
+
+DEFINE_TASK_CODE(LPC_PEGASUS_HEDGED_READ, TASK_PRIORITY_COMMON, ::dsn::THREAD_POOL_DEFAULT)
+
+DSN_DEFINE_uint32("pegasus.client",
+                  hedged_read_percentile,
+                  0,
+                  "the gets, multi_gets, ttls and sortkey_counts of a client are hedged to a "
+                  "secondary if the primary doesn't respond within this percentile (e.g. 95 or "
+                  "99) of the recent latencies of the partition, 0 means not to hedge the reads");
+DSN_TAG_VARIABLE(hedged_read_percentile, FT_MUTABLE);
+
+DSN_DEFINE_uint32("pegasus.client",
+                  hedged_read_budget_percent,
+                  5,
+                  "the hedges of a client are limited to this percent of its reads, which bounds "
+                  "the extra load of the servers");
+DSN_TAG_VARIABLE(hedged_read_budget_percent, FT_MUTABLE);
+
+// the partition configuration is refreshed in this interval, so that the hedges follow the
+// secondaries. it's queried at most once a second, even if some hedge fails.
+static const uint64_t CONFIG_REFRESH_INTERVAL_MS = 30 * 1000;
+static const uint64_t CONFIG_QUERY_INTERVAL_MS = 1000;
+static const int CONFIG_QUERY_TIMEOUT_MS = 5000;
+
+latency_histogram::latency_histogram() : _total(0) { std::fill_n(_buckets, BUCKET_COUNT, 0); }
+
+/*static*/ const std::vector<uint64_t> &latency_histogram::bucket_bounds_us()
+{
+    // 100us, 125us, 156us, ..., about 130s for the last bucket
+    static const std::vector<uint64_t> bounds = []() {
+        std::vector<uint64_t> b;
+        double bound = 100;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            b.push_back(static_cast<uint64_t>(bound));
+            bound *= 1.25;
+        }
+        return b;
+    }();
+    return bounds;
+}
+
+void latency_histogram::record(uint64_t latency_us)
+{
+    const auto &bounds = bucket_bounds_us();
+    size_t i = std::lower_bound(bounds.begin(), bounds.end(), latency_us) - bounds.begin();
+    i = std::min(i, bounds.size() - 1);
+
+    ::dsn::zauto_lock l(_lock);
+    ++_buckets[i];
+    if (++_total < WINDOW_SIZE) {
+        return;
+    }
+    _total = 0;
+    for (auto &count : _buckets) {
+        count /= 2;
+        _total += count;
+    }
+}
+
+uint64_t latency_histogram::percentile_us(uint32_t percentile) const
+{
+    const auto &bounds = bucket_bounds_us();
+
+    ::dsn::zauto_lock l(_lock);
+    if (_total < MIN_SAMPLES) {
+        return 0;
+    }
+    uint64_t threshold = (_total * percentile + 99) / 100;
+    uint64_t count = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        count += _buckets[i];
+        if (count >= threshold) {
+            return bounds[i];
+        }
+    }
+    return bounds.back();
+}
+
+pegasus_read_hedger::pegasus_read_hedger(const std::string &cluster_name,
+                                         const std::string &app_name,
+                                         const ::dsn::rpc_address &meta_server)
+    : _app_name(app_name), _meta_server(meta_server)
+{
+    std::string name = fmt::format("hedged_read_qps@{}.{}", cluster_name, app_name);
+    _pfc_hedged_read_qps.init_app_counter(
+        "app.pegasus", name.c_str(), COUNTER_TYPE_RATE, "statistic the qps of hedged reads");
+
+    name = fmt::format("hedged_read_win_qps@{}.{}", cluster_name, app_name);
+    _pfc_hedged_read_win_qps.init_app_counter("app.pegasus",
+                                              name.c_str(),
+                                              COUNTER_TYPE_RATE,
+                                              "statistic the qps of hedges responded first");
+
+    name = fmt::format("hedged_read_loss_qps@{}.{}", cluster_name, app_name);
+    _pfc_hedged_read_loss_qps.init_app_counter(
+        "app.pegasus",
+        name.c_str(),
+        COUNTER_TYPE_RATE,
+        "statistic the qps of hedges whose primary responded first");
+
+    name = fmt::format("hedged_read_no_budget_qps@{}.{}", cluster_name, app_name);
+    _pfc_hedged_read_no_budget_qps.init_app_counter(
+        "app.pegasus",
+        name.c_str(),
+        COUNTER_TYPE_RATE,
+        "statistic the qps of hedges not sent because the budget is exhausted");
+}
+
+pegasus_read_hedger::~pegasus_read_hedger() { _tracker.cancel_outstanding_tasks(); }
+
+/*static*/ bool pegasus_read_hedger::enabled()
+{
+    return FLAGS_hedged_read_percentile > 0 && FLAGS_hedged_read_percentile < 100;
+}
+
+int pegasus_read_hedger::prepare(uint64_t partition_hash,
+                                 int timeout_milliseconds,
+                                 hedged_read &ctx)
+{
+    add_budget();
+    ctx.start_ns = dsn_now_ns();
+
+    std::shared_ptr<const partition_table> table;
+    {
+        ::dsn::zauto_read_lock l(_lock);
+        table = _table;
+    }
+    if (table == nullptr || dsn_now_ms() - table->update_ms >= CONFIG_REFRESH_INTERVAL_MS) {
+        query_config();
+    }
+    if (table == nullptr || table->configs.empty()) {
+        return 0;
+    }
+
+    // the partition is decided the same way as the partition resolver does.
+    ctx.partition_index = static_cast<int>(partition_hash % table->configs.size());
+    ctx.latencies = table->latencies[ctx.partition_index];
+    if (table->configs[ctx.partition_index].secondaries.empty() || !has_budget()) {
+        return 0;
+    }
+
+    uint64_t delay_us = ctx.latencies->percentile_us(FLAGS_hedged_read_percentile);
+    if (delay_us == 0) {
+        return 0;
+    }
+    // rounded up to ms, which is the granularity of the timers.
+    uint64_t delay_ms = (delay_us + 999) / 1000;
+    if (delay_ms >= static_cast<uint64_t>(timeout_milliseconds)) {
+        return 0;
+    }
+    return static_cast<int>(delay_ms);
+}
+
+void pegasus_read_hedger::schedule_hedge(const std::shared_ptr<hedged_read> &ctx, int delay_ms)
+{
+    ::dsn::tasking::enqueue(LPC_PEGASUS_HEDGED_READ,
+                            &_tracker,
+                            [this, ctx]() { send_hedge(ctx); },
+                            0,
+                            std::chrono::milliseconds(delay_ms));
+}
+
+void pegasus_read_hedger::send_hedge(const std::shared_ptr<hedged_read> &ctx)
+{
+    if (ctx->done.load()) {
+        return;
+    }
+
+    std::shared_ptr<const partition_table> table;
+    {
+        ::dsn::zauto_read_lock l(_lock);
+        table = _table;
+    }
+    if (table == nullptr || ctx->partition_index >= static_cast<int>(table->configs.size())) {
+        // the partition count is changed
+        return;
+    }
+    const auto &config = table->configs[ctx->partition_index];
+    if (config.secondaries.empty()) {
+        return;
+    }
+    if (!consume_budget()) {
+        _pfc_hedged_read_no_budget_qps->increment();
+        return;
+    }
+
+    auto secondary =
+        config.secondaries[::dsn::rand::next_u32(0, config.secondaries.size() - 1)];
+    dsn::message_ex *request = ctx->hedge_request.get();
+    request->header->gpid = config.pid;
+    // the secondary only serves the reads of backup requests.
+    request->header->context.u.is_backup_request = true;
+    ctx->hedged.store(true);
+    _pfc_hedged_read_qps->increment();
+    ::dsn::rpc::call(
+        secondary,
+        request,
+        &_tracker,
+        [this, ctx](::dsn::error_code err, dsn::message_ex *req, dsn::message_ex *resp) {
+            on_hedge_response(ctx, err, req, resp);
+        });
+}
+
+void pegasus_read_hedger::on_hedge_response(const std::shared_ptr<hedged_read> &ctx,
+                                            ::dsn::error_code err,
+                                            dsn::message_ex *req,
+                                            dsn::message_ex *resp)
+{
+    if (err != ::dsn::ERR_OK) {
+        // the configuration may be stale, and the read is still answered by the primary.
+        query_config();
+        return;
+    }
+    if (!ctx->done.exchange(true)) {
+        _pfc_hedged_read_win_qps->increment();
+        ctx->callback(err, req, resp);
+    }
+}
+
+void pegasus_read_hedger::on_primary_response(const std::shared_ptr<hedged_read> &ctx,
+                                              ::dsn::error_code err,
+                                              dsn::message_ex *req,
+                                              dsn::message_ex *resp)
+{
+    // the latency of the primary is recorded even if the hedge wins. the timeouts are recorded
+    // at their elapsed time, otherwise a partition which times out would look fast, while the
+    // other errors are excluded since they're usually replied immediately regardless of the
+    // load of the partition.
+    if ((err == ::dsn::ERR_OK || err == ::dsn::ERR_TIMEOUT) && ctx->latencies != nullptr) {
+        ctx->latencies->record((dsn_now_ns() - ctx->start_ns) / 1000);
+    }
+    if (ctx->done.exchange(true)) {
+        return;
+    }
+    if (ctx->hedged.load()) {
+        _pfc_hedged_read_loss_qps->increment();
+    }
+    ctx->callback(err, req, resp);
+}
+
+void pegasus_read_hedger::add_budget()
+{
+    int64_t budget = _budget.load();
+    do {
+        if (budget >= MAX_BUDGET) {
+            return;
+        }
+    } while (!_budget.compare_exchange_weak(budget, budget + FLAGS_hedged_read_budget_percent));
+}
+
+bool pegasus_read_hedger::has_budget() const { return _budget.load() >= HEDGE_COST; }
+
+bool pegasus_read_hedger::consume_budget()
+{
+    int64_t budget = _budget.load();
+    do {
+        if (budget < HEDGE_COST) {
+            return false;
+        }
+    } while (!_budget.compare_exchange_weak(budget, budget - HEDGE_COST));
+    return true;
+}
+
+void pegasus_read_hedger::query_config()
+{
+    uint64_t now_ms = dsn_now_ms();
+    if (now_ms - _last_query_ms.load() < CONFIG_QUERY_INTERVAL_MS) {
+        return;
+    }
+    bool expected = false;
+    if (!_querying_config.compare_exchange_strong(expected, true)) {
+        return;
+    }
+    _last_query_ms.store(now_ms);
+
+    ::dsn::configuration_query_by_index_request req;
+    req.app_name = _app_name;
+    ::dsn::rpc::call(
+        _meta_server,
+        RPC_CM_QUERY_PARTITION_CONFIG_BY_INDEX,
+        req,
+        &_tracker,
+        [this](::dsn::error_code err, dsn::message_ex *req, dsn::message_ex *resp) {
+            on_config_queried(err, resp);
+        },
+        std::chrono::milliseconds(CONFIG_QUERY_TIMEOUT_MS),
+        0,
+        0);
+}
+
+void pegasus_read_hedger::on_config_queried(::dsn::error_code err, dsn::message_ex *resp)
+{
+    ::dsn::configuration_query_by_index_response response;
+    if (err == ::dsn::ERR_OK) {
+        ::dsn::unmarshall(resp, response);
+        err = response.err;
+    }
+    if (err != ::dsn::ERR_OK) {
+        dwarn("failed to query the partition configuration of %s: %s",
+              _app_name.c_str(),
+              err.to_string());
+        _querying_config.store(false);
+        return;
+    }
+
+    auto table = std::make_shared<partition_table>();
+    table->configs = std::move(response.partitions);
+    table->update_ms = dsn_now_ms();
+    {
+        ::dsn::zauto_write_lock l(_lock);
+        // the latencies are kept unless the partition count is changed.
+        if (_table != nullptr && _table->latencies.size() == table->configs.size()) {
+            table->latencies = _table->latencies;
+        } else {
+            for (size_t i = 0; i < table->configs.size(); ++i) {
+                table->latencies.emplace_back(std::make_shared<latency_histogram>());
+            }
+        }
+        _table = table;
+    }
+    _querying_config.store(false);
+}
+
+} // namespace client
+} // namespace pegasus
@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <rrdb/rrdb.client.h>
+#include <dsn/cpp/serialization_helper/dsn.layer2_types.h>
+#include <dsn/perf_counter/perf_counter_wrapper.h>
+#include <dsn/tool-api/task_tracker.h>
+#include <dsn/tool-api/zlocks.h>
+
+namespace pegasus {
+namespace client {
+
+// The recent latencies of the reads of a partition, which are kept in exponential buckets and
+// halved once there are `WINDOW_SIZE` samples, so that the old samples fade out.
+class latency_histogram
+{
+public:
+    // the percentile is valid after so many samples are recorded.
+    static constexpr uint64_t MIN_SAMPLES = 100;
+    static constexpr uint64_t WINDOW_SIZE = 2000;
+
+    latency_histogram();
+
+    void record(uint64_t latency_us);
+
+    // the upper bound of the bucket where the `percentile` (in (0, 100)) lies, 0 if there are
+    // less than MIN_SAMPLES samples.
+    uint64_t percentile_us(uint32_t percentile) const;
+
+private:
+    friend class pegasus_read_hedger_test;
+
+    static constexpr int BUCKET_COUNT = 64;
+    static const std::vector<uint64_t> &bucket_bounds_us();
+
+    mutable ::dsn::zlock _lock;
+    uint64_t _buckets[BUCKET_COUNT];
+    uint64_t _total;
+};
+
+// Hedges the reads of a client: a read is sent to the primary as usual, and if it doesn't
+// respond within the `hedged_read_percentile` latency of the partition, the same read is sent to
+// a random secondary as a backup request, and the first response wins. The hedges are limited to
+// `hedged_read_budget_percent` of the reads, so that the extra load of the servers is bounded.
+// Like the backup requests, a hedged read may get a stale value from the secondary.
+class pegasus_read_hedger
+{
+public:
+    typedef std::function<void(
+        ::dsn::error_code /*err*/, dsn::message_ex * /*req*/, dsn::message_ex * /*resp*/)>
+        rpc_callback_t;
+
+    pegasus_read_hedger(const std::string &cluster_name,
+                        const std::string &app_name,
+                        const ::dsn::rpc_address &meta_server);
+    ~pegasus_read_hedger();
+
+    // whether the reads should be hedged, which is configured by `hedged_read_percentile`.
+    static bool enabled();
+
+    // send the read `request` of rpc `code` by `send(callback)`, which calls the primary, and
+    // hedge it if the reads are hedged. `callback` is called once with the first response.
+    template <typename TRequest, typename TCallback, typename TSend>
+    void call(::dsn::task_code code,
+              const TRequest &request,
+              uint64_t partition_hash,
+              int timeout_milliseconds,
+              TCallback &&callback,
+              TSend &&send)
+    {
+        if (!enabled()) {
+            send(std::forward<TCallback>(callback));
+            return;
+        }
+
+        auto ctx = std::make_shared<hedged_read>();
+        ctx->callback = std::forward<TCallback>(callback);
+        int delay_ms = prepare(partition_hash, timeout_milliseconds, *ctx);
+        if (delay_ms > 0) {
+            // the request is marshalled in advance, since the caller may not keep it.
+            ctx->hedge_request = ::dsn::message_ex::create_request(
+                code, timeout_milliseconds - delay_ms, 0, partition_hash);
+            ::dsn::marshall(ctx->hedge_request.get(), request);
+            schedule_hedge(ctx, delay_ms);
+        }
+        send([this, ctx](::dsn::error_code err, dsn::message_ex *req, dsn::message_ex *resp) {
+            on_primary_response(ctx, err, req, resp);
+        });
+    }
+
+private:
+    friend class pegasus_read_hedger_test;
+
+    struct hedged_read
+    {
+        rpc_callback_t callback;
+        std::atomic<bool> done{false};
+        std::atomic<bool> hedged{false};
+        // -1 if the partition is unknown yet
+        int partition_index = -1;
+        uint64_t start_ns = 0;
+        std::shared_ptr<latency_histogram> latencies;
+        ::dsn::message_ptr hedge_request;
+    };
+
+    struct partition_table
+    {
+        std::vector<::dsn::partition_configuration> configs;
+        std::vector<std::shared_ptr<latency_histogram>> latencies;
+        uint64_t update_ms = 0;
+    };
+
+    // fill the partition of `ctx` and return the delay to hedge the read after, 0 means not to
+    // hedge it.
+    int prepare(uint64_t partition_hash, int timeout_milliseconds, hedged_read &ctx);
+
+    void schedule_hedge(const std::shared_ptr<hedged_read> &ctx, int delay_ms);
+
+    void send_hedge(const std::shared_ptr<hedged_read> &ctx);
+
+    void on_primary_response(const std::shared_ptr<hedged_read> &ctx,
+                             ::dsn::error_code err,
+                             dsn::message_ex *req,
+                             dsn::message_ex *resp);
+
+    void on_hedge_response(const std::shared_ptr<hedged_read> &ctx,
+                           ::dsn::error_code err,
+                           dsn::message_ex *req,
+                           dsn::message_ex *resp);
+
+    // the budget is increased by `hedged_read_budget_percent` for each read, and decreased by
+    // HEDGE_COST for each hedge.
+    void add_budget();
+    bool has_budget() const;
+    bool consume_budget();
+
+    // query the partition configuration of the app from meta server, at most once in a while.
+    void query_config();
+    void on_config_queried(::dsn::error_code err, dsn::message_ex *resp);
+
+    static constexpr int64_t HEDGE_COST = 100;
+    static constexpr int64_t MAX_BUDGET = 100 * HEDGE_COST;
+
+    const std::string _app_name;
+    const ::dsn::rpc_address _meta_server;
+    ::dsn::task_tracker _tracker;
+
+    mutable ::dsn::zrwlock_nr _lock;
+    // null if not queried yet, protected by _lock
+    std::shared_ptr<const partition_table> _table;
+    std::atomic<bool> _querying_config{false};
+    std::atomic<uint64_t> _last_query_ms{0};
+
+    std::atomic<int64_t> _budget{0};
+
+    ::dsn::perf_counter_wrapper _pfc_hedged_read_qps;
+    ::dsn::perf_counter_wrapper _pfc_hedged_read_win_qps;
+    ::dsn::perf_counter_wrapper _pfc_hedged_read_loss_qps;
+    ::dsn::perf_counter_wrapper _pfc_hedged_read_no_budget_qps;
+};
+
+} // namespace client
+} // namespace pegasus
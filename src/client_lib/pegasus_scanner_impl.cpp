@@ -18,6 +18,7 @@
  */
 
 #include "pegasus_client_impl.h"
+#include "pegasus_parallel_scan_executor.h"
 #include "base/pegasus_const.h"
 
 using namespace ::dsn;
@@ -50,7 +51,8 @@ pegasus_client_impl::pegasus_scanner_impl::pegasus_scanner_impl(::dsn::apps::rrd
       _p(-1),
       _context(SCAN_CONTEXT_ID_COMPLETED),
       _rpc_started(false),
-      _validate_partition_hash(validate_partition_hash)
+      _validate_partition_hash(validate_partition_hash),
+      _aggregate_type(SA_NONE)
 {
 }
 
@@ -84,6 +86,17 @@ int pegasus_client_impl::pegasus_scanner_impl::next(std::string &hashkey,
 void pegasus_client_impl::pegasus_scanner_impl::async_next(async_scan_next_callback_t &&callback)
 {
     _lock.lock();
+    if (_batch_callback) {
+        // async_next_batch() in-progress
+        _lock.unlock();
+        callback(PERR_INVALID_ARGUMENT,
+                 std::string(),
+                 std::string(),
+                 std::string(),
+                 internal_info(),
+                 0);
+        return;
+    }
     if (_queue.empty()) {
         _queue.emplace_back(std::move(callback));
         _async_next_internal();
@@ -96,10 +109,114 @@ void pegasus_client_impl::pegasus_scanner_impl::async_next(async_scan_next_callb
     }
 }
 
+int pegasus_client_impl::pegasus_scanner_impl::next_batch(scan_batch &batch, internal_info *info)
+{
+    ::dsn::utils::notify_event op_completed;
+    int ret = -1;
+    auto callback = [&](int err, scan_batch &&b, internal_info &&ii) {
+        ret = err;
+        batch = std::move(b);
+        if (info) {
+            (*info) = std::move(ii);
+        }
+        op_completed.notify();
+    };
+    async_next_batch(std::move(callback));
+    op_completed.wait();
+    return ret;
+}
+
+void pegasus_client_impl::pegasus_scanner_impl::async_next_batch(
+    async_scan_next_batch_callback_t &&callback)
+{
+    _lock.lock();
+    if (_batch_callback || !_queue.empty() || _aggregate_type != SA_NONE ||
+        _batch_executor != nullptr) {
+        _lock.unlock();
+        callback(PERR_INVALID_ARGUMENT, scan_batch(), internal_info());
+        return;
+    }
+    _batch_callback = std::move(callback);
+    _async_next_batch_internal();
+}
+
+int pegasus_client_impl::pegasus_scanner_impl::aggregate(scan_aggregate_type type,
+                                                         scan_aggregate_result &result)
+{
+    ::dsn::utils::notify_event op_completed;
+    int ret = PERR_OK;
+    result = scan_aggregate_result();
+    auto callback = [&](int err, scan_aggregate_result &&batch_result) {
+        if (err == PERR_OK) {
+            result.merge(batch_result);
+            return;
+        }
+        ret = (err == PERR_SCAN_COMPLETE ? PERR_OK : err);
+        op_completed.notify();
+    };
+    async_aggregate(type, std::move(callback));
+    op_completed.wait();
+    return ret;
+}
+
+void pegasus_client_impl::pegasus_scanner_impl::async_aggregate(
+    scan_aggregate_type type, async_scan_aggregate_callback_t &&callback)
+{
+    _lock.lock();
+    // the scanner should not be iterated or aggregated before
+    if (type == SA_NONE || _aggregate_type != SA_NONE || !_queue.empty() || _batch_callback ||
+        _p != -1 || !_kvs.empty()) {
+        _lock.unlock();
+        callback(PERR_INVALID_ARGUMENT, scan_aggregate_result());
+        return;
+    }
+    _aggregate_type = type;
+    _aggregate_callback = std::move(callback);
+    _async_aggregate_internal();
+}
+
+void pegasus_client_impl::pegasus_scanner_impl::async_scan_batches(
+    int partition_concurrency, int max_pending_batches, async_scan_batches_callback_t &&callback)
+{
+    _lock.lock();
+    // the scanner should not be iterated or aggregated before
+    if (partition_concurrency <= 0 || max_pending_batches <= 0 || _batch_executor != nullptr ||
+        _aggregate_type != SA_NONE || !_queue.empty() || _batch_callback || _p != -1 ||
+        !_kvs.empty()) {
+        _lock.unlock();
+        callback(PERR_INVALID_ARGUMENT, scan_batch(), internal_info(), []() {});
+        return;
+    }
+
+    ::dsn::apps::get_scanner_request req;
+    _fill_get_scanner_request(req);
+    req.start_key = _start_key;
+    req.start_inclusive = _options.start_inclusive;
+    // the request is kept by the executor, which may outlive the scanner, so the patterns are
+    // copied instead of referring to _options.
+    req.hash_key_filter_pattern = ::dsn::blob::create_from_bytes(
+        std::string(_options.hash_key_filter_pattern));
+    req.sort_key_filter_pattern = ::dsn::blob::create_from_bytes(
+        std::string(_options.sort_key_filter_pattern));
+    auto executor = std::make_shared<pegasus_parallel_scan_executor>(_client,
+                                                                     std::move(_splits_hash),
+                                                                     req,
+                                                                     _options.timeout_ms,
+                                                                     partition_concurrency,
+                                                                     max_pending_batches,
+                                                                     std::move(callback));
+    _splits_hash.clear();
+    _batch_executor = executor;
+    _lock.unlock();
+
+    executor->start();
+}
+
 bool pegasus_client_impl::pegasus_scanner_impl::safe_destructible() const
 {
     ::dsn::zauto_lock l(_lock);
-    return _queue.empty();
+    return _queue.empty() && !_batch_callback && !_aggregate_callback &&
+           (_batch_executor == nullptr || _batch_executor->terminated());
 }
 
 pegasus_client::pegasus_scanner_wrapper
@@ -188,6 +305,94 @@ void pegasus_client_impl::pegasus_scanner_impl::_async_next_internal()
     }
 }
 
+// rpc won't be executed concurrently
+void pegasus_client_impl::pegasus_scanner_impl::_async_next_batch_internal()
+{
+    // _lock is locked when called
+    dassert(_batch_callback, "callback should be set when _async_next_batch_internal start");
+
+    while (_p + 1 >= static_cast<int32_t>(_kvs.size())) {
+        if (_context == SCAN_CONTEXT_ID_COMPLETED) {
+            // reach the end of one partition
+            if (_splits_hash.empty()) {
+                // all completed
+                async_scan_next_batch_callback_t callback = std::move(_batch_callback);
+                _batch_callback = nullptr;
+                _lock.unlock();
+                // ATTENTION: after unlock, member variables can not be used anymore
+                internal_info info;
+                info.app_id = -1;
+                info.partition_index = -1;
+                info.decree = -1;
+                callback(PERR_SCAN_COMPLETE, scan_batch(), std::move(info));
+                return;
+            }
+            _hash = _splits_hash.back();
+            _splits_hash.pop_back();
+            _split_reset();
+        } else if (_context == SCAN_CONTEXT_ID_NOT_EXIST) {
+            // no valid context_id found
+            _lock.unlock();
+            _start_scan();
+            return;
+        } else {
+            // valid context_id
+            _lock.unlock();
+            _next_batch();
+            return;
+        }
+    }
+
+    // hand over the k-v pairs not got yet, whose blobs are moved instead of copied.
+    auto rows = std::make_shared<scan_batch::rows>();
+    if (_p == -1) {
+        rows->kvs = std::move(_kvs);
+    } else {
+        rows->kvs.assign(std::make_move_iterator(_kvs.begin() + _p + 1),
+                         std::make_move_iterator(_kvs.end()));
+    }
+    // keep the last k-v pair, which the scan is restarted from if the context is lost.
+    _kvs.assign(1, rows->kvs.back());
+    _p = 0;
+
+    async_scan_next_batch_callback_t callback = std::move(_batch_callback);
+    _batch_callback = nullptr;
+    internal_info info(_info);
+    _lock.unlock();
+    // ATTENTION: after unlock, member variables can not be used anymore
+    callback(PERR_OK, scan_batch(std::move(rows)), std::move(info));
+}
+
+// rpc won't be executed concurrently
+void pegasus_client_impl::pegasus_scanner_impl::_async_aggregate_internal()
+{
+    // _lock is locked when called
+    dassert(_aggregate_callback, "callback should be set when _async_aggregate_internal start");
+
+    if (_context == SCAN_CONTEXT_ID_COMPLETED) {
+        // reach the end of one partition
+        if (_splits_hash.empty()) {
+            // all completed
+            async_scan_aggregate_callback_t callback = std::move(_aggregate_callback);
+            _aggregate_callback = nullptr;
+            _lock.unlock();
+            // ATTENTION: after unlock, member variables can not be used anymore
+            callback(PERR_SCAN_COMPLETE, scan_aggregate_result());
+            return;
+        }
+        _hash = _splits_hash.back();
+        _splits_hash.pop_back();
+        _split_reset();
+    }
+
+    _lock.unlock();
+    if (_context == SCAN_CONTEXT_ID_NOT_EXIST) {
+        _start_scan();
+    } else {
+        _next_batch();
+    }
+}
+
 void pegasus_client_impl::pegasus_scanner_impl::_next_batch()
 {
     ::dsn::apps::scan_request req;
@@ -206,6 +411,7 @@ void pegasus_client_impl::pegasus_scanner_impl::_next_batch()
 void pegasus_client_impl::pegasus_scanner_impl::_start_scan()
 {
     ::dsn::apps::get_scanner_request req;
+    _fill_get_scanner_request(req);
     if (_kvs.empty()) {
         req.start_key = _start_key;
         req.start_inclusive = _options.start_inclusive;
@@ -213,6 +419,21 @@ void pegasus_client_impl::pegasus_scanner_impl::_start_scan()
         req.start_key = _kvs.back().key;
         req.start_inclusive = false;
     }
+
+    dassert(!_rpc_started, "");
+    _rpc_started = true;
+    _client->get_scanner(
+        req,
+        [this](::dsn::error_code err, dsn::message_ex *req, dsn::message_ex *resp) mutable {
+            _on_scan_response(err, req, resp);
+        },
+        std::chrono::milliseconds(_options.timeout_ms),
+        _hash);
+}
+
+void pegasus_client_impl::pegasus_scanner_impl::_fill_get_scanner_request(
+    ::dsn::apps::get_scanner_request &req) const
+{
     req.stop_key = _stop_key;
     req.stop_inclusive = _options.stop_inclusive;
     req.batch_size = _options.batch_size;
@@ -225,16 +446,9 @@ void pegasus_client_impl::pegasus_scanner_impl::_start_scan()
     req.no_value = _options.no_value;
     req.__set_validate_partition_hash(_validate_partition_hash);
     req.__set_return_expire_ts(_options.return_expire_ts);
-
-    dassert(!_rpc_started, "");
-    _rpc_started = true;
-    _client->get_scanner(
-        req,
-        [this](::dsn::error_code err, dsn::message_ex *req, dsn::message_ex *resp) mutable {
-            _on_scan_response(err, req, resp);
-        },
-        std::chrono::milliseconds(_options.timeout_ms),
-        _hash);
+    if (_aggregate_type != SA_NONE) {
+        req.__set_aggregate_type((dsn::apps::scan_aggregate_type::type)_aggregate_type);
+    }
 }
 
 void pegasus_client_impl::pegasus_scanner_impl::_on_scan_response(::dsn::error_code err,
@@ -251,17 +465,43 @@ void pegasus_client_impl::pegasus_scanner_impl::_on_scan_response(::dsn::error_c
         _info.decree = -1;
         _info.server = response.server;
 
-        if (response.error == 0) {
+        if (response.error == 0 && _aggregate_type != SA_NONE && response.__isset.aggregate) {
+            scan_aggregate_result batch_result;
+            const auto &aggregate = response.aggregate;
+            batch_result.row_count = aggregate.row_count;
+            batch_result.key_bytes = aggregate.key_bytes;
+            batch_result.value_bytes = aggregate.value_bytes;
+            batch_result.int_count = aggregate.int_count;
+            batch_result.int_sum = aggregate.int_sum;
+            batch_result.int_min = aggregate.int_min;
+            batch_result.int_max = aggregate.int_max;
+            _aggregate_callback(PERR_OK, std::move(batch_result));
+            _lock.lock();
+            _context = response.context_id;
+            _async_aggregate_internal();
+            return;
+        } else if (response.error == 0 && _aggregate_type == SA_NONE) {
             _lock.lock();
             _kvs = std::move(response.kvs);
             _p = -1;
             _context = response.context_id;
-            _async_next_internal();
+            if (_batch_callback) {
+                _async_next_batch_internal();
+            } else {
+                _async_next_internal();
+            }
             return;
-        } else if (get_rocksdb_server_error(response.error) == PERR_NOT_FOUND) {
+        } else if (get_rocksdb_server_error(response.error) == PERR_NOT_FOUND &&
+                   _aggregate_type == SA_NONE) {
+            // the context is lost (e.g. evicted or the replica is moved), restart the scan from
+            // the last key got. it's not possible for the aggregation, which has no key got.
             _lock.lock();
             _context = SCAN_CONTEXT_ID_NOT_EXIST;
-            _async_next_internal();
+            if (_batch_callback) {
+                _async_next_batch_internal();
+            } else {
+                _async_next_internal();
+            }
             return;
         }
     } else {
@@ -274,13 +514,34 @@ void pegasus_client_impl::pegasus_scanner_impl::_on_scan_response(::dsn::error_c
     // error occured
     auto ret =
         get_client_error(err == ERR_OK ? get_rocksdb_server_error(response.error) : int(err));
+    if (ret == PERR_OK) {
+        // the aggregate is not returned by the server which doesn't support the aggregation
+        ret = PERR_NOT_SUPPORTED;
+    }
     internal_info info = _info;
+    if (_aggregate_type != SA_NONE) {
+        _lock.lock();
+        async_scan_aggregate_callback_t callback = std::move(_aggregate_callback);
+        _aggregate_callback = nullptr;
+        _lock.unlock();
+        // ATTENTION: after unlock with empty callback, memebers variables can not be used anymore
+        callback(ret, scan_aggregate_result());
+        return;
+    }
+
     std::list<async_scan_next_callback_t> temp;
+    async_scan_next_batch_callback_t batch_callback;
     _lock.lock();
     std::swap(_queue, temp);
+    std::swap(_batch_callback, batch_callback);
     _lock.unlock();
     // ATTENTION: after unlock with empty queue,  memebers variables can not be used anymore
 
+    if (batch_callback) {
+        batch_callback(ret, scan_batch(), std::move(info));
+        return;
+    }
+
     for (auto &callback : temp) {
         if (callback) {
             callback(ret, std::string(), std::string(), std::string(), internal_info(info), 0);
@@ -301,6 +562,7 @@ pegasus_client_impl::pegasus_scanner_impl::~pegasus_scanner_impl()
 
     dassert(!_rpc_started, "all scan-rpc should be completed here");
     dassert(_queue.empty(), "queue should be empty");
+    dassert(!_batch_callback, "no batch should be in-progress");
 
     if (_client) {
         if (_context >= SCAN_CONTEXT_ID_VALID_MIN)
@@ -328,8 +590,91 @@ void pegasus_client_impl::pegasus_scanner_impl_wrapper::async_next(
     });
 }
 
+void pegasus_client_impl::pegasus_scanner_impl_wrapper::async_next_batch(
+    async_scan_next_batch_callback_t &&callback)
+{
+    // wrap shared_ptr _p with callback
+    _p->async_next_batch([ __p = _p, user_callback = std::move(callback) ](
+        int error_code, scan_batch &&batch, internal_info &&info) {
+        user_callback(error_code, std::move(batch), std::move(info));
+    });
+}
+
+void pegasus_client_impl::pegasus_scanner_impl_wrapper::async_scan_batches(
+    int partition_concurrency, int max_pending_batches, async_scan_batches_callback_t &&callback)
+{
+    // wrap shared_ptr _p with callback
+    _p->async_scan_batches(
+        partition_concurrency,
+        max_pending_batches,
+        [ __p = _p, user_callback = std::move(callback) ](int error_code,
+                                                          scan_batch &&batch,
+                                                          internal_info &&info,
+                                                          std::function<void()> &&release) {
+            return user_callback(
+                error_code, std::move(batch), std::move(info), std::move(release));
+        });
+}
+
+void pegasus_client_impl::pegasus_scanner_impl_wrapper::async_aggregate(
+    scan_aggregate_type type, async_scan_aggregate_callback_t &&callback)
+{
+    // wrap shared_ptr _p with callback
+    _p->async_aggregate(
+        type,
+        [ __p = _p, user_callback = std::move(callback) ](
+            int error_code, scan_aggregate_result &&batch_result) {
+            user_callback(error_code, std::move(batch_result));
+        });
+}
+
 const char pegasus_client_impl::pegasus_scanner_impl::_holder[] = {'\x00', '\x00', '\xFF', '\xFF'};
 const ::dsn::blob pegasus_client_impl::pegasus_scanner_impl::_min = ::dsn::blob(_holder, 0, 2);
 const ::dsn::blob pegasus_client_impl::pegasus_scanner_impl::_max = ::dsn::blob(_holder, 2, 2);
 } // namespace client
+
+// the hash key length of the key generated by pegasus_generate_key(), which is in big endian.
+static inline uint16_t hash_key_length(const ::dsn::blob &key)
+{
+    return be16toh(*(const uint16_t *)(key.data()));
+}
+
+size_t pegasus_client::scan_batch::size() const
+{
+    return _rows == nullptr ? 0 : _rows->kvs.size();
+}
+
+pegasus_client::scan_batch::slice pegasus_client::scan_batch::hash_key(size_t i) const
+{
+    const ::dsn::blob &key = _rows->kvs[i].key;
+    slice s;
+    s.data = key.data() + 2;
+    s.size = hash_key_length(key);
+    return s;
+}
+
+pegasus_client::scan_batch::slice pegasus_client::scan_batch::sort_key(size_t i) const
+{
+    const ::dsn::blob &key = _rows->kvs[i].key;
+    uint16_t hash_key_len = hash_key_length(key);
+    slice s;
+    s.data = key.data() + 2 + hash_key_len;
+    s.size = key.length() - 2 - hash_key_len;
+    return s;
+}
+
+pegasus_client::scan_batch::slice pegasus_client::scan_batch::value(size_t i) const
+{
+    const ::dsn::blob &value = _rows->kvs[i].value;
+    slice s;
+    s.data = value.data();
+    s.size = value.length();
+    return s;
+}
+
+uint32_t pegasus_client::scan_batch::expire_ts_seconds(size_t i) const
+{
+    const auto &kv = _rows->kvs[i];
+    return kv.__isset.expire_ts_seconds ? static_cast<uint32_t>(kv.expire_ts_seconds) : 0;
+}
 } // namespace pegasus
@@ -0,0 +1,255 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "pegasus_write_batcher.h"
+
+#include <dsn/tool-api/async_calls.h>
+#include <dsn/utility/flags.h>
+
+#include "pegasus_client_impl.h"
+
+namespace pegasus {
+namespace client {
+
+DEFINE_TASK_CODE(LPC_PEGASUS_WRITE_BATCH_FLUSH, TASK_PRIORITY_COMMON, ::dsn::THREAD_POOL_DEFAULT)
+
+DSN_DEFINE_uint32("pegasus.client",
+                  write_batch_delay_ms,
+                  0,
+                  "the async sets and dels of a client are buffered for at most this time, and "
+                  "sent as one batch_write rpc per partition, 0 means not to batch the writes");
+DSN_TAG_VARIABLE(write_batch_delay_ms, FT_MUTABLE);
+
+DSN_DEFINE_uint32("pegasus.client",
+                  write_batch_max_bytes,
+                  64 * 1024,
+                  "the buffered writes of a partition are sent immediately once their size "
+                  "reaches this threshold");
+DSN_TAG_VARIABLE(write_batch_max_bytes, FT_MUTABLE);
+
+// parse the response of a write rpc into the client error and `info`.
+static int parse_update_response(::dsn::error_code err,
+                                 dsn::message_ex *resp,
+                                 pegasus_client::internal_info &info)
+{
+    ::dsn::apps::update_response response;
+    if (err == ::dsn::ERR_OK) {
+        ::dsn::unmarshall(resp, response);
+        info.app_id = response.app_id;
+        info.partition_index = response.partition_index;
+        info.decree = response.decree;
+        info.server = response.server;
+    }
+    return pegasus_client_impl::get_client_error(
+        err == ::dsn::ERR_OK ? pegasus_client_impl::get_rocksdb_server_error(response.error)
+                             : int(err));
+}
+
+// sends the rpcs by the rrdb client.
+class rrdb_rpc_sender : public pegasus_write_batcher::rpc_sender
+{
+public:
+    explicit rrdb_rpc_sender(::dsn::apps::rrdb_client *client) : _client(client) {}
+
+    void batch_write(const ::dsn::apps::batch_write_request &request,
+                     uint64_t partition_hash,
+                     int timeout_milliseconds,
+                     pegasus_write_batcher::callback_t &&callback) override
+    {
+        _client->batch_write(request,
+                             wrap(std::move(callback)),
+                             std::chrono::milliseconds(timeout_milliseconds),
+                             partition_hash);
+    }
+
+    void write_one(::dsn::apps::batch_write_operation &&op,
+                   int timeout_milliseconds,
+                   pegasus_write_batcher::callback_t &&callback) override
+    {
+        uint64_t partition_hash = pegasus_key_hash(op.key);
+        if (op.operation == ::dsn::apps::mutate_operation::MO_PUT) {
+            ::dsn::apps::update_request req;
+            req.key = std::move(op.key);
+            req.value = std::move(op.value);
+            req.expire_ts_seconds = op.expire_ts_seconds;
+            _client->put(req,
+                         wrap(std::move(callback)),
+                         std::chrono::milliseconds(timeout_milliseconds),
+                         partition_hash);
+        } else {
+            _client->remove(op.key,
+                            wrap(std::move(callback)),
+                            std::chrono::milliseconds(timeout_milliseconds),
+                            partition_hash);
+        }
+    }
+
+private:
+    static std::function<void(::dsn::error_code, dsn::message_ex *, dsn::message_ex *)>
+    wrap(pegasus_write_batcher::callback_t &&callback)
+    {
+        return [callback = std::move(callback)](
+            ::dsn::error_code err, dsn::message_ex * req, dsn::message_ex * resp)
+        {
+            if (callback == nullptr) {
+                return;
+            }
+            pegasus_client::internal_info info;
+            int ret = parse_update_response(err, resp, info);
+            callback(ret, std::move(info));
+        };
+    }
+
+    ::dsn::apps::rrdb_client *_client;
+};
+
+pegasus_write_batcher::pegasus_write_batcher(::dsn::apps::rrdb_client *client,
+                                             std::function<void()> &&on_partition_mismatch)
+    : pegasus_write_batcher(std::make_shared<rrdb_rpc_sender>(client),
+                            std::move(on_partition_mismatch))
+{
+}
+
+pegasus_write_batcher::pegasus_write_batcher(std::shared_ptr<rpc_sender> sender,
+                                             std::function<void()> &&on_partition_mismatch)
+    : _sender(std::move(sender)),
+      _on_partition_mismatch(
+          std::make_shared<std::function<void()>>(std::move(on_partition_mismatch)))
+{
+}
+
+pegasus_write_batcher::~pegasus_write_batcher()
+{
+    _tracker.cancel_outstanding_tasks();
+
+    // send the buffered writes, whose callbacks are called as long as the client is alive.
+    std::unordered_map<int, batch> batches;
+    {
+        ::dsn::zauto_lock l(_lock);
+        batches.swap(_batches);
+    }
+    for (auto &kv : batches) {
+        send(std::move(kv.second));
+    }
+}
+
+/*static*/ bool pegasus_write_batcher::enabled() { return FLAGS_write_batch_delay_ms > 0; }
+
+void pegasus_write_batcher::add(int partition_index,
+                                uint64_t partition_hash,
+                                ::dsn::apps::batch_write_operation &&op,
+                                callback_t &&callback,
+                                int timeout_milliseconds)
+{
+    batch full_batch;
+    bool schedule_flush = false;
+    uint64_t deadline_ms = dsn_now_ms() + timeout_milliseconds;
+    {
+        ::dsn::zauto_lock l(_lock);
+        batch &b = _batches[partition_index];
+        if (b.request.operations.empty()) {
+            b.partition_hash = partition_hash;
+            b.deadline_ms = deadline_ms;
+            schedule_flush = true;
+        } else {
+            b.deadline_ms = std::min(b.deadline_ms, deadline_ms);
+        }
+        b.bytes += op.key.length() + op.value.length();
+        b.request.operations.emplace_back(std::move(op));
+        b.callbacks.emplace_back(std::move(callback));
+
+        if (b.bytes >= FLAGS_write_batch_max_bytes) {
+            full_batch = std::move(b);
+            _batches.erase(partition_index);
+            schedule_flush = false;
+        }
+    }
+
+    if (!full_batch.request.operations.empty()) {
+        send(std::move(full_batch));
+    } else if (schedule_flush) {
+        // the flush may send a newer batch earlier if this batch is sent because it's full,
+        // which is harmless.
+        ::dsn::tasking::enqueue(LPC_PEGASUS_WRITE_BATCH_FLUSH,
+                                &_tracker,
+                                [this, partition_index]() { flush(partition_index); },
+                                0,
+                                std::chrono::milliseconds(FLAGS_write_batch_delay_ms));
+    }
+}
+
+void pegasus_write_batcher::flush(int partition_index)
+{
+    batch b;
+    {
+        ::dsn::zauto_lock l(_lock);
+        auto iter = _batches.find(partition_index);
+        if (iter == _batches.end()) {
+            return;
+        }
+        b = std::move(iter->second);
+        _batches.erase(iter);
+    }
+    send(std::move(b));
+}
+
+/*static*/ int pegasus_write_batcher::remaining_timeout_ms(uint64_t deadline_ms)
+{
+    uint64_t now_ms = dsn_now_ms();
+    return deadline_ms > now_ms ? static_cast<int>(deadline_ms - now_ms) : 1;
+}
+
+void pegasus_write_batcher::send(batch &&b)
+{
+    // the rpc callback doesn't refer to the batcher, which may be destroyed before the reply.
+    auto context = std::make_shared<batch>(std::move(b));
+    auto new_callback = [
+        sender = _sender,
+        on_partition_mismatch = _on_partition_mismatch,
+        context
+    ](int ret, pegasus_client::internal_info && info)
+    {
+        if (ret == PERR_INVALID_ARGUMENT) {
+            // some keys don't belong to the partition, the partition count may be changed. the
+            // writes are retried one by one, so that each of them is routed by its own key and
+            // its callback gets its own result.
+            (*on_partition_mismatch)();
+            auto &operations = context->request.operations;
+            for (size_t i = 0; i < operations.size(); ++i) {
+                sender->write_one(std::move(operations[i]),
+                                  remaining_timeout_ms(context->deadline_ms),
+                                  std::move(context->callbacks[i]));
+            }
+            return;
+        }
+
+        for (auto &callback : context->callbacks) {
+            if (callback != nullptr) {
+                callback(ret, pegasus_client::internal_info(info));
+            }
+        }
+    };
+    _sender->batch_write(context->request,
+                         context->partition_hash,
+                         remaining_timeout_ms(context->deadline_ms),
+                         std::move(new_callback));
+}
+
+} // namespace client
+} // namespace pegasus
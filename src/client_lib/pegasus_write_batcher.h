@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <pegasus/client.h>
+#include <rrdb/rrdb.client.h>
+#include <dsn/tool-api/task_tracker.h>
+#include <dsn/tool-api/zlocks.h>
+
+namespace pegasus {
+namespace client {
+
+// Buffers the async puts and removes of a client per partition, and sends the buffer of each
+// partition as one batch_write rpc once it's delayed for `write_batch_delay_ms` or its size
+// reaches `write_batch_max_bytes`. The server applies a batch in one rocksdb write batch, and
+// the callback of every write is still called with the result of its batch.
+class pegasus_write_batcher
+{
+public:
+    typedef std::function<void(int /*error_code*/, pegasus_client::internal_info && /*info*/)>
+        callback_t;
+
+    // Sends the rpcs of the batcher, whose callbacks are called with the client error. It's
+    // replaced in the tests.
+    class rpc_sender
+    {
+    public:
+        virtual ~rpc_sender() = default;
+        virtual void batch_write(const ::dsn::apps::batch_write_request &request,
+                                 uint64_t partition_hash,
+                                 int timeout_milliseconds,
+                                 callback_t &&callback) = 0;
+        // send `op` alone by a put or remove rpc, routed by its own key. `callback` may be
+        // null.
+        virtual void write_one(::dsn::apps::batch_write_operation &&op,
+                               int timeout_milliseconds,
+                               callback_t &&callback) = 0;
+    };
+
+    // `on_partition_mismatch` is called when a batch is rejected because some keys don't belong
+    // to the partition, which means the partition count of the app is changed.
+    pegasus_write_batcher(::dsn::apps::rrdb_client *client,
+                          std::function<void()> &&on_partition_mismatch);
+    pegasus_write_batcher(std::shared_ptr<rpc_sender> sender,
+                          std::function<void()> &&on_partition_mismatch);
+    ~pegasus_write_batcher();
+
+    // whether the writes should be batched, which is configured by `write_batch_delay_ms`.
+    static bool enabled();
+
+    // buffer the write `op`, whose key belongs to partition `partition_index`.
+    void add(int partition_index,
+             uint64_t partition_hash,
+             ::dsn::apps::batch_write_operation &&op,
+             callback_t &&callback,
+             int timeout_milliseconds);
+
+private:
+    friend class pegasus_write_batcher_test;
+
+    struct batch
+    {
+        ::dsn::apps::batch_write_request request;
+        std::vector<callback_t> callbacks;
+        uint64_t partition_hash = 0;
+        size_t bytes = 0;
+        // the min deadline of the writes in the batch, so that the time buffered is subtracted
+        // from their timeouts.
+        uint64_t deadline_ms = 0;
+    };
+
+    // the timeout of an rpc sent now for the writes due at `deadline_ms`, at least 1ms.
+    static int remaining_timeout_ms(uint64_t deadline_ms);
+
+    // send the buffered batch of `partition_index` if any.
+    void flush(int partition_index);
+
+    void send(batch &&b);
+
+    const std::shared_ptr<rpc_sender> _sender;
+    const std::shared_ptr<std::function<void()>> _on_partition_mismatch;
+    ::dsn::task_tracker _tracker;
+
+    ::dsn::zlock _lock;
+    // partition_index => the buffered writes, protected by _lock
+    std::unordered_map<int, batch> _batches;
+};
+
+} // namespace client
+} // namespace pegasus
@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <pegasus/future.h>
+
+namespace pegasus {
+
+struct test_result
+{
+    int error = PERR_OK;
+    int value = 0;
+};
+
+static test_result make_result(int error, int value)
+{
+    test_result result;
+    result.error = error;
+    result.value = value;
+    return result;
+}
+
+TEST(future_test, default_constructed)
+{
+    pegasus_future<test_result> future;
+    ASSERT_FALSE(future.valid());
+    ASSERT_FALSE(future.ready());
+    // cancelling an invalid future is a no-op
+    future.cancel();
+    ASSERT_FALSE(future.ready());
+}
+
+TEST(future_test, ready_and_get)
+{
+    pegasus_promise<test_result> promise;
+    auto future = promise.get_future();
+    ASSERT_TRUE(future.valid());
+    ASSERT_FALSE(future.ready());
+
+    ASSERT_TRUE(promise.set_value(make_result(PERR_OK, 1)));
+    ASSERT_TRUE(future.ready());
+    // the future is completed only once
+    ASSERT_FALSE(promise.set_value(make_result(PERR_OK, 2)));
+    test_result result = future.get();
+    ASSERT_EQ(PERR_OK, result.error);
+    ASSERT_EQ(1, result.value);
+}
+
+TEST(future_test, then)
+{
+    // the continuation registered before the completion is called by set_value
+    pegasus_promise<test_result> promise;
+    int value = 0;
+    promise.get_future().then([&value](test_result &&result) { value = result.value; });
+    ASSERT_EQ(0, value);
+    promise.set_value(make_result(PERR_OK, 1));
+    ASSERT_EQ(1, value);
+
+    // and the one registered after the completion is called immediately
+    pegasus_promise<test_result> completed;
+    completed.set_value(make_result(PERR_OK, 2));
+    completed.get_future().then([&value](test_result &&result) { value = result.value; });
+    ASSERT_EQ(2, value);
+}
+
+TEST(future_test, cancel)
+{
+    pegasus_promise<test_result> promise;
+    int hook_count = 0;
+    promise.on_cancel([&hook_count]() { ++hook_count; });
+    auto future = promise.get_future();
+
+    future.cancel();
+    ASSERT_EQ(1, hook_count);
+    ASSERT_TRUE(future.ready());
+    ASSERT_EQ(PERR_CANCELLED, future.get().error);
+    // the result arriving after the cancellation is dropped
+    ASSERT_FALSE(promise.set_value(make_result(PERR_OK, 1)));
+    future.cancel();
+    ASSERT_EQ(1, hook_count);
+
+    // cancelling a completed future neither calls the hooks nor changes the result
+    pegasus_promise<test_result> completed;
+    completed.on_cancel([&hook_count]() { ++hook_count; });
+    completed.set_value(make_result(PERR_OK, 2));
+    auto completed_future = completed.get_future();
+    completed_future.cancel();
+    ASSERT_EQ(1, hook_count);
+    ASSERT_EQ(2, completed_future.get().value);
+}
+
+TEST(future_test, when_all)
+{
+    // no future
+    auto empty = when_all(std::vector<pegasus_future<test_result>>());
+    ASSERT_TRUE(empty.ready());
+    ASSERT_EQ(PERR_OK, empty.get().error);
+
+    // the results are in the order of the futures, and the first error is reported
+    std::vector<pegasus_promise<test_result>> promises(3);
+    std::vector<pegasus_future<test_result>> futures;
+    for (const auto &promise : promises) {
+        futures.emplace_back(promise.get_future());
+    }
+    auto all = when_all(std::move(futures));
+    promises[2].set_value(make_result(PERR_TIMEOUT, 2));
+    promises[0].set_value(make_result(PERR_OK, 0));
+    ASSERT_FALSE(all.ready());
+    promises[1].set_value(make_result(PERR_NOT_FOUND, 1));
+    ASSERT_TRUE(all.ready());
+    auto result = all.get();
+    ASSERT_EQ(PERR_TIMEOUT, result.error);
+    ASSERT_EQ(3, result.results.size());
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(i, result.results[i].value);
+    }
+}
+
+TEST(future_test, when_all_cancel)
+{
+    std::vector<pegasus_promise<test_result>> promises(2);
+    std::vector<pegasus_future<test_result>> futures;
+    for (const auto &promise : promises) {
+        futures.emplace_back(promise.get_future());
+    }
+    auto all = when_all(std::move(futures));
+    promises[0].set_value(make_result(PERR_OK, 0));
+
+    // cancelling the aggregated future cancels the pending ones
+    all.cancel();
+    ASSERT_TRUE(all.ready());
+    ASSERT_FALSE(promises[1].set_value(make_result(PERR_OK, 1)));
+    auto result = all.get();
+    ASSERT_EQ(PERR_CANCELLED, result.error);
+    ASSERT_EQ(PERR_OK, result.results[0].error);
+    ASSERT_EQ(PERR_CANCELLED, result.results[1].error);
+}
+
+} // namespace pegasus
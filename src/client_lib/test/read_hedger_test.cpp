@@ -0,0 +1,297 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "client_lib/pegasus_read_hedger.h"
+
+#include <algorithm>
+#include <thread>
+#include <dsn/utility/flags.h>
+#include <dsn/utility/smart_pointers.h>
+#include <gtest/gtest.h>
+
+namespace pegasus {
+namespace client {
+
+DSN_DECLARE_uint32(hedged_read_percentile);
+DSN_DECLARE_uint32(hedged_read_budget_percent);
+
+class pegasus_read_hedger_test : public ::testing::Test
+{
+public:
+    pegasus_read_hedger_test()
+    {
+        _old_percentile = FLAGS_hedged_read_percentile;
+        _old_budget_percent = FLAGS_hedged_read_budget_percent;
+        FLAGS_hedged_read_percentile = 95;
+        FLAGS_hedged_read_budget_percent = 5;
+
+        _hedger = dsn::make_unique<pegasus_read_hedger>(
+            "onebox", "temp", ::dsn::rpc_address("127.0.0.1", 34601));
+        // pretend a query is in progress, so that no configuration is queried from meta server.
+        _hedger->_querying_config.store(true);
+    }
+
+    ~pegasus_read_hedger_test() override
+    {
+        FLAGS_hedged_read_percentile = _old_percentile;
+        FLAGS_hedged_read_budget_percent = _old_budget_percent;
+    }
+
+    // the upper bound of the bucket where `latency_us` lies.
+    static uint64_t bucket_bound_us(uint64_t latency_us)
+    {
+        const auto &bounds = latency_histogram::bucket_bounds_us();
+        return *std::lower_bound(bounds.begin(), bounds.end(), latency_us);
+    }
+
+    static uint64_t sample_count(const latency_histogram &h)
+    {
+        ::dsn::zauto_lock l(h._lock);
+        return h._total;
+    }
+
+    int64_t budget() const { return _hedger->_budget.load(); }
+    static int64_t hedge_cost() { return pegasus_read_hedger::HEDGE_COST; }
+    static int64_t max_budget() { return pegasus_read_hedger::MAX_BUDGET; }
+    void add_budget(int times)
+    {
+        for (int i = 0; i < times; ++i) {
+            _hedger->add_budget();
+        }
+    }
+    bool has_budget() const { return _hedger->has_budget(); }
+    bool consume_budget() { return _hedger->consume_budget(); }
+
+    // set a table of one partition, whose latencies are `latency_us`.
+    void set_table(bool has_secondary, uint64_t latency_us)
+    {
+        auto table = std::make_shared<pegasus_read_hedger::partition_table>();
+        table->configs.resize(1);
+        table->configs[0].pid = ::dsn::gpid(1, 0);
+        table->configs[0].primary = ::dsn::rpc_address("127.0.0.1", 34801);
+        if (has_secondary) {
+            table->configs[0].secondaries.emplace_back(::dsn::rpc_address("127.0.0.1", 34802));
+        }
+        table->latencies.emplace_back(std::make_shared<latency_histogram>());
+        for (uint64_t i = 0; i < latency_histogram::MIN_SAMPLES; ++i) {
+            table->latencies[0]->record(latency_us);
+        }
+        table->update_ms = dsn_now_ms();
+        _hedger->_table = table;
+    }
+
+    int prepare(int timeout_milliseconds)
+    {
+        pegasus_read_hedger::hedged_read ctx;
+        return _hedger->prepare(0, timeout_milliseconds, ctx);
+    }
+
+    // a read whose callback counts the calls.
+    std::shared_ptr<pegasus_read_hedger::hedged_read> make_read(std::atomic_int &called)
+    {
+        auto ctx = std::make_shared<pegasus_read_hedger::hedged_read>();
+        ctx->callback = [&called](::dsn::error_code, dsn::message_ex *, dsn::message_ex *) {
+            called++;
+        };
+        ctx->hedged.store(true);
+        ctx->latencies = std::make_shared<latency_histogram>();
+        ctx->start_ns = dsn_now_ns();
+        return ctx;
+    }
+
+    void on_primary_response(const std::shared_ptr<pegasus_read_hedger::hedged_read> &ctx,
+                             ::dsn::error_code err)
+    {
+        _hedger->on_primary_response(ctx, err, nullptr, nullptr);
+    }
+
+    void on_hedge_response(const std::shared_ptr<pegasus_read_hedger::hedged_read> &ctx,
+                           ::dsn::error_code err)
+    {
+        _hedger->on_hedge_response(ctx, err, nullptr, nullptr);
+    }
+
+protected:
+    std::unique_ptr<pegasus_read_hedger> _hedger;
+
+    uint32_t _old_percentile;
+    uint32_t _old_budget_percent;
+};
+
+TEST_F(pegasus_read_hedger_test, enabled)
+{
+    ASSERT_TRUE(pegasus_read_hedger::enabled());
+    FLAGS_hedged_read_percentile = 0;
+    ASSERT_FALSE(pegasus_read_hedger::enabled());
+    FLAGS_hedged_read_percentile = 100;
+    ASSERT_FALSE(pegasus_read_hedger::enabled());
+}
+
+TEST_F(pegasus_read_hedger_test, percentile)
+{
+    latency_histogram h;
+    for (int i = 0; i < 89; ++i) {
+        h.record(100);
+    }
+    for (int i = 0; i < 10; ++i) {
+        h.record(10000);
+    }
+    // not valid until there are MIN_SAMPLES samples
+    ASSERT_EQ(0, h.percentile_us(50));
+
+    h.record(100);
+    ASSERT_EQ(100, h.percentile_us(50));
+    ASSERT_EQ(100, h.percentile_us(90));
+    ASSERT_EQ(bucket_bound_us(10000), h.percentile_us(91));
+    ASSERT_EQ(bucket_bound_us(10000), h.percentile_us(99));
+    ASSERT_GE(bucket_bound_us(10000), 10000);
+
+    // the latencies beyond the last bucket are counted into it.
+    latency_histogram slow;
+    for (uint64_t i = 0; i < latency_histogram::MIN_SAMPLES; ++i) {
+        slow.record(UINT64_MAX);
+    }
+    ASSERT_EQ(latency_histogram::bucket_bounds_us().back(), slow.percentile_us(50));
+}
+
+TEST_F(pegasus_read_hedger_test, decay)
+{
+    latency_histogram h;
+    for (uint64_t i = 0; i < latency_histogram::WINDOW_SIZE; ++i) {
+        h.record(100);
+    }
+    // halved once there are WINDOW_SIZE samples
+    ASSERT_EQ(latency_histogram::WINDOW_SIZE / 2, sample_count(h));
+
+    // the old samples weigh half, without which the 60th percentile would still be 100us.
+    for (uint64_t i = 0; i < latency_histogram::WINDOW_SIZE / 2 - 1; ++i) {
+        h.record(10000);
+    }
+    ASSERT_EQ(latency_histogram::WINDOW_SIZE - 1, sample_count(h));
+    ASSERT_EQ(100, h.percentile_us(50));
+    ASSERT_EQ(bucket_bound_us(10000), h.percentile_us(60));
+
+    // the old samples fade out after some windows.
+    for (uint64_t i = 0; i < latency_histogram::WINDOW_SIZE * 10; ++i) {
+        h.record(10000);
+    }
+    ASSERT_EQ(bucket_bound_us(10000), h.percentile_us(1));
+}
+
+TEST_F(pegasus_read_hedger_test, budget)
+{
+    ASSERT_EQ(0, budget());
+    ASSERT_FALSE(has_budget());
+    ASSERT_FALSE(consume_budget());
+
+    // a hedge is earned by every 100 / hedged_read_budget_percent reads.
+    int reads_per_hedge = static_cast<int>(hedge_cost() / FLAGS_hedged_read_budget_percent);
+    add_budget(reads_per_hedge - 1);
+    ASSERT_FALSE(has_budget());
+    ASSERT_FALSE(consume_budget());
+    add_budget(1);
+    ASSERT_TRUE(has_budget());
+    ASSERT_TRUE(consume_budget());
+    ASSERT_EQ(0, budget());
+    ASSERT_FALSE(consume_budget());
+
+    // the budget is capped, so that a burst of hedges is bounded after a quiet period.
+    add_budget(static_cast<int>(max_budget() / FLAGS_hedged_read_budget_percent) * 2);
+    ASSERT_EQ(max_budget(), budget());
+    int hedges = 0;
+    while (consume_budget()) {
+        hedges++;
+    }
+    ASSERT_EQ(max_budget() / hedge_cost(), hedges);
+    ASSERT_EQ(0, budget());
+}
+
+TEST_F(pegasus_read_hedger_test, prepare)
+{
+    // not hedged until the configuration is got
+    ASSERT_EQ(0, prepare(1000));
+
+    // not hedged without budget
+    set_table(true, 2000);
+    ASSERT_EQ(0, prepare(1000));
+
+    // the delay is the percentile latency rounded up to ms
+    add_budget(static_cast<int>(hedge_cost() / FLAGS_hedged_read_budget_percent));
+    int delay_ms = prepare(1000);
+    ASSERT_EQ(static_cast<int>((bucket_bound_us(2000) + 999) / 1000), delay_ms);
+
+    // not hedged if the hedge would be sent after the timeout
+    ASSERT_EQ(0, prepare(delay_ms));
+
+    // not hedged without any secondary
+    set_table(false, 2000);
+    ASSERT_EQ(0, prepare(1000));
+}
+
+TEST_F(pegasus_read_hedger_test, first_wins)
+{
+    // the hedge wins, and the latency of the primary is still recorded.
+    std::atomic_int called(0);
+    auto ctx = make_read(called);
+    on_hedge_response(ctx, ::dsn::ERR_OK);
+    ASSERT_EQ(1, called.load());
+    on_primary_response(ctx, ::dsn::ERR_OK);
+    ASSERT_EQ(1, called.load());
+    ASSERT_EQ(1, sample_count(*ctx->latencies));
+
+    // the primary wins
+    called.store(0);
+    ctx = make_read(called);
+    on_primary_response(ctx, ::dsn::ERR_OK);
+    on_hedge_response(ctx, ::dsn::ERR_OK);
+    ASSERT_EQ(1, called.load());
+
+    // a failed hedge is ignored, and the read is answered by the primary.
+    called.store(0);
+    ctx = make_read(called);
+    on_hedge_response(ctx, ::dsn::ERR_TIMEOUT);
+    ASSERT_EQ(0, called.load());
+    on_primary_response(ctx, ::dsn::ERR_TIMEOUT);
+    ASSERT_EQ(1, called.load());
+    // the latency of a timed out primary is recorded, so that a slow partition looks slow
+    ASSERT_EQ(1, sample_count(*ctx->latencies));
+
+    // but not of the other errors, which are replied immediately
+    called.store(0);
+    ctx = make_read(called);
+    on_primary_response(ctx, ::dsn::ERR_OBJECT_NOT_FOUND);
+    ASSERT_EQ(1, called.load());
+    ASSERT_EQ(0, sample_count(*ctx->latencies));
+}
+
+TEST_F(pegasus_read_hedger_test, first_wins_race)
+{
+    for (int i = 0; i < 100; ++i) {
+        std::atomic_int called(0);
+        auto ctx = make_read(called);
+        std::thread primary([&]() { on_primary_response(ctx, ::dsn::ERR_OK); });
+        std::thread hedge([&]() { on_hedge_response(ctx, ::dsn::ERR_OK); });
+        primary.join();
+        hedge.join();
+        ASSERT_EQ(1, called.load());
+    }
+}
+
+} // namespace client
+} // namespace pegasus
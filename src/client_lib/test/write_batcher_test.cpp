@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "client_lib/pegasus_write_batcher.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <dsn/utility/flags.h>
+#include <dsn/utility/smart_pointers.h>
+#include <gtest/gtest.h>
+
+namespace pegasus {
+namespace client {
+
+DSN_DECLARE_uint32(write_batch_delay_ms);
+DSN_DECLARE_uint32(write_batch_max_bytes);
+
+// records the rpcs instead of sending them, whose callbacks are called by the tests.
+class mock_rpc_sender : public pegasus_write_batcher::rpc_sender
+{
+public:
+    struct batch_write_rpc
+    {
+        ::dsn::apps::batch_write_request request;
+        uint64_t partition_hash;
+        int timeout_milliseconds;
+        pegasus_write_batcher::callback_t callback;
+    };
+    struct write_one_rpc
+    {
+        ::dsn::apps::batch_write_operation op;
+        int timeout_milliseconds;
+        pegasus_write_batcher::callback_t callback;
+    };
+
+    void batch_write(const ::dsn::apps::batch_write_request &request,
+                     uint64_t partition_hash,
+                     int timeout_milliseconds,
+                     pegasus_write_batcher::callback_t &&callback) override
+    {
+        std::lock_guard<std::mutex> l(lock);
+        batch_writes.push_back(
+            {request, partition_hash, timeout_milliseconds, std::move(callback)});
+    }
+
+    void write_one(::dsn::apps::batch_write_operation &&op,
+                   int timeout_milliseconds,
+                   pegasus_write_batcher::callback_t &&callback) override
+    {
+        std::lock_guard<std::mutex> l(lock);
+        write_ones.push_back({std::move(op), timeout_milliseconds, std::move(callback)});
+    }
+
+    size_t batch_write_count()
+    {
+        std::lock_guard<std::mutex> l(lock);
+        return batch_writes.size();
+    }
+
+    std::mutex lock;
+    std::vector<batch_write_rpc> batch_writes;
+    std::vector<write_one_rpc> write_ones;
+};
+
+class pegasus_write_batcher_test : public ::testing::Test
+{
+public:
+    pegasus_write_batcher_test()
+    {
+        _old_delay_ms = FLAGS_write_batch_delay_ms;
+        _old_max_bytes = FLAGS_write_batch_max_bytes;
+        FLAGS_write_batch_delay_ms = 10;
+        FLAGS_write_batch_max_bytes = 64 * 1024;
+
+        _sender = std::make_shared<mock_rpc_sender>();
+        _batcher = dsn::make_unique<pegasus_write_batcher>(
+            _sender, [this]() { _partition_mismatch_count++; });
+    }
+
+    ~pegasus_write_batcher_test() override
+    {
+        _batcher.reset();
+        FLAGS_write_batch_delay_ms = _old_delay_ms;
+        FLAGS_write_batch_max_bytes = _old_max_bytes;
+    }
+
+    // buffer a put of `key` into partition 0, whose result is saved in `_results[key]`.
+    void put(const std::string &key, const std::string &value, int timeout_milliseconds = 5000)
+    {
+        ::dsn::apps::batch_write_operation op;
+        op.operation = ::dsn::apps::mutate_operation::MO_PUT;
+        op.key = ::dsn::blob::create_from_bytes(std::string(key));
+        op.value = ::dsn::blob::create_from_bytes(std::string(value));
+        _batcher->add(0,
+                      0,
+                      std::move(op),
+                      [this, key](int err, pegasus_client::internal_info &&info) {
+                          _results[key] = err;
+                      },
+                      timeout_milliseconds);
+    }
+
+    // wait until there are `count` batch_write rpcs sent.
+    void wait_batch_writes(size_t count)
+    {
+        for (int i = 0; i < 1000 && _sender->batch_write_count() < count; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ(count, _sender->batch_write_count());
+    }
+
+    static int remaining_timeout_ms(uint64_t deadline_ms)
+    {
+        return pegasus_write_batcher::remaining_timeout_ms(deadline_ms);
+    }
+
+protected:
+    std::shared_ptr<mock_rpc_sender> _sender;
+    std::unique_ptr<pegasus_write_batcher> _batcher;
+    int _partition_mismatch_count = 0;
+    std::map<std::string, int> _results;
+
+    uint32_t _old_delay_ms;
+    uint32_t _old_max_bytes;
+};
+
+TEST_F(pegasus_write_batcher_test, flush_by_delay)
+{
+    put("k1", "v1");
+    put("k2", "v2");
+    put("k3", "v3");
+    // sent once delayed for write_batch_delay_ms
+    ASSERT_NO_FATAL_FAILURE(wait_batch_writes(1));
+    const auto &rpc = _sender->batch_writes[0];
+    ASSERT_EQ(3, rpc.request.operations.size());
+    ASSERT_EQ("k1", rpc.request.operations[0].key.to_string());
+    ASSERT_EQ("k3", rpc.request.operations[2].key.to_string());
+
+    // the callback of every write is called with the result of the batch
+    rpc.callback(PERR_OK, pegasus_client::internal_info());
+    ASSERT_EQ(3, _results.size());
+    for (const auto &kv : _results) {
+        ASSERT_EQ(PERR_OK, kv.second);
+    }
+}
+
+TEST_F(pegasus_write_batcher_test, flush_by_bytes)
+{
+    FLAGS_write_batch_delay_ms = 60 * 1000;
+    FLAGS_write_batch_max_bytes = 10;
+    put("k1", "v1");
+    put("k2", "v2");
+    ASSERT_EQ(0, _sender->batch_write_count());
+    // sent immediately once the size reaches write_batch_max_bytes
+    put("k3", "v3");
+    ASSERT_EQ(1, _sender->batch_write_count());
+    ASSERT_EQ(3, _sender->batch_writes[0].request.operations.size());
+
+    // the next write starts a new batch
+    put("k4", "v4");
+    ASSERT_EQ(1, _sender->batch_write_count());
+}
+
+TEST_F(pegasus_write_batcher_test, partition_mismatch)
+{
+    put("k1", "v1");
+    put("k2", "v2");
+    ASSERT_NO_FATAL_FAILURE(wait_batch_writes(1));
+
+    // the rejected batch is retried write by write
+    _sender->batch_writes[0].callback(PERR_INVALID_ARGUMENT, pegasus_client::internal_info());
+    ASSERT_EQ(1, _partition_mismatch_count);
+    ASSERT_TRUE(_results.empty());
+    ASSERT_EQ(2, _sender->write_ones.size());
+    ASSERT_EQ("k1", _sender->write_ones[0].op.key.to_string());
+    ASSERT_EQ("k2", _sender->write_ones[1].op.key.to_string());
+
+    // and each callback gets the result of its own write
+    _sender->write_ones[0].callback(PERR_OK, pegasus_client::internal_info());
+    _sender->write_ones[1].callback(PERR_TIMEOUT, pegasus_client::internal_info());
+    ASSERT_EQ(PERR_OK, _results["k1"]);
+    ASSERT_EQ(PERR_TIMEOUT, _results["k2"]);
+}
+
+TEST_F(pegasus_write_batcher_test, deadline)
+{
+    FLAGS_write_batch_delay_ms = 100;
+    put("k1", "v1", 5000);
+    put("k2", "v2", 1000);
+    ASSERT_NO_FATAL_FAILURE(wait_batch_writes(1));
+    // the batch is due at the min deadline of its writes, less the time buffered
+    int timeout_ms = _sender->batch_writes[0].timeout_milliseconds;
+    ASSERT_LE(timeout_ms, 1000 - 100);
+    ASSERT_GT(timeout_ms, 0);
+
+    // so are the writes retried one by one
+    _sender->batch_writes[0].callback(PERR_INVALID_ARGUMENT, pegasus_client::internal_info());
+    ASSERT_EQ(2, _sender->write_ones.size());
+    for (const auto &rpc : _sender->write_ones) {
+        ASSERT_LE(rpc.timeout_milliseconds, timeout_ms);
+        ASSERT_GT(rpc.timeout_milliseconds, 0);
+    }
+
+    // an expired write is still sent with the min timeout
+    ASSERT_EQ(1, remaining_timeout_ms(dsn_now_ms() - 10));
+    ASSERT_LE(remaining_timeout_ms(dsn_now_ms() + 1000), 1000);
+}
+
+} // namespace client
+} // namespace pegasus
@@ -25,7 +25,10 @@ enum filter_type
     FT_NO_FILTER,
     FT_MATCH_ANYWHERE,
     FT_MATCH_PREFIX,
-    FT_MATCH_POSTFIX
+    FT_MATCH_POSTFIX,
+    // 4 is taken by FT_MATCH_EXACT of pegasus_client, which is only resolved on the client side.
+    FT_MATCH_REGEX = 5,
+    FT_MATCH_MULTI_PATTERN = 6
 }
 
 enum cas_check_type
@@ -64,6 +67,13 @@ enum mutate_operation
     MO_DELETE
 }
 
+enum scan_aggregate_type
+{
+    SA_NONE,
+    SA_COUNT,           // count rows, and sum up the sizes of keys and values
+    SA_INT_STATS        // SA_COUNT, plus sum/min/max of the values parsed as int64
+}
+
 struct update_request
 {
     1:dsn.blob      key;
@@ -161,6 +171,9 @@ struct multi_get_response
     3:i32           app_id;
     4:i32           partition_index;
     6:string        server;
+    // the last sort key scanned by a range read which is incomplete, from which the read can be
+    // resumed even if all the scanned rows are filtered out.
+    7:optional dsn.blob last_sortkey;
 }
 
 struct incr_request
@@ -241,6 +254,19 @@ struct check_and_mutate_response
     8:string         server;
 }
 
+// the aggregate of the rows scanned in one batch.
+struct scan_aggregate_result
+{
+    1:i64           row_count;
+    2:i64           key_bytes;      // the total size of hash keys and sort keys
+    3:i64           value_bytes;
+    // the following are only for SA_INT_STATS, min and max are valid only if int_count > 0.
+    4:i64           int_count;      // the count of values which can be parsed as int64
+    5:i64           int_sum;
+    6:i64           int_min;
+    7:i64           int_max;
+}
+
 struct get_scanner_request
 {
     1:dsn.blob  start_key;
@@ -255,6 +281,8 @@ struct get_scanner_request
     10:dsn.blob    sort_key_filter_pattern;
     11:optional bool    validate_partition_hash;
     12:optional bool    return_expire_ts;
+    // if set and not SA_NONE, return only the aggregate of each batch instead of the rows.
+    13:optional scan_aggregate_type aggregate_type;
 }
 
 struct scan_request
@@ -270,6 +298,7 @@ struct scan_response
     4:i32           app_id;
     5:i32           partition_index;
     6:string        server;
+    7:optional scan_aggregate_result aggregate;
 }
 
 struct duplicate_request
@@ -298,6 +327,54 @@ struct duplicate_response
     2: optional string error_hint;
 }
 
+struct full_key
+{
+    1:dsn.blob      hash_key;
+    2:dsn.blob      sort_key;
+}
+
+struct batch_get_request
+{
+    1:list<full_key> keys; // all keys should belong to the same partition
+}
+
+struct full_data
+{
+    1:dsn.blob      hash_key;
+    2:dsn.blob      sort_key;
+    3:dsn.blob      value;
+}
+
+struct batch_get_response
+{
+    1:i32           error;
+    2:list<full_data> data; // only the found keys are returned
+    3:i32           app_id;
+    4:i32           partition_index;
+    6:string        server;
+}
+
+struct sortkey_count_request
+{
+    1:dsn.blob      hash_key;
+    2:bool          approximate; // estimate the count if it's too expensive to be exact
+}
+
+struct batch_write_operation
+{
+    1:mutate_operation operation;
+    2:dsn.blob         key; // the raw key composed of hash key and sort key
+    3:dsn.blob         value; // set null if operation is MO_DELETE
+    4:i32              expire_ts_seconds; // set 0 if operation is MO_DELETE
+}
+
+struct batch_write_request
+{
+    // all keys should belong to the same partition, and the operations are applied in order
+    // atomically.
+    1:list<batch_write_operation> operations;
+}
+
 service rrdb
 {
     update_response put(1:update_request update);
@@ -307,9 +384,12 @@ service rrdb
     incr_response incr(1:incr_request request);
     check_and_set_response check_and_set(1:check_and_set_request request);
     check_and_mutate_response check_and_mutate(1:check_and_mutate_request request);
+    update_response batch_write(1:batch_write_request request);
     read_response get(1:dsn.blob key);
     multi_get_response multi_get(1:multi_get_request request);
+    batch_get_response batch_get(1:batch_get_request request);
     count_response sortkey_count(1:dsn.blob hash_key);
+    count_response sortkey_count_v2(1:sortkey_count_request request);
     ttl_response ttl(1:dsn.blob key);
 
     scan_response get_scanner(1:get_scanner_request request);
@@ -19,14 +19,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <set>
 #include <map>
 #include <stdint.h>
 #include <pegasus/error.h>
+#include <pegasus/future.h>
 #include <functional>
 #include <memory>
+#include <utility>
 
 namespace pegasus {
 
@@ -85,7 +88,13 @@ public:
         FT_MATCH_ANYWHERE = 1,
         FT_MATCH_PREFIX = 2,
         FT_MATCH_POSTFIX = 3,
-        FT_MATCH_EXACT = 4
+        FT_MATCH_EXACT = 4, // only supported by the shell, resolved on the client side
+        // match if the regular expression (ECMAScript syntax) matches any part of the key,
+        // use '^' and '$' to anchor it.
+        FT_MATCH_REGEX = 5,
+        // match if any of the patterns appears anywhere in the key, the patterns are separated
+        // by '\n' in the filter pattern.
+        FT_MATCH_MULTI_PATTERN = 6
     };
 
     struct multi_get_options
@@ -278,6 +287,55 @@ public:
         }
     };
 
+    // the aggregation of a scan, which is done on the server side, only the aggregate is
+    // returned instead of the scanned k-v pairs.
+    enum scan_aggregate_type
+    {
+        SA_NONE = 0,
+        // count the k-v pairs, and sum up the sizes of the keys and values.
+        SA_COUNT = 1,
+        // SA_COUNT, plus the sum/min/max of the values which can be parsed as int64,
+        // the other values are ignored.
+        SA_INT_STATS = 2
+    };
+
+    struct scan_aggregate_result
+    {
+        int64_t row_count;
+        int64_t key_bytes; // the total size of hash keys and sort keys
+        int64_t value_bytes;
+        // the following are only for SA_INT_STATS, int_min and int_max are valid only if
+        // int_count > 0.
+        int64_t int_count;
+        int64_t int_sum; // wraps around on overflow
+        int64_t int_min;
+        int64_t int_max;
+        scan_aggregate_result()
+            : row_count(0),
+              key_bytes(0),
+              value_bytes(0),
+              int_count(0),
+              int_sum(0),
+              int_min(0),
+              int_max(0)
+        {
+        }
+        void merge(const scan_aggregate_result &o)
+        {
+            row_count += o.row_count;
+            key_bytes += o.key_bytes;
+            value_bytes += o.value_bytes;
+            if (o.int_count == 0) {
+                return;
+            }
+            int_min = int_count == 0 ? o.int_min : std::min(int_min, o.int_min);
+            int_max = int_count == 0 ? o.int_max : std::max(int_max, o.int_max);
+            int_count += o.int_count;
+            int_sum = static_cast<int64_t>(static_cast<uint64_t>(int_sum) +
+                                           static_cast<uint64_t>(o.int_sum));
+        }
+    };
+
     class pegasus_scanner;
 
     // define callback function types for asynchronous operations.
@@ -294,6 +352,10 @@ public:
     typedef std::function<void(
         int /*error_code*/, std::set<std::string> && /*sortkeys*/, internal_info && /*info*/)>
         async_multi_get_sortkeys_callback_t;
+    typedef std::function<void(int /*error_code*/,
+                               std::map<std::pair<std::string, std::string>,
+                                        std::string> && /*values*/)>
+        async_batch_get_callback_t;
     typedef std::function<void(int /*error_code*/, internal_info && /*info*/)> async_del_callback_t;
     typedef std::function<void(
         int /*error_code*/, int64_t /*deleted_count*/, internal_info && /*info*/)>
@@ -314,11 +376,86 @@ public:
                                internal_info && /*info*/,
                                uint32_t /*expire_ts_seconds*/)>
         async_scan_next_callback_t;
+    typedef std::function<void(int /*error_code*/, scan_aggregate_result && /*batch_result*/)>
+        async_scan_aggregate_callback_t;
     typedef std::function<void(int /*error_code*/, pegasus_scanner * /*hash_scanner*/)>
         async_get_scanner_callback_t;
     typedef std::function<void(int /*error_code*/, std::vector<pegasus_scanner *> && /*scanners*/)>
         async_get_unordered_scanners_callback_t;
 
+    // the k-v pairs got by one scan rpc, which are kept in the buffer of the rpc response and
+    // accessed without being copied. it's cheap to copy a batch, which shares the buffer.
+    class scan_batch
+    {
+    public:
+        // refers to the buffer of the batch, which is valid as long as the batch.
+        struct slice
+        {
+            const char *data = nullptr;
+            size_t size = 0;
+            std::string to_string() const { return std::string(data, size); }
+        };
+
+        // the rows of the batch, which are only visible to the client lib.
+        struct rows;
+
+        scan_batch() = default;
+        explicit scan_batch(std::shared_ptr<const rows> r) : _rows(std::move(r)) {}
+
+        size_t size() const;
+        bool empty() const { return size() == 0; }
+        // the i-th row of the batch, i should be less than size().
+        slice hash_key(size_t i) const;
+        slice sort_key(size_t i) const;
+        slice value(size_t i) const;
+        // 0 if not returned, see scan_options::return_expire_ts.
+        uint32_t expire_ts_seconds(size_t i) const;
+
+    private:
+        std::shared_ptr<const rows> _rows;
+    };
+    typedef std::function<void(
+        int /*error_code*/, scan_batch && /*batch*/, internal_info && /*info*/)>
+        async_scan_next_batch_callback_t;
+    typedef std::function<bool(int /*error_code*/,
+                               scan_batch && /*batch*/,
+                               internal_info && /*info*/,
+                               std::function<void()> && /*release*/)>
+        async_scan_batches_callback_t;
+
+    // define result types for future-based operations.
+    struct set_result
+    {
+        int error = PERR_OK;
+        internal_info info;
+    };
+    struct get_result
+    {
+        int error = PERR_OK;
+        std::string value;
+        internal_info info;
+    };
+    struct multi_get_result
+    {
+        int error = PERR_OK;
+        std::map<std::string, std::string> values;
+        internal_info info;
+    };
+    struct scan_next_result
+    {
+        int error = PERR_OK;
+        std::string hashkey;
+        std::string sortkey;
+        std::string value;
+        internal_info info;
+        uint32_t expire_ts_seconds = 0;
+    };
+    struct get_unordered_scanners_result
+    {
+        int error = PERR_OK;
+        std::vector<pegasus_scanner *> scanners;
+    };
+
     class abstract_pegasus_scanner
     {
     public:
@@ -354,6 +491,103 @@ public:
         ///
         virtual void async_next(async_scan_next_callback_t &&callback) = 0;
 
+        ///
+        /// \brief future-based async_next
+        /// \return
+        /// the future of the next k-v pair, whose error is the same as that of async_next()
+        ///
+        pegasus_future<scan_next_result> future_next()
+        {
+            pegasus_promise<scan_next_result> promise;
+            auto future = promise.get_future();
+            async_next([promise](int error_code,
+                                 std::string &&hashkey,
+                                 std::string &&sortkey,
+                                 std::string &&value,
+                                 internal_info &&info,
+                                 uint32_t expire_ts_seconds) {
+                scan_next_result result;
+                result.error = error_code;
+                result.hashkey = std::move(hashkey);
+                result.sortkey = std::move(sortkey);
+                result.value = std::move(value);
+                result.info = std::move(info);
+                result.expire_ts_seconds = expire_ts_seconds;
+                promise.set_value(std::move(result));
+            });
+            return future;
+        }
+
+        ///
+        /// \brief get the k-v pairs of the next server batch of this scanner at once, which
+        /// avoids the per-row overhead of next().
+        /// if some k-v pairs of the current batch are not got by next()/async_next() yet, only
+        /// they are returned. it should not be called concurrently with next()/async_next().
+        /// \param batch
+        /// the k-v pairs, which is never empty if PERR_OK is returned
+        /// \return
+        /// int, the error indicates whether or not the operation is succeeded.
+        /// this error can be converted to a string using get_error_string()
+        /// PERR_OK means a non-empty batch got
+        /// PERR_SCAN_COMPLETE means all k-v have been iterated before this call
+        /// otherwise some error orrured
+        ///
+        virtual int next_batch(scan_batch &batch, internal_info *info = nullptr) = 0;
+
+        ///
+        /// \brief async get the k-v pairs of the next server batch of this scanner at once
+        /// \param callback
+        /// status and batch will be passed to callback, the same as next_batch()
+        ///
+        virtual void async_next_batch(async_scan_next_batch_callback_t &&callback) = 0;
+
+        ///
+        /// \brief aggregate all the k-v pairs of this scanner on the server side
+        /// it should be called on a new scanner instead of next()/async_next(), and only once.
+        /// \param type
+        /// the aggregation to do, should not be SA_NONE
+        /// \param result
+        /// the aggregate of all the k-v pairs, the filters of the scanner are applied
+        /// \return
+        /// int, the error indicates whether or not the operation is succeeded.
+        /// this error can be converted to a string using get_error_string()
+        /// PERR_OK means all k-v pairs are aggregated
+        /// otherwise some error orrured
+        ///
+        virtual int aggregate(scan_aggregate_type type, scan_aggregate_result &result) = 0;
+
+        ///
+        /// \brief async aggregate all the k-v pairs of this scanner on the server side
+        /// \param callback
+        /// called once for each batch with status(PERR_OK) and the aggregate of the batch, then
+        /// called with status(PERR_SCAN_COMPLETE) when all k-v pairs are aggregated,
+        /// otherwise called with the error once and the aggregation stops
+        ///
+        virtual void async_aggregate(scan_aggregate_type type,
+                                     async_scan_aggregate_callback_t &&callback) = 0;
+
+        ///
+        /// \brief scan the partitions of this scanner in parallel, the k-v pairs are delivered
+        /// in batches instead of one by one.
+        /// it should be called on a new scanner instead of next()/async_next(), and only once.
+        /// \param partition_concurrency
+        /// the max number of partitions scanned at the same time
+        /// \param max_pending_batches
+        /// the max number of batches fetched or being fetched but not released yet, the scan is
+        /// paused once it's reached until some batch is released, which applies backpressure
+        /// \param callback
+        /// called with status(PERR_OK) for each batch, which contains the k-v pairs of one
+        /// partition in order, just like the batch got by next_batch(). `release` must be
+        /// called once when the batch is processed, maybe asynchronously, after which the batch
+        /// may still be kept. return false to stop the scan.
+        /// then called with status(PERR_SCAN_COMPLETE) once all the batches are released, or
+        /// with the error if some error occurred, in which case the scan stops.
+        /// the callback is never called concurrently.
+        ///
+        virtual void async_scan_batches(int partition_concurrency,
+                                        int max_pending_batches,
+                                        async_scan_batches_callback_t &&callback) = 0;
+
         virtual ~abstract_pegasus_scanner() {}
     };
 
@@ -427,6 +661,12 @@ public:
     ///     store the k-v to the cluster.
     ///     will not be blocked, return immediately.
     ///     key is composed of hashkey and sortkey.
+    ///     if [pegasus.client] write_batch_delay_ms is not 0, the writes to the same partition
+    ///     are buffered for at most that time (or until write_batch_max_bytes is reached) and
+    ///     sent together in one rpc; the callback of each write is still invoked separately.
+    ///     NOTICE: a buffered write may be applied after the writes not batched (i.e. the sync
+    ///     writes, multi_set, incr, check_and_set, etc.) on the same key issued later, so wait
+    ///     for the callback of the async write before writing the same key by them.
     /// \param hashkey
     /// used to decide which partition to put this k-v
     /// \param sortkey
@@ -497,6 +737,10 @@ public:
     ///
     /// \brief get
     ///     get value by key from the cluster.
+    ///     if [pegasus.client] hedged_read_percentile is not 0, the read is also sent to a
+    ///     secondary once the primary is slower than that percentile of the recent reads, and
+    ///     the first response is returned, which may be stale if it's from the secondary. the
+    ///     same applies to multi_get, multi_get_sortkeys, exist, ttl and sortkey_count.
     /// \param hashkey
     /// used to decide which partition to get this k-v
     /// \param sortkey
@@ -661,6 +905,52 @@ public:
                                  int max_fetch_size = 1000000,
                                  int timeout_milliseconds = 5000) = 0;
 
+    ///
+    /// \brief batch_get
+    ///     get values of a batch of keys from the cluster, the keys may belong to different
+    ///     hash keys and partitions.
+    ///     the keys are grouped by partition, and the keys of each partition are fetched by
+    ///     one rpc. the rpcs of different partitions are sent in parallel.
+    ///     if the partition count of the table is changed (e.g. by partition split), the keys
+    ///     rejected by the server are regrouped by the new partition count and retried once.
+    /// \param keys
+    /// the <hashkey,sortkey> pairs to get.
+    /// \param values
+    /// the returned <<hashkey,sortkey>,value> pairs will be put into it.
+    /// if data is not found for some <hashkey,sortkey>, then it will not appear in the map.
+    /// \param timeout_milliseconds
+    /// if wait longer than this value, will return time out error
+    /// \return
+    /// int, the error indicates whether or not the operation is succeeded.
+    /// this error can be converted to a string using get_error_string().
+    /// returns PERR_OK if fetch done, even no data is returned.
+    /// if failed on some partitions, returns the error of the first failed partition, and
+    /// the values fetched from other partitions are still returned.
+    /// the keys of one partition are bounded by the multi_get limits of the server, returns
+    /// PERR_INCOMPLETE if they are exceeded, in which case the keys should be split.
+    ///
+    virtual int batch_get(const std::vector<std::pair<std::string, std::string>> &keys,
+                          std::map<std::pair<std::string, std::string>, std::string> &values,
+                          int timeout_milliseconds = 5000) = 0;
+
+    ///
+    /// \brief asynchronous batch_get
+    ///     get values of a batch of keys from the cluster, the keys may belong to different
+    ///     hash keys and partitions.
+    ///     will not be blocked, return immediately.
+    /// \param keys
+    /// the <hashkey,sortkey> pairs to get.
+    /// \param callback
+    /// the callback function will be invoked after operation finished or error occurred.
+    /// \param timeout_milliseconds
+    /// if wait longer than this value, will return time out error
+    /// \return
+    /// void.
+    ///
+    virtual void async_batch_get(const std::vector<std::pair<std::string, std::string>> &keys,
+                                 async_batch_get_callback_t &&callback = nullptr,
+                                 int timeout_milliseconds = 5000) = 0;
+
     ///
     /// \brief multi_get_sortkeys
     ///     get multiple sort keys by hash key from the cluster.
@@ -750,6 +1040,28 @@ public:
                               int timeout_milliseconds = 5000,
                               internal_info *info = nullptr) = 0;
 
+    ///
+    /// \brief approximate_sortkey_count
+    ///     get sortkey count by hashkey from the cluster, which is estimated if the hashkey has
+    ///     too many sortkeys to be counted in time, instead of failing like sortkey_count.
+    ///     the estimation is based on the approximate data size of the hashkey in the storage,
+    ///     so it may be inaccurate especially for the hashkeys with values of various sizes.
+    ///     it's not supported by the servers older than the client.
+    /// \param hashkey
+    /// used to decide which partition to get this k-v
+    /// \param count
+    /// the returned sortkey count
+    /// \param timeout_milliseconds
+    /// if wait longer than this value, will return time out error
+    /// \return
+    /// int, the error indicates whether or not the operation is succeeded.
+    /// this error can be converted to a string using get_error_string().
+    ///
+    virtual int approximate_sortkey_count(const std::string &hashkey,
+                                          int64_t &count,
+                                          int timeout_milliseconds = 5000,
+                                          internal_info *info = nullptr) = 0;
+
     ///
     /// \brief del
     ///     del stored k-v by key from cluster
@@ -774,6 +1086,8 @@ public:
     ///     del stored k-v by key from cluster
     ///     key is composed of hashkey and sortkey. must provide both to get the value.
     ///     will not be blocked, return immediately.
+    ///     the dels are batched with the async sets if write_batch_delay_ms is not 0, see
+    ///     async_set.
     /// \param hashkey
     /// used to decide from which partition to del this k-v
     /// \param sortkey
@@ -849,6 +1163,10 @@ public:
     ///     if ttl_seconds > 0, then update with the new ttl if incr succeed.
     ///     if ttl_seconds == -1, then update to no ttl if incr succeed.
     ///
+    ///     if the table env "replica.incr_merge_enabled" is true, the old value is not read when
+    ///     writing, so PERR_OK is always returned with `new_value' as 0, and the increment is
+    ///     ignored if the old data is not an integer or the new value is out of range.
+    ///
     /// \param hashkey
     /// used to decide which partition to get this k-v
     /// \param sortkey
@@ -891,6 +1209,10 @@ public:
     ///     if ttl_seconds > 0, then update with the new ttl if incr succeed.
     ///     if ttl_seconds == -1, then update to no ttl if incr succeed.
     ///
+    ///     if the table env "replica.incr_merge_enabled" is true, the old value is not read when
+    ///     writing, so PERR_OK is always returned with `new_value' as 0, and the increment is
+    ///     ignored if the old data is not an integer or the new value is out of range.
+    ///
     /// \param hashkey
     /// used to decide which partition to get this k-v
     /// \param sortkey
@@ -1157,6 +1479,104 @@ public:
                                  const scan_options &options,
                                  async_get_unordered_scanners_callback_t &&callback) = 0;
 
+    ///
+    /// \brief future-based operations
+    ///     the same as the async operations of the same names, but return a pegasus_future of
+    ///     the result instead of taking a callback. no thread is blocked unless get() is called
+    ///     on the future, and the futures can be combined by when_all(), see future.h.
+    ///
+    pegasus_future<set_result> future_set(const std::string &hashkey,
+                                          const std::string &sortkey,
+                                          const std::string &value,
+                                          int timeout_milliseconds = 5000,
+                                          int ttl_seconds = 0)
+    {
+        pegasus_promise<set_result> promise;
+        auto future = promise.get_future();
+        async_set(hashkey,
+                  sortkey,
+                  value,
+                  [promise](int error_code, internal_info &&info) {
+                      set_result result;
+                      result.error = error_code;
+                      result.info = std::move(info);
+                      promise.set_value(std::move(result));
+                  },
+                  timeout_milliseconds,
+                  ttl_seconds);
+        return future;
+    }
+
+    pegasus_future<get_result> future_get(const std::string &hashkey,
+                                          const std::string &sortkey,
+                                          int timeout_milliseconds = 5000)
+    {
+        pegasus_promise<get_result> promise;
+        auto future = promise.get_future();
+        async_get(hashkey,
+                  sortkey,
+                  [promise](int error_code, std::string &&value, internal_info &&info) {
+                      get_result result;
+                      result.error = error_code;
+                      result.value = std::move(value);
+                      result.info = std::move(info);
+                      promise.set_value(std::move(result));
+                  },
+                  timeout_milliseconds);
+        return future;
+    }
+
+    pegasus_future<multi_get_result> future_multi_get(const std::string &hashkey,
+                                                      const std::set<std::string> &sortkeys,
+                                                      int max_fetch_count = 100,
+                                                      int max_fetch_size = 1000000,
+                                                      int timeout_milliseconds = 5000)
+    {
+        pegasus_promise<multi_get_result> promise;
+        auto future = promise.get_future();
+        async_multi_get(
+            hashkey,
+            sortkeys,
+            [promise](int error_code,
+                      std::map<std::string, std::string> &&values,
+                      internal_info &&info) {
+                multi_get_result result;
+                result.error = error_code;
+                result.values = std::move(values);
+                result.info = std::move(info);
+                promise.set_value(std::move(result));
+            },
+            max_fetch_count,
+            max_fetch_size,
+            timeout_milliseconds);
+        return future;
+    }
+
+    ///
+    /// the scanners of a completed future are owned by the caller, even if it's cancelled after
+    /// they are returned; the scanners returned after the future is cancelled are deleted.
+    ///
+    pegasus_future<get_unordered_scanners_result>
+    future_get_unordered_scanners(int max_split_count, const scan_options &options)
+    {
+        pegasus_promise<get_unordered_scanners_result> promise;
+        auto future = promise.get_future();
+        async_get_unordered_scanners(
+            max_split_count,
+            options,
+            [promise](int error_code, std::vector<pegasus_scanner *> &&scanners) {
+                get_unordered_scanners_result result;
+                result.error = error_code;
+                result.scanners = scanners;
+                if (!promise.set_value(std::move(result))) {
+                    for (auto scanner : scanners) {
+                        delete scanner;
+                    }
+                }
+            });
+        return future;
+    }
+
     ///
     /// \brief get_error_string
     /// get error string
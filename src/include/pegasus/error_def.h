@@ -49,6 +49,7 @@ PEGASUS_ERR_CODE(PERR_GEO_DECODE_VALUE_ERROR,
                  -207,
                  "decode latitude and longitude from value error");
 PEGASUS_ERR_CODE(PERR_GEO_INVALID_LATLNG_ERROR, -208, "latitude or longitude is invalid");
+PEGASUS_ERR_CODE(PERR_CANCELLED, -209, "operation is cancelled");
 
 // SERVER ERROR
 // start from -301
@@ -0,0 +1,269 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <pegasus/error.h>
+
+namespace pegasus {
+
+template <typename T>
+class pegasus_promise;
+
+namespace detail {
+
+// the state shared by a promise and its future.
+template <typename T>
+class future_state
+{
+public:
+    // returns false if the state is already completed, e.g. it's cancelled.
+    bool complete(T &&value)
+    {
+        std::function<void(T &&)> continuation;
+        std::vector<std::function<void()>> cancel_hooks;
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            if (_completed) {
+                return false;
+            }
+            _completed = true;
+            continuation = std::move(_continuation);
+            cancel_hooks.swap(_cancel_hooks);
+            if (!continuation) {
+                _value = std::move(value);
+            }
+        }
+        if (continuation) {
+            continuation(std::move(value));
+        } else {
+            _cond.notify_all();
+        }
+        return true;
+    }
+
+    void cancel()
+    {
+        std::vector<std::function<void()>> cancel_hooks;
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            if (_completed) {
+                return;
+            }
+            cancel_hooks.swap(_cancel_hooks);
+        }
+        for (auto &hook : cancel_hooks) {
+            hook();
+        }
+        T value;
+        value.error = PERR_CANCELLED;
+        complete(std::move(value));
+    }
+
+    void add_cancel_hook(std::function<void()> &&hook)
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (!_completed) {
+            _cancel_hooks.emplace_back(std::move(hook));
+        }
+    }
+
+    void then(std::function<void(T &&)> &&continuation)
+    {
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            if (!_completed) {
+                _continuation = std::move(continuation);
+                return;
+            }
+        }
+        continuation(std::move(_value));
+    }
+
+    T get()
+    {
+        std::unique_lock<std::mutex> l(_lock);
+        _cond.wait(l, [this]() { return _completed; });
+        return std::move(_value);
+    }
+
+    bool ready()
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        return _completed;
+    }
+
+private:
+    std::mutex _lock;
+    std::condition_variable _cond;
+    bool _completed = false;
+    T _value;
+    std::function<void(T &&)> _continuation;
+    std::vector<std::function<void()>> _cancel_hooks;
+};
+
+} // namespace detail
+
+///
+/// \brief pegasus_future
+/// the result of an asynchronous operation, which is completed by the rpc callback instead of
+/// parking a thread on the operation.
+/// T must be default constructible and has an `int error` member, which is set to
+/// PERR_CANCELLED if the future is cancelled before the operation is completed.
+/// the result should be consumed only once, by either then() or get().
+/// a default constructed future is not valid(), which is never ready() and can't be consumed.
+///
+template <typename T>
+class pegasus_future
+{
+public:
+    pegasus_future() = default;
+
+    bool valid() const { return _state != nullptr; }
+
+    bool ready() const { return valid() && _state->ready(); }
+
+    ///
+    /// \brief register the continuation, which is called with the result once the operation is
+    /// completed, or called immediately if it's already completed.
+    /// the continuation is usually called in the rpc callback thread, so it should not block.
+    ///
+    void then(std::function<void(T && /*result*/)> &&continuation)
+    {
+        assert(valid());
+        _state->then(std::move(continuation));
+    }
+
+    ///
+    /// \brief wait until the operation is completed and return the result.
+    ///
+    T get()
+    {
+        assert(valid());
+        return _state->get();
+    }
+
+    ///
+    /// \brief complete the future with PERR_CANCELLED if it's not completed yet, the result of
+    /// the operation is dropped when it arrives.
+    /// note that a cancelled write may still be applied by the server.
+    ///
+    void cancel()
+    {
+        if (valid()) {
+            _state->cancel();
+        }
+    }
+
+private:
+    friend class pegasus_promise<T>;
+
+    explicit pegasus_future(std::shared_ptr<detail::future_state<T>> state)
+        : _state(std::move(state))
+    {
+    }
+
+    std::shared_ptr<detail::future_state<T>> _state;
+};
+
+///
+/// \brief pegasus_promise
+/// the producer side of a pegasus_future, which is copied into the rpc callback.
+///
+template <typename T>
+class pegasus_promise
+{
+public:
+    pegasus_promise() : _state(std::make_shared<detail::future_state<T>>()) {}
+
+    pegasus_future<T> get_future() const { return pegasus_future<T>(_state); }
+
+    // returns false if the future is already completed, e.g. it's cancelled.
+    bool set_value(T &&value) const { return _state->complete(std::move(value)); }
+
+    // the hook is called when the future is cancelled before it's completed.
+    void on_cancel(std::function<void()> &&hook) const { _state->add_cancel_hook(std::move(hook)); }
+
+private:
+    std::shared_ptr<detail::future_state<T>> _state;
+};
+
+template <typename T>
+struct when_all_result
+{
+    // the first error of the results which is not PERR_OK, or PERR_OK
+    int error = PERR_OK;
+    // the results in the order of the futures
+    std::vector<T> results;
+};
+
+///
+/// \brief when_all
+/// aggregate the futures into one, which is completed once all of them are completed.
+/// cancelling the aggregated future cancels all the futures which are not completed yet.
+///
+template <typename T>
+pegasus_future<when_all_result<T>> when_all(std::vector<pegasus_future<T>> &&futures)
+{
+    struct when_all_context
+    {
+        std::mutex lock;
+        size_t pending_count = 0;
+        when_all_result<T> result;
+        pegasus_promise<when_all_result<T>> promise;
+    };
+
+    auto context = std::make_shared<when_all_context>();
+    auto future = context->promise.get_future();
+    if (futures.empty()) {
+        context->promise.set_value(std::move(context->result));
+        return future;
+    }
+
+    context->pending_count = futures.size();
+    context->result.results.resize(futures.size());
+    for (auto &f : futures) {
+        context->promise.on_cancel([f]() mutable { f.cancel(); });
+    }
+    for (size_t i = 0; i < futures.size(); ++i) {
+        futures[i].then([context, i](T &&result) {
+            bool done = false;
+            {
+                std::lock_guard<std::mutex> l(context->lock);
+                if (result.error != PERR_OK && context->result.error == PERR_OK) {
+                    context->result.error = result.error;
+                }
+                context->result.results[i] = std::move(result);
+                done = (--context->pending_count == 0);
+            }
+            if (done) {
+                context->promise.set_value(std::move(context->result));
+            }
+        });
+    }
+    return future;
+}
+
+} // namespace pegasus
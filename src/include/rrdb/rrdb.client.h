@@ -247,6 +247,37 @@ public:
                                   reply_thread_hash);
     }
 
+    // ---------- call RPC_RRDB_RRDB_BATCH_WRITE ------------
+    // - synchronous
+    std::pair<::dsn::error_code, update_response> batch_write_sync(
+        const batch_write_request &args, std::chrono::milliseconds timeout, uint64_t partition_hash)
+    {
+        return ::dsn::rpc::wait_and_unwrap<update_response>(
+            _resolver->call_op(RPC_RRDB_RRDB_BATCH_WRITE,
+                               args,
+                               &_tracker,
+                               empty_rpc_handler,
+                               timeout,
+                               partition_hash));
+    }
+
+    // - asynchronous with on-stack batch_write_request and update_response
+    template <typename TCallback>
+    ::dsn::task_ptr batch_write(const batch_write_request &args,
+                                TCallback &&callback,
+                                std::chrono::milliseconds timeout,
+                                uint64_t request_partition_hash,
+                                int reply_thread_hash = 0)
+    {
+        return _resolver->call_op(RPC_RRDB_RRDB_BATCH_WRITE,
+                                  args,
+                                  &_tracker,
+                                  std::forward<TCallback>(callback),
+                                  timeout,
+                                  request_partition_hash,
+                                  reply_thread_hash);
+    }
+
     // ---------- call RPC_RRDB_RRDB_GET ------------
     // - synchronous
     std::pair<::dsn::error_code, read_response>
@@ -299,6 +330,32 @@ public:
                                   reply_thread_hash);
     }
 
+    // ---------- call RPC_RRDB_RRDB_BATCH_GET ------------
+    // - synchronous
+    std::pair<::dsn::error_code, batch_get_response> batch_get_sync(
+        const batch_get_request &args, std::chrono::milliseconds timeout, uint64_t partition_hash)
+    {
+        return ::dsn::rpc::wait_and_unwrap<batch_get_response>(_resolver->call_op(
+            RPC_RRDB_RRDB_BATCH_GET, args, &_tracker, empty_rpc_handler, timeout, partition_hash));
+    }
+
+    // - asynchronous with on-stack batch_get_request and batch_get_response
+    template <typename TCallback>
+    ::dsn::task_ptr batch_get(const batch_get_request &args,
+                              TCallback &&callback,
+                              std::chrono::milliseconds timeout,
+                              uint64_t request_partition_hash,
+                              int reply_thread_hash = 0)
+    {
+        return _resolver->call_op(RPC_RRDB_RRDB_BATCH_GET,
+                                  args,
+                                  &_tracker,
+                                  std::forward<TCallback>(callback),
+                                  timeout,
+                                  request_partition_hash,
+                                  reply_thread_hash);
+    }
+
     // ---------- call RPC_RRDB_RRDB_SORTKEY_COUNT ------------
     // - synchronous
     std::pair<::dsn::error_code, count_response> sortkey_count_sync(
@@ -330,6 +387,39 @@ public:
                                   reply_thread_hash);
     }
 
+    // ---------- call RPC_RRDB_RRDB_SORTKEY_COUNT_V2 ------------
+    // - synchronous
+    std::pair<::dsn::error_code, count_response>
+    sortkey_count_v2_sync(const sortkey_count_request &args,
+                          std::chrono::milliseconds timeout,
+                          uint64_t partition_hash)
+    {
+        return ::dsn::rpc::wait_and_unwrap<count_response>(
+            _resolver->call_op(RPC_RRDB_RRDB_SORTKEY_COUNT_V2,
+                               args,
+                               &_tracker,
+                               empty_rpc_handler,
+                               timeout,
+                               partition_hash));
+    }
+
+    // - asynchronous with on-stack sortkey_count_request and count_response
+    template <typename TCallback>
+    ::dsn::task_ptr sortkey_count_v2(const sortkey_count_request &args,
+                                     TCallback &&callback,
+                                     std::chrono::milliseconds timeout,
+                                     uint64_t request_partition_hash,
+                                     int reply_thread_hash = 0)
+    {
+        return _resolver->call_op(RPC_RRDB_RRDB_SORTKEY_COUNT_V2,
+                                  args,
+                                  &_tracker,
+                                  std::forward<TCallback>(callback),
+                                  timeout,
+                                  request_partition_hash,
+                                  reply_thread_hash);
+    }
+
     // ---------- call RPC_RRDB_RRDB_TTL ------------
     // - synchronous
     std::pair<::dsn::error_code, ttl_response>
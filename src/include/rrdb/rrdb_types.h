@@ -27,7 +27,9 @@ struct filter_type
         FT_NO_FILTER = 0,
         FT_MATCH_ANYWHERE = 1,
         FT_MATCH_PREFIX = 2,
-        FT_MATCH_POSTFIX = 3
+        FT_MATCH_POSTFIX = 3,
+        FT_MATCH_REGEX = 5,
+        FT_MATCH_MULTI_PATTERN = 6
     };
 };
 
@@ -71,6 +73,18 @@ struct mutate_operation
 
 extern const std::map<int, const char *> _mutate_operation_VALUES_TO_NAMES;
 
+struct scan_aggregate_type
+{
+    enum type
+    {
+        SA_NONE = 0,
+        SA_COUNT = 1,
+        SA_INT_STATS = 2
+    };
+};
+
+extern const std::map<int, const char *> _scan_aggregate_type_VALUES_TO_NAMES;
+
 class update_request;
 
 class update_response;
@@ -107,6 +121,8 @@ class check_and_mutate_request;
 
 class check_and_mutate_response;
 
+class scan_aggregate_result;
+
 class get_scanner_request;
 
 class scan_request;
@@ -117,6 +133,20 @@ class duplicate_request;
 
 class duplicate_response;
 
+class full_key;
+
+class batch_get_request;
+
+class full_data;
+
+class batch_get_response;
+
+class sortkey_count_request;
+
+class batch_write_operation;
+
+class batch_write_request;
+
 typedef struct _update_request__isset
 {
     _update_request__isset() : key(false), value(false), expire_ts_seconds(false) {}
@@ -867,7 +897,12 @@ inline std::ostream &operator<<(std::ostream &out, const multi_get_request &obj)
 typedef struct _multi_get_response__isset
 {
     _multi_get_response__isset()
-        : error(false), kvs(false), app_id(false), partition_index(false), server(false)
+        : error(false),
+          kvs(false),
+          app_id(false),
+          partition_index(false),
+          server(false),
+          last_sortkey(false)
     {
     }
     bool error : 1;
@@ -875,6 +910,7 @@ typedef struct _multi_get_response__isset
     bool app_id : 1;
     bool partition_index : 1;
     bool server : 1;
+    bool last_sortkey : 1;
 } _multi_get_response__isset;
 
 class multi_get_response
@@ -892,6 +928,7 @@ public:
     int32_t app_id;
     int32_t partition_index;
     std::string server;
+    ::dsn::blob last_sortkey;
 
     _multi_get_response__isset __isset;
 
@@ -905,6 +942,8 @@ public:
 
     void __set_server(const std::string &val);
 
+    void __set_last_sortkey(const ::dsn::blob &val);
+
     bool operator==(const multi_get_response &rhs) const
     {
         if (!(error == rhs.error))
@@ -917,6 +956,10 @@ public:
             return false;
         if (!(server == rhs.server))
             return false;
+        if (__isset.last_sortkey != rhs.__isset.last_sortkey)
+            return false;
+        else if (__isset.last_sortkey && !(last_sortkey == rhs.last_sortkey))
+            return false;
         return true;
     }
     bool operator!=(const multi_get_response &rhs) const { return !(*this == rhs); }
@@ -1554,6 +1597,106 @@ inline std::ostream &operator<<(std::ostream &out, const check_and_mutate_respon
     return out;
 }
 
+typedef struct _scan_aggregate_result__isset
+{
+    _scan_aggregate_result__isset()
+        : row_count(false),
+          key_bytes(false),
+          value_bytes(false),
+          int_count(false),
+          int_sum(false),
+          int_min(false),
+          int_max(false)
+    {
+    }
+    bool row_count : 1;
+    bool key_bytes : 1;
+    bool value_bytes : 1;
+    bool int_count : 1;
+    bool int_sum : 1;
+    bool int_min : 1;
+    bool int_max : 1;
+} _scan_aggregate_result__isset;
+
+class scan_aggregate_result
+{
+public:
+    scan_aggregate_result(const scan_aggregate_result &);
+    scan_aggregate_result(scan_aggregate_result &&);
+    scan_aggregate_result &operator=(const scan_aggregate_result &);
+    scan_aggregate_result &operator=(scan_aggregate_result &&);
+    scan_aggregate_result()
+        : row_count(0),
+          key_bytes(0),
+          value_bytes(0),
+          int_count(0),
+          int_sum(0),
+          int_min(0),
+          int_max(0)
+    {
+    }
+
+    virtual ~scan_aggregate_result() throw();
+    int64_t row_count;
+    int64_t key_bytes;
+    int64_t value_bytes;
+    int64_t int_count;
+    int64_t int_sum;
+    int64_t int_min;
+    int64_t int_max;
+
+    _scan_aggregate_result__isset __isset;
+
+    void __set_row_count(const int64_t val);
+
+    void __set_key_bytes(const int64_t val);
+
+    void __set_value_bytes(const int64_t val);
+
+    void __set_int_count(const int64_t val);
+
+    void __set_int_sum(const int64_t val);
+
+    void __set_int_min(const int64_t val);
+
+    void __set_int_max(const int64_t val);
+
+    bool operator==(const scan_aggregate_result &rhs) const
+    {
+        if (!(row_count == rhs.row_count))
+            return false;
+        if (!(key_bytes == rhs.key_bytes))
+            return false;
+        if (!(value_bytes == rhs.value_bytes))
+            return false;
+        if (!(int_count == rhs.int_count))
+            return false;
+        if (!(int_sum == rhs.int_sum))
+            return false;
+        if (!(int_min == rhs.int_min))
+            return false;
+        if (!(int_max == rhs.int_max))
+            return false;
+        return true;
+    }
+    bool operator!=(const scan_aggregate_result &rhs) const { return !(*this == rhs); }
+
+    bool operator<(const scan_aggregate_result &) const;
+
+    uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
+    uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
+
+    virtual void printTo(std::ostream &out) const;
+};
+
+void swap(scan_aggregate_result &a, scan_aggregate_result &b);
+
+inline std::ostream &operator<<(std::ostream &out, const scan_aggregate_result &obj)
+{
+    obj.printTo(out);
+    return out;
+}
+
 typedef struct _get_scanner_request__isset
 {
     _get_scanner_request__isset()
@@ -1568,7 +1711,8 @@ typedef struct _get_scanner_request__isset
           sort_key_filter_type(false),
           sort_key_filter_pattern(false),
           validate_partition_hash(false),
-          return_expire_ts(false)
+          return_expire_ts(false),
+          aggregate_type(false)
     {
     }
     bool start_key : 1;
@@ -1583,6 +1727,7 @@ typedef struct _get_scanner_request__isset
     bool sort_key_filter_pattern : 1;
     bool validate_partition_hash : 1;
     bool return_expire_ts : 1;
+    bool aggregate_type : 1;
 } _get_scanner_request__isset;
 
 class get_scanner_request
@@ -1600,7 +1745,8 @@ public:
           hash_key_filter_type((filter_type::type)0),
           sort_key_filter_type((filter_type::type)0),
           validate_partition_hash(0),
-          return_expire_ts(0)
+          return_expire_ts(0),
+          aggregate_type((scan_aggregate_type::type)0)
     {
     }
 
@@ -1617,6 +1763,7 @@ public:
     ::dsn::blob sort_key_filter_pattern;
     bool validate_partition_hash;
     bool return_expire_ts;
+    scan_aggregate_type::type aggregate_type;
 
     _get_scanner_request__isset __isset;
 
@@ -1644,6 +1791,8 @@ public:
 
     void __set_return_expire_ts(const bool val);
 
+    void __set_aggregate_type(const scan_aggregate_type::type val);
+
     bool operator==(const get_scanner_request &rhs) const
     {
         if (!(start_key == rhs.start_key))
@@ -1675,6 +1824,10 @@ public:
             return false;
         else if (__isset.return_expire_ts && !(return_expire_ts == rhs.return_expire_ts))
             return false;
+        if (__isset.aggregate_type != rhs.__isset.aggregate_type)
+            return false;
+        else if (__isset.aggregate_type && !(aggregate_type == rhs.aggregate_type))
+            return false;
         return true;
     }
     bool operator!=(const get_scanner_request &rhs) const { return !(*this == rhs); }
@@ -1749,7 +1902,8 @@ typedef struct _scan_response__isset
           context_id(false),
           app_id(false),
           partition_index(false),
-          server(false)
+          server(false),
+          aggregate(false)
     {
     }
     bool error : 1;
@@ -1758,6 +1912,7 @@ typedef struct _scan_response__isset
     bool app_id : 1;
     bool partition_index : 1;
     bool server : 1;
+    bool aggregate : 1;
 } _scan_response__isset;
 
 class scan_response
@@ -1776,6 +1931,7 @@ public:
     int32_t app_id;
     int32_t partition_index;
     std::string server;
+    scan_aggregate_result aggregate;
 
     _scan_response__isset __isset;
 
@@ -1791,6 +1947,8 @@ public:
 
     void __set_server(const std::string &val);
 
+    void __set_aggregate(const scan_aggregate_result &val);
+
     bool operator==(const scan_response &rhs) const
     {
         if (!(error == rhs.error))
@@ -1805,6 +1963,10 @@ public:
             return false;
         if (!(server == rhs.server))
             return false;
+        if (__isset.aggregate != rhs.__isset.aggregate)
+            return false;
+        else if (__isset.aggregate && !(aggregate == rhs.aggregate))
+            return false;
         return true;
     }
     bool operator!=(const scan_response &rhs) const { return !(*this == rhs); }
@@ -1967,6 +2129,399 @@ inline std::ostream &operator<<(std::ostream &out, const duplicate_response &obj
     obj.printTo(out);
     return out;
 }
+typedef struct _full_key__isset
+{
+    _full_key__isset() : hash_key(false), sort_key(false) {}
+    bool hash_key : 1;
+    bool sort_key : 1;
+} _full_key__isset;
+
+class full_key
+{
+public:
+    full_key(const full_key &);
+    full_key(full_key &&);
+    full_key &operator=(const full_key &);
+    full_key &operator=(full_key &&);
+    full_key() {}
+
+    virtual ~full_key() throw();
+    ::dsn::blob hash_key;
+    ::dsn::blob sort_key;
+
+    _full_key__isset __isset;
+
+    void __set_hash_key(const ::dsn::blob &val);
+
+    void __set_sort_key(const ::dsn::blob &val);
+
+    bool operator==(const full_key &rhs) const
+    {
+        if (!(hash_key == rhs.hash_key))
+            return false;
+        if (!(sort_key == rhs.sort_key))
+            return false;
+        return true;
+    }
+    bool operator!=(const full_key &rhs) const { return !(*this == rhs); }
+
+    bool operator<(const full_key &) const;
+
+    uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
+    uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
+
+    virtual void printTo(std::ostream &out) const;
+};
+
+void swap(full_key &a, full_key &b);
+
+inline std::ostream &operator<<(std::ostream &out, const full_key &obj)
+{
+    obj.printTo(out);
+    return out;
+}
+
+typedef struct _batch_get_request__isset
+{
+    _batch_get_request__isset() : keys(false) {}
+    bool keys : 1;
+} _batch_get_request__isset;
+
+class batch_get_request
+{
+public:
+    batch_get_request(const batch_get_request &);
+    batch_get_request(batch_get_request &&);
+    batch_get_request &operator=(const batch_get_request &);
+    batch_get_request &operator=(batch_get_request &&);
+    batch_get_request() {}
+
+    virtual ~batch_get_request() throw();
+    std::vector<full_key> keys;
+
+    _batch_get_request__isset __isset;
+
+    void __set_keys(const std::vector<full_key> &val);
+
+    bool operator==(const batch_get_request &rhs) const
+    {
+        if (!(keys == rhs.keys))
+            return false;
+        return true;
+    }
+    bool operator!=(const batch_get_request &rhs) const { return !(*this == rhs); }
+
+    bool operator<(const batch_get_request &) const;
+
+    uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
+    uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
+
+    virtual void printTo(std::ostream &out) const;
+};
+
+void swap(batch_get_request &a, batch_get_request &b);
+
+inline std::ostream &operator<<(std::ostream &out, const batch_get_request &obj)
+{
+    obj.printTo(out);
+    return out;
+}
+
+typedef struct _full_data__isset
+{
+    _full_data__isset() : hash_key(false), sort_key(false), value(false) {}
+    bool hash_key : 1;
+    bool sort_key : 1;
+    bool value : 1;
+} _full_data__isset;
+
+class full_data
+{
+public:
+    full_data(const full_data &);
+    full_data(full_data &&);
+    full_data &operator=(const full_data &);
+    full_data &operator=(full_data &&);
+    full_data() {}
+
+    virtual ~full_data() throw();
+    ::dsn::blob hash_key;
+    ::dsn::blob sort_key;
+    ::dsn::blob value;
+
+    _full_data__isset __isset;
+
+    void __set_hash_key(const ::dsn::blob &val);
+
+    void __set_sort_key(const ::dsn::blob &val);
+
+    void __set_value(const ::dsn::blob &val);
+
+    bool operator==(const full_data &rhs) const
+    {
+        if (!(hash_key == rhs.hash_key))
+            return false;
+        if (!(sort_key == rhs.sort_key))
+            return false;
+        if (!(value == rhs.value))
+            return false;
+        return true;
+    }
+    bool operator!=(const full_data &rhs) const { return !(*this == rhs); }
+
+    bool operator<(const full_data &) const;
+
+    uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
+    uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
+
+    virtual void printTo(std::ostream &out) const;
+};
+
+void swap(full_data &a, full_data &b);
+
+inline std::ostream &operator<<(std::ostream &out, const full_data &obj)
+{
+    obj.printTo(out);
+    return out;
+}
+
+typedef struct _batch_get_response__isset
+{
+    _batch_get_response__isset()
+        : error(false), data(false), app_id(false), partition_index(false), server(false)
+    {
+    }
+    bool error : 1;
+    bool data : 1;
+    bool app_id : 1;
+    bool partition_index : 1;
+    bool server : 1;
+} _batch_get_response__isset;
+
+class batch_get_response
+{
+public:
+    batch_get_response(const batch_get_response &);
+    batch_get_response(batch_get_response &&);
+    batch_get_response &operator=(const batch_get_response &);
+    batch_get_response &operator=(batch_get_response &&);
+    batch_get_response() : error(0), app_id(0), partition_index(0), server() {}
+
+    virtual ~batch_get_response() throw();
+    int32_t error;
+    std::vector<full_data> data;
+    int32_t app_id;
+    int32_t partition_index;
+    std::string server;
+
+    _batch_get_response__isset __isset;
+
+    void __set_error(const int32_t val);
+
+    void __set_data(const std::vector<full_data> &val);
+
+    void __set_app_id(const int32_t val);
+
+    void __set_partition_index(const int32_t val);
+
+    void __set_server(const std::string &val);
+
+    bool operator==(const batch_get_response &rhs) const
+    {
+        if (!(error == rhs.error))
+            return false;
+        if (!(data == rhs.data))
+            return false;
+        if (!(app_id == rhs.app_id))
+            return false;
+        if (!(partition_index == rhs.partition_index))
+            return false;
+        if (!(server == rhs.server))
+            return false;
+        return true;
+    }
+    bool operator!=(const batch_get_response &rhs) const { return !(*this == rhs); }
+
+    bool operator<(const batch_get_response &) const;
+
+    uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
+    uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
+
+    virtual void printTo(std::ostream &out) const;
+};
+
+void swap(batch_get_response &a, batch_get_response &b);
+
+inline std::ostream &operator<<(std::ostream &out, const batch_get_response &obj)
+{
+    obj.printTo(out);
+    return out;
+}
+
+typedef struct _sortkey_count_request__isset
+{
+    _sortkey_count_request__isset() : hash_key(false), approximate(false) {}
+    bool hash_key : 1;
+    bool approximate : 1;
+} _sortkey_count_request__isset;
+
+class sortkey_count_request
+{
+public:
+    sortkey_count_request(const sortkey_count_request &);
+    sortkey_count_request(sortkey_count_request &&);
+    sortkey_count_request &operator=(const sortkey_count_request &);
+    sortkey_count_request &operator=(sortkey_count_request &&);
+    sortkey_count_request() : approximate(false) {}
+
+    virtual ~sortkey_count_request() throw();
+    ::dsn::blob hash_key;
+    bool approximate;
+
+    _sortkey_count_request__isset __isset;
+
+    void __set_hash_key(const ::dsn::blob &val);
+
+    void __set_approximate(const bool val);
+
+    bool operator==(const sortkey_count_request &rhs) const
+    {
+        if (!(hash_key == rhs.hash_key))
+            return false;
+        if (!(approximate == rhs.approximate))
+            return false;
+        return true;
+    }
+    bool operator!=(const sortkey_count_request &rhs) const { return !(*this == rhs); }
+
+    bool operator<(const sortkey_count_request &) const;
+
+    uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
+    uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
+
+    virtual void printTo(std::ostream &out) const;
+};
+
+void swap(sortkey_count_request &a, sortkey_count_request &b);
+
+inline std::ostream &operator<<(std::ostream &out, const sortkey_count_request &obj)
+{
+    obj.printTo(out);
+    return out;
+}
+
+typedef struct _batch_write_operation__isset
+{
+    _batch_write_operation__isset()
+        : operation(false), key(false), value(false), expire_ts_seconds(false)
+    {
+    }
+    bool operation : 1;
+    bool key : 1;
+    bool value : 1;
+    bool expire_ts_seconds : 1;
+} _batch_write_operation__isset;
+
+class batch_write_operation
+{
+public:
+    batch_write_operation(const batch_write_operation &);
+    batch_write_operation(batch_write_operation &&);
+    batch_write_operation &operator=(const batch_write_operation &);
+    batch_write_operation &operator=(batch_write_operation &&);
+    batch_write_operation() : operation((mutate_operation::type)0), expire_ts_seconds(0) {}
+
+    virtual ~batch_write_operation() throw();
+    mutate_operation::type operation;
+    ::dsn::blob key;
+    ::dsn::blob value;
+    int32_t expire_ts_seconds;
+
+    _batch_write_operation__isset __isset;
+
+    void __set_operation(const mutate_operation::type val);
+
+    void __set_key(const ::dsn::blob &val);
+
+    void __set_value(const ::dsn::blob &val);
+
+    void __set_expire_ts_seconds(const int32_t val);
+
+    bool operator==(const batch_write_operation &rhs) const
+    {
+        if (!(operation == rhs.operation))
+            return false;
+        if (!(key == rhs.key))
+            return false;
+        if (!(value == rhs.value))
+            return false;
+        if (!(expire_ts_seconds == rhs.expire_ts_seconds))
+            return false;
+        return true;
+    }
+    bool operator!=(const batch_write_operation &rhs) const { return !(*this == rhs); }
+
+    bool operator<(const batch_write_operation &) const;
+
+    uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
+    uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
+
+    virtual void printTo(std::ostream &out) const;
+};
+
+void swap(batch_write_operation &a, batch_write_operation &b);
+
+inline std::ostream &operator<<(std::ostream &out, const batch_write_operation &obj)
+{
+    obj.printTo(out);
+    return out;
+}
+
+typedef struct _batch_write_request__isset
+{
+    _batch_write_request__isset() : operations(false) {}
+    bool operations : 1;
+} _batch_write_request__isset;
+
+class batch_write_request
+{
+public:
+    batch_write_request(const batch_write_request &);
+    batch_write_request(batch_write_request &&);
+    batch_write_request &operator=(const batch_write_request &);
+    batch_write_request &operator=(batch_write_request &&);
+    batch_write_request() {}
+
+    virtual ~batch_write_request() throw();
+    std::vector<batch_write_operation> operations;
+
+    _batch_write_request__isset __isset;
+
+    void __set_operations(const std::vector<batch_write_operation> &val);
+
+    bool operator==(const batch_write_request &rhs) const
+    {
+        if (!(operations == rhs.operations))
+            return false;
+        return true;
+    }
+    bool operator!=(const batch_write_request &rhs) const { return !(*this == rhs); }
+
+    bool operator<(const batch_write_request &) const;
+
+    uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
+    uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
+
+    virtual void printTo(std::ostream &out) const;
+};
+
+void swap(batch_write_request &a, batch_write_request &b);
+
+inline std::ostream &operator<<(std::ostream &out, const batch_write_request &obj)
+{
+    obj.printTo(out);
+    return out;
+}
 }
 } // namespace
 
@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <dsn/service_api_cpp.h>
+
+#include "proxy_bench.h"
+
+using namespace pegasus::proxy::bench;
+
+static const std::map<std::string, std::function<int(int, char **)>> s_cases = {
+    {"parse", parse_bench},
+    {"reply", reply_bench},
+};
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || s_cases.find(argv[1]) == s_cases.end()) {
+        std::cerr << "USAGE: " << argv[0] << " <case> [args...]" << std::endl;
+        std::cerr << "cases:" << std::endl;
+        for (const auto &kv : s_cases) {
+            std::cerr << "  " << kv.first << std::endl;
+        }
+        return -1;
+    }
+
+    // the messages and the parser need the runtime of rDSN.
+    dsn_run_config("config.ini", false);
+    int ret = s_cases.at(argv[1])(argc - 1, argv + 1);
+    dsn_exit(ret);
+}
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "redis_parser.h"
+
+namespace pegasus {
+namespace proxy {
+namespace bench {
+
+// A redis parser which only counts the parsed commands and the sent responses, instead of
+// executing and sending them.
+class redis_bench_parser : public redis_parser
+{
+public:
+    explicit redis_bench_parser(dsn::message_ex *first_msg) : redis_parser(nullptr, first_msg)
+    {
+    }
+
+    bool parse_message(dsn::message_ex *msg) { return parse(msg); }
+
+    // reply the commands of a pipeline in the reverse order, i.e. the first command is replied at
+    // last, like it's the slowest one.
+    void reply_pipeline(int depth)
+    {
+        std::vector<message_entry *> entries;
+        for (int i = 0; i < depth; ++i) {
+            std::unique_ptr<message_entry> entry(new message_entry());
+            entries.push_back(entry.get());
+            enqueue_pending_response(std::move(entry));
+        }
+        for (int i = depth - 1; i >= 0; --i) {
+            reply_message(*entries[i], redis_bulk_string(std::string(16, 'v')));
+        }
+    }
+
+    int64_t command_count{0};
+    int64_t response_count{0};
+
+protected:
+    void handle_command(std::unique_ptr<message_entry> &&entry) override { ++command_count; }
+
+    void send_response(dsn::message_ex *resp) override { ++response_count; }
+};
+
+// each benchmark case returns 0 if succeed.
+int parse_bench(int argc, char **argv);
+int reply_bench(int argc, char **argv);
+
+} // namespace bench
+} // namespace proxy
+} // namespace pegasus
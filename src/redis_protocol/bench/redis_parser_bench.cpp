@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dsn/utility/string_conv.h>
+
+#include "proxy_bench.h"
+
+namespace pegasus {
+namespace proxy {
+namespace bench {
+
+// split `data` into messages of `message_size` bytes, each of which owns its buffer like the
+// messages received from network. a reference of each message is held by the caller.
+static std::vector<dsn::message_ex *> create_messages(const std::string &data, size_t message_size)
+{
+    std::vector<dsn::message_ex *> msgs;
+    for (size_t offset = 0; offset < data.length(); offset += message_size) {
+        dsn::blob body = dsn::blob::create_from_bytes(data.substr(offset, message_size));
+        dsn::message_ex *msg = dsn::message_ex::create_receive_message_with_standalone_header(body);
+        msg->add_ref();
+        msgs.push_back(msg);
+    }
+    return msgs;
+}
+
+static bool bench_parse(const std::string &name,
+                        const std::string &command,
+                        int command_count,
+                        size_t message_size)
+{
+    std::string data;
+    data.reserve(command.length() * command_count);
+    for (int i = 0; i < command_count; ++i) {
+        data.append(command);
+    }
+    std::vector<dsn::message_ex *> msgs = create_messages(data, message_size);
+
+    dsn::message_ex *first_msg = dsn::message_ex::create_received_request(
+        RPC_CALL_RAW_MESSAGE, dsn::DSF_THRIFT_BINARY, nullptr, 0);
+    first_msg->header->from_address = dsn::rpc_address("127.0.0.1", 123);
+    first_msg->add_ref();
+    auto parser = std::make_shared<redis_bench_parser>(first_msg);
+
+    bool succeed = true;
+    auto start = std::chrono::steady_clock::now();
+    for (dsn::message_ex *msg : msgs) {
+        if (succeed && !parser->parse_message(msg)) {
+            std::cerr << name << ": parse failed" << std::endl;
+            succeed = false;
+        }
+    }
+    auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+    parser.reset();
+    for (dsn::message_ex *msg : msgs) {
+        msg->release_ref();
+    }
+    first_msg->release_ref();
+    if (!succeed) {
+        return false;
+    }
+
+    std::cout << name << ": " << command_count << " commands, " << data.length() << " bytes, "
+              << duration_ns / command_count << " ns/command, "
+              << data.length() * 1000.0 / duration_ns << " MB/s" << std::endl;
+    return true;
+}
+
+// parses pipelined redis requests split into messages of different sizes.
+// USAGE: parse [command_count]
+int parse_bench(int argc, char **argv)
+{
+    int command_count = 100000;
+    if (argc > 1 && !dsn::buf2int32(argv[1], command_count)) {
+        std::cerr << "USAGE: parse [command_count]" << std::endl;
+        return -1;
+    }
+
+    const std::string small_value(100, 'v');
+    const std::string small_set = "*3\r\n$3\r\nSET\r\n$16\r\nkey_0123456789ab\r\n$" +
+                                  std::to_string(small_value.length()) + "\r\n" + small_value +
+                                  "\r\n";
+    const std::string get = "*2\r\n$3\r\nGET\r\n$16\r\nkey_0123456789ab\r\n";
+    const std::string large_value(64 * 1024, 'v');
+    const std::string large_set = "*3\r\n$3\r\nSET\r\n$3\r\nkey\r\n$" +
+                                  std::to_string(large_value.length()) + "\r\n" + large_value +
+                                  "\r\n";
+
+    bool succeed = bench_parse("small SET, 16KB messages", small_set, command_count, 16 * 1024) &&
+                   bench_parse("small SET, 1KB messages", small_set, command_count, 1024) &&
+                   bench_parse("GET, 16KB messages", get, command_count, 16 * 1024) &&
+                   bench_parse("64KB SET, 16KB messages",
+                               large_set,
+                               std::max(1, command_count / 100),
+                               16 * 1024);
+    return succeed ? 0 : -1;
+}
+
+} // namespace bench
+} // namespace proxy
+} // namespace pegasus
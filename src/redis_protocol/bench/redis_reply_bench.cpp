@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+#include <dsn/utility/string_conv.h>
+
+#include "proxy_bench.h"
+
+namespace pegasus {
+namespace proxy {
+namespace bench {
+
+// replies pipelined redis requests out of order, and reports how many replies are coalesced
+// into one response at different pipeline depths.
+// USAGE: reply [reply_count]
+int reply_bench(int argc, char **argv)
+{
+    int reply_count = 100000;
+    if (argc > 1 && !dsn::buf2int32(argv[1], reply_count)) {
+        std::cerr << "USAGE: reply [reply_count]" << std::endl;
+        return -1;
+    }
+
+    for (int depth : {1, 16, 128}) {
+        dsn::message_ex *first_msg = dsn::message_ex::create_received_request(
+            RPC_CALL_RAW_MESSAGE, dsn::DSF_THRIFT_BINARY, nullptr, 0);
+        first_msg->header->from_address = dsn::rpc_address("127.0.0.1", 123);
+        first_msg->add_ref();
+        auto parser = std::make_shared<redis_bench_parser>(first_msg);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < reply_count; i += depth) {
+            parser->reply_pipeline(depth);
+        }
+        auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+
+        std::cout << "pipeline depth " << depth << ": " << reply_count << " replies, "
+                  << parser->response_count << " responses, " << duration_ns / reply_count
+                  << " ns/reply" << std::endl;
+        parser.reset();
+        first_msg->release_ref();
+    }
+    return 0;
+}
+
+} // namespace bench
+} // namespace proxy
+} // namespace pegasus
@@ -20,6 +20,7 @@
 #include <dsn/tool-api/task_spec.h>
 
 #include <rrdb/rrdb.code.definition.h>
+#include <pegasus/client.h>
 #include "proxy_layer.h"
 
 namespace pegasus {
@@ -35,6 +36,11 @@ proxy_stub::proxy_stub(const proxy_session::factory &f,
       _app(app),
       _geo_app(geo_app)
 {
+    // the client factory is initialized only once when the proxy starts, instead of by the
+    // sessions.
+    pegasus_client_factory::initialize(nullptr);
+    _pegasus_client = pegasus_client_factory::get_client(cluster, app);
+
     dsn::task_spec::get(RPC_CALL_RAW_MESSAGE)->allow_inline = true;
     dsn::task_spec::get(RPC_CALL_RAW_SESSION_DISCONNECT)->allow_inline = true;
 
@@ -51,6 +57,17 @@ proxy_stub::proxy_stub(const proxy_session::factory &f,
     dsn::task_spec::get(dsn::apps::RPC_RRDB_RRDB_CLEAR_SCANNER_ACK)->allow_inline = true;
     dsn::task_spec::get(dsn::apps::RPC_RRDB_RRDB_INCR_ACK)->allow_inline = true;
 
+    _pfc_reply_qps.init_app_counter(
+        "app.pegasus", "proxy.reply.qps", COUNTER_TYPE_RATE, "statistic the replies per second");
+    _pfc_reply_flush_qps.init_app_counter("app.pegasus",
+                                          "proxy.reply.flush.qps",
+                                          COUNTER_TYPE_RATE,
+                                          "statistic the responses sent per second");
+    _pfc_replies_per_flush.init_app_counter("app.pegasus",
+                                            "proxy.replies.per.flush",
+                                            COUNTER_TYPE_NUMBER_PERCENTILES,
+                                            "statistic the replies sent by one response");
+
     open_service();
 }
 
@@ -79,6 +96,13 @@ void proxy_stub::on_rpc_request(dsn::message_ex *request)
     session->on_recv_request(request);
 }
 
+void proxy_stub::on_replies_flushed(size_t reply_count)
+{
+    _pfc_reply_qps->add(reply_count);
+    _pfc_reply_flush_qps->increment();
+    _pfc_replies_per_flush->set(reply_count);
+}
+
 void proxy_stub::on_recv_remove_session_request(dsn::message_ex *request)
 {
     ::dsn::rpc_address source = request->header->from_address;
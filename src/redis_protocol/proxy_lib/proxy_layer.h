@@ -21,10 +21,13 @@
 
 #include <dsn/service_api_cpp.h>
 #include <dsn/tool-api/zlocks.h>
+#include <dsn/perf_counter/perf_counter_wrapper.h>
 #include <unordered_map>
 #include <functional>
 
 namespace pegasus {
+class pegasus_client;
+
 namespace proxy {
 
 DEFINE_TASK_CODE_RPC(RPC_CALL_RAW_SESSION_DISCONNECT,
@@ -79,6 +82,7 @@ public:
     const char *get_cluster() const { return _cluster.c_str(); }
     const char *get_app() const { return _app.c_str(); }
     const char *get_geo_app() const { return _geo_app.c_str(); }
+    pegasus_client *get_pegasus_client() const { return _pegasus_client; }
     void open_service()
     {
         this->register_rpc_handler(
@@ -94,6 +98,9 @@ public:
     }
     void remove_session(dsn::rpc_address remote_address);
 
+    // called after `reply_count` replies are sent to a client by one response.
+    void on_replies_flushed(size_t reply_count);
+
 private:
     void on_rpc_request(dsn::message_ex *request);
     void on_recv_remove_session_request(dsn::message_ex *);
@@ -105,6 +112,12 @@ private:
     std::string _cluster;
     std::string _app;
     std::string _geo_app;
+    // the client of the app, which is owned by pegasus_client_factory.
+    pegasus_client *_pegasus_client;
+
+    ::dsn::perf_counter_wrapper _pfc_reply_qps;
+    ::dsn::perf_counter_wrapper _pfc_reply_flush_qps;
+    ::dsn::perf_counter_wrapper _pfc_replies_per_flush;
 };
 } // namespace proxy
 } // namespace pegasus
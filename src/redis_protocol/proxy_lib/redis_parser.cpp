@@ -19,9 +19,11 @@
 
 #include "redis_parser.h"
 
+#include <limits>
 #include <rocksdb/status.h>
 #include <dsn/dist/fmt_logging.h>
 #include <dsn/dist/replication/replication_other_types.h>
+#include <dsn/utility/flags.h>
 #include <dsn/utility/string_conv.h>
 
 #include <rrdb/rrdb.client.h>
@@ -33,6 +35,24 @@
 namespace pegasus {
 namespace proxy {
 
+DSN_DEFINE_uint32("pegasus.proxy",
+                  redis_request_timeout_ms,
+                  2000,
+                  "timeout of the requests sent to pegasus for the redis commands, in ms");
+DSN_TAG_VARIABLE(redis_request_timeout_ms, FT_MUTABLE);
+
+DSN_DEFINE_uint32("pegasus.proxy",
+                  redis_max_hgetall_reply_size_kb,
+                  65536,
+                  "max size of the fields accumulated for the reply of HGETALL, which is read "
+                  "page by page, in KB");
+DSN_TAG_VARIABLE(redis_max_hgetall_reply_size_kb, FT_MUTABLE);
+
+static std::chrono::milliseconds request_timeout()
+{
+    return std::chrono::milliseconds(FLAGS_redis_request_timeout_ms);
+}
+
 std::atomic_llong redis_parser::s_next_seqid(0);
 const char redis_parser::CR = '\015';
 const char redis_parser::LF = '\012';
@@ -53,6 +73,20 @@ std::unordered_map<std::string, redis_parser::redis_call_handler> redis_parser::
     {"INCRBY", redis_parser::g_incr_by},
     {"DECR", redis_parser::g_decr},
     {"DECRBY", redis_parser::g_decr_by},
+    {"MGET", redis_parser::g_mget},
+    {"MSET", redis_parser::g_mset},
+    {"EXISTS", redis_parser::g_exists},
+    {"EXPIRE", redis_parser::g_expire},
+    {"PEXPIRE", redis_parser::g_expire},
+    {"UNLINK", redis_parser::g_unlink},
+    {"HSET", redis_parser::g_hset},
+    {"HMSET", redis_parser::g_hset},
+    {"HGET", redis_parser::g_hget},
+    {"HMGET", redis_parser::g_hmget},
+    {"HGETALL", redis_parser::g_hgetall},
+    {"HDEL", redis_parser::g_hdel},
+    {"HLEN", redis_parser::g_hlen},
+    {"HSCAN", redis_parser::g_hscan},
 };
 
 redis_parser::redis_call_handler redis_parser::get_handler(const char *command, unsigned int length)
@@ -81,6 +115,7 @@ redis_parser::redis_parser(proxy_stub *op, dsn::message_ex *first_msg)
         dsn::replication::replica_helper::load_meta_servers(
             meta_list, PEGASUS_CLUSTER_SECTION_NAME.c_str(), op->get_cluster());
         r = new ::dsn::apps::rrdb_client(op->get_cluster(), meta_list, op->get_app());
+        _pegasus_client = op->get_pegasus_client();
         if (strlen(op->get_geo_app()) != 0) {
             _geo_client = dsn::make_unique<geo::geo_client>(
                 "config.ini", op->get_cluster(), op->get_app(), op->get_geo_app());
@@ -98,6 +133,19 @@ redis_parser::~redis_parser()
     ddebug("%s: redis parser destroyed", _remote_address.to_string());
 }
 
+// return the blob which references [data, data + length) of `msg` and shares the ownership of
+// the buffer, or an empty blob if the buffer is not owned by `msg`.
+static dsn::blob share_message_buffer(dsn::message_ex *msg, const char *data, size_t length)
+{
+    for (const dsn::blob &bb : msg->buffers) {
+        if (bb.buffer() != nullptr && bb.data() <= data &&
+            data + length <= bb.data() + bb.length()) {
+            return bb.range(static_cast<int>(data - bb.data()), static_cast<int>(length));
+        }
+    }
+    return dsn::blob();
+}
+
 void redis_parser::prepare_current_buffer()
 {
     void *msg_buffer;
@@ -111,18 +159,22 @@ void redis_parser::prepare_current_buffer()
             first_msg->header->rpc_name);
         _current_buffer = reinterpret_cast<char *>(msg_buffer);
         _current_cursor = 0;
+        _current_blob = share_message_buffer(first_msg, _current_buffer, _current_buffer_length);
     } else if (_current_cursor >= _current_buffer_length) {
         dsn::message_ex *first_msg = _recv_buffers.front();
         first_msg->read_commit(_current_buffer_length);
         if (first_msg->read_next(&msg_buffer, &_current_buffer_length)) {
             _current_buffer = reinterpret_cast<char *>(msg_buffer);
             _current_cursor = 0;
+            _current_blob =
+                share_message_buffer(first_msg, _current_buffer, _current_buffer_length);
         } else {
             // we have consume this message all over
             // reference is added in append message
             first_msg->release_ref();
             _recv_buffers.pop();
             _current_buffer = nullptr;
+            _current_blob = dsn::blob();
             prepare_current_buffer();
         }
     }
@@ -144,6 +196,7 @@ void redis_parser::reset_parser()
     _current_buffer = nullptr;
     _current_buffer_length = 0;
     _current_cursor = 0;
+    _current_blob = dsn::blob();
     while (!_recv_buffers.empty()) {
         _recv_buffers.front()->release_ref();
         _recv_buffers.pop();
@@ -185,14 +238,43 @@ void redis_parser::eat_all(char *dest, size_t length)
     }
 }
 
-bool redis_parser::end_array_size()
+void redis_parser::advance(size_t length)
+{
+    _current_cursor += length;
+    _total_length -= length;
+}
+
+bool redis_parser::parse_size(dsn::string_view size_str, int32_t &size)
 {
-    int32_t count = 0;
-    if (dsn_unlikely(!dsn::buf2int32(dsn::string_view(_current_size), count))) {
-        derror_f(
-            "{}: invalid size string \"{}\"", _remote_address.to_string(), _current_size.c_str());
+    // parse the digits directly instead of by strtol, which needs a null-terminated copy.
+    const char *p = size_str.data();
+    const char *end = p + size_str.length();
+    const bool negative = (p != end && *p == '-');
+    if (negative) {
+        ++p;
+    }
+    // a 32 bits integer has at most 10 digits.
+    bool valid = (p != end && end - p <= 10);
+    int64_t value = 0;
+    for (; valid && p != end; ++p) {
+        const unsigned digit = static_cast<unsigned char>(*p) - '0';
+        valid = digit <= 9;
+        value = value * 10 + digit;
+    }
+    value = negative ? -value : value;
+    if (dsn_unlikely(!valid || value > std::numeric_limits<int32_t>::max() ||
+                     value < std::numeric_limits<int32_t>::min())) {
+        derror_f("{}: invalid size string \"{}\"",
+                 _remote_address.to_string(),
+                 std::string(size_str.data(), size_str.length()));
         return false;
     }
+    size = static_cast<int32_t>(value);
+    return true;
+}
+
+bool redis_parser::end_array_size(int32_t count)
+{
     if (dsn_unlikely(count <= 0)) {
         derror_f("{}: array size should be positive in redis request, but got {}",
                  _remote_address.to_string(),
@@ -204,7 +286,6 @@ bool redis_parser::end_array_size()
     current_request.sub_request_count = count;
     current_request.sub_requests.reserve(count);
 
-    _current_size.clear();
     _status = kStartBulkString;
     return true;
 }
@@ -223,19 +304,10 @@ void redis_parser::append_current_bulk_string()
     }
 }
 
-bool redis_parser::end_bulk_string_size()
+bool redis_parser::end_bulk_string_size(int32_t length)
 {
-    int32_t length = 0;
-    if (dsn_unlikely(!dsn::buf2int32(
-            dsn::string_view(_current_size.c_str(), _current_size.length()), length))) {
-        derror_f(
-            "{}: invalid size string \"{}\"", _remote_address.to_string(), _current_size.c_str());
-        return false;
-    }
-
     _current_str.length = length;
     _current_str.data.assign(nullptr, 0, 0);
-    _current_size.clear();
 
     if (-1 == _current_str.length) {
         append_current_bulk_string();
@@ -264,7 +336,6 @@ void redis_parser::append_message(dsn::message_ex *msg)
 // refererence: http://redis.io/topics/protocol
 bool redis_parser::parse_stream()
 {
-    char t;
     while (_total_length > 0) {
         switch (_status) {
         case kStartArray:
@@ -276,32 +347,63 @@ bool redis_parser::parse_stream()
             _status = kInBulkStringSize;
             break;
         case kInArraySize:
-        case kInBulkStringSize:
-            t = peek();
-            if (t == CR) {
-                if (_total_length > 1) {
-                    dverify(eat(CR));
-                    dverify(eat(LF));
-                    if (kInArraySize == _status) {
-                        dverify(end_array_size());
-                    } else {
-                        dverify(end_bulk_string_size());
-                    }
-                } else {
-                    return true;
-                }
+        case kInBulkStringSize: {
+            // find the CR ending the size in current buffer by memchr, which is vectorized.
+            prepare_current_buffer();
+            const char *begin = _current_buffer + _current_cursor;
+            const size_t available = _current_buffer_length - _current_cursor;
+            const char *cr = static_cast<const char *>(::memchr(begin, CR, available));
+            if (cr == nullptr) {
+                // the size continues in the next buffer.
+                _current_size.append(begin, available);
+                advance(available);
+                break;
+            }
+
+            const size_t size_length = cr - begin;
+            if (_total_length < size_length + 2) {
+                // wait for the LF.
+                _current_size.append(begin, size_length);
+                advance(size_length);
+                return true;
+            }
+
+            // parse the size before CR LF are eaten, which may release the buffer.
+            int32_t size = 0;
+            if (_current_size.empty()) {
+                dverify(parse_size(dsn::string_view(begin, size_length), size));
+            } else {
+                _current_size.append(begin, size_length);
+                dverify(parse_size(_current_size, size));
+                _current_size.clear();
+            }
+            advance(size_length);
+            dverify(eat(CR));
+            dverify(eat(LF));
+            if (kInArraySize == _status) {
+                dverify(end_array_size(size));
             } else {
-                _current_size.push_back(t);
-                dverify(eat(t));
+                dverify(end_bulk_string_size(size));
             }
             break;
+        }
         case kStartBulkStringData:
             // string content + CR + LF
-            if (_total_length >= _current_str.length + 2) {
+            if (_total_length >= static_cast<size_t>(_current_str.length) + 2) {
                 if (_current_str.length > 0) {
-                    std::string str_data(_current_str.length, '\0');
-                    eat_all(const_cast<char *>(str_data.data()), _current_str.length);
-                    _current_str.data = dsn::blob::create_from_bytes(std::move(str_data));
+                    prepare_current_buffer();
+                    if (_current_blob.buffer() != nullptr &&
+                        _current_buffer_length - _current_cursor >=
+                            static_cast<size_t>(_current_str.length)) {
+                        // the string is in current buffer, just reference it.
+                        _current_str.data = _current_blob.range(
+                            static_cast<int>(_current_cursor), _current_str.length);
+                        advance(_current_str.length);
+                    } else {
+                        std::string str_data(_current_str.length, '\0');
+                        eat_all(const_cast<char *>(str_data.data()), _current_str.length);
+                        _current_str.data = dsn::blob::create_from_bytes(std::move(str_data));
+                    }
                 }
                 dverify(eat(CR));
                 dverify(eat(LF));
@@ -336,46 +438,65 @@ void redis_parser::enqueue_pending_response(std::unique_ptr<message_entry> &&ent
     pending_response.emplace_back(std::move(entry));
 }
 
-void redis_parser::fetch_and_dequeue_messages(std::vector<dsn::message_ex *> &msgs,
-                                              bool only_ready_ones)
+void redis_parser::clear_reply_queue()
 {
+    // clear the response pipeline
     dsn::zauto_lock l(response_lock);
-    while (!pending_response.empty()) {
-        message_entry *entry = pending_response.front().get();
-        dsn::message_ex *r = entry->response.load(std::memory_order_acquire);
-        if (only_ready_ones && r == nullptr) {
-            break;
-        } else {
-            msgs.push_back(r);
-            pending_response.pop_front();
-        }
-    }
+    pending_response.clear();
 }
 
-void redis_parser::clear_reply_queue()
+void redis_parser::reply_all_ready()
 {
-    // clear the response pipeline
-    std::vector<dsn::message_ex *> all_responses;
-    fetch_and_dequeue_messages(all_responses, false);
-    for (dsn::message_ex *m : all_responses) {
-        if (m != nullptr) {
-            m->release_ref();
-        }
+    // only one thread flushes the replies at a time, so that they are sent in order. A thread which
+    // finds a flush in progress doesn't wait for it, but lets the flushing thread flush once more
+    // for the replies it made ready. So the replies which get ready during a flush are coalesced
+    // into the next response.
+    if (_flush_requests.fetch_add(1, std::memory_order_acq_rel) != 0) {
+        return;
     }
+    int pending = 1;
+    do {
+        flush_ready_replies();
+        pending = _flush_requests.fetch_sub(pending, std::memory_order_acq_rel) - pending;
+    } while (pending != 0);
 }
 
-void redis_parser::reply_all_ready()
+void redis_parser::flush_ready_replies()
 {
-    std::vector<dsn::message_ex *> ready_responses;
-    fetch_and_dequeue_messages(ready_responses, true);
-    for (dsn::message_ex *m : ready_responses) {
-        dassert(m != nullptr, "");
-        dsn_rpc_reply(m, ::dsn::ERR_OK);
-        // added when message is created
-        m->release_ref();
+    {
+        dsn::zauto_lock l(response_lock);
+        while (!pending_response.empty() &&
+               pending_response.front()->replied.load(std::memory_order_acquire)) {
+            _flushing_entries.emplace_back(std::move(pending_response.front()));
+            pending_response.pop_front();
+        }
+    }
+    if (_flushing_entries.empty()) {
+        return;
+    }
+
+    // the replies are serialized into the buffers of the response, which are allocated by
+    // rpc_write_stream from the transient memory of rDSN, and sent by one write.
+    dsn::message_ex *resp = create_response();
+    resp->add_ref();
+    {
+        dsn::rpc_write_stream s(resp);
+        for (const auto &entry : _flushing_entries) {
+            entry->reply->marshalling(s);
+        }
+        s.commit_buffer();
     }
+    send_response(resp);
+    resp->release_ref();
+
+    if (_stub != nullptr) {
+        _stub->on_replies_flushed(_flushing_entries.size());
+    }
+    _flushing_entries.clear();
 }
 
+void redis_parser::send_response(dsn::message_ex *resp) { dsn_rpc_reply(resp, ::dsn::ERR_OK); }
+
 std::shared_ptr<redis_parser::redis_bulk_string> redis_parser::construct_bulk_string(double data)
 {
     std::string data_str(std::to_string(data));
@@ -482,8 +603,7 @@ void redis_parser::set_internal(redis_parser::message_entry &entry)
         else
             req.expire_ts_seconds = ttl_seconds + utils::epoch_now();
         auto partition_hash = pegasus_key_hash(req.key);
-        // TODO: set the timeout
-        client->put(req, on_set_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        client->put(req, on_set_reply, request_timeout(), 0, partition_hash);
     }
 }
 
@@ -522,7 +642,7 @@ void redis_parser::set_geo_internal(message_entry &entry)
                                std::string(),                                  // ""  => sort_key
                                redis_request.sub_requests[2].data.to_string(), // value
                                set_callback,
-                               2000, // TODO: set the timeout
+                               FLAGS_redis_request_timeout_ms,
                                ttl_seconds);
     }
 }
@@ -589,8 +709,7 @@ void redis_parser::setex(message_entry &entry)
 
         auto partition_hash = pegasus_key_hash(req.key);
 
-        // TODO: set the timeout
-        client->put(req, on_setex_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        client->put(req, on_setex_reply, request_timeout(), 0, partition_hash);
     }
 }
 
@@ -641,8 +760,7 @@ void redis_parser::get(message_entry &entry)
         ::dsn::blob null_blob;
         pegasus_generate_key(req, redis_req.sub_requests[1].data, null_blob);
         auto partition_hash = pegasus_key_hash(req);
-        // TODO: set the timeout
-        client->get(req, on_get_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        client->get(req, on_get_reply, request_timeout(), 0, partition_hash);
     }
 }
 
@@ -706,8 +824,7 @@ void redis_parser::del_internal(message_entry &entry)
         ::dsn::blob null_blob;
         pegasus_generate_key(req, redis_req.sub_requests[1].data, null_blob);
         auto partition_hash = pegasus_key_hash(req);
-        // TODO: set the timeout
-        client->remove(req, on_del_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        client->remove(req, on_del_reply, request_timeout(), 0, partition_hash);
     }
 }
 
@@ -743,7 +860,7 @@ void redis_parser::del_geo_internal(message_entry &entry)
                                std::string(),                                  // ""  => sort_key
                                false,
                                del_callback,
-                               2000); // TODO: set the timeout
+                               FLAGS_redis_request_timeout_ms);
     }
 }
 
@@ -802,8 +919,7 @@ void redis_parser::ttl(message_entry &entry)
         ::dsn::blob null_blob;
         pegasus_generate_key(req, redis_req.sub_requests[1].data, null_blob);
         auto partition_hash = pegasus_key_hash(req);
-        // TODO: set the timeout
-        client->ttl(req, on_ttl_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        client->ttl(req, on_ttl_reply, request_timeout(), 0, partition_hash);
     }
 }
 
@@ -865,8 +981,13 @@ void redis_parser::geo_radius(message_entry &entry)
             entry, unit, WITHCOORD, WITHDIST, WITHHASH, ec, std::move(results));
     };
 
-    _geo_client->async_search_radial(
-        lat_degrees, lng_degrees, radius_m, count, sort_type, 2000, search_callback);
+    _geo_client->async_search_radial(lat_degrees,
+                                     lng_degrees,
+                                     radius_m,
+                                     count,
+                                     sort_type,
+                                     FLAGS_redis_request_timeout_ms,
+                                     search_callback);
 }
 
 // command format:
@@ -920,7 +1041,7 @@ void redis_parser::geo_radius_by_member(message_entry &entry)
     };
 
     _geo_client->async_search_radial(
-        hash_key, "", radius_m, count, sort_type, 2000, search_callback);
+        hash_key, "", radius_m, count, sort_type, FLAGS_redis_request_timeout_ms, search_callback);
 }
 
 void redis_parser::incr(message_entry &entry) { counter_internal(entry); }
@@ -1005,7 +1126,1038 @@ void redis_parser::counter_internal(message_entry &entry)
     dsn::apps::incr_request req;
     pegasus_generate_key(req.key, entry.request.sub_requests[1].data, dsn::blob());
     req.increment = increment;
-    client->incr(req, on_incr_reply, std::chrono::milliseconds(2000), 0, pegasus_key_hash(req.key));
+    client->incr(req, on_incr_reply, request_timeout(), 0, pegasus_key_hash(req.key));
+}
+
+// the max count of retrying EXPIRE when the value is modified concurrently.
+static const int kMaxExpireRetryCount = 3;
+
+// the context of a command which is split into several rpcs, it's replied after all of the rpcs
+// complete.
+struct fanout_context
+{
+    explicit fanout_context(int count) : pending_count(count) {}
+
+    // record the first error.
+    void set_error(std::string message)
+    {
+        ::dsn::zauto_lock l(lock);
+        if (error.empty()) {
+            error = std::move(message);
+        }
+    }
+
+    // return true if all of the rpcs complete.
+    bool finish_one() { return --pending_count == 0; }
+
+    std::atomic<int> pending_count;
+    ::dsn::zlock lock;
+    std::string error;
+};
+
+// origin command format:
+// MGET key [key ...]
+void redis_parser::mget(message_entry &entry) { batch_get_internal(entry, false); }
+
+// origin command format:
+// EXISTS key [key ...]
+void redis_parser::exists(message_entry &entry) { batch_get_internal(entry, true); }
+
+void redis_parser::batch_get_internal(message_entry &entry, bool exists_only)
+{
+    redis_request &redis_req = entry.request;
+    const char *command = exists_only ? "exists" : "mget";
+    if (redis_req.sub_requests.size() < 2) {
+        ddebug_f("{}: {} command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 command,
+                 entry.sequence_id);
+        simple_error_reply(entry,
+                           fmt::format("wrong number of arguments for '{}' command", command));
+        return;
+    }
+    if (_pegasus_client == nullptr) {
+        simple_error_reply(entry, fmt::format("'{}' command is not supported", command));
+        return;
+    }
+
+    dinfo_f("{}: send {} command seqid({})",
+            _remote_address.to_string(),
+            command,
+            entry.sequence_id);
+    std::vector<std::pair<std::string, std::string>> keys;
+    keys.reserve(redis_req.sub_requests.size() - 1);
+    for (size_t i = 1; i < redis_req.sub_requests.size(); ++i) {
+        keys.emplace_back(redis_req.sub_requests[i].data.to_string(), std::string());
+    }
+
+    // the keys are grouped by partition, and read by one batch_get rpc per partition in parallel.
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_batch_get_reply = [ref_this, this, &entry, keys, exists_only, command](
+        int ec, std::map<std::pair<std::string, std::string>, std::string> &&values) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: {} command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     command,
+                     entry.sequence_id);
+            return;
+        }
+
+        if (PERR_OK != ec) {
+            ddebug_f("{}: {} command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     command,
+                     entry.sequence_id,
+                     _pegasus_client->get_error_string(ec));
+            simple_error_reply(entry, _pegasus_client->get_error_string(ec));
+            return;
+        }
+
+        if (exists_only) {
+            // a key is counted as many times as it's specified, the same as redis.
+            int64_t count = 0;
+            for (const auto &key : keys) {
+                count += values.count(key);
+            }
+            simple_integer_reply(entry, count);
+            return;
+        }
+
+        // the values are replied in the order of the keys, nil for the absent ones.
+        redis_array result;
+        result.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            auto iter = values.find(keys[i]);
+            if (iter == values.end()) {
+                result.array[i] = std::make_shared<redis_bulk_string>();
+            } else {
+                result.array[i] = std::make_shared<redis_bulk_string>(iter->second);
+            }
+        }
+        reply_message(entry, std::move(result));
+    };
+    _pegasus_client->async_batch_get(
+        keys, std::move(on_batch_get_reply), FLAGS_redis_request_timeout_ms);
+}
+
+// origin command format:
+// MSET key value [key value ...]
+// NOTE: there is no rpc to write the keys of different hash keys at once, so every key is put by
+// its own rpc in parallel, and the command is not atomic.
+void redis_parser::mset(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() < 3 || redis_req.sub_requests.size() % 2 != 1) {
+        ddebug_f("{}: mset command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'mset' command");
+        return;
+    }
+
+    dinfo_f("{}: send mset command seqid({})", _remote_address.to_string(), entry.sequence_id);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto context = std::make_shared<fanout_context>((redis_req.sub_requests.size() - 1) / 2);
+    auto on_set_reply = [ref_this, this, &entry, context](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (::dsn::ERR_OK != ec) {
+            context->set_error(ec.to_string());
+        } else {
+            ::dsn::apps::update_response rrdb_response;
+            ::dsn::unmarshall(response, rrdb_response);
+            if (rrdb_response.error != 0) {
+                context->set_error("internal error " + std::to_string(rrdb_response.error));
+            }
+        }
+        if (!context->finish_one()) {
+            return;
+        }
+
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: mset command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+        if (context->error.empty()) {
+            simple_ok_reply(entry);
+        } else {
+            ddebug_f("{}: mset command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     entry.sequence_id,
+                     context->error);
+            simple_error_reply(entry, context->error);
+        }
+    };
+
+    for (size_t i = 1; i < redis_req.sub_requests.size(); i += 2) {
+        ::dsn::apps::update_request req;
+        pegasus_generate_key(req.key, redis_req.sub_requests[i].data, ::dsn::blob());
+        req.value = redis_req.sub_requests[i + 1].data;
+        req.expire_ts_seconds = 0;
+        auto partition_hash = pegasus_key_hash(req.key);
+        client->put(req, on_set_reply, request_timeout(), 0, partition_hash);
+    }
+}
+
+// origin command format:
+// UNLINK key [key ...]
+// NOTE: like DEL, a non-existent key is also counted as removed, and every key is removed by its
+// own rpc in parallel.
+void redis_parser::unlink(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() < 2) {
+        ddebug_f("{}: unlink command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'unlink' command");
+        return;
+    }
+    if (_geo_client != nullptr) {
+        // the geo index is not removed together.
+        simple_error_reply(entry, "'unlink' command is not supported on GEO mode");
+        return;
+    }
+
+    dinfo_f("{}: send unlink command seqid({})", _remote_address.to_string(), entry.sequence_id);
+    const int key_count = static_cast<int>(redis_req.sub_requests.size() - 1);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto context = std::make_shared<fanout_context>(key_count);
+    auto on_del_reply = [ref_this, this, &entry, context, key_count](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (::dsn::ERR_OK != ec) {
+            context->set_error(ec.to_string());
+        } else {
+            ::dsn::apps::read_response rrdb_response;
+            ::dsn::unmarshall(response, rrdb_response);
+            if (rrdb_response.error != 0) {
+                context->set_error("internal error " + std::to_string(rrdb_response.error));
+            }
+        }
+        if (!context->finish_one()) {
+            return;
+        }
+
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: unlink command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+        if (context->error.empty()) {
+            simple_integer_reply(entry, key_count);
+        } else {
+            ddebug_f("{}: unlink command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     entry.sequence_id,
+                     context->error);
+            simple_error_reply(entry, context->error);
+        }
+    };
+
+    for (size_t i = 1; i < redis_req.sub_requests.size(); ++i) {
+        ::dsn::blob req;
+        pegasus_generate_key(req, redis_req.sub_requests[i].data, ::dsn::blob());
+        auto partition_hash = pegasus_key_hash(req);
+        client->remove(req, on_del_reply, request_timeout(), 0, partition_hash);
+    }
+}
+
+// process 'expire' and 'pexpire'
+// origin command format:
+// EXPIRE key seconds
+// PEXPIRE key milliseconds
+// NOTE: the ttl of pegasus is in seconds, so the milliseconds are rounded up to seconds.
+void redis_parser::expire(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    bool is_expire = (toupper(redis_req.sub_requests[0].data.data()[0]) == 'E');
+    const char *command = is_expire ? "expire" : "pexpire";
+    if (redis_req.sub_requests.size() != 3) {
+        ddebug_f("{}: {} command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 command,
+                 entry.sequence_id);
+        simple_error_reply(entry,
+                           fmt::format("wrong number of arguments for '{}' command", command));
+        return;
+    }
+
+    int64_t ttl = 0;
+    if (!dsn::buf2int64(redis_req.sub_requests[2].data, ttl)) {
+        simple_error_reply(entry, "value is not an integer or out of range");
+        return;
+    }
+    if (!is_expire) {
+        ttl = ttl / 1000 + (ttl > 0 && ttl % 1000 != 0 ? 1 : 0);
+    }
+    // the expire_ts is an epoch time in int32.
+    if (ttl > std::numeric_limits<int32_t>::max() - static_cast<int64_t>(utils::epoch_now())) {
+        simple_error_reply(entry, fmt::format("invalid expire time in '{}' command", command));
+        return;
+    }
+
+    dinfo_f("{}: send {} command seqid({})",
+            _remote_address.to_string(),
+            command,
+            entry.sequence_id);
+    expire_internal(entry, static_cast<int32_t>(std::max<int64_t>(ttl, 0)), kMaxExpireRetryCount);
+}
+
+// pegasus can't update the ttl alone, so the value is read and then written back with the new ttl
+// by check_and_set, which fails if the value is modified meanwhile, and then it's retried.
+// A key is removed if the ttl is 0, the same as redis does for a non-positive ttl.
+// NOTE: check_and_set compares only the value bytes (CT_VALUE_BYTES_EQUAL), since there is no
+// check type on the expire time. So a concurrent SET of the same value with another ttl is not
+// detected, and its ttl is overwritten by this command.
+void redis_parser::expire_internal(message_entry &entry, int32_t ttl_seconds, int retry_count)
+{
+    ::dsn::blob raw_key;
+    pegasus_generate_key(raw_key, entry.request.sub_requests[1].data, ::dsn::blob());
+    auto partition_hash = pegasus_key_hash(raw_key);
+
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_write_reply = [ref_this, this, &entry, ttl_seconds, retry_count](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: expire command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+        if (::dsn::ERR_OK != ec) {
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        int error = 0;
+        if (ttl_seconds == 0) {
+            ::dsn::apps::read_response rrdb_response;
+            ::dsn::unmarshall(response, rrdb_response);
+            error = rrdb_response.error;
+        } else {
+            ::dsn::apps::check_and_set_response rrdb_response;
+            ::dsn::unmarshall(response, rrdb_response);
+            error = rrdb_response.error;
+        }
+        if (error == rocksdb::Status::kTryAgain) {
+            // the value is modified after read.
+            if (retry_count > 0) {
+                expire_internal(entry, ttl_seconds, retry_count - 1);
+            } else {
+                simple_error_reply(entry, "the key is modified concurrently");
+            }
+        } else if (error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(error));
+        } else {
+            simple_integer_reply(entry, 1);
+        }
+    };
+
+    auto on_get_reply = [ref_this, this, &entry, ttl_seconds, partition_hash, on_write_reply](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: expire command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+        if (::dsn::ERR_OK != ec) {
+            ddebug_f("{}: expire command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     entry.sequence_id,
+                     ec.to_string());
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::read_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error == rocksdb::Status::kNotFound) {
+            simple_integer_reply(entry, 0);
+            return;
+        }
+        if (rrdb_response.error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+            return;
+        }
+
+        const ::dsn::blob &hash_key = entry.request.sub_requests[1].data;
+        if (ttl_seconds == 0) {
+            ::dsn::blob raw_key;
+            pegasus_generate_key(raw_key, hash_key, ::dsn::blob());
+            client->remove(
+                raw_key, on_write_reply, request_timeout(), 0, partition_hash);
+            return;
+        }
+
+        ::dsn::apps::check_and_set_request req;
+        req.hash_key = hash_key;
+        req.check_type = ::dsn::apps::cas_check_type::CT_VALUE_BYTES_EQUAL;
+        req.check_operand = rrdb_response.value;
+        req.set_diff_sort_key = false;
+        req.set_value = rrdb_response.value;
+        req.set_expire_ts_seconds = static_cast<int32_t>(utils::epoch_now()) + ttl_seconds;
+        req.return_check_value = false;
+        client->check_and_set(
+            req, on_write_reply, request_timeout(), 0, partition_hash);
+    };
+    client->get(raw_key, on_get_reply, request_timeout(), 0, partition_hash);
+}
+
+// the max count of the HSCAN cursors kept in a session.
+static const size_t kMaxHscanCursorCount = 1024;
+// the default count of the fields returned by HSCAN, the same as redis.
+static const int kDefaultHscanCount = 10;
+
+// The hash commands map a redis hash to a hash key of pegasus, and the fields of the hash to the
+// sort keys, so all of the fields of a hash are in one partition and are read or written by one
+// rpc. The empty sort key is where the value of a string key is stored, so the key of a hash
+// can't be used as a string key at the same time, and an empty field is not allowed.
+bool redis_parser::check_hash_arguments(message_entry &entry,
+                                        const char *command,
+                                        size_t first_field_index,
+                                        size_t field_step)
+{
+    const std::vector<redis_bulk_string> &args = entry.request.sub_requests;
+    const ::dsn::blob &hash_key = args[1].data;
+    if (hash_key.length() == 0 || hash_key.length() >= UINT16_MAX) {
+        simple_error_reply(entry, fmt::format("invalid key in '{}' command", command));
+        return false;
+    }
+    for (size_t i = first_field_index; i < args.size(); i += field_step) {
+        if (args[i].data.length() == 0) {
+            simple_error_reply(entry, fmt::format("empty field in '{}' command", command));
+            return false;
+        }
+    }
+    return true;
+}
+
+// process 'hset' and 'hmset'
+// origin command format:
+// HSET key field value [field value ...]
+// HMSET key field value [field value ...]
+// NOTE: HSET replies the count of the fields written instead of the newly added ones, because
+// which fields exist is unknown without reading them.
+void redis_parser::hset(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    bool is_hmset = (redis_req.sub_requests[0].data.length() == 5);
+    const char *command = is_hmset ? "hmset" : "hset";
+    if (redis_req.sub_requests.size() < 4 || redis_req.sub_requests.size() % 2 != 0) {
+        ddebug_f("{}: {} command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 command,
+                 entry.sequence_id);
+        simple_error_reply(entry,
+                           fmt::format("wrong number of arguments for '{}' command", command));
+        return;
+    }
+    if (!check_hash_arguments(entry, command, 2, 2)) {
+        return;
+    }
+
+    dinfo_f("{}: send {} command seqid({})",
+            _remote_address.to_string(),
+            command,
+            entry.sequence_id);
+    const int64_t field_count = (redis_req.sub_requests.size() - 2) / 2;
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_multi_put_reply = [ref_this, this, &entry, command, is_hmset, field_count](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: {} command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     command,
+                     entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            ddebug_f("{}: {} command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     command,
+                     entry.sequence_id,
+                     ec.to_string());
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::update_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+        } else if (is_hmset) {
+            simple_ok_reply(entry);
+        } else {
+            simple_integer_reply(entry, field_count);
+        }
+    };
+
+    ::dsn::apps::multi_put_request req;
+    req.hash_key = redis_req.sub_requests[1].data;
+    req.expire_ts_seconds = 0;
+    req.kvs.reserve(field_count);
+    for (size_t i = 2; i < redis_req.sub_requests.size(); i += 2) {
+        ::dsn::apps::key_value kv;
+        kv.key = redis_req.sub_requests[i].data;
+        kv.value = redis_req.sub_requests[i + 1].data;
+        req.kvs.emplace_back(std::move(kv));
+    }
+    auto partition_hash = pegasus_hash_key_hash(req.hash_key);
+    client->multi_put(req, on_multi_put_reply, request_timeout(), 0, partition_hash);
+}
+
+// origin command format:
+// HGET key field
+void redis_parser::hget(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() != 3) {
+        ddebug_f("{}: hget command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'hget' command");
+        return;
+    }
+    if (!check_hash_arguments(entry, "hget", 2, 1)) {
+        return;
+    }
+
+    dinfo_f("{}: send hget command seqid({})", _remote_address.to_string(), entry.sequence_id);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_get_reply = [ref_this, this, &entry](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: hget command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            ddebug_f("{}: hget command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     entry.sequence_id,
+                     ec.to_string());
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::read_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error == rocksdb::Status::kNotFound) {
+            reply_message(entry, redis_bulk_string());
+        } else if (rrdb_response.error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+        } else {
+            reply_message(entry, redis_bulk_string(rrdb_response.value));
+        }
+    };
+    ::dsn::blob req;
+    pegasus_generate_key(req, redis_req.sub_requests[1].data, redis_req.sub_requests[2].data);
+    auto partition_hash = pegasus_key_hash(req);
+    client->get(req, on_get_reply, request_timeout(), 0, partition_hash);
+}
+
+// origin command format:
+// HMGET key field [field ...]
+void redis_parser::hmget(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() < 3) {
+        ddebug_f("{}: hmget command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'hmget' command");
+        return;
+    }
+    if (!check_hash_arguments(entry, "hmget", 2, 1)) {
+        return;
+    }
+
+    dinfo_f("{}: send hmget command seqid({})", _remote_address.to_string(), entry.sequence_id);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_multi_get_reply = [ref_this, this, &entry](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: hmget command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            ddebug_f("{}: hmget command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     entry.sequence_id,
+                     ec.to_string());
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::multi_get_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error != 0) {
+            // kIncomplete means the fields exceed the limits of multi_get on the server.
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+            return;
+        }
+
+        // the values are replied in the order of the fields, nil for the absent ones.
+        std::unordered_map<std::string, const ::dsn::blob *> values;
+        for (const auto &kv : rrdb_response.kvs) {
+            values.emplace(kv.key.to_string(), &kv.value);
+        }
+        const std::vector<redis_bulk_string> &fields = entry.request.sub_requests;
+        redis_array result;
+        result.resize(fields.size() - 2);
+        for (size_t i = 2; i < fields.size(); ++i) {
+            auto iter = values.find(fields[i].data.to_string());
+            if (iter == values.end()) {
+                result.array[i - 2] = std::make_shared<redis_bulk_string>();
+            } else {
+                result.array[i - 2] = std::make_shared<redis_bulk_string>(*iter->second);
+            }
+        }
+        reply_message(entry, std::move(result));
+    };
+
+    ::dsn::apps::multi_get_request req;
+    req.hash_key = redis_req.sub_requests[1].data;
+    req.max_kv_count = -1;
+    req.max_kv_size = -1;
+    req.no_value = false;
+    req.start_inclusive = true;
+    req.stop_inclusive = false;
+    req.sort_keys.reserve(redis_req.sub_requests.size() - 2);
+    for (size_t i = 2; i < redis_req.sub_requests.size(); ++i) {
+        req.sort_keys.emplace_back(redis_req.sub_requests[i].data);
+    }
+    auto partition_hash = pegasus_hash_key_hash(req.hash_key);
+    client->multi_get(req, on_multi_get_reply, request_timeout(), 0, partition_hash);
+}
+
+// origin command format:
+// HGETALL key
+// NOTE: the fields are read by a range read in the partition of the key, which is split into
+// several multi_get rpcs if it exceeds the limits of multi_get on the server.
+void redis_parser::hgetall(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() != 2) {
+        ddebug_f("{}: hgetall command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'hgetall' command");
+        return;
+    }
+    if (!check_hash_arguments(entry, "hgetall", 2, 1)) {
+        return;
+    }
+
+    dinfo_f("{}: send hgetall command seqid({})", _remote_address.to_string(), entry.sequence_id);
+    hgetall_internal(entry, std::make_shared<redis_array>(), 0, ::dsn::blob());
+}
+
+void redis_parser::hgetall_internal(message_entry &entry,
+                                    std::shared_ptr<redis_array> result,
+                                    uint64_t result_size,
+                                    const ::dsn::blob &start_sortkey)
+{
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_multi_get_reply = [ref_this, this, &entry, result, result_size, start_sortkey](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) mutable {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: hgetall command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            ddebug_f("{}: hgetall command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     entry.sequence_id,
+                     ec.to_string());
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::multi_get_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error != 0 && rrdb_response.error != rocksdb::Status::kIncomplete) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+            return;
+        }
+
+        for (const auto &kv : rrdb_response.kvs) {
+            result_size += kv.key.length() + kv.value.length();
+            result->array.emplace_back(std::make_shared<redis_bulk_string>(kv.key));
+            result->array.emplace_back(std::make_shared<redis_bulk_string>(kv.value));
+        }
+        if (rrdb_response.error == rocksdb::Status::kIncomplete) {
+            // resume from the last sort key scanned by the server, which may be beyond the last
+            // returned field, e.g. if there are many expired fields.
+            ::dsn::blob last_sortkey;
+            if (rrdb_response.__isset.last_sortkey) {
+                last_sortkey = rrdb_response.last_sortkey;
+            } else if (!rrdb_response.kvs.empty()) {
+                last_sortkey = rrdb_response.kvs.back().key;
+            }
+            if (last_sortkey.to_string() <= start_sortkey.to_string()) {
+                // no progress is made, resuming from the same sort key would loop forever.
+                simple_error_reply(entry, "hgetall is incomplete without any progress");
+                return;
+            }
+            uint64_t max_reply_size =
+                static_cast<uint64_t>(FLAGS_redis_max_hgetall_reply_size_kb) << 10;
+            if (result_size > max_reply_size) {
+                simple_error_reply(entry, "hash is too large for 'hgetall', use 'hscan' instead");
+                return;
+            }
+            hgetall_internal(entry, result, result_size, last_sortkey);
+            return;
+        }
+        result->count = static_cast<int>(result->array.size());
+        reply_message(entry, std::move(*result));
+    };
+
+    ::dsn::apps::multi_get_request req;
+    req.hash_key = entry.request.sub_requests[1].data;
+    req.max_kv_count = -1;
+    req.max_kv_size = -1;
+    req.no_value = false;
+    // the empty sort key is excluded by the exclusive start.
+    req.start_sortkey = start_sortkey;
+    req.start_inclusive = false;
+    req.stop_inclusive = false;
+    req.sort_key_filter_type = ::dsn::apps::filter_type::FT_NO_FILTER;
+    req.reverse = false;
+    auto partition_hash = pegasus_hash_key_hash(req.hash_key);
+    client->multi_get(req, on_multi_get_reply, request_timeout(), 0, partition_hash);
+}
+
+// origin command format:
+// HDEL key field [field ...]
+// NOTE: like DEL, a non-existent field is also counted as removed.
+void redis_parser::hdel(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() < 3) {
+        ddebug_f("{}: hdel command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'hdel' command");
+        return;
+    }
+    if (!check_hash_arguments(entry, "hdel", 2, 1)) {
+        return;
+    }
+
+    dinfo_f("{}: send hdel command seqid({})", _remote_address.to_string(), entry.sequence_id);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_multi_remove_reply = [ref_this, this, &entry](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: hdel command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            ddebug_f("{}: hdel command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     entry.sequence_id,
+                     ec.to_string());
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::multi_remove_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+        } else {
+            simple_integer_reply(entry, rrdb_response.count);
+        }
+    };
+
+    ::dsn::apps::multi_remove_request req;
+    req.hash_key = redis_req.sub_requests[1].data;
+    req.sort_keys.reserve(redis_req.sub_requests.size() - 2);
+    for (size_t i = 2; i < redis_req.sub_requests.size(); ++i) {
+        req.sort_keys.emplace_back(redis_req.sub_requests[i].data);
+    }
+    auto partition_hash = pegasus_hash_key_hash(req.hash_key);
+    client->multi_remove(
+        req, on_multi_remove_reply, request_timeout(), 0, partition_hash);
+}
+
+// origin command format:
+// HLEN key
+// NOTE: the value of the string key of the same name is also counted if it exists.
+void redis_parser::hlen(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() != 2) {
+        ddebug_f("{}: hlen command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'hlen' command");
+        return;
+    }
+    if (!check_hash_arguments(entry, "hlen", 2, 1)) {
+        return;
+    }
+
+    dinfo_f("{}: send hlen command seqid({})", _remote_address.to_string(), entry.sequence_id);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_sortkey_count_reply = [ref_this, this, &entry](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: hlen command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            ddebug_f("{}: hlen command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     entry.sequence_id,
+                     ec.to_string());
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::count_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+        } else {
+            simple_integer_reply(entry, rrdb_response.count);
+        }
+    };
+
+    const ::dsn::blob &hash_key = redis_req.sub_requests[1].data;
+    auto partition_hash = pegasus_hash_key_hash(hash_key);
+    client->sortkey_count(
+        hash_key, on_sortkey_count_reply, request_timeout(), 0, partition_hash);
+}
+
+// origin command format:
+// HSCAN key cursor [MATCH pattern] [COUNT count]
+// NOTE: the fields are scanned in the order of their names. A cursor other than 0 is only valid
+// in the connection where it's returned.
+void redis_parser::hscan(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() < 3) {
+        ddebug_f("{}: hscan command seqid({}) with invalid arguments",
+                 _remote_address.to_string(),
+                 entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'hscan' command");
+        return;
+    }
+    // the options are not fields, so only the key is checked.
+    if (!check_hash_arguments(entry, "hscan", redis_req.sub_requests.size(), 1)) {
+        return;
+    }
+
+    const ::dsn::blob &hash_key = redis_req.sub_requests[1].data;
+    int64_t cursor = 0;
+    std::string start_sortkey;
+    if (!dsn::buf2int64(redis_req.sub_requests[2].data, cursor) ||
+        (cursor != 0 && !load_hscan_cursor(cursor, hash_key, start_sortkey))) {
+        simple_error_reply(entry, "invalid cursor");
+        return;
+    }
+
+    int count = kDefaultHscanCount;
+    ::dsn::apps::filter_type::type filter_type = ::dsn::apps::filter_type::FT_NO_FILTER;
+    std::string filter_pattern;
+    for (size_t i = 3; i < redis_req.sub_requests.size(); i += 2) {
+        const std::string opt = redis_req.sub_requests[i].data.to_string();
+        if (i + 1 >= redis_req.sub_requests.size()) {
+            simple_error_reply(entry, "syntax error");
+            return;
+        }
+        const ::dsn::blob &value = redis_req.sub_requests[i + 1].data;
+        if (strcasecmp(opt.c_str(), "MATCH") == 0) {
+            parse_match_pattern(value.to_string(), filter_type, filter_pattern);
+        } else if (strcasecmp(opt.c_str(), "COUNT") == 0) {
+            if (!dsn::buf2int32(value, count)) {
+                simple_error_reply(entry, "value is not an integer or out of range");
+                return;
+            }
+            if (count <= 0) {
+                simple_error_reply(entry, "syntax error");
+                return;
+            }
+        } else {
+            simple_error_reply(entry, "syntax error");
+            return;
+        }
+    }
+
+    dinfo_f("{}: send hscan command seqid({})", _remote_address.to_string(), entry.sequence_id);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_multi_get_reply = [ref_this, this, &entry, start_sortkey](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            ddebug_f("{}: hscan command seqid({}) got reply, but session has reset",
+                     _remote_address.to_string(),
+                     entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            ddebug_f("{}: hscan command seqid({}) got reply with error = {}",
+                     _remote_address.to_string(),
+                     entry.sequence_id,
+                     ec.to_string());
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::multi_get_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error != 0 && rrdb_response.error != rocksdb::Status::kIncomplete) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+            return;
+        }
+
+        // like redis, fewer fields than COUNT may be returned before the scan completes, e.g.
+        // when most of the fields are filtered out. The scan is resumed from the last sort key
+        // scanned by the server, which may be beyond the last returned field.
+        int64_t next_cursor = 0;
+        if (rrdb_response.error == rocksdb::Status::kIncomplete) {
+            std::string last_sortkey;
+            if (rrdb_response.__isset.last_sortkey) {
+                last_sortkey = rrdb_response.last_sortkey.to_string();
+            } else if (!rrdb_response.kvs.empty()) {
+                last_sortkey = rrdb_response.kvs.back().key.to_string();
+            }
+            if (last_sortkey <= start_sortkey) {
+                // the server doesn't tell where it stopped, or didn't move forward, resuming from
+                // the same cursor would loop forever.
+                simple_error_reply(entry, "scan is incomplete without any progress");
+                return;
+            }
+            next_cursor =
+                save_hscan_cursor(entry.request.sub_requests[1].data, std::move(last_sortkey));
+        }
+        auto fields = std::make_shared<redis_array>();
+        fields->resize(rrdb_response.kvs.size() * 2);
+        for (size_t i = 0; i < rrdb_response.kvs.size(); ++i) {
+            fields->array[i * 2] = std::make_shared<redis_bulk_string>(rrdb_response.kvs[i].key);
+            fields->array[i * 2 + 1] =
+                std::make_shared<redis_bulk_string>(rrdb_response.kvs[i].value);
+        }
+        redis_array result;
+        result.resize(2);
+        result.array[0] = std::make_shared<redis_bulk_string>(std::to_string(next_cursor));
+        result.array[1] = fields;
+        reply_message(entry, std::move(result));
+    };
+
+    ::dsn::apps::multi_get_request req;
+    req.hash_key = hash_key;
+    req.max_kv_count = count;
+    req.max_kv_size = -1;
+    req.no_value = false;
+    // the empty sort key is excluded by the exclusive start.
+    req.start_sortkey = ::dsn::blob::create_from_bytes(std::move(start_sortkey));
+    req.start_inclusive = false;
+    req.stop_inclusive = false;
+    req.sort_key_filter_type = filter_type;
+    req.sort_key_filter_pattern = ::dsn::blob::create_from_bytes(std::move(filter_pattern));
+    req.reverse = false;
+    auto partition_hash = pegasus_hash_key_hash(req.hash_key);
+    client->multi_get(req, on_multi_get_reply, request_timeout(), 0, partition_hash);
+}
+
+int64_t redis_parser::save_hscan_cursor(const ::dsn::blob &hash_key, std::string last_sortkey)
+{
+    ::dsn::zauto_lock l(_hscan_cursor_lock);
+    if (_hscan_cursors.size() >= kMaxHscanCursorCount) {
+        _hscan_cursors.erase(_hscan_cursors.begin());
+    }
+    int64_t cursor = _next_hscan_cursor++;
+    _hscan_cursors.emplace(cursor, std::make_pair(hash_key.to_string(), std::move(last_sortkey)));
+    return cursor;
+}
+
+bool redis_parser::load_hscan_cursor(int64_t cursor,
+                                     const ::dsn::blob &hash_key,
+                                     std::string &last_sortkey)
+{
+    ::dsn::zauto_lock l(_hscan_cursor_lock);
+    auto iter = _hscan_cursors.find(cursor);
+    if (iter == _hscan_cursors.end() || iter->second.first != hash_key.to_string()) {
+        return false;
+    }
+    last_sortkey = iter->second.second;
+    return true;
+}
+
+// "prefix*" is converted to a prefix filter, by which the server only iterates the sort keys with
+// the prefix. Other patterns are converted to anchored regular expressions.
+void redis_parser::parse_match_pattern(const std::string &glob,
+                                       ::dsn::apps::filter_type::type &filter_type,
+                                       std::string &filter_pattern)
+{
+    size_t first_special = glob.find_first_of("*?[\\");
+    if (!glob.empty() && first_special + 1 == glob.length() && glob.back() == '*') {
+        filter_type = first_special == 0 ? ::dsn::apps::filter_type::FT_NO_FILTER
+                                         : ::dsn::apps::filter_type::FT_MATCH_PREFIX;
+        filter_pattern = glob.substr(0, first_special);
+        return;
+    }
+
+    // "\A" and "\z" instead of "^" and "$" anchor the whole sort key, and "[\s\S]" instead of
+    // "." matches any byte, because the sort key may contain '\n'.
+    static const char *kRegexSpecials = ".^$|()[]{}*+?\\";
+    std::string regex = "\\A";
+    for (size_t i = 0; i < glob.length(); ++i) {
+        char c = glob[i];
+        if (c == '*') {
+            regex += "[\\s\\S]*";
+        } else if (c == '?') {
+            regex += "[\\s\\S]";
+        } else if (c == '[' && glob.find(']', i + 1) != std::string::npos) {
+            size_t end = glob.find(']', i + 1);
+            regex += '[';
+            size_t j = i + 1;
+            if (j < end && glob[j] == '^') {
+                regex += '^';
+                ++j;
+            }
+            for (; j < end; ++j) {
+                if (glob[j] == '\\' || glob[j] == '[') {
+                    regex += '\\';
+                }
+                regex += glob[j];
+            }
+            regex += ']';
+            i = end;
+        } else {
+            if (c == '\\' && i + 1 < glob.length()) {
+                c = glob[++i];
+            }
+            if (c != '\0' && strchr(kRegexSpecials, c) != nullptr) {
+                regex += '\\';
+            }
+            regex += c;
+        }
+    }
+    regex += "\\z";
+    filter_type = ::dsn::apps::filter_type::FT_MATCH_REGEX;
+    filter_pattern = std::move(regex);
 }
 
 void redis_parser::parse_set_parameters(const std::vector<redis_bulk_string> &opts,
@@ -1154,7 +2306,7 @@ void redis_parser::process_geo_radius_result(message_entry &entry,
                 result.array[i++] = sub_array;
             }
         }
-        reply_message(entry, result);
+        reply_message(entry, std::move(result));
     }
 }
 
@@ -1207,7 +2359,12 @@ void redis_parser::geo_add(message_entry &entry)
         if (dsn::buf2double(lng_degree_str, lng_degree) &&
             dsn::buf2double(lat_degree_str, lat_degree)) {
             const std::string &hashkey = redis_request.sub_requests[2 + i * 3 + 2].data.to_string();
-            _geo_client->async_set(hashkey, "", lat_degree, lng_degree, set_latlng_callback, 2000);
+            _geo_client->async_set(hashkey,
+                                   "",
+                                   lat_degree,
+                                   lng_degree,
+                                   set_latlng_callback,
+                                   FLAGS_redis_request_timeout_ms);
         } else if (set_count->fetch_sub(1) == 1) {
             reply_message(entry, *result);
         }
@@ -1225,7 +2382,6 @@ void redis_parser::geo_dist(message_entry &entry)
     if (redis_request.sub_requests.size() < 4) {
         simple_error_reply(entry, "wrong number of arguments for 'geodist' command");
     } else {
-        // TODO: set the timeout
         std::string hash_key1 =
             redis_request.sub_requests[2].data.to_string(); // member1 => hash_key1
         std::string hash_key2 =
@@ -1257,7 +2413,8 @@ void redis_parser::geo_dist(message_entry &entry)
                 reply_message(entry, redis_bulk_string(std::to_string(distance)));
             }
         };
-        _geo_client->async_distance(hash_key1, "", hash_key2, "", 2000, get_callback);
+        _geo_client->async_distance(
+            hash_key1, "", hash_key2, "", FLAGS_redis_request_timeout_ms, get_callback);
     }
 }
 
@@ -1310,8 +2467,11 @@ void redis_parser::geo_pos(message_entry &entry)
     };
 
     for (int i = 0; i < member_count; ++i) {
-        _geo_client->async_get(
-            redis_request.sub_requests[i + 2].data.to_string(), "", i, get_latlng_callback, 2000);
+        _geo_client->async_get(redis_request.sub_requests[i + 2].data.to_string(),
+                               "",
+                               i,
+                               get_latlng_callback,
+                               FLAGS_redis_request_timeout_ms);
     }
 }
 
@@ -1320,7 +2480,7 @@ void redis_parser::handle_command(std::unique_ptr<message_entry> &&entry)
     message_entry &e = *entry.get();
     redis_request &request = e.request;
     e.sequence_id = ++s_next_seqid;
-    e.response.store(nullptr, std::memory_order_relaxed);
+    e.replied.store(false, std::memory_order_relaxed);
 
     dinfo("%s: new command parsed with new seqid %" PRId64 "",
           _remote_address.to_string(),
@@ -22,6 +22,8 @@
 #include <queue>
 #include <deque>
 #include <list>
+#include <map>
+#include <rrdb/rrdb_types.h>
 #include "proxy_layer.h"
 #include "geo/lib/geo_client.h"
 
@@ -107,7 +109,10 @@ protected:
     struct message_entry
     {
         redis_request request;
-        std::atomic<dsn::message_ex *> response;
+        // the reply is valid after "replied" is set, and it's serialized when all of the
+        // replies before it are ready.
+        std::unique_ptr<redis_base_type> reply;
+        std::atomic_bool replied{false};
         int64_t sequence_id = 0;
     };
 
@@ -120,6 +125,11 @@ private:
     // queue for pipeline the response
     dsn::zlock response_lock;
     std::deque<std::unique_ptr<message_entry>> pending_response;
+    // the count of the flushes requested, see reply_all_ready.
+    std::atomic<int> _flush_requests{0};
+    // the entries replied by one flush, which is only used by the flushing thread, and reused
+    // across flushes.
+    std::vector<std::unique_ptr<message_entry>> _flushing_entries;
 
     enum parser_status
     {
@@ -143,11 +153,25 @@ private:
     char *_current_buffer;
     size_t _current_buffer_length;
     size_t _current_cursor;
+    // the blob which shares the ownership of _current_buffer, so that a bulk string in it can be
+    // referenced without copy. It's empty if the message doesn't own its buffer.
+    dsn::blob _current_blob;
     // ]
 
     // for rrdb
     std::unique_ptr<::dsn::apps::rrdb_client> client;
     std::unique_ptr<geo::geo_client> _geo_client;
+    // for the commands on multiple keys, which group the keys by partition like pegasus_client
+    // does, e.g. MGET. It's shared by all the sessions of the proxy_stub, and owned by
+    // pegasus_client_factory.
+    pegasus_client *_pegasus_client = nullptr;
+
+    // the cursors of HSCAN. The cursor replied to the client is an integer, which is mapped to the
+    // hash key and the last sort key it scanned. The oldest cursors are dropped if there are too
+    // many of them.
+    dsn::zlock _hscan_cursor_lock;
+    std::map<int64_t, std::pair<std::string, std::string>> _hscan_cursors;
+    int64_t _next_hscan_cursor = 1;
 
 protected:
     // function for data stream
@@ -156,11 +180,14 @@ protected:
     char peek();
     bool eat(char c);
     void eat_all(char *dest, size_t length);
+    // skip `length` bytes, all of which must be in current buffer.
+    void advance(size_t length);
     void reset_parser();
 
     // function for parser
-    bool end_array_size();
-    bool end_bulk_string_size();
+    bool parse_size(dsn::string_view size_str, int32_t &size);
+    bool end_array_size(int32_t count);
+    bool end_bulk_string_size(int32_t length);
     void append_current_bulk_string();
     bool parse_stream();
 
@@ -186,6 +213,18 @@ protected:
     DECLARE_REDIS_HANDLER(incr_by)
     DECLARE_REDIS_HANDLER(decr)
     DECLARE_REDIS_HANDLER(decr_by)
+    DECLARE_REDIS_HANDLER(mget)
+    DECLARE_REDIS_HANDLER(mset)
+    DECLARE_REDIS_HANDLER(exists)
+    DECLARE_REDIS_HANDLER(expire)
+    DECLARE_REDIS_HANDLER(unlink)
+    DECLARE_REDIS_HANDLER(hset)
+    DECLARE_REDIS_HANDLER(hget)
+    DECLARE_REDIS_HANDLER(hmget)
+    DECLARE_REDIS_HANDLER(hgetall)
+    DECLARE_REDIS_HANDLER(hdel)
+    DECLARE_REDIS_HANDLER(hlen)
+    DECLARE_REDIS_HANDLER(hscan)
     DECLARE_REDIS_HANDLER(default_handler)
 
     void set_internal(message_entry &entry);
@@ -193,6 +232,26 @@ protected:
     void del_internal(message_entry &entry);
     void del_geo_internal(message_entry &entry);
     void counter_internal(message_entry &entry);
+    // read the keys of MGET/EXISTS by one batch_get rpc per partition.
+    void batch_get_internal(message_entry &entry, bool exists_only);
+    void expire_internal(message_entry &entry, int32_t ttl_seconds, int retry_count);
+    // check the key and the fields of a hash command, which are used as hash key and sort keys.
+    bool check_hash_arguments(message_entry &entry,
+                              const char *command,
+                              size_t first_field_index,
+                              size_t field_step);
+    // read all of the fields of a hash page by page, starting after `start_sortkey`.
+    // `result_size` is the size of the fields accumulated in `result`.
+    void hgetall_internal(message_entry &entry,
+                          std::shared_ptr<redis_array> result,
+                          uint64_t result_size,
+                          const ::dsn::blob &start_sortkey);
+    int64_t save_hscan_cursor(const ::dsn::blob &hash_key, std::string last_sortkey);
+    bool load_hscan_cursor(int64_t cursor, const ::dsn::blob &hash_key, std::string &last_sortkey);
+    // convert a glob-style pattern of redis to a sort key filter of pegasus.
+    static void parse_match_pattern(const std::string &glob,
+                                    ::dsn::apps::filter_type::type &filter_type,
+                                    std::string &filter_pattern);
     static void parse_set_parameters(const std::vector<redis_bulk_string> &opts, int &ttl_seconds);
     static void parse_geo_radius_parameters(const std::vector<redis_bulk_string> &opts,
                                             int base_index,
@@ -213,22 +272,19 @@ protected:
 
     // function for pipeline reply
     void enqueue_pending_response(std::unique_ptr<message_entry> &&entry);
-    void fetch_and_dequeue_messages(std::vector<dsn::message_ex *> &msgs, bool only_ready_ones);
     void clear_reply_queue();
     void reply_all_ready();
+    // send all of the ready replies at the head of the queue by one response.
+    void flush_ready_replies();
+    // this is virtual only because we can override and test the replies
+    virtual void send_response(dsn::message_ex *resp);
 
     template <typename T>
-    void reply_message(message_entry &entry, const T &value)
+    void reply_message(message_entry &entry, T &&value)
     {
-        dsn::message_ex *resp = create_response();
-        // release in reply_all_ready or reset
-        resp->add_ref();
-
-        dsn::rpc_write_stream s(resp);
-        value.marshalling(s);
-        s.commit_buffer();
-
-        entry.response.store(resp, std::memory_order_release);
+        entry.reply.reset(new typename std::decay<T>::type(std::forward<T>(value)));
+        // the entry may be released by another thread once "replied" is set.
+        entry.replied.store(true, std::memory_order_release);
         reply_all_ready();
     }
 
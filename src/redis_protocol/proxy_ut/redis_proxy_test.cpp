@@ -132,10 +132,26 @@ protected:
             }
         }
 
+        _last_request = act_request;
         _got_a_message = true;
         ++_entry_index;
     }
 
+    void send_response(dsn::message_ex *resp) override
+    {
+        dsn::message_ex *msg = resp->copy(true, true);
+        msg->add_ref();
+        std::string data;
+        void *rw_ptr;
+        size_t length;
+        while (msg->read_next(&rw_ptr, &length)) {
+            data.append(static_cast<const char *>(rw_ptr), length);
+            msg->read_commit(length);
+        }
+        msg->release_ref();
+        _sent_responses.emplace_back(std::move(data));
+    }
+
 private:
     friend class proxy_test;
     FRIEND_TEST(proxy_test, test_simple_cases);
@@ -147,8 +163,12 @@ private:
     FRIEND_TEST(proxy_test, test_nil_bulk_string);
     FRIEND_TEST(proxy_test, test_random_cases);
     FRIEND_TEST(proxy_test, test_parse_parameters);
+    FRIEND_TEST(proxy_test, test_zero_copy_bulk_string);
+    FRIEND_TEST(proxy_test, test_coalesced_replies);
 
     std::vector<std::unique_ptr<message_entry>> _reserved_entry;
+    redis_request _last_request;
+    std::vector<std::string> _sent_responses;
     int _entry_index;
     bool _got_a_message;
 };
@@ -174,6 +194,8 @@ public:
     bool parse(dsn::message_ex *msg) { return _parser->parse(msg); }
     bool got_message() { return _parser->_got_a_message; }
     int parsed_entry_count() { return _parser->_entry_index; }
+    const redis_parser::redis_request &last_request() { return _parser->_last_request; }
+    redis_test_parser &test_parser() { return *_parser; }
 
 private:
     std::shared_ptr<redis_test_parser> _parser;
@@ -272,6 +294,64 @@ TEST_F(proxy_test, test_nil_bulk_string)
     ASSERT_TRUE(got_message());
 }
 
+TEST_F(proxy_test, test_zero_copy_bulk_string)
+{
+    redis_test_parser::redis_request request(3, {{"SET"}, {"foo"}, {std::string(1000, 'v')}});
+    set_msg(0, request);
+    dsn::message_ex *response = redis_test_parser::marshalling_array(request);
+    // the copied message owns its buffers, like the messages received from network.
+    dsn::message_ex *msg = response->copy(true, true);
+    response->add_ref();
+    response->release_ref();
+
+    msg->add_ref();
+    ASSERT_TRUE(parse(msg));
+    ASSERT_TRUE(got_message());
+
+    // the bulk strings reference the buffers of the message instead of copies.
+    for (const auto &str : last_request().sub_requests) {
+        bool in_message = false;
+        for (const dsn::blob &bb : msg->buffers) {
+            if (str.data.data() >= bb.data() && str.data.data() < bb.data() + bb.length()) {
+                in_message = true;
+            }
+        }
+        ASSERT_TRUE(in_message);
+    }
+    msg->release_ref();
+}
+
+TEST_F(proxy_test, test_coalesced_replies)
+{
+    redis_test_parser &parser = test_parser();
+    auto new_entry = [&parser]() {
+        std::unique_ptr<redis_test_parser::message_entry> entry(
+            new redis_test_parser::message_entry());
+        redis_test_parser::message_entry *e = entry.get();
+        parser.enqueue_pending_response(std::move(entry));
+        return e;
+    };
+    std::vector<redis_test_parser::message_entry *> entries;
+    for (int i = 0; i < 3; ++i) {
+        entries.push_back(new_entry());
+    }
+
+    // the replies are not sent until all of the replies before them are ready.
+    parser.simple_integer_reply(*entries[2], 3);
+    parser.simple_ok_reply(*entries[1]);
+    ASSERT_TRUE(parser._sent_responses.empty());
+
+    // then all of the ready replies are sent in order by one response.
+    parser.simple_integer_reply(*entries[0], 1);
+    ASSERT_EQ(1u, parser._sent_responses.size());
+    ASSERT_EQ(":1\r\n+OK\r\n:3\r\n", parser._sent_responses[0]);
+
+    // a reply is sent at once if there is no reply before it.
+    parser.simple_error_reply(*new_entry(), "error");
+    ASSERT_EQ(2u, parser._sent_responses.size());
+    ASSERT_EQ("-ERR error\r\n", parser._sent_responses[1]);
+}
+
 TEST_F(proxy_test, test_random_cases)
 {
     int total_requests = 10;
@@ -497,6 +577,32 @@ TEST_F(proxy_test, test_parse_parameters)
         redis_test_parser::parse_set_parameters(opts, ttl_seconds);
         ASSERT_EQ(ttl_seconds, 123);
     }
+
+    {
+        struct test_case
+        {
+            std::string glob;
+            ::dsn::apps::filter_type::type filter_type;
+            std::string filter_pattern;
+        } tests[] = {
+            {"*", ::dsn::apps::filter_type::FT_NO_FILTER, ""},
+            {"abc*", ::dsn::apps::filter_type::FT_MATCH_PREFIX, "abc"},
+            {"abc", ::dsn::apps::filter_type::FT_MATCH_REGEX, "\\Aabc\\z"},
+            {"", ::dsn::apps::filter_type::FT_MATCH_REGEX, "\\A\\z"},
+            {"*abc", ::dsn::apps::filter_type::FT_MATCH_REGEX, "\\A[\\s\\S]*abc\\z"},
+            {"a?c", ::dsn::apps::filter_type::FT_MATCH_REGEX, "\\Aa[\\s\\S]c\\z"},
+            {"h[^e]llo", ::dsn::apps::filter_type::FT_MATCH_REGEX, "\\Ah[^e]llo\\z"},
+            {"a.c\\*", ::dsn::apps::filter_type::FT_MATCH_REGEX, "\\Aa\\.c\\*\\z"},
+            {"a[b", ::dsn::apps::filter_type::FT_MATCH_REGEX, "\\Aa\\[b\\z"},
+        };
+        for (const auto &test : tests) {
+            ::dsn::apps::filter_type::type filter_type;
+            std::string filter_pattern;
+            redis_test_parser::parse_match_pattern(test.glob, filter_type, filter_pattern);
+            ASSERT_EQ(test.filter_type, filter_type) << test.glob;
+            ASSERT_EQ(test.filter_pattern, filter_pattern) << test.glob;
+        }
+    }
 }
 
 TEST(proxy, connection)
@@ -592,6 +698,60 @@ TEST(proxy, connection)
         ASSERT_STREQ(resps, got_reply);
     }
 
+    // commands on multiple keys
+    {
+        const char *req = "*5\r\n$4\r\nMSET\r\n$2\r\nk1\r\n$2\r\nv1\r\n$2\r\nk2\r\n$2\r\nv2\r\n"
+                          "*4\r\n$4\r\nMGET\r\n$2\r\nk1\r\n$2\r\nk3\r\n$2\r\nk2\r\n"
+                          "*4\r\n$6\r\nEXISTS\r\n$2\r\nk1\r\n$2\r\nk2\r\n$2\r\nk3\r\n"
+                          "*3\r\n$6\r\nEXPIRE\r\n$2\r\nk1\r\n$4\r\n9999\r\n"
+                          "*3\r\n$7\r\nPEXPIRE\r\n$2\r\nk3\r\n$4\r\n9999\r\n"
+                          "*3\r\n$6\r\nUNLINK\r\n$2\r\nk1\r\n$2\r\nk2\r\n"
+                          "*3\r\n$6\r\nEXISTS\r\n$2\r\nk1\r\n$2\r\nk2\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = "+OK\r\n"
+                            "*3\r\n$2\r\nv1\r\n$-1\r\n$2\r\nv2\r\n"
+                            ":2\r\n"
+                            ":1\r\n"
+                            ":0\r\n"
+                            ":2\r\n"
+                            ":0\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
+    // hash commands
+    {
+        const char *req = "*5\r\n$4\r\nHDEL\r\n$2\r\nh1\r\n$2\r\nf1\r\n$2\r\nf2\r\n$2\r\nf3\r\n"
+                          "*6\r\n$4\r\nHSET\r\n$2\r\nh1\r\n$2\r\nf1\r\n$2\r\nv1\r\n$2\r\nf2\r\n$2\r\nv2\r\n"
+                          "*4\r\n$5\r\nHMSET\r\n$2\r\nh1\r\n$2\r\nf3\r\n$2\r\nv3\r\n"
+                          "*3\r\n$4\r\nHGET\r\n$2\r\nh1\r\n$2\r\nf1\r\n"
+                          "*5\r\n$5\r\nHMGET\r\n$2\r\nh1\r\n$2\r\nf3\r\n$2\r\nf4\r\n$2\r\nf1\r\n"
+                          "*2\r\n$4\r\nHLEN\r\n$2\r\nh1\r\n"
+                          "*2\r\n$7\r\nHGETALL\r\n$2\r\nh1\r\n"
+                          "*5\r\n$5\r\nHSCAN\r\n$2\r\nh1\r\n$1\r\n0\r\n$5\r\nMATCH\r\n$6\r\nf[13]*\r\n"
+                          "*5\r\n$4\r\nHDEL\r\n$2\r\nh1\r\n$2\r\nf1\r\n$2\r\nf2\r\n$2\r\nf3\r\n"
+                          "*2\r\n$4\r\nHLEN\r\n$2\r\nh1\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = ":3\r\n"
+                            ":2\r\n"
+                            "+OK\r\n"
+                            "$2\r\nv1\r\n"
+                            "*3\r\n$2\r\nv3\r\n$-1\r\n$2\r\nv1\r\n"
+                            ":3\r\n"
+                            "*6\r\n$2\r\nf1\r\n$2\r\nv1\r\n$2\r\nf2\r\n$2\r\nv2\r\n$2\r\nf3\r\n$2\r\nv3\r\n"
+                            "*2\r\n$1\r\n0\r\n*4\r\n$2\r\nf1\r\n$2\r\nv1\r\n$2\r\nf3\r\n$2\r\nv3\r\n"
+                            ":3\r\n"
+                            ":0\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
     // let's send partitial message then close the socket
     {
         const char *req = "*3\r\n$3\r\nSET\r\n$3\r\nfoo\r\n$4\r\nbar1\r\n"
@@ -0,0 +1,136 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <vector>
+
+#include <dsn/utility/rand.h>
+#include <dsn/utility/string_conv.h>
+
+#include "server/key_filter_matcher.h"
+#include "server_bench.h"
+
+namespace pegasus {
+namespace server {
+
+// the implementation before the filters are compiled into key_filter_matcher, which switches on
+// the filter type for every row.
+static bool validate_filter(::dsn::apps::filter_type::type filter_type,
+                            const std::string &filter_pattern,
+                            const std::string &value)
+{
+    switch (filter_type) {
+    case ::dsn::apps::filter_type::FT_NO_FILTER:
+        return true;
+    case ::dsn::apps::filter_type::FT_MATCH_ANYWHERE:
+    case ::dsn::apps::filter_type::FT_MATCH_PREFIX:
+    case ::dsn::apps::filter_type::FT_MATCH_POSTFIX: {
+        if (filter_pattern.length() == 0)
+            return true;
+        if (value.length() < filter_pattern.length())
+            return false;
+        if (filter_type == ::dsn::apps::filter_type::FT_MATCH_ANYWHERE) {
+            return dsn::string_view(value).find(filter_pattern) != dsn::string_view::npos;
+        } else if (filter_type == ::dsn::apps::filter_type::FT_MATCH_PREFIX) {
+            return ::memcmp(value.data(), filter_pattern.data(), filter_pattern.length()) == 0;
+        } else {
+            return ::memcmp(value.data() + value.length() - filter_pattern.length(),
+                            filter_pattern.data(),
+                            filter_pattern.length()) == 0;
+        }
+    }
+    default:
+        return false;
+    }
+}
+
+namespace bench {
+
+// compares the per-row filter validation with the compiled key_filter_matcher, on the keys
+// which seldom match the pattern, as the usual case of scanning with a filter.
+// USAGE: key_filter [row_count] [key_size] [times]
+int key_filter_bench(int argc, char **argv)
+{
+    int row_count = 1000;
+    int key_size = 64;
+    int times = 1000;
+    if ((argc > 1 && !dsn::buf2int32(argv[1], row_count)) ||
+        (argc > 2 && !dsn::buf2int32(argv[2], key_size)) ||
+        (argc > 3 && !dsn::buf2int32(argv[3], times))) {
+        std::cerr << "USAGE: key_filter [row_count] [key_size] [times]" << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < row_count; ++i) {
+        std::string key(key_size, 'a');
+        for (auto &c : key) {
+            c = static_cast<char>('a' + dsn::rand::next_u32(0, 25));
+        }
+        keys.emplace_back(std::move(key));
+    }
+    const std::string pattern = "pegasus";
+
+    std::cout << "row_count = " << row_count << ", key_size = " << key_size
+              << ", times = " << times << std::endl;
+
+    const ::dsn::apps::filter_type::type types[] = {::dsn::apps::filter_type::FT_MATCH_ANYWHERE,
+                                                    ::dsn::apps::filter_type::FT_MATCH_PREFIX,
+                                                    ::dsn::apps::filter_type::FT_MATCH_POSTFIX};
+    for (auto type : types) {
+        const std::string type_name = ::dsn::apps::_filter_type_VALUES_TO_NAMES.find(type)->second;
+        int matched = 0;
+        run_case("validate_filter_" + type_name, times, [&]() {
+            for (const auto &key : keys) {
+                matched += validate_filter(type, pattern, key);
+            }
+        });
+
+        key_filter_matcher matcher(type, pattern);
+        run_case("key_filter_matcher_" + type_name, times, [&]() {
+            for (const auto &key : keys) {
+                matched += matcher.match(key);
+            }
+        });
+        std::cout << "matched = " << matched << std::endl;
+    }
+
+#if defined(__x86_64__)
+    // compares the implementations of FT_MATCH_ANYWHERE directly.
+    std::vector<std::pair<std::string, key_filter_impl::match_anywhere_func>> impls = {
+        {"match_anywhere_scalar", key_filter_impl::match_anywhere_scalar},
+        {"match_anywhere_sse2", key_filter_impl::match_anywhere_sse2}};
+    if (__builtin_cpu_supports("avx2")) {
+        impls.emplace_back("match_anywhere_avx2", key_filter_impl::match_anywhere_avx2);
+    }
+    for (const auto &impl : impls) {
+        int matched = 0;
+        run_case(impl.first, times, [&]() {
+            for (const auto &key : keys) {
+                matched += impl.second(key, pattern);
+            }
+        });
+        std::cout << "matched = " << matched << std::endl;
+    }
+#endif
+
+    return 0;
+}
+
+} // namespace bench
+} // namespace server
+} // namespace pegasus
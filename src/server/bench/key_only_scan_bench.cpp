@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <dsn/utility/string_conv.h>
+#include <rocksdb/db.h>
+#include <rocksdb/write_batch.h>
+
+#include "base/pegasus_key_schema.h"
+#include "base/pegasus_value_schema.h"
+#include "base/pegasus_utils.h"
+#include "server_bench.h"
+
+namespace pegasus {
+namespace server {
+namespace bench {
+
+// counts the rows of one hash key without reading the values, like sortkey_count and the scans
+// with no_value do, from the data column family vs. the key column family which only keeps the
+// expire_ts of each row (see ROCKSDB_SEPARATE_KEY_CF).
+// USAGE: key_only_scan [db_path] [value_size] [row_count] [times]
+int key_only_scan_bench(int argc, char **argv)
+{
+    std::string db_path = "./key_only_scan_bench_db";
+    int value_size = 1024;
+    int row_count = 20000;
+    int times = 10;
+    if (argc > 1) {
+        db_path = argv[1];
+    }
+    if ((argc > 2 && !dsn::buf2int32(argv[2], value_size)) ||
+        (argc > 3 && !dsn::buf2int32(argv[3], row_count)) ||
+        (argc > 4 && !dsn::buf2int32(argv[4], times))) {
+        std::cerr << "USAGE: key_only_scan [db_path] [value_size] [row_count] [times]"
+                  << std::endl;
+        return -1;
+    }
+
+    const uint32_t data_version = 1;
+    const std::string hash_key = "key_only_scan_bench_hash_key";
+
+    rocksdb::Options options;
+    options.create_if_missing = true;
+    options.create_missing_column_families = true;
+    rocksdb::DestroyDB(db_path, options);
+    std::vector<rocksdb::ColumnFamilyDescriptor> column_families(
+        {{rocksdb::kDefaultColumnFamilyName, options}, {"key", options}});
+    std::vector<rocksdb::ColumnFamilyHandle *> handles;
+    rocksdb::DB *db = nullptr;
+    rocksdb::Status status = rocksdb::DB::Open(options, db_path, column_families, &handles, &db);
+    if (!status.ok()) {
+        std::cerr << "open db " << db_path << " failed: " << status.ToString() << std::endl;
+        return -1;
+    }
+    std::unique_ptr<rocksdb::DB> db_holder(db);
+    rocksdb::ColumnFamilyHandle *data_cf = handles[0];
+    rocksdb::ColumnFamilyHandle *key_cf = handles[1];
+
+    // prepare data like rocksdb_wrapper does, and flush it to make the reads go through the sst
+    // files like the most of the rows
+    pegasus_value_generator gen;
+    std::string user_data(value_size, 'v');
+    const int batch_size = 100;
+    for (int i = 0; i < row_count && status.ok(); i += batch_size) {
+        rocksdb::WriteBatch batch;
+        for (int j = i; j < std::min(i + batch_size, row_count); ++j) {
+            dsn::blob raw_key;
+            pegasus_generate_key(raw_key, hash_key, "sort_key_" + std::to_string(j));
+            rocksdb::Slice key(raw_key.data(), raw_key.length());
+            batch.Put(data_cf,
+                      rocksdb::SliceParts(&key, 1),
+                      gen.generate_value(data_version, user_data, 0, 0));
+            batch.Put(key_cf,
+                      rocksdb::SliceParts(&key, 1),
+                      gen.generate_value(0, dsn::string_view(), 0, 0));
+        }
+        status = db->Write(rocksdb::WriteOptions(), &batch);
+    }
+    if (status.ok()) {
+        status = db->Flush(rocksdb::FlushOptions(), handles);
+    }
+    if (!status.ok()) {
+        std::cerr << "prepare data failed: " << status.ToString() << std::endl;
+        return -1;
+    }
+
+    std::cout << "value_size = " << value_size << ", row_count = " << row_count
+              << ", times = " << times << std::endl;
+
+    dsn::blob start_key, stop_key;
+    pegasus_generate_key(start_key, hash_key, std::string());
+    pegasus_generate_next_blob(stop_key, hash_key);
+    rocksdb::Slice start(start_key.data(), start_key.length());
+    rocksdb::Slice stop(stop_key.data(), stop_key.length());
+    auto count = [&](rocksdb::ColumnFamilyHandle *cf, uint32_t version) {
+        rocksdb::ReadOptions rd_opts;
+        rd_opts.iterate_upper_bound = &stop;
+        std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(rd_opts, cf));
+        uint32_t epoch_now = utils::epoch_now();
+        int counted = 0;
+        for (it->Seek(start); it->Valid(); it->Next()) {
+            uint32_t expire_ts =
+                pegasus_extract_expire_ts(version, utils::to_string_view(it->value()));
+            if (!check_if_ts_expired(epoch_now, expire_ts)) {
+                counted++;
+            }
+        }
+        if (counted != row_count) {
+            std::cerr << "counted " << counted << " rows, expected " << row_count << std::endl;
+        }
+    };
+
+    run_case("count_data_cf", times, [&]() { count(data_cf, data_version); });
+    run_case("count_key_cf", times, [&]() { count(key_cf, 0); });
+
+    for (auto handle : handles) {
+        db->DestroyColumnFamilyHandle(handle);
+    }
+    db_holder.reset();
+    rocksdb::DestroyDB(db_path, options);
+    return 0;
+}
+
+} // namespace bench
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "server_bench.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <new>
+
+static std::atomic<uint64_t> s_allocation_count{0};
+
+void *operator new(size_t size)
+{
+    s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+namespace pegasus {
+namespace server {
+namespace bench {
+
+uint64_t allocation_count() { return s_allocation_count.load(std::memory_order_relaxed); }
+
+} // namespace bench
+} // namespace server
+} // namespace pegasus
+
+using namespace pegasus::server::bench;
+
+static const std::map<std::string, std::function<int(int, char **)>> s_cases = {
+    {"response_arena", response_arena_bench},
+    {"multi_get", multi_get_bench},
+    {"key_filter", key_filter_bench},
+    {"key_only_scan", key_only_scan_bench},
+};
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || s_cases.find(argv[1]) == s_cases.end()) {
+        std::cerr << "USAGE: " << argv[0] << " <case> [args...]" << std::endl;
+        std::cerr << "cases:" << std::endl;
+        for (const auto &kv : s_cases) {
+            std::cerr << "  " << kv.first << std::endl;
+        }
+        return -1;
+    }
+
+    return s_cases.at(argv[1])(argc - 1, argv + 1);
+}
@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <vector>
+#include <algorithm>
+#include <vector>
+
+#include <dsn/utility/rand.h>
+#include <dsn/utility/string_conv.h>
+#include <rocksdb/db.h>
+#include <rocksdb/write_batch.h>
+
+#include "base/pegasus_key_schema.h"
+#include "base/pegasus_value_schema.h"
+#include "server_bench.h"
+
+namespace pegasus {
+namespace server {
+namespace bench {
+
+// compares the ways of reading an explicit sort keys list of one hash key: calling Get for each
+// key vs. calling the batched MultiGet with the sorted keys.
+// USAGE: multi_get [db_path] [value_size] [times]
+int multi_get_bench(int argc, char **argv)
+{
+    std::string db_path = "./multi_get_bench_db";
+    int value_size = 100;
+    int times = 1000;
+    if (argc > 1) {
+        db_path = argv[1];
+    }
+    if ((argc > 2 && !dsn::buf2int32(argv[2], value_size)) ||
+        (argc > 3 && !dsn::buf2int32(argv[3], times))) {
+        std::cerr << "USAGE: multi_get [db_path] [value_size] [times]" << std::endl;
+        return -1;
+    }
+
+    const int sort_key_count = 10000;
+    const uint32_t data_version = 1;
+    const std::string hash_key = "multi_get_bench_hash_key";
+
+    rocksdb::Options options;
+    options.create_if_missing = true;
+    rocksdb::DestroyDB(db_path, options);
+    rocksdb::DB *db = nullptr;
+    rocksdb::Status status = rocksdb::DB::Open(options, db_path, &db);
+    if (!status.ok()) {
+        std::cerr << "open db " << db_path << " failed: " << status.ToString() << std::endl;
+        return -1;
+    }
+    std::unique_ptr<rocksdb::DB> db_holder(db);
+
+    // prepare data, and flush it to make the reads go through the sst files
+    pegasus_value_generator gen;
+    std::string user_data(value_size, 'v');
+    rocksdb::WriteBatch batch;
+    for (int i = 0; i < sort_key_count; ++i) {
+        dsn::blob raw_key;
+        pegasus_generate_key(raw_key, hash_key, "sort_key_" + std::to_string(i));
+        rocksdb::Slice key(raw_key.data(), raw_key.length());
+        batch.Put(rocksdb::SliceParts(&key, 1), gen.generate_value(data_version, user_data, 0, 0));
+    }
+    status = db->Write(rocksdb::WriteOptions(), &batch);
+    if (status.ok()) {
+        status = db->Flush(rocksdb::FlushOptions());
+    }
+    if (!status.ok()) {
+        std::cerr << "prepare data failed: " << status.ToString() << std::endl;
+        return -1;
+    }
+
+    std::cout << "value_size = " << value_size << ", times = " << times << std::endl;
+
+    for (int key_count : {10, 100, 1000}) {
+        // pick the sort keys randomly, in random order
+        std::vector<dsn::blob> raw_keys;
+        for (int i = 0; i < key_count; ++i) {
+            dsn::blob raw_key;
+            int id = dsn::rand::next_u32(0, sort_key_count - 1);
+            pegasus_generate_key(raw_key, hash_key, "sort_key_" + std::to_string(id));
+            raw_keys.emplace_back(std::move(raw_key));
+        }
+
+        run_case("get_loop_" + std::to_string(key_count), times, [&]() {
+            for (const auto &raw_key : raw_keys) {
+                rocksdb::PinnableSlice value;
+                db->Get(rocksdb::ReadOptions(),
+                        db->DefaultColumnFamily(),
+                        rocksdb::Slice(raw_key.data(), raw_key.length()),
+                        &value);
+            }
+        });
+
+        run_case("sorted_multi_get_" + std::to_string(key_count), times, [&]() {
+            std::vector<rocksdb::Slice> keys;
+            keys.reserve(raw_keys.size());
+            for (const auto &raw_key : raw_keys) {
+                keys.emplace_back(raw_key.data(), raw_key.length());
+            }
+            std::sort(keys.begin(),
+                      keys.end(),
+                      [](const rocksdb::Slice &l, const rocksdb::Slice &r) {
+                          return l.compare(r) < 0;
+                      });
+            std::vector<rocksdb::PinnableSlice> values(keys.size());
+            std::vector<rocksdb::Status> statuses(keys.size());
+            db->MultiGet(rocksdb::ReadOptions(),
+                         db->DefaultColumnFamily(),
+                         keys.size(),
+                         keys.data(),
+                         values.data(),
+                         statuses.data(),
+                         true /* sorted_input */);
+        });
+    }
+
+    db_holder.reset();
+    rocksdb::DestroyDB(db_path, options);
+    return 0;
+}
+
+} // namespace bench
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <vector>
+
+#include <dsn/utility/string_conv.h>
+#include <rrdb/rrdb_types.h>
+
+#include "base/pegasus_value_schema.h"
+#include "server/response_arena.h"
+#include "server_bench.h"
+
+namespace pegasus {
+namespace server {
+namespace bench {
+
+// compares the way of building the kvs of a scan_response: allocating buffers per kv vs.
+// allocating them from a response_arena.
+// USAGE: response_arena [row_count] [value_size] [times]
+int response_arena_bench(int argc, char **argv)
+{
+    int row_count = 1000;
+    int value_size = 100;
+    int times = 1000;
+    if ((argc > 1 && !dsn::buf2int32(argv[1], row_count)) ||
+        (argc > 2 && !dsn::buf2int32(argv[2], value_size)) ||
+        (argc > 3 && !dsn::buf2int32(argv[3], times))) {
+        std::cerr << "USAGE: response_arena [row_count] [value_size] [times]" << std::endl;
+        return -1;
+    }
+
+    const uint32_t data_version = 1;
+    std::vector<std::string> raw_keys;
+    std::vector<std::string> raw_values;
+    pegasus_value_generator gen;
+    std::string user_data(value_size, 'v');
+    for (int i = 0; i < row_count; ++i) {
+        raw_keys.emplace_back("hash_key_" + std::to_string(i) + "sort_key_" + std::to_string(i));
+        rocksdb::SliceParts sparts = gen.generate_value(data_version, user_data, 0, 0);
+        std::string raw_value;
+        for (int j = 0; j < sparts.num_parts; j++) {
+            raw_value += sparts.parts[j].ToString();
+        }
+        raw_values.emplace_back(std::move(raw_value));
+    }
+
+    std::cout << "row_count = " << row_count << ", value_size = " << value_size
+              << ", times = " << times << std::endl;
+
+    run_case("per_kv_allocation", times, [&]() {
+        std::vector<::dsn::apps::key_value> kvs;
+        kvs.reserve(row_count);
+        for (int i = 0; i < row_count; ++i) {
+            ::dsn::apps::key_value kv;
+            const std::string &key = raw_keys[i];
+            std::shared_ptr<char> key_buf(::dsn::utils::make_shared_array<char>(key.length()));
+            ::memcpy(key_buf.get(), key.data(), key.length());
+            kv.key.assign(std::move(key_buf), 0, key.length());
+            std::string value_buf(raw_values[i].data(), raw_values[i].size());
+            pegasus_extract_user_data(data_version, std::move(value_buf), kv.value);
+            kvs.emplace_back(std::move(kv));
+        }
+    });
+
+    run_case("response_arena", times, [&]() {
+        std::vector<::dsn::apps::key_value> kvs;
+        kvs.reserve(row_count);
+        response_arena arena;
+        for (int i = 0; i < row_count; ++i) {
+            ::dsn::apps::key_value kv;
+            kv.key = arena.copy(raw_keys[i]);
+            kv.value = arena.copy(pegasus_extract_user_data_view(data_version, raw_values[i]));
+            kvs.emplace_back(std::move(kv));
+        }
+    });
+
+    return 0;
+}
+
+} // namespace bench
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace pegasus {
+namespace server {
+namespace bench {
+
+// the count of heap allocations made by 'operator new' since the process started.
+uint64_t allocation_count();
+
+// measures the time and heap allocations of 'func' running 'times' times.
+template <typename Func>
+void run_case(const std::string &name, int times, Func &&func)
+{
+    uint64_t start_allocs = allocation_count();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < times; ++i) {
+        func();
+    }
+    auto end = std::chrono::steady_clock::now();
+    uint64_t allocs = allocation_count() - start_allocs;
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::cout << name << ": " << ns / times << " ns/op, " << allocs / times << " allocs/op"
+              << std::endl;
+}
+
+// each benchmark case returns 0 if succeed.
+int response_arena_bench(int argc, char **argv);
+int multi_get_bench(int argc, char **argv);
+int key_filter_bench(int argc, char **argv);
+int key_only_scan_bench(int argc, char **argv);
+
+} // namespace bench
+} // namespace server
+} // namespace pegasus
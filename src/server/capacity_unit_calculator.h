@@ -43,9 +43,16 @@ public:
                           int32_t status,
                           const dsn::blob &hash_key,
                           const std::vector<::dsn::apps::key_value> &kvs);
+    void add_batch_get_cu(dsn::message_ex *req,
+                          int32_t status,
+                          const std::vector<::dsn::apps::full_data> &datas);
     void add_scan_cu(dsn::message_ex *req,
                      int32_t status,
                      const std::vector<::dsn::apps::key_value> &kvs);
+    // the aggregation is charged as if the aggregated rows were returned.
+    void add_scan_aggregate_cu(dsn::message_ex *req,
+                               int32_t status,
+                               const ::dsn::apps::scan_aggregate_result &aggregate);
     void add_sortkey_count_cu(dsn::message_ex *req, int32_t status, const dsn::blob &hash_key);
     void add_ttl_cu(dsn::message_ex *req, int32_t status, const dsn::blob &key);
 
@@ -82,6 +89,8 @@ protected:
 #endif
 
 private:
+    void add_scan_bytes_cu(dsn::message_ex *req, int32_t status, int64_t data_size);
+
     uint64_t _read_capacity_unit_size;
     uint64_t _write_capacity_unit_size;
     uint32_t _log_read_cu_size;
@@ -92,6 +101,7 @@ private:
 
     ::dsn::perf_counter_wrapper _pfc_get_bytes;
     ::dsn::perf_counter_wrapper _pfc_multi_get_bytes;
+    ::dsn::perf_counter_wrapper _pfc_batch_get_bytes;
     ::dsn::perf_counter_wrapper _pfc_scan_bytes;
     ::dsn::perf_counter_wrapper _pfc_put_bytes;
     ::dsn::perf_counter_wrapper _pfc_multi_put_bytes;
@@ -103,7 +113,9 @@ private:
         hotkey capturing weight rules:
             add_get_cu: whether find the key or not, weight = 1(read_collector),
             add_multi_get_cu: weight = returned sortkey count(read_collector),
+            add_batch_get_cu: weight = 1 for each returned key(read_collector),
             add_scan_cu : not capture now,
+            add_scan_aggregate_cu : not capture now,
             add_sortkey_count_cu: weight = 1(read_collector),
             add_ttl_cu: weight = 1(read_collector),
             add_put_cu: weight = 1(write_collector),
@@ -0,0 +1,237 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "compaction_scheduler.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include <dsn/dist/fmt_logging.h>
+#include <dsn/tool-api/async_calls.h>
+#include <dsn/utility/flags.h>
+
+namespace pegasus {
+namespace server {
+
+DEFINE_TASK_CODE(LPC_MANUAL_COMPACT_SCHEDULE, TASK_PRIORITY_COMMON, ::dsn::THREAD_POOL_DEFAULT)
+
+DSN_DEFINE_uint32("pegasus.server",
+                  manual_compact_schedule_interval_ms,
+                  1000,
+                  "the interval of checking whether the queued manual compactions can be started");
+
+DSN_DEFINE_uint32("pegasus.server",
+                  manual_compact_stagger_interval_s,
+                  10,
+                  "min interval between the starts of two manual compactions on one server, in "
+                  "seconds, 0 means no interval");
+DSN_TAG_VARIABLE(manual_compact_stagger_interval_s, FT_MUTABLE);
+
+DSN_DEFINE_uint32("pegasus.server",
+                  manual_compact_server_max_running_count,
+                  0,
+                  "max count of the running manual compactions on one server, 0 means no limit");
+DSN_TAG_VARIABLE(manual_compact_server_max_running_count, FT_MUTABLE);
+
+DSN_DEFINE_uint32("pegasus.server",
+                  manual_compact_rate_limit_mb_per_sec,
+                  0,
+                  "the rate of the shared rocksdb rate limiter while some manual compactions are "
+                  "running, in MB/s, 0 means not to change the rate. It doesn't work if "
+                  "rocksdb_limiter_enable_auto_tune is true");
+DSN_TAG_VARIABLE(manual_compact_rate_limit_mb_per_sec, FT_MUTABLE);
+
+DSN_DEFINE_uint32("pegasus.server",
+                  manual_compact_pause_p99_latency_ms,
+                  0,
+                  "no new manual compaction is started while the p99 latency of get or multi_get "
+                  "of some replica exceeds this threshold, in ms, 0 means never pause");
+DSN_TAG_VARIABLE(manual_compact_pause_p99_latency_ms, FT_MUTABLE);
+
+compaction_scheduler::compaction_scheduler(std::shared_ptr<rocksdb::RateLimiter> rate_limiter,
+                                           int64_t default_bytes_per_sec)
+    : _rate_limiter(std::move(rate_limiter)),
+      _default_bytes_per_sec(default_bytes_per_sec),
+      _current_bytes_per_sec(default_bytes_per_sec)
+{
+}
+
+void compaction_scheduler::start()
+{
+    ::dsn::tasking::enqueue_timer(
+        LPC_MANUAL_COMPACT_SCHEDULE,
+        &_tracker,
+        [this]() { dispatch(dsn_now_ms()); },
+        std::chrono::milliseconds(FLAGS_manual_compact_schedule_interval_ms));
+}
+
+bool compaction_scheduler::enqueue(const dsn::gpid &pid, std::function<void()> start_compact)
+{
+    ::dsn::zauto_lock l(_lock);
+    if (_running.count(pid) > 0 ||
+        std::any_of(_queue.begin(), _queue.end(), [&pid](const queued_compaction &c) {
+            return c.pid == pid;
+        })) {
+        return false;
+    }
+    _queue.push_back(queued_compaction{pid, dsn_now_ms(), std::move(start_compact)});
+    return true;
+}
+
+void compaction_scheduler::finish(const dsn::gpid &pid)
+{
+    ::dsn::zauto_lock l(_lock);
+    if (_running.erase(pid) > 0) {
+        update_rate_limit();
+    }
+}
+
+bool compaction_scheduler::remove(const dsn::gpid &pid)
+{
+    ::dsn::zauto_lock l(_lock);
+    if (_running.erase(pid) > 0) {
+        update_rate_limit();
+    }
+    auto iter = std::find_if(_queue.begin(), _queue.end(), [&pid](const queued_compaction &c) {
+        return c.pid == pid;
+    });
+    if (iter == _queue.end()) {
+        return false;
+    }
+    _queue.erase(iter);
+    return true;
+}
+
+void compaction_scheduler::register_latency_source(const dsn::gpid &pid,
+                                                   std::function<uint64_t()> p99_latency_ns)
+{
+    ::dsn::zauto_lock l(_lock);
+    _latency_sources[pid] = std::move(p99_latency_ns);
+}
+
+void compaction_scheduler::unregister_latency_source(const dsn::gpid &pid)
+{
+    ::dsn::zauto_lock l(_lock);
+    _latency_sources.erase(pid);
+}
+
+void compaction_scheduler::dispatch(uint64_t now_ms)
+{
+    ::dsn::zauto_lock l(_lock);
+    if (_queue.empty()) {
+        return;
+    }
+
+    // the latencies are only checked before starting new compactions, the running ones can't be
+    // paused but are limited by the rate limiter.
+    uint64_t pause_latency_ns = FLAGS_manual_compact_pause_p99_latency_ms * 1000000ULL;
+    uint64_t max_latency_ns = 0;
+    if (pause_latency_ns > 0) {
+        for (const auto &source : _latency_sources) {
+            max_latency_ns = std::max(max_latency_ns, source.second());
+        }
+    }
+    bool paused = pause_latency_ns > 0 && max_latency_ns > pause_latency_ns;
+    if (paused != _paused) {
+        ddebug_f("{} the manual compactions, p99 latency = {}ns, threshold = {}ns, queued = {}",
+                 paused ? "pause" : "resume",
+                 max_latency_ns,
+                 pause_latency_ns,
+                 _queue.size());
+        _paused = paused;
+    }
+    _paused_latency_ns = paused ? max_latency_ns : 0;
+    if (paused) {
+        return;
+    }
+
+    uint64_t stagger_interval_ms = FLAGS_manual_compact_stagger_interval_s * 1000ULL;
+    while (!_queue.empty()) {
+        if (FLAGS_manual_compact_server_max_running_count > 0 &&
+            _running.size() >= FLAGS_manual_compact_server_max_running_count) {
+            break;
+        }
+        if (_last_start_time_ms > 0 && now_ms < _last_start_time_ms + stagger_interval_ms) {
+            break;
+        }
+
+        queued_compaction compaction = std::move(_queue.front());
+        _queue.pop_front();
+        _running.insert(compaction.pid);
+        _last_start_time_ms = now_ms;
+        ddebug_f("start manual compaction of {}, waited {}ms, queued = {}, running = {}",
+                 compaction.pid.to_string(),
+                 now_ms - std::min(now_ms, compaction.enqueue_time_ms),
+                 _queue.size(),
+                 _running.size());
+        compaction.start_compact();
+        update_rate_limit();
+        if (stagger_interval_ms > 0) {
+            break;
+        }
+    }
+}
+
+void compaction_scheduler::update_rate_limit()
+{
+    if (_rate_limiter == nullptr) {
+        return;
+    }
+
+    int64_t bytes_per_sec = _default_bytes_per_sec;
+    if (!_running.empty() && FLAGS_manual_compact_rate_limit_mb_per_sec > 0) {
+        bytes_per_sec = std::min(
+            bytes_per_sec, static_cast<int64_t>(FLAGS_manual_compact_rate_limit_mb_per_sec) << 20);
+    }
+    if (bytes_per_sec != _current_bytes_per_sec) {
+        ddebug_f("update the rate of rocksdb rate limiter from {} to {} bytes/s, running manual "
+                 "compactions = {}",
+                 _current_bytes_per_sec,
+                 bytes_per_sec,
+                 _running.size());
+        _rate_limiter->SetBytesPerSecond(bytes_per_sec);
+        _current_bytes_per_sec = bytes_per_sec;
+    }
+}
+
+std::string compaction_scheduler::query_state(const dsn::gpid &pid) const
+{
+    ::dsn::zauto_lock l(_lock);
+    std::stringstream state;
+    if (_running.count(pid) > 0) {
+        state << "running in scheduler, " << _running.size() << " running on this server";
+        return state.str();
+    }
+
+    auto iter = std::find_if(_queue.begin(), _queue.end(), [&pid](const queued_compaction &c) {
+        return c.pid == pid;
+    });
+    if (iter == _queue.end()) {
+        return std::string();
+    }
+    state << "queued in scheduler at " << (iter - _queue.begin() + 1) << "/" << _queue.size()
+          << ", " << _running.size() << " running on this server";
+    if (_paused) {
+        state << ", paused by p99 latency " << _paused_latency_ns / 1000000 << "ms";
+    }
+    return state.str();
+}
+
+} // namespace server
+} // namespace pegasus
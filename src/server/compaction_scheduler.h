@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+
+#include <dsn/tool-api/gpid.h>
+#include <dsn/tool-api/task_tracker.h>
+#include <dsn/tool-api/zlocks.h>
+#include <rocksdb/rate_limiter.h>
+
+namespace pegasus {
+namespace server {
+
+// The node level scheduler of the manual compactions, which is shared by all the replicas on one
+// server. The compactions are queued in FIFO order and started one by one at an interval, so
+// that the periodic compactions of all the partitions are not started at the same time. While
+// some of them are running, the shared rate limiter is set to the IO budget of compactions. No
+// new compaction is started while the p99 read latency of some replica exceeds the threshold.
+class compaction_scheduler
+{
+public:
+    // `rate_limiter` is the one shared by the rocksdb instances on this server, whose original
+    // rate is `default_bytes_per_sec`. It's null if the rate is not limited or auto tuned.
+    compaction_scheduler(std::shared_ptr<rocksdb::RateLimiter> rate_limiter,
+                         int64_t default_bytes_per_sec);
+
+    // start the timer to dispatch the queued compactions.
+    void start();
+
+    // queue the compaction of replica `pid`, `start_compact` is called when it's allowed to
+    // start, which should enqueue the compaction task rather than run it.
+    // return false if the replica is already queued or running.
+    bool enqueue(const dsn::gpid &pid, std::function<void()> start_compact);
+
+    // called after the compaction started by `start_compact` is finished or skipped.
+    void finish(const dsn::gpid &pid);
+
+    // remove the compaction of a closed replica.
+    // return true if it's still in the queue, i.e. `start_compact` is never called.
+    bool remove(const dsn::gpid &pid);
+
+    // `p99_latency_ns` returns the p99 read latency of the replica in nanoseconds.
+    void register_latency_source(const dsn::gpid &pid, std::function<uint64_t()> p99_latency_ns);
+    void unregister_latency_source(const dsn::gpid &pid);
+
+    // start the queued compactions as many as the limits allow.
+    void dispatch(uint64_t now_ms);
+
+    // return the state of the compaction of replica `pid` in the scheduler, or empty if it's
+    // neither queued nor running.
+    std::string query_state(const dsn::gpid &pid) const;
+
+private:
+    friend class compaction_scheduler_test;
+
+    void update_rate_limit();
+
+    struct queued_compaction
+    {
+        dsn::gpid pid;
+        uint64_t enqueue_time_ms;
+        std::function<void()> start_compact;
+    };
+
+    const std::shared_ptr<rocksdb::RateLimiter> _rate_limiter;
+    const int64_t _default_bytes_per_sec;
+    dsn::task_tracker _tracker;
+
+    mutable ::dsn::zlock _lock; // [
+    std::deque<queued_compaction> _queue;
+    std::set<dsn::gpid> _running;
+    std::map<dsn::gpid, std::function<uint64_t()>> _latency_sources;
+    uint64_t _last_start_time_ms = 0;
+    bool _paused = false;
+    uint64_t _paused_latency_ns = 0;
+    // the rate currently set to `_rate_limiter`
+    int64_t _current_bytes_per_sec;
+    // ]
+};
+
+} // namespace server
+} // namespace pegasus
@@ -17,11 +17,14 @@
 
 #include "hotkey_collector.h"
 
+#include <algorithm>
+#include <limits>
 #include <dsn/dist/replication/replication_enums.h>
 #include <dsn/utility/smart_pointers.h>
 #include <boost/functional/hash.hpp>
 #include <dsn/dist/fmt_logging.h>
 #include <dsn/utility/flags.h>
+#include <dsn/utility/crc.h>
 #include "base/pegasus_key_schema.h"
 #include "base/pegasus_utils.h"
 
@@ -67,6 +70,13 @@ DSN_DEFINE_uint32(
     "the max time (in seconds) allowed to capture hotkey, will stop if hotkey's not found");
 DSN_TAG_VARIABLE(max_seconds_to_detect_hotkey, FT_MUTABLE);
 
+DSN_DEFINE_bool("pegasus.server",
+                hotkey_detect_by_sketch,
+                false,
+                "whether to detect hotkey in one phase by count-min sketch, instead of the "
+                "coarse and fine capture, takes effect when hotkey detection starts");
+DSN_TAG_VARIABLE(hotkey_detect_by_sketch, FT_MUTABLE);
+
 // 68–95–99.7 rule, same algorithm as hotspot_partition_calculator::stat_histories_analyse
 /*extern*/ bool
 find_outlier_index(const std::vector<uint64_t> &captured_keys, int threshold, int &hot_index)
@@ -119,6 +129,7 @@ hotkey_collector::hotkey_collector(dsn::replication::hotkey_type::type hotkey_ty
         std::make_shared<hotkey_coarse_data_collector>(this, now_hash_bucket_num);
     _internal_fine_collector =
         std::make_shared<hotkey_fine_data_collector>(this, now_hash_bucket_num);
+    _internal_sketch_collector = std::make_shared<hotkey_sketch_data_collector>(this);
     _internal_empty_collector = std::make_shared<hotkey_empty_data_collector>(this);
     _state.store(hotkey_collector_state::STOPPED);
 }
@@ -129,10 +140,19 @@ inline void hotkey_collector::change_state_to_stopped()
     _result.if_find_result.store(false);
     _internal_coarse_collector->clear();
     _internal_fine_collector->clear();
+    _internal_sketch_collector->clear();
+}
+
+inline void hotkey_collector::reset_result()
+{
+    _result.coarse_bucket_index = -1;
+    _result.hot_hash_key.clear();
+    _result.top_hash_keys.clear();
 }
 
 inline void hotkey_collector::change_state_to_coarse_detecting()
 {
+    reset_result();
     _state.store(hotkey_collector_state::COARSE_DETECTING);
     _collector_start_time_second.store(dsn_now_s());
 }
@@ -143,6 +163,13 @@ inline void hotkey_collector::change_state_to_fine_detecting()
     _internal_fine_collector->change_target_bucket(_result.coarse_bucket_index);
 }
 
+inline void hotkey_collector::change_state_to_sketch_detecting()
+{
+    reset_result();
+    _state.store(hotkey_collector_state::SKETCH_DETECTING);
+    _collector_start_time_second.store(dsn_now_s());
+}
+
 inline void hotkey_collector::change_state_to_finished()
 {
     _state.store(hotkey_collector_state::FINISHED);
@@ -156,6 +183,8 @@ inline std::shared_ptr<internal_collector_base> hotkey_collector::get_internal_c
         return _internal_coarse_collector;
     case hotkey_collector_state::FINE_DETECTING:
         return _internal_fine_collector;
+    case hotkey_collector_state::SKETCH_DETECTING:
+        return _internal_sketch_collector;
     default:
         return _internal_empty_collector;
     }
@@ -170,6 +199,7 @@ inline void hotkey_collector::change_state_by_result()
         }
         break;
     case hotkey_collector_state::FINE_DETECTING:
+    case hotkey_collector_state::SKETCH_DETECTING:
         if (!_result.hot_hash_key.empty()) {
             change_state_to_finished();
             derror_replica("Find the hotkey: {}",
@@ -215,6 +245,7 @@ void hotkey_collector::capture_hash_key(const dsn::blob &hash_key, int64_t weigh
     switch (_state.load()) {
     case hotkey_collector_state::COARSE_DETECTING:
     case hotkey_collector_state::FINE_DETECTING:
+    case hotkey_collector_state::SKETCH_DETECTING:
         get_internal_collector_by_state()->capture_data(hash_key, weight > 0 ? weight : 1);
         return;
     default:
@@ -227,6 +258,7 @@ void hotkey_collector::analyse_data()
     switch (_state.load()) {
     case hotkey_collector_state::COARSE_DETECTING:
     case hotkey_collector_state::FINE_DETECTING:
+    case hotkey_collector_state::SKETCH_DETECTING:
         if (!terminate_if_timeout()) {
             get_internal_collector_by_state()->analyse_data(_result);
             change_state_by_result();
@@ -244,6 +276,7 @@ void hotkey_collector::on_start_detect(dsn::replication::detect_hotkey_response
     switch (now_state) {
     case hotkey_collector_state::COARSE_DETECTING:
     case hotkey_collector_state::FINE_DETECTING:
+    case hotkey_collector_state::SKETCH_DETECTING:
         resp.err = dsn::ERR_BUSY;
         hint = fmt::format("still detecting {} hotkey, state is {}",
                            dsn::enum_to_string(_hotkey_type),
@@ -257,9 +290,15 @@ void hotkey_collector::on_start_detect(dsn::replication::detect_hotkey_response
                            pegasus::utils::c_escape_string(_result.hot_hash_key));
         break;
     case hotkey_collector_state::STOPPED:
-        change_state_to_coarse_detecting();
+        if (FLAGS_hotkey_detect_by_sketch) {
+            change_state_to_sketch_detecting();
+        } else {
+            change_state_to_coarse_detecting();
+        }
         resp.err = dsn::ERR_OK;
-        hint = fmt::format("starting to detect {} hotkey", dsn::enum_to_string(_hotkey_type));
+        hint = fmt::format("starting to detect {} hotkey, state is {}",
+                           dsn::enum_to_string(_hotkey_type),
+                           enum_to_string(_state.load()));
         break;
     default:
         hint = "invalid collector state";
@@ -292,9 +331,26 @@ void hotkey_collector::query_result(dsn::replication::detect_hotkey_response &re
     } else {
         resp.err = dsn::ERR_OK;
         resp.__set_hotkey_result(pegasus::utils::c_escape_string(_result.hot_hash_key));
+        if (!_result.top_hash_keys.empty()) {
+            std::string hint = "top hash keys with estimated weights:";
+            for (const auto &top : _result.top_hash_keys) {
+                hint += fmt::format(
+                    " {}({})", pegasus::utils::c_escape_string(top.first), top.second);
+            }
+            resp.__set_err_hint(hint);
+        }
     }
 }
 
+bool hotkey_collector::get_hot_hash_key(/*out*/ std::string &hash_key) const
+{
+    if (_state.load() != hotkey_collector_state::FINISHED) {
+        return false;
+    }
+    hash_key = _result.hot_hash_key;
+    return true;
+}
+
 bool hotkey_collector::terminate_if_timeout()
 {
     if (dsn_now_s() >= _collector_start_time_second.load() + FLAGS_max_seconds_to_detect_hotkey) {
@@ -433,5 +489,132 @@ void hotkey_fine_data_collector::clear()
     }
 }
 
+hotkey_sketch_data_collector::hotkey_sketch_data_collector(replica_base *base,
+                                                           uint32_t top_k,
+                                                           uint32_t sketch_width,
+                                                           uint32_t sketch_depth)
+    : internal_collector_base(base),
+      _top_k(top_k),
+      _sketch_width(sketch_width),
+      _sketch_depth(sketch_depth),
+      _sketch(sketch_width * sketch_depth)
+{
+    dassert_f(top_k > 0, "top_k({}) should be positive", top_k);
+    dassert_f(sketch_width > 0 && (sketch_width & (sketch_width - 1)) == 0,
+              "sketch_width({}) should be a power of 2",
+              sketch_width);
+    dassert_f(sketch_depth > 0, "sketch_depth({}) should be positive", sketch_depth);
+    for (auto &counter : _sketch) {
+        counter.store(0);
+    }
+    _top_keys.reserve(top_k);
+    _min_top_weight.store(0);
+}
+
+void hotkey_sketch_data_collector::capture_data(const dsn::blob &hash_key, uint64_t weight)
+{
+    // the column of each row is chosen by double hashing on the two halves of one hash value
+    const uint64_t hash = dsn::utils::crc64_calc(hash_key.data(), hash_key.length(), 0);
+    const uint32_t h1 = static_cast<uint32_t>(hash);
+    const uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    uint64_t estimated_weight = std::numeric_limits<uint64_t>::max();
+    for (uint32_t row = 0; row < _sketch_depth; ++row) {
+        const uint32_t column = (h1 + row * h2) & (_sketch_width - 1);
+        const uint64_t count =
+            _sketch[row * _sketch_width + column].fetch_add(weight, std::memory_order_relaxed) +
+            weight;
+        estimated_weight = std::min(estimated_weight, count);
+    }
+
+    if (estimated_weight <= _min_top_weight.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // The top-k always records the latest estimated weight rather than accumulating, so it's
+    // harmless to skip the update if the lock is held by others: the weight has been counted
+    // by the sketch, and a hot key will be captured again soon.
+    if (!_top_keys_lock.try_lock()) {
+        return;
+    }
+    update_top_keys(hash_key, estimated_weight);
+    _top_keys_lock.unlock();
+}
+
+void hotkey_sketch_data_collector::update_top_keys(const dsn::blob &hash_key,
+                                                   uint64_t estimated_weight)
+{
+    const dsn::string_view key(hash_key);
+    auto iter = std::find_if(
+        _top_keys.begin(), _top_keys.end(), [key](const std::pair<std::string, uint64_t> &top) {
+            return key == top.first;
+        });
+    if (iter != _top_keys.end()) {
+        iter->second = std::max(iter->second, estimated_weight);
+    } else if (_top_keys.size() < _top_k) {
+        _top_keys.emplace_back(key.to_string(), estimated_weight);
+    } else {
+        auto min_iter = std::min_element(
+            _top_keys.begin(),
+            _top_keys.end(),
+            [](const std::pair<std::string, uint64_t> &lhs,
+               const std::pair<std::string, uint64_t> &rhs) { return lhs.second < rhs.second; });
+        if (estimated_weight <= min_iter->second) {
+            return;
+        }
+        *min_iter = std::make_pair(key.to_string(), estimated_weight);
+    }
+
+    uint64_t min_weight = 0;
+    if (_top_keys.size() == _top_k) {
+        min_weight = std::numeric_limits<uint64_t>::max();
+        for (const auto &top : _top_keys) {
+            min_weight = std::min(min_weight, top.second);
+        }
+    }
+    _min_top_weight.store(min_weight, std::memory_order_relaxed);
+}
+
+void hotkey_sketch_data_collector::analyse_data(detect_hotkey_result &result)
+{
+    std::vector<std::pair<std::string, uint64_t>> top_keys;
+    {
+        ::dsn::zauto_lock l(_top_keys_lock);
+        top_keys = _top_keys;
+    }
+    if (top_keys.empty()) {
+        return;
+    }
+    std::sort(top_keys.begin(),
+              top_keys.end(),
+              [](const std::pair<std::string, uint64_t> &lhs,
+                 const std::pair<std::string, uint64_t> &rhs) { return lhs.second > rhs.second; });
+
+    std::vector<uint64_t> weights;
+    weights.reserve(top_keys.size());
+    for (const auto &top : top_keys) {
+        weights.push_back(top.second);
+    }
+    // Like hotkey_fine_data_collector, with less than 3 keys captured the hottest one is the
+    // hotkey, otherwise it must be an outlier among the top-k. Without a hotkey the estimated
+    // weights of the top-k are so close that their variance may be 0, so the hotkey must also
+    // be at least twice as heavy as the second one.
+    int hot_index;
+    if (weights.size() < 3 ||
+        (weights[0] >= 2 * weights[1] &&
+         find_outlier_index(weights, FLAGS_hot_key_variance_threshold, hot_index))) {
+        result.hot_hash_key = top_keys.front().first;
+    }
+    result.top_hash_keys = std::move(top_keys);
+}
+
+void hotkey_sketch_data_collector::clear()
+{
+    ::dsn::zauto_lock l(_top_keys_lock);
+    for (auto &counter : _sketch) {
+        counter.store(0);
+    }
+    _top_keys.clear();
+    _min_top_weight.store(0);
+}
+
 } // namespace server
 } // namespace pegasus
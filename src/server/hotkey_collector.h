@@ -20,6 +20,7 @@
 #include <dsn/dist/replication/replication_types.h>
 #include <concurrentqueue/concurrentqueue.h>
 #include <dsn/dist/replication/replica_base.h>
+#include <dsn/tool-api/zlocks.h>
 #include "hotkey_collector_state.h"
 
 namespace pegasus {
@@ -29,12 +30,16 @@ class internal_collector_base;
 class hotkey_empty_data_collector;
 class hotkey_coarse_data_collector;
 class hotkey_fine_data_collector;
+class hotkey_sketch_data_collector;
 
 struct detect_hotkey_result
 {
     std::atomic<bool> if_find_result;
     int coarse_bucket_index;
     std::string hot_hash_key;
+    // the hottest hash keys with their estimated weights in descending order, only analysed by
+    // hotkey_sketch_data_collector
+    std::vector<std::pair<std::string, uint64_t>> top_hash_keys;
     detect_hotkey_result() : coarse_bucket_index(-1), hot_hash_key("")
     {
         if_find_result.store(false);
@@ -94,15 +99,21 @@ public:
     void analyse_data();
     void handle_rpc(const dsn::replication::detect_hotkey_request &req,
                     /*out*/ dsn::replication::detect_hotkey_response &resp);
+    // return true and the hotkey if it has been found, i.e. the state is FINISHED.
+    bool get_hot_hash_key(/*out*/ std::string &hash_key) const;
 
 private:
     void on_start_detect(dsn::replication::detect_hotkey_response &resp);
     void on_stop_detect(dsn::replication::detect_hotkey_response &resp);
     void query_result(dsn::replication::detect_hotkey_response &resp);
 
+    // the result of the last detection is reset when a new detection starts, rather than when
+    // it's stopped, since it may be queried concurrently until then.
+    void reset_result();
     void change_state_to_stopped();
     void change_state_to_coarse_detecting();
     void change_state_to_fine_detecting();
+    void change_state_to_sketch_detecting();
     void change_state_to_finished();
 
     bool terminate_if_timeout();
@@ -117,6 +128,7 @@ private:
     std::shared_ptr<hotkey_empty_data_collector> _internal_empty_collector;
     std::shared_ptr<hotkey_coarse_data_collector> _internal_coarse_collector;
     std::shared_ptr<hotkey_fine_data_collector> _internal_fine_collector;
+    std::shared_ptr<hotkey_sketch_data_collector> _internal_sketch_collector;
 
     friend class hotkey_collector_test;
 };
@@ -184,5 +196,45 @@ private:
     friend class fine_collector_test;
 };
 
+// hotkey_sketch_data_collector finds the hotkey in one phase, without the coarse capture.
+// The weights of all the captured hash keys are counted by a Count-Min Sketch, whose counters
+// are updated lock-free, so no key is abandoned however heavy the traffic is. Along with it
+// the top-k hash keys are kept like Space-Saving: a key whose estimated weight exceeds the
+// minimum of the top-k replaces that minimum. The memory used is bounded by the size of the
+// sketch and k.
+class hotkey_sketch_data_collector : public internal_collector_base
+{
+public:
+    hotkey_sketch_data_collector(replica_base *base,
+                                 uint32_t top_k = 10,
+                                 uint32_t sketch_width = 1024,
+                                 uint32_t sketch_depth = 4);
+    void capture_data(const dsn::blob &hash_key, uint64_t weight) override;
+    void analyse_data(detect_hotkey_result &result) override;
+    void clear() override;
+
+private:
+    hotkey_sketch_data_collector() = delete;
+
+    // update the estimated weight of `hash_key` in the top-k, should be called with
+    // _top_keys_lock held.
+    void update_top_keys(const dsn::blob &hash_key, uint64_t estimated_weight);
+
+    const uint32_t _top_k;
+    // _sketch_width is a power of 2, so that the column is calculated by a mask
+    const uint32_t _sketch_width;
+    const uint32_t _sketch_depth;
+    // _sketch_depth rows of _sketch_width counters
+    std::vector<std::atomic<uint64_t>> _sketch;
+
+    ::dsn::zlock _top_keys_lock;
+    std::vector<std::pair<std::string, uint64_t>> _top_keys;
+    // the min weight of _top_keys if it's full, otherwise 0. A key whose estimated weight is
+    // not larger than it can't enter the top-k, so the lock needn't be acquired.
+    std::atomic<uint64_t> _min_top_weight;
+
+    friend class sketch_collector_test;
+};
+
 } // namespace server
 } // namespace pegasus
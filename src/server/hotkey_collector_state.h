@@ -45,12 +45,17 @@ namespace server {
 //  capture and analyse   +-------v--------+                            |
 //  is done, ready to get |    FINISHED    |+---------------------------+
 //  the result            +----------------+
+//
+// If `hotkey_detect_by_sketch` is set when the START RPC is received, the collector goes from
+// STOPPED to SKETCH_DETECTING instead, which captures and analyses in one phase, and goes to
+// FINISHED once a hotkey is found, or back to STOPPED on timeout or the STOP RPC.
 
 enum class hotkey_collector_state
 {
     STOPPED,
     COARSE_DETECTING,
     FINE_DETECTING,
+    SKETCH_DETECTING,
     FINISHED
 };
 
@@ -58,6 +63,7 @@ ENUM_BEGIN2(hotkey_collector_state, hotkey_collector_state, hotkey_collector_sta
 ENUM_REG(hotkey_collector_state::STOPPED)
 ENUM_REG(hotkey_collector_state::COARSE_DETECTING)
 ENUM_REG(hotkey_collector_state::FINE_DETECTING)
+ENUM_REG(hotkey_collector_state::SKETCH_DETECTING)
 ENUM_REG(hotkey_collector_state::FINISHED)
 ENUM_END2(hotkey_collector_state, hotkey_collector_state)
 
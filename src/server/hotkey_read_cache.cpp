@@ -0,0 +1,198 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "hotkey_read_cache.h"
+
+#include <algorithm>
+
+#include "base/pegasus_key_schema.h"
+
+namespace pegasus {
+namespace server {
+
+hotkey_read_cache::hotkey_read_cache(uint64_t capacity) : _capacity(capacity) {}
+
+static uint64_t rows_size(const std::unordered_map<std::string, std::string> &rows)
+{
+    uint64_t size = 0;
+    for (const auto &row : rows) {
+        size += row.first.size() + row.second.size();
+    }
+    return size;
+}
+
+void hotkey_read_cache::set_bypassed(bool bypassed)
+{
+    ::dsn::zauto_write_lock l(_lock);
+    if (bypassed == _bypassed) {
+        return;
+    }
+    _bypassed = bypassed;
+    clear_rows();
+    _enabled.store(!_bypassed && !_hot_key_hashes.empty());
+}
+
+void hotkey_read_cache::set_specified_hash_keys(std::set<std::string> hash_keys)
+{
+    ::dsn::zauto_write_lock l(_lock);
+    if (hash_keys == _specified_hash_keys) {
+        return;
+    }
+    _specified_hash_keys = std::move(hash_keys);
+    reset_hot_key_hashes();
+}
+
+void hotkey_read_cache::set_detected_hash_key(const std::string &hash_key)
+{
+    ::dsn::zauto_write_lock l(_lock);
+    if (hash_key == _detected_hash_key) {
+        return;
+    }
+    _detected_hash_key = hash_key;
+    reset_hot_key_hashes();
+}
+
+void hotkey_read_cache::reset_hot_key_hashes()
+{
+    _hot_key_hashes.clear();
+    // the rows of an empty hash key are hashed by their sort keys, which can't be cached.
+    for (const auto &hash_key : _specified_hash_keys) {
+        if (!hash_key.empty()) {
+            _hot_key_hashes.insert(
+                pegasus_hash_key_hash(dsn::blob(hash_key.data(), 0, hash_key.length())));
+        }
+    }
+    if (!_detected_hash_key.empty()) {
+        _hot_key_hashes.insert(pegasus_hash_key_hash(
+            dsn::blob(_detected_hash_key.data(), 0, _detected_hash_key.length())));
+    }
+
+    for (auto iter = _rows.begin(); iter != _rows.end();) {
+        if (_hot_key_hashes.count(iter->first) == 0) {
+            _row_count -= iter->second.size();
+            _size -= rows_size(iter->second);
+            iter = _rows.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    ++_version;
+    _enabled.store(!_bypassed && !_hot_key_hashes.empty());
+}
+
+bool hotkey_read_cache::get(dsn::string_view raw_key,
+                            uint64_t key_hash,
+                            /*out*/ std::string &value,
+                            /*out*/ uint64_t &version)
+{
+    ::dsn::zauto_read_lock l(_lock);
+    version = 0;
+    if (_hot_key_hashes.count(key_hash) == 0) {
+        return false;
+    }
+    auto rows = _rows.find(key_hash);
+    if (rows != _rows.end()) {
+        auto row = rows->second.find(std::string(raw_key.data(), raw_key.length()));
+        if (row != rows->second.end()) {
+            value.assign(row->second);
+            return true;
+        }
+    }
+    version = _version;
+    return false;
+}
+
+void hotkey_read_cache::fill(dsn::string_view raw_key,
+                             uint64_t key_hash,
+                             dsn::string_view value,
+                             uint64_t version)
+{
+    const uint64_t row_size = raw_key.length() + value.length();
+    ::dsn::zauto_write_lock l(_lock);
+    if (version != _version || _bypassed || _size + row_size > _capacity ||
+        _hot_key_hashes.count(key_hash) == 0) {
+        return;
+    }
+    auto result = _rows[key_hash].emplace(std::string(raw_key.data(), raw_key.length()),
+                                          std::string(value.data(), value.length()));
+    if (result.second) {
+        ++_row_count;
+        _size += row_size;
+    }
+}
+
+void hotkey_read_cache::invalidate(const std::vector<uint64_t> &key_hashes)
+{
+    {
+        // most of the writes are not on the hot keys, which needn't the write lock.
+        ::dsn::zauto_read_lock l(_lock);
+        if (std::none_of(key_hashes.begin(), key_hashes.end(), [this](uint64_t key_hash) {
+                return _hot_key_hashes.count(key_hash) > 0;
+            })) {
+            return;
+        }
+    }
+
+    ::dsn::zauto_write_lock l(_lock);
+    bool invalidated = false;
+    for (uint64_t key_hash : key_hashes) {
+        if (_hot_key_hashes.count(key_hash) == 0) {
+            continue;
+        }
+        invalidated = true;
+        auto rows = _rows.find(key_hash);
+        if (rows != _rows.end()) {
+            _row_count -= rows->second.size();
+            _size -= rows_size(rows->second);
+            _rows.erase(rows);
+        }
+    }
+    if (invalidated) {
+        ++_version;
+    }
+}
+
+void hotkey_read_cache::clear()
+{
+    ::dsn::zauto_write_lock l(_lock);
+    clear_rows();
+}
+
+void hotkey_read_cache::clear_rows()
+{
+    _rows.clear();
+    _row_count = 0;
+    _size = 0;
+    ++_version;
+}
+
+size_t hotkey_read_cache::row_count() const
+{
+    ::dsn::zauto_read_lock l(_lock);
+    return _row_count;
+}
+
+uint64_t hotkey_read_cache::size() const
+{
+    ::dsn::zauto_read_lock l(_lock);
+    return _size;
+}
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <dsn/tool-api/zlocks.h>
+#include <dsn/utility/string_view.h>
+
+namespace pegasus {
+namespace server {
+
+/// A read-through cache of the rows of hot hash keys in a replica, so that the reads of a hot
+/// key needn't go through rocksdb. The hot hash keys are specified by the app env
+/// "replica.hotkey_read_cache.hash_keys", or found by the READ hotkey detection.
+///
+/// The rows are cached with their rocksdb values, so the TTL is still checked on each hit
+/// the same as reading from rocksdb. The rows are grouped by the hash of their hash keys
+/// (i.e. pegasus_key_hash), and a write invalidates all the cached rows of its hash key after
+/// the write batch is applied to rocksdb.
+///
+/// A read which misses the cache gets a version, and its value is filled only if no
+/// invalidation happened since then, so a value read before a write can't be filled after the
+/// write is invalidated.
+///
+/// The compaction may drop the rows or rewrite their expire_ts without the cache knowing, if a
+/// default TTL or a user specified compaction is set on the table, so the cache is bypassed
+/// then.
+class hotkey_read_cache
+{
+public:
+    // `capacity` is the max total bytes of the raw keys and values cached.
+    explicit hotkey_read_cache(uint64_t capacity);
+
+    // false if no hash key is hot or the cache is bypassed, when the other functions needn't
+    // be called.
+    bool enabled() const { return _enabled.load(); }
+
+    // bypass the cache and evict all the cached rows, if the compaction may change the rows.
+    void set_bypassed(bool bypassed);
+
+    // replace the hash keys specified by the app env, or the hash key found by hotkey
+    // detection (empty if none). The cached rows of the hash keys no longer hot are evicted.
+    void set_specified_hash_keys(std::set<std::string> hash_keys);
+    void set_detected_hash_key(const std::string &hash_key);
+
+    // return true and the rocksdb value of `raw_key` if it's cached. Otherwise `version` is
+    // set for fill() if the hash key of `raw_key` is hot, or 0 if not.
+    bool get(dsn::string_view raw_key,
+             uint64_t key_hash,
+             /*out*/ std::string &value,
+             /*out*/ uint64_t &version);
+    void fill(dsn::string_view raw_key,
+              uint64_t key_hash,
+              dsn::string_view value,
+              uint64_t version);
+
+    // evict the cached rows of the hash keys, which are just written.
+    void invalidate(const std::vector<uint64_t> &key_hashes);
+    // evict all the cached rows, e.g. after files are ingested.
+    void clear();
+
+    size_t row_count() const;
+    uint64_t size() const;
+
+private:
+    // should be called with _lock held in write mode.
+    void reset_hot_key_hashes();
+    void clear_rows();
+
+    const uint64_t _capacity;
+    std::atomic_bool _enabled{false};
+
+    mutable ::dsn::zrwlock_nr _lock;
+    std::set<std::string> _specified_hash_keys;
+    std::string _detected_hash_key;
+    std::unordered_set<uint64_t> _hot_key_hashes;
+    bool _bypassed{false};
+    // key hash -> raw key -> rocksdb value
+    std::unordered_map<uint64_t, std::unordered_map<std::string, std::string>> _rows;
+    size_t _row_count{0};
+    // total bytes of the raw keys and values in _rows
+    uint64_t _size{0};
+    // increased on every invalidation, 0 is reserved for the keys not hot.
+    uint64_t _version{1};
+};
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,189 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <rocksdb/merge_operator.h>
+#include <dsn/utility/endians.h>
+#include <dsn/utility/string_conv.h>
+
+#include "base/pegasus_utils.h"
+#include "base/pegasus_value_schema.h"
+
+namespace pegasus {
+namespace server {
+
+/// The merge operand of an incr request, which is written instead of the new value when
+/// the table env "replica.incr_merge_enabled" is true, so that incr needn't read the old value.
+///
+/// The operator is only installed if the server config "rocksdb_incr_merge_operator_enabled" is
+/// on, which should be the same on all the servers of a cluster. Once some operand is written,
+/// the config can't be turned off nor the servers be rolled back to a version without the
+/// operator, until the env is turned off and the operands are fully compacted.
+///
+/// operand = [version(uint8_t)] [data_version(uint8_t)] [increment(int64_t)]
+///           [expire_ts_seconds(int32_t)] [default_expire_ts(uint32_t)] [write_ts(uint32_t)]
+///           [timetag(uint64_t)]
+struct incr_operand
+{
+    static const uint8_t kVersion = 0;
+    static const size_t kEncodedSize = 1 + 1 + 8 + 4 + 4 + 4 + 8;
+
+    // the data version of the value generated by merging.
+    uint32_t data_version{0};
+    int64_t increment{0};
+    // the same as incr_request.expire_ts_seconds: 0 means keep the old ttl, <0 means clear the
+    // ttl, >0 means set the ttl.
+    int32_t expire_ts_seconds{0};
+    // the expire_ts used if the new value has no ttl, which is calculated by the table level
+    // default ttl when writing, 0 if there is no default ttl.
+    uint32_t default_expire_ts{0};
+    // the time (in seconds) when the incr is written, by which the old value is checked whether
+    // expired.
+    uint32_t write_ts{0};
+    uint64_t timetag{0};
+
+    std::string encode() const
+    {
+        std::string buf(kEncodedSize, '\0');
+        dsn::data_output(buf)
+            .write_u8(kVersion)
+            .write_u8(static_cast<uint8_t>(data_version))
+            .write_u64(static_cast<uint64_t>(increment))
+            .write_u32(static_cast<uint32_t>(expire_ts_seconds))
+            .write_u32(default_expire_ts)
+            .write_u32(write_ts)
+            .write_u64(timetag);
+        return buf;
+    }
+
+    // return false if `data` is not a valid operand.
+    bool decode(dsn::string_view data)
+    {
+        if (data.length() != kEncodedSize) {
+            return false;
+        }
+        dsn::data_input input(data);
+        if (input.read_u8() != kVersion) {
+            return false;
+        }
+        data_version = input.read_u8();
+        increment = static_cast<int64_t>(input.read_u64());
+        expire_ts_seconds = static_cast<int32_t>(input.read_u32());
+        default_expire_ts = input.read_u32();
+        write_ts = input.read_u32();
+        timetag = input.read_u64();
+        return data_version <= PEGASUS_DATA_VERSION_MAX;
+    }
+};
+
+/// Applies the incr operands of a key on its old value, with the same semantics as the
+/// read-modify-write incr in pegasus_write_service::impl::incr:
+///  - a not found, expired or empty old value is treated as 0.
+///  - an operand is ignored if the old value is not an integer, or the new value overflows,
+///    just like the incr request fails in these cases.
+///  - the ttl is updated according to incr_operand::expire_ts_seconds.
+///
+/// The operands can't be combined by partial merge, since whether the old value expires
+/// depends on when each operand is written.
+class IncrMergeOperator : public rocksdb::MergeOperator
+{
+public:
+    bool FullMergeV2(const MergeOperationInput &merge_in,
+                     MergeOperationOutput *merge_out) const override
+    {
+        std::vector<incr_operand> operands(merge_in.operand_list.size());
+        for (size_t i = 0; i < operands.size(); ++i) {
+            if (!operands[i].decode(utils::to_string_view(merge_in.operand_list[i]))) {
+                return false;
+            }
+        }
+        const uint32_t data_version = operands.back().data_version;
+
+        bool found = merge_in.existing_value != nullptr;
+        uint32_t expire_ts = 0;
+        int64_t value = 0;
+        bool is_integer = true;
+        if (found) {
+            dsn::string_view existing_value = utils::to_string_view(*merge_in.existing_value);
+            expire_ts = pegasus_extract_expire_ts(data_version, existing_value);
+            dsn::string_view user_data =
+                pegasus_extract_user_data_view(data_version, existing_value);
+            if (user_data.length() > 0) {
+                is_integer = dsn::buf2int64(user_data, value);
+            }
+        }
+
+        bool changed = false;
+        uint64_t timetag = 0;
+        for (const incr_operand &op : operands) {
+            if (found && check_if_ts_expired(op.write_ts, expire_ts)) {
+                found = false;
+            }
+            if (!found) {
+                value = op.increment;
+                expire_ts = op.expire_ts_seconds > 0 ? op.expire_ts_seconds : 0;
+                is_integer = true;
+                found = true;
+            } else {
+                if (!is_integer) {
+                    continue;
+                }
+                int64_t new_value = value + op.increment;
+                if ((op.increment > 0 && new_value < value) ||
+                    (op.increment < 0 && new_value > value)) {
+                    continue;
+                }
+                value = new_value;
+                if (op.expire_ts_seconds > 0) {
+                    expire_ts = op.expire_ts_seconds;
+                } else if (op.expire_ts_seconds < 0) {
+                    expire_ts = 0;
+                }
+            }
+            if (expire_ts == 0) {
+                expire_ts = op.default_expire_ts;
+            }
+            timetag = op.timetag;
+            changed = true;
+        }
+
+        if (!changed) {
+            // all of the operands are ignored, keep the old value.
+            merge_out->existing_operand = *merge_in.existing_value;
+            return true;
+        }
+
+        std::string user_data = std::to_string(value);
+        pegasus_value_generator gen;
+        rocksdb::SliceParts parts = gen.generate_value(data_version, user_data, expire_ts, timetag);
+        merge_out->new_value.clear();
+        for (int i = 0; i < parts.num_parts; ++i) {
+            merge_out->new_value.append(parts.parts[i].data(), parts.parts[i].size());
+        }
+        return true;
+    }
+
+    const char *Name() const override { return "IncrMergeOperator"; }
+};
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,178 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "key_filter_matcher.h"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+namespace pegasus {
+namespace server {
+
+aho_corasick_matcher::aho_corasick_matcher(const std::vector<std::string> &patterns)
+{
+    _root_children.fill(-1);
+    _nodes.emplace_back();
+
+    // build the trie of the patterns.
+    for (const auto &pattern : patterns) {
+        if (pattern.empty()) {
+            _match_all = true;
+            continue;
+        }
+        int32_t state = 0;
+        for (char c : pattern) {
+            int32_t next = child(state, static_cast<unsigned char>(c));
+            state = next >= 0 ? next : add_child(state, static_cast<unsigned char>(c));
+        }
+        _nodes[state].output = true;
+    }
+
+    // build the failure links by BFS, the failure link of a node points to the node of its
+    // longest proper suffix in the trie.
+    std::queue<int32_t> q;
+    for (const auto &kv : _nodes[0].children) {
+        _nodes[kv.second].fail = 0;
+        q.push(kv.second);
+    }
+    while (!q.empty()) {
+        int32_t state = q.front();
+        q.pop();
+        for (const auto &kv : _nodes[state].children) {
+            int32_t fail = _nodes[state].fail;
+            int32_t next = child(fail, kv.first);
+            while (fail != 0 && next < 0) {
+                fail = _nodes[fail].fail;
+                next = child(fail, kv.first);
+            }
+            _nodes[kv.second].fail = next >= 0 ? next : 0;
+            _nodes[kv.second].output |= _nodes[_nodes[kv.second].fail].output;
+            q.push(kv.second);
+        }
+    }
+}
+
+int32_t aho_corasick_matcher::child(int32_t state, unsigned char c) const
+{
+    if (state == 0) {
+        return _root_children[c];
+    }
+    for (const auto &kv : _nodes[state].children) {
+        if (kv.first == c) {
+            return kv.second;
+        }
+    }
+    return -1;
+}
+
+int32_t aho_corasick_matcher::add_child(int32_t state, unsigned char c)
+{
+    int32_t next = static_cast<int32_t>(_nodes.size());
+    _nodes.emplace_back();
+    auto &children = _nodes[state].children;
+    children.emplace_back(c, next);
+    std::sort(children.begin(), children.end());
+    if (state == 0) {
+        _root_children[c] = next;
+    }
+    return next;
+}
+
+bool aho_corasick_matcher::match(dsn::string_view text) const
+{
+    if (_match_all) {
+        return true;
+    }
+    int32_t state = 0;
+    for (char ch : text) {
+        auto c = static_cast<unsigned char>(ch);
+        int32_t next = child(state, c);
+        while (state != 0 && next < 0) {
+            state = _nodes[state].fail;
+            next = child(state, c);
+        }
+        state = next >= 0 ? next : 0;
+        if (_nodes[state].output) {
+            return true;
+        }
+    }
+    return false;
+}
+
+key_filter_matcher::key_filter_matcher(::dsn::apps::filter_type::type type,
+                                       dsn::string_view pattern)
+    : _type(type), _pattern(pattern.data(), pattern.length())
+{
+    if (_pattern.empty()) {
+        return;
+    }
+
+    switch (_type) {
+    case ::dsn::apps::filter_type::FT_MATCH_ANYWHERE:
+        _match_anywhere = key_filter_impl::best_match_anywhere();
+        break;
+    case ::dsn::apps::filter_type::FT_MATCH_REGEX:
+        if (_pattern.length() > kMaxRegexLength) {
+            _valid = false;
+            break;
+        }
+        try {
+            _regex.reset(new boost::regex(_pattern, boost::regex::ECMAScript));
+        } catch (const std::runtime_error &) {
+            // boost::regex_error, or the pattern is too complex to be compiled
+            _valid = false;
+        }
+        break;
+    case ::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN: {
+        // the patterns may contain any byte except the separator, so they are neither trimmed
+        // nor truncated by '\0'. Empty patterns (e.g. a trailing separator) are ignored.
+        std::vector<std::string> patterns;
+        size_t begin = 0;
+        while (begin <= _pattern.length()) {
+            size_t end = _pattern.find(kMultiPatternSeparator, begin);
+            if (end == std::string::npos) {
+                end = _pattern.length();
+            }
+            if (end > begin) {
+                patterns.emplace_back(_pattern.substr(begin, end - begin));
+            }
+            begin = end + 1;
+        }
+        _multi_pattern.reset(new aho_corasick_matcher(patterns));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+bool key_filter_matcher::match_regex(dsn::string_view value) const
+{
+    try {
+        return boost::regex_search(value.data(), value.data() + value.length(), *_regex);
+    } catch (const std::runtime_error &) {
+        // the search exceeds the complexity or memory limits of boost, e.g. a catastrophic
+        // backtracking pattern on a long key.
+        return false;
+    }
+}
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,234 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <string.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/regex.hpp>
+#include <dsn/utility/string_view.h>
+#include <rrdb/rrdb_types.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace pegasus {
+namespace server {
+
+// Implementations of the FT_MATCH_ANYWHERE filter, i.e. whether `pattern` is a substring of
+// `value`. All of them require 0 < pattern.length() <= value.length().
+namespace key_filter_impl {
+
+inline bool match_anywhere_scalar(dsn::string_view value, dsn::string_view pattern)
+{
+    return value.find(pattern) != dsn::string_view::npos;
+}
+
+#if defined(__x86_64__)
+
+// The candidate positions are those where both the first and the last byte of the pattern
+// match, which are found by comparing a whole block of positions at once. Only candidates are
+// verified by memcmp, the positions left at the tail are checked by the scalar version.
+inline bool match_anywhere_sse2(dsn::string_view value, dsn::string_view pattern)
+{
+    const size_t n = value.length();
+    const size_t k = pattern.length();
+    if (k == 1) {
+        return ::memchr(value.data(), pattern[0], n) != nullptr;
+    }
+
+    const char *s = value.data();
+    const __m128i first = _mm_set1_epi8(pattern[0]);
+    const __m128i last = _mm_set1_epi8(pattern[k - 1]);
+    size_t i = 0;
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+        const __m128i block_last =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + k - 1));
+        unsigned mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+        while (mask != 0) {
+            const int bit = __builtin_ctz(mask);
+            if (::memcmp(s + i + bit + 1, pattern.data() + 1, k - 2) == 0) {
+                return true;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return match_anywhere_scalar(value.substr(i), pattern);
+}
+
+__attribute__((target("avx2"))) inline bool match_anywhere_avx2(dsn::string_view value,
+                                                                dsn::string_view pattern)
+{
+    const size_t n = value.length();
+    const size_t k = pattern.length();
+    if (k == 1) {
+        return ::memchr(value.data(), pattern[0], n) != nullptr;
+    }
+
+    const char *s = value.data();
+    const __m256i first = _mm256_set1_epi8(pattern[0]);
+    const __m256i last = _mm256_set1_epi8(pattern[k - 1]);
+    size_t i = 0;
+    for (; i + k - 1 + 32 <= n; i += 32) {
+        const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+        const __m256i block_last =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i + k - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last))));
+        while (mask != 0) {
+            const int bit = __builtin_ctz(mask);
+            if (::memcmp(s + i + bit + 1, pattern.data() + 1, k - 2) == 0) {
+                return true;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return match_anywhere_sse2(value.substr(i), pattern);
+}
+
+#endif
+
+typedef bool (*match_anywhere_func)(dsn::string_view value, dsn::string_view pattern);
+
+// the fastest implementation supported by the running cpu, which is selected only once.
+inline match_anywhere_func best_match_anywhere()
+{
+#if defined(__x86_64__)
+    static const match_anywhere_func func =
+        __builtin_cpu_supports("avx2") ? match_anywhere_avx2 : match_anywhere_sse2;
+    return func;
+#else
+    return match_anywhere_scalar;
+#endif
+}
+
+} // namespace key_filter_impl
+
+// An Aho-Corasick automaton, which checks whether any of the patterns appears in a text by
+// scanning the text only once.
+class aho_corasick_matcher
+{
+public:
+    explicit aho_corasick_matcher(const std::vector<std::string> &patterns);
+
+    // return true if any of the patterns is a substring of `text`.
+    bool match(dsn::string_view text) const;
+
+    size_t state_count() const { return _nodes.size(); }
+
+private:
+    struct node
+    {
+        // the goto transitions, sorted by the byte. Most of the nodes have only one or two
+        // children, so a linear search is faster than a table.
+        std::vector<std::pair<unsigned char, int32_t>> children;
+        int32_t fail{0};
+        // true if some pattern ends at this node or any of its suffixes.
+        bool output{false};
+    };
+
+    // return the child of `state` by `c`, or -1 if not exist.
+    int32_t child(int32_t state, unsigned char c) const;
+
+    int32_t add_child(int32_t state, unsigned char c);
+
+    std::vector<node> _nodes;
+    // the goto transitions of the root are looked up by a table, because the root is visited
+    // by most of the bytes of a text.
+    std::array<int32_t, 256> _root_children;
+    // true if there is an empty pattern, which matches any text.
+    bool _match_all{false};
+};
+
+// A hash_key/sort_key filter of scan and multi_get, compiled once from the filter type and
+// pattern of the request, and then applied to each row.
+//
+// The pattern of FT_MATCH_REGEX is an ECMAScript regular expression which is searched in the
+// key, and the pattern of FT_MATCH_MULTI_PATTERN is a list of patterns separated by '\n', any
+// of which appears in the key is a match.
+//
+// Since the regular expression comes from the client, it's limited to kMaxRegexLength, and a
+// key on which the search is too complex (e.g. the catastrophic backtracking of "(a+)+$") is
+// treated as not matched, instead of letting the exception of boost escape.
+class key_filter_matcher
+{
+public:
+    static const char kMultiPatternSeparator = '\n';
+    static const size_t kMaxRegexLength = 1024;
+
+    // a matcher of FT_NO_FILTER, which matches everything.
+    key_filter_matcher() = default;
+
+    key_filter_matcher(::dsn::apps::filter_type::type type, dsn::string_view pattern);
+
+    // return false if the pattern can't be compiled, e.g. an invalid regular expression.
+    bool valid() const { return _valid; }
+
+    bool no_filter() const { return _type == ::dsn::apps::filter_type::FT_NO_FILTER; }
+
+    ::dsn::apps::filter_type::type type() const { return _type; }
+
+    const std::string &pattern() const { return _pattern; }
+
+    // return true if `value` passes the filter.
+    bool match(dsn::string_view value) const
+    {
+        if (_type == ::dsn::apps::filter_type::FT_NO_FILTER || _pattern.empty()) {
+            return true;
+        }
+        switch (_type) {
+        case ::dsn::apps::filter_type::FT_MATCH_ANYWHERE:
+            return value.length() >= _pattern.length() && _match_anywhere(value, _pattern);
+        case ::dsn::apps::filter_type::FT_MATCH_PREFIX:
+            return value.length() >= _pattern.length() &&
+                   ::memcmp(value.data(), _pattern.data(), _pattern.length()) == 0;
+        case ::dsn::apps::filter_type::FT_MATCH_POSTFIX:
+            return value.length() >= _pattern.length() &&
+                   ::memcmp(value.data() + value.length() - _pattern.length(),
+                            _pattern.data(),
+                            _pattern.length()) == 0;
+        case ::dsn::apps::filter_type::FT_MATCH_REGEX:
+            return _regex != nullptr && match_regex(value);
+        case ::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN:
+            return _multi_pattern != nullptr && _multi_pattern->match(value);
+        default:
+            return false;
+        }
+    }
+
+private:
+    bool match_regex(dsn::string_view value) const;
+
+    ::dsn::apps::filter_type::type _type{::dsn::apps::filter_type::FT_NO_FILTER};
+    std::string _pattern;
+    bool _valid{true};
+    key_filter_impl::match_anywhere_func _match_anywhere{key_filter_impl::match_anywhere_scalar};
+    std::unique_ptr<boost::regex> _regex;
+    std::unique_ptr<aho_corasick_matcher> _multi_pattern;
+};
+
+} // namespace server
+} // namespace pegasus
@@ -121,6 +121,7 @@ public:
     }
     void EnableFilter() { _enabled.store(true, std::memory_order_release); }
     void SetDefaultTTL(uint32_t ttl) { _default_ttl.store(ttl, std::memory_order_release); }
+    uint32_t GetDefaultTTL() const { return _default_ttl.load(std::memory_order_acquire); }
     void SetValidatePartitionHash(bool validate_hash)
     {
         _validate_partition_hash.store(validate_hash, std::memory_order_release);
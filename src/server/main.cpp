@@ -22,6 +22,7 @@
 #include "info_collector_app.h"
 #include "brief_stat.h"
 #include "compaction_operation.h"
+#include "rocksdb_event_timeline.h"
 
 #include <pegasus/version.h>
 #include <pegasus/git_commit.h>
@@ -88,6 +89,13 @@ void dsn_app_registration_pegasus()
         "server-stat - query selected perf counters",
         "server-stat",
         [](const std::vector<std::string> &args) { return pegasus::get_brief_stat(); });
+    dsn::command_manager::instance().register_command(
+        {"rocksdb-events"},
+        "rocksdb-events - query the recent flush, compaction and write stall events of rocksdb",
+        "rocksdb-events [app_id[.partition_index]] [count]",
+        [](const std::vector<std::string> &args) {
+            return pegasus::server::rocksdb_event_timeline::instance().query_command(args);
+        });
     pegasus::server::register_compaction_operations();
 }
 
@@ -19,13 +19,81 @@
 
 #include "pegasus_event_listener.h"
 #include "logging_utils.h"
+#include "rocksdb_event_timeline.h"
 
+#include <dsn/c/api_layer1.h>
 #include <dsn/c/api_utilities.h>
+#include <dsn/dist/fmt_logging.h>
 
 namespace pegasus {
 namespace server {
 
-pegasus_event_listener::pegasus_event_listener(replica_base *r) : replica_base(r)
+namespace {
+
+const char *flush_reason_to_string(rocksdb::FlushReason reason)
+{
+    switch (reason) {
+    case rocksdb::FlushReason::kGetLiveFiles:
+        return "GetLiveFiles";
+    case rocksdb::FlushReason::kShutDown:
+        return "ShutDown";
+    case rocksdb::FlushReason::kExternalFileIngestion:
+        return "ExternalFileIngestion";
+    case rocksdb::FlushReason::kManualCompaction:
+        return "ManualCompaction";
+    case rocksdb::FlushReason::kWriteBufferManager:
+        return "WriteBufferManager";
+    case rocksdb::FlushReason::kWriteBufferFull:
+        return "WriteBufferFull";
+    case rocksdb::FlushReason::kManualFlush:
+        return "ManualFlush";
+    case rocksdb::FlushReason::kErrorRecovery:
+        return "ErrorRecovery";
+    default:
+        return "Other";
+    }
+}
+
+const char *compaction_reason_to_string(rocksdb::CompactionReason reason)
+{
+    switch (reason) {
+    case rocksdb::CompactionReason::kLevelL0FilesNum:
+        return "LevelL0FilesNum";
+    case rocksdb::CompactionReason::kLevelMaxLevelSize:
+        return "LevelMaxLevelSize";
+    case rocksdb::CompactionReason::kManualCompaction:
+        return "ManualCompaction";
+    case rocksdb::CompactionReason::kFilesMarkedForCompaction:
+        return "FilesMarkedForCompaction";
+    case rocksdb::CompactionReason::kBottommostFiles:
+        return "BottommostFiles";
+    case rocksdb::CompactionReason::kTtl:
+        return "Ttl";
+    case rocksdb::CompactionReason::kPeriodicCompaction:
+        return "PeriodicCompaction";
+    default:
+        return "Other";
+    }
+}
+
+const char *stall_condition_to_string(rocksdb::WriteStallCondition condition)
+{
+    switch (condition) {
+    case rocksdb::WriteStallCondition::kDelayed:
+        return "delayed";
+    case rocksdb::WriteStallCondition::kStopped:
+        return "stopped";
+    default:
+        return "normal";
+    }
+}
+
+} // anonymous namespace
+
+pegasus_event_listener::pegasus_event_listener(replica_base *r, int num_levels)
+    : replica_base(r),
+      _pfc_level_write_amplification(num_levels),
+      _level_written_bytes(num_levels, 0)
 {
     _pfc_recent_flush_completed_count.init_app_counter("app.pegasus",
                                                        "recent.flush.completed.count",
@@ -58,6 +126,22 @@ pegasus_event_listener::pegasus_event_listener(replica_base *r) : replica_base(r
         "recent.write.change.stopped.count",
         COUNTER_TYPE_VOLATILE_NUMBER,
         "rocksdb recent write change stopped count");
+
+    std::string str_gpid = get_gpid().to_string();
+    for (int i = 0; i < num_levels; ++i) {
+        std::string name = fmt::format("rdb.level{}.write_amplification@{}", i, str_gpid);
+        std::string desc = fmt::format(
+            "the bytes written into level {} of rocksdb per byte flushed, in percentage", i);
+        _pfc_level_write_amplification[i].init_app_counter(
+            "app.pegasus", name.c_str(), COUNTER_TYPE_NUMBER, desc.c_str());
+    }
+}
+
+void pegasus_event_listener::OnFlushBegin(rocksdb::DB *db,
+                                          const rocksdb::FlushJobInfo &flush_job_info)
+{
+    ::dsn::zauto_lock l(_lock);
+    _flush_begin_time_ms[flush_job_info.job_id] = dsn_now_ms();
 }
 
 void pegasus_event_listener::OnFlushCompleted(rocksdb::DB *db,
@@ -65,6 +149,29 @@ void pegasus_event_listener::OnFlushCompleted(rocksdb::DB *db,
 {
     _pfc_recent_flush_completed_count->increment();
     _pfc_recent_flush_output_bytes->add(flush_job_info.table_properties.data_size);
+
+    rocksdb_event event;
+    event.event_type = rocksdb_event::type::FLUSH;
+    event.pid = get_gpid();
+    event.time_ms = dsn_now_ms();
+    event.cf_name = flush_job_info.cf_name;
+    event.job_id = flush_job_info.job_id;
+    event.reason = flush_reason_to_string(flush_job_info.flush_reason);
+    event.output_files = 1;
+    event.output_bytes = flush_job_info.table_properties.data_size;
+    {
+        ::dsn::zauto_lock l(_lock);
+        auto iter = _flush_begin_time_ms.find(flush_job_info.job_id);
+        if (iter != _flush_begin_time_ms.end()) {
+            event.duration_ms = event.time_ms - iter->second;
+            _flush_begin_time_ms.erase(iter);
+        }
+    }
+    rocksdb_event_timeline::instance().add(std::move(event));
+
+    if (flush_job_info.cf_name == rocksdb::kDefaultColumnFamilyName) {
+        update_level_write_amplification(0, flush_job_info.table_properties.data_size, true);
+    }
 }
 
 void pegasus_event_listener::OnCompactionCompleted(rocksdb::DB *db,
@@ -73,6 +180,41 @@ void pegasus_event_listener::OnCompactionCompleted(rocksdb::DB *db,
     _pfc_recent_compaction_completed_count->increment();
     _pfc_recent_compaction_input_bytes->add(ci.stats.total_input_bytes);
     _pfc_recent_compaction_output_bytes->add(ci.stats.total_output_bytes);
+
+    rocksdb_event event;
+    event.event_type = rocksdb_event::type::COMPACTION;
+    event.pid = get_gpid();
+    event.time_ms = dsn_now_ms();
+    event.cf_name = ci.cf_name;
+    event.job_id = ci.job_id;
+    event.reason = compaction_reason_to_string(ci.compaction_reason);
+    event.input_level = ci.base_input_level;
+    event.output_level = ci.output_level;
+    event.input_files = ci.stats.num_input_files;
+    event.output_files = ci.stats.num_output_files;
+    event.input_bytes = ci.stats.total_input_bytes;
+    event.output_bytes = ci.stats.total_output_bytes;
+    event.duration_ms = ci.stats.elapsed_micros / 1000;
+    // The listener doesn't tell the input bytes of each level, so the bytes coming from the
+    // input level are estimated by its share of the input files.
+    uint64_t input_level_bytes = ci.stats.total_input_bytes;
+    if (ci.stats.num_input_files > ci.stats.num_input_files_at_output_level) {
+        input_level_bytes = ci.stats.total_input_bytes *
+                            (ci.stats.num_input_files - ci.stats.num_input_files_at_output_level) /
+                            ci.stats.num_input_files;
+    }
+    if (input_level_bytes > 0) {
+        event.write_amplification = (double)ci.stats.total_output_bytes / input_level_bytes;
+    }
+    if (ci.stats.total_output_bytes > 0) {
+        event.read_amplification =
+            (double)ci.stats.total_input_bytes / ci.stats.total_output_bytes;
+    }
+    rocksdb_event_timeline::instance().add(std::move(event));
+
+    if (ci.cf_name == rocksdb::kDefaultColumnFamilyName) {
+        update_level_write_amplification(ci.output_level, ci.stats.total_output_bytes, false);
+    }
 }
 
 void pegasus_event_listener::OnStallConditionsChanged(const rocksdb::WriteStallInfo &info)
@@ -84,6 +226,52 @@ void pegasus_event_listener::OnStallConditionsChanged(const rocksdb::WriteStallI
         derror_replica("rocksdb write stopped");
         _pfc_recent_write_change_stopped_count->increment();
     }
+
+    rocksdb_event event;
+    event.event_type = rocksdb_event::type::STALL;
+    event.pid = get_gpid();
+    event.time_ms = dsn_now_ms();
+    event.cf_name = info.cf_name;
+    event.prev_condition = stall_condition_to_string(info.condition.prev);
+    event.cur_condition = stall_condition_to_string(info.condition.cur);
+    {
+        ::dsn::zauto_lock l(_lock);
+        if (info.condition.cur == rocksdb::WriteStallCondition::kNormal) {
+            auto iter = _stall_begin_time_ms.find(info.cf_name);
+            if (iter != _stall_begin_time_ms.end()) {
+                event.stall_duration_ms = event.time_ms - iter->second;
+                _stall_begin_time_ms.erase(iter);
+            }
+        } else if (info.condition.prev == rocksdb::WriteStallCondition::kNormal) {
+            _stall_begin_time_ms[info.cf_name] = event.time_ms;
+        }
+    }
+    rocksdb_event_timeline::instance().add(std::move(event));
+}
+
+void pegasus_event_listener::update_level_write_amplification(int level,
+                                                              uint64_t bytes,
+                                                              bool is_flush)
+{
+    if (level < 0 || level >= (int)_level_written_bytes.size()) {
+        return;
+    }
+
+    ::dsn::zauto_lock l(_lock);
+    if (is_flush) {
+        _flushed_bytes += bytes;
+    }
+    _level_written_bytes[level] += bytes;
+    if (_flushed_bytes == 0) {
+        return;
+    }
+    // a flush changes the amplification of all the levels.
+    for (int i = 0; i < (int)_level_written_bytes.size(); ++i) {
+        if (is_flush || i == level) {
+            _pfc_level_write_amplification[i]->set(_level_written_bytes[i] * 100 /
+                                                   _flushed_bytes);
+        }
+    }
 }
 
 } // namespace server
@@ -19,10 +19,14 @@
 
 #pragma once
 
+#include <map>
+#include <vector>
+
 #include <rocksdb/db.h>
 #include <rocksdb/listener.h>
 #include <dsn/perf_counter/perf_counter_wrapper.h>
 #include <dsn/dist/replication/replica_base.h>
+#include <dsn/tool-api/zlocks.h>
 
 namespace pegasus {
 namespace server {
@@ -30,9 +34,12 @@ namespace server {
 class pegasus_event_listener : public rocksdb::EventListener, dsn::replication::replica_base
 {
 public:
-    explicit pegasus_event_listener(replica_base *r);
+    // `num_levels` is the number of levels of the data column family.
+    pegasus_event_listener(replica_base *r, int num_levels);
     ~pegasus_event_listener() override = default;
 
+    void OnFlushBegin(rocksdb::DB *db, const rocksdb::FlushJobInfo &flush_job_info) override;
+
     void OnFlushCompleted(rocksdb::DB *db, const rocksdb::FlushJobInfo &flush_job_info) override;
 
     void OnCompactionCompleted(rocksdb::DB *db, const rocksdb::CompactionJobInfo &ci) override;
@@ -40,6 +47,12 @@ public:
     void OnStallConditionsChanged(const rocksdb::WriteStallInfo &info) override;
 
 private:
+    friend class pegasus_event_listener_test;
+
+    // update the write amplification counters of the data column family after `bytes` are
+    // written into `level`.
+    void update_level_write_amplification(int level, uint64_t bytes, bool is_flush);
+
     ::dsn::perf_counter_wrapper _pfc_recent_flush_completed_count;
     ::dsn::perf_counter_wrapper _pfc_recent_flush_output_bytes;
     ::dsn::perf_counter_wrapper _pfc_recent_compaction_completed_count;
@@ -47,6 +60,18 @@ private:
     ::dsn::perf_counter_wrapper _pfc_recent_compaction_output_bytes;
     ::dsn::perf_counter_wrapper _pfc_recent_write_change_delayed_count;
     ::dsn::perf_counter_wrapper _pfc_recent_write_change_stopped_count;
+    // the bytes written into each level per byte flushed, in percentage
+    std::vector<::dsn::perf_counter_wrapper> _pfc_level_write_amplification;
+
+    ::dsn::zlock _lock; // [
+    // job_id => the time when the flush began
+    std::map<int, uint64_t> _flush_begin_time_ms;
+    // cf_name => the time when the writes of the column family began to stall
+    std::map<std::string, uint64_t> _stall_begin_time_ms;
+    uint64_t _flushed_bytes = 0;
+    // the bytes written into each level by flushes and compactions since the db is opened
+    std::vector<uint64_t> _level_written_bytes;
+    // ]
 };
 
 } // namespace server
@@ -27,6 +27,7 @@
 
 #include "base/pegasus_const.h"
 #include "pegasus_server_impl.h"
+#include "compaction_scheduler.h"
 
 namespace pegasus {
 namespace server {
@@ -97,10 +98,19 @@ void pegasus_manual_compact_service::start_manual_compact_if_needed(
         extract_manual_compact_opts(envs, compact_rule, options);
 
         _pfc_manual_compact_enqueue_count->increment();
-        dsn::tasking::enqueue(LPC_MANUAL_COMPACT, &_app->_tracker, [this, options]() {
-            _pfc_manual_compact_enqueue_count->decrement();
-            manual_compact(options);
+        // the compaction is started after the ones queued before it on this server, see
+        // compaction_scheduler.
+        bool queued = _app->_s_compaction_scheduler->enqueue(get_gpid(), [this, options]() {
+            dsn::tasking::enqueue(LPC_MANUAL_COMPACT, &_app->_tracker, [this, options]() {
+                _pfc_manual_compact_enqueue_count->decrement();
+                manual_compact(options);
+            });
         });
+        if (!queued) {
+            _pfc_manual_compact_enqueue_count->decrement();
+            _manual_compact_enqueue_time_ms.store(0);
+            ddebug_replica("ignored compact because last one is still in compaction scheduler");
+        }
     } else {
         ddebug_replica("ignored compact because last one is on going or just finished");
     }
@@ -281,6 +291,7 @@ void pegasus_manual_compact_service::manual_compact(const rocksdb::CompactRangeO
     if (_disabled.load()) {
         ddebug_replica("ignored compact because disabled");
         _manual_compact_enqueue_time_ms.store(0);
+        _app->_s_compaction_scheduler->finish(get_gpid());
         return;
     }
 
@@ -291,6 +302,7 @@ void pegasus_manual_compact_service::manual_compact(const rocksdb::CompactRangeO
         ddebug_replica("ignored compact because exceed max_concurrent_running_count({})",
                        _max_concurrent_running_count.load());
         _manual_compact_enqueue_time_ms.store(0);
+        _app->_s_compaction_scheduler->finish(get_gpid());
         return;
     }
 
@@ -299,6 +311,16 @@ void pegasus_manual_compact_service::manual_compact(const rocksdb::CompactRangeO
     end_manual_compact(start, finish);
 
     _pfc_manual_compact_running_count->decrement();
+    _app->_s_compaction_scheduler->finish(get_gpid());
+}
+
+void pegasus_manual_compact_service::cancel_scheduled_compact()
+{
+    if (_app->_s_compaction_scheduler->remove(get_gpid())) {
+        ddebug_replica("removed the queued compact from compaction scheduler");
+        _pfc_manual_compact_enqueue_count->decrement();
+        _manual_compact_enqueue_time_ms.store(0);
+    }
 }
 
 uint64_t pegasus_manual_compact_service::begin_manual_compact()
@@ -348,6 +370,11 @@ std::string pegasus_manual_compact_service::query_compact_state() const
         dsn::utils::time_ms_to_string(start_time_ms, str);
         state << ", recent start at [" << str << "]";
     }
+
+    std::string scheduler_state = _app->_s_compaction_scheduler->query_state(get_gpid());
+    if (!scheduler_state.empty()) {
+        state << ", " << scheduler_state;
+    }
     return state.str();
 }
 
@@ -40,6 +40,10 @@ public:
 
     std::string query_compact_state() const;
 
+    // remove the compaction of this replica queued in the compaction scheduler, called when the
+    // replica is closed.
+    void cancel_scheduled_compact();
+
 private:
     friend class manual_compact_service_test;
 
@@ -66,10 +66,45 @@ using namespace dsn::literals::chrono_literals;
         dsn::from_blob_to_thrift(data, thrift_request);
         return pegasus_hash_key_hash(thrift_request.hash_key);
     }
+    if (tc == dsn::apps::RPC_RRDB_RRDB_BATCH_WRITE) {
+        // all the keys of a batch_write belong to the same local partition, but a batch_write
+        // is split by split_batch_write() before duplicated.
+        dsn::apps::batch_write_request thrift_request;
+        dsn::from_blob_to_thrift(data, thrift_request);
+        return thrift_request.operations.empty()
+                   ? 0
+                   : pegasus_key_hash(thrift_request.operations[0].key);
+    }
     dfatal("unexpected task code: %s", tc.to_string());
     __builtin_unreachable();
 }
 
+/*extern*/ std::vector<std::pair<dsn::task_code, dsn::blob>>
+split_batch_write(const dsn::blob &request_data)
+{
+    dsn::apps::batch_write_request thrift_request;
+    dsn::from_blob_to_thrift(request_data, thrift_request);
+    std::vector<std::pair<dsn::task_code, dsn::blob>> writes;
+    writes.reserve(thrift_request.operations.size());
+    for (auto &op : thrift_request.operations) {
+        dsn::message_ptr msg;
+        if (op.operation == dsn::apps::mutate_operation::MO_PUT) {
+            dsn::apps::update_request request;
+            request.key = std::move(op.key);
+            request.value = std::move(op.value);
+            request.expire_ts_seconds = op.expire_ts_seconds;
+            msg = dsn::from_thrift_request_to_received_message(request,
+                                                               dsn::apps::RPC_RRDB_RRDB_PUT);
+            writes.emplace_back(dsn::apps::RPC_RRDB_RRDB_PUT, dsn::move_message_to_blob(msg));
+        } else {
+            msg = dsn::from_thrift_request_to_received_message(op.key,
+                                                               dsn::apps::RPC_RRDB_RRDB_REMOVE);
+            writes.emplace_back(dsn::apps::RPC_RRDB_RRDB_REMOVE, dsn::move_message_to_blob(msg));
+        }
+    }
+    return writes;
+}
+
 pegasus_mutation_duplicator::pegasus_mutation_duplicator(dsn::replication::replica_base *r,
                                                          dsn::string_view remote_cluster,
                                                          dsn::string_view app)
@@ -184,31 +219,42 @@ void pegasus_mutation_duplicator::duplicate(mutation_tuple_set muts, callback cb
 {
     _total_shipped_size = 0;
 
+    auto add_inflight = [this](uint64_t timestamp, dsn::task_code rpc_code, dsn::blob raw_message) {
+        auto dreq = dsn::make_unique<dsn::apps::duplicate_request>();
+        dreq->__set_raw_message(raw_message);
+        dreq->__set_task_code(rpc_code);
+        dreq->__set_timestamp(timestamp);
+        dreq->__set_cluster_id(get_current_cluster_id());
+
+        uint64_t hash = get_hash_from_request(rpc_code, raw_message);
+        duplicate_rpc rpc(std::move(dreq),
+                          dsn::apps::RPC_RRDB_RRDB_DUPLICATE,
+                          10_s, // TODO(wutao1): configurable timeout.
+                          hash);
+        _inflights[hash].push_back(std::move(rpc));
+    };
+
     for (auto mut : muts) {
         // mut: 0=timestamp, 1=rpc_code, 2=raw_message
 
         dsn::task_code rpc_code = std::get<1>(mut);
         dsn::blob raw_message = std::get<2>(mut);
-        auto dreq = dsn::make_unique<dsn::apps::duplicate_request>();
 
         if (rpc_code == dsn::apps::RPC_RRDB_RRDB_DUPLICATE) {
             // ignore if it is a DUPLICATE
             // Because DUPLICATE comes from other clusters should not be forwarded to any other
             // destinations. A DUPLICATE is meant to be targeting only one cluster.
             continue;
+        } else if (rpc_code == dsn::apps::RPC_RRDB_RRDB_BATCH_WRITE) {
+            // the keys of a batch_write may belong to different partitions of the remote cluster,
+            // whose partition count may differ, so it's duplicated key by key. The writes on the
+            // same key are still shipped in order.
+            for (auto &write : split_batch_write(raw_message)) {
+                add_inflight(std::get<0>(mut), write.first, std::move(write.second));
+            }
         } else {
-            dreq->__set_raw_message(raw_message);
-            dreq->__set_task_code(rpc_code);
-            dreq->__set_timestamp(std::get<0>(mut));
-            dreq->__set_cluster_id(get_current_cluster_id());
+            add_inflight(std::get<0>(mut), rpc_code, std::move(raw_message));
         }
-
-        uint64_t hash = get_hash_from_request(rpc_code, raw_message);
-        duplicate_rpc rpc(std::move(dreq),
-                          dsn::apps::RPC_RRDB_RRDB_DUPLICATE,
-                          10_s, // TODO(wutao1): configurable timeout.
-                          hash);
-        _inflights[hash].push_back(std::move(rpc));
     }
 
     if (_inflights.empty()) {
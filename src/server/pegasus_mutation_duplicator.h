@@ -75,5 +75,10 @@ private:
 // calculates the hash value from the write's hash key.
 extern uint64_t get_hash_from_request(dsn::task_code rpc_code, const dsn::blob &request_data);
 
+// Splits the binary batch_write request `request_data` into the put and remove requests of its
+// operations in order, each of which is routed by its own key.
+extern std::vector<std::pair<dsn::task_code, dsn::blob>>
+split_batch_write(const dsn::blob &request_data);
+
 } // namespace server
 } // namespace pegasus
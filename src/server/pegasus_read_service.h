@@ -27,7 +27,11 @@ namespace server {
 typedef ::dsn::rpc_holder<::dsn::blob, ::dsn::apps::read_response> get_rpc;
 typedef ::dsn::rpc_holder<dsn::apps::multi_get_request, dsn::apps::multi_get_response>
     multi_get_rpc;
+typedef ::dsn::rpc_holder<dsn::apps::batch_get_request, dsn::apps::batch_get_response>
+    batch_get_rpc;
 typedef ::dsn::rpc_holder<::dsn::blob, dsn::apps::count_response> sortkey_count_rpc;
+typedef ::dsn::rpc_holder<dsn::apps::sortkey_count_request, dsn::apps::count_response>
+    sortkey_count_v2_rpc;
 typedef ::dsn::rpc_holder<::dsn::blob, dsn::apps::ttl_response> ttl_rpc;
 typedef ::dsn::rpc_holder<::dsn::apps::get_scanner_request, dsn::apps::scan_response>
     get_scanner_rpc;
@@ -53,8 +57,12 @@ protected:
     virtual void on_get(get_rpc rpc) = 0;
     // RPC_RRDB_RRDB_MULTI_GET
     virtual void on_multi_get(multi_get_rpc rpc) = 0;
+    // RPC_RRDB_RRDB_BATCH_GET
+    virtual void on_batch_get(batch_get_rpc rpc) = 0;
     // RPC_RRDB_RRDB_SORTKEY_COUNT
     virtual void on_sortkey_count(sortkey_count_rpc rpc) = 0;
+    // RPC_RRDB_RRDB_SORTKEY_COUNT_V2
+    virtual void on_sortkey_count_v2(sortkey_count_v2_rpc rpc) = 0;
     // RPC_RRDB_RRDB_TTL
     virtual void on_ttl(ttl_rpc rpc) = 0;
     // RPC_RRDB_RRDB_GET_SCANNER
@@ -69,8 +77,12 @@ protected:
         register_rpc_handler_with_rpc_holder(dsn::apps::RPC_RRDB_RRDB_GET, "get", on_get);
         register_rpc_handler_with_rpc_holder(
             dsn::apps::RPC_RRDB_RRDB_MULTI_GET, "multi_get", on_multi_get);
+        register_rpc_handler_with_rpc_holder(
+            dsn::apps::RPC_RRDB_RRDB_BATCH_GET, "batch_get", on_batch_get);
         register_rpc_handler_with_rpc_holder(
             dsn::apps::RPC_RRDB_RRDB_SORTKEY_COUNT, "sortkey_count", on_sortkey_count);
+        register_rpc_handler_with_rpc_holder(
+            dsn::apps::RPC_RRDB_RRDB_SORTKEY_COUNT_V2, "sortkey_count_v2", on_sortkey_count_v2);
         register_rpc_handler_with_rpc_holder(dsn::apps::RPC_RRDB_RRDB_TTL, "ttl", on_ttl);
         register_rpc_handler_with_rpc_holder(
             dsn::apps::RPC_RRDB_RRDB_GET_SCANNER, "get_scanner", on_get_scanner);
@@ -85,10 +97,18 @@ private:
     {
         svc->on_multi_get(rpc);
     }
+    static void on_batch_get(pegasus_read_service *svc, batch_get_rpc rpc)
+    {
+        svc->on_batch_get(rpc);
+    }
     static void on_sortkey_count(pegasus_read_service *svc, sortkey_count_rpc rpc)
     {
         svc->on_sortkey_count(rpc);
     }
+    static void on_sortkey_count_v2(pegasus_read_service *svc, sortkey_count_v2_rpc rpc)
+    {
+        svc->on_sortkey_count_v2(rpc);
+    }
     static void on_ttl(pegasus_read_service *svc, ttl_rpc rpc) { svc->on_ttl(rpc); }
     static void on_get_scanner(pegasus_read_service *svc, get_scanner_rpc rpc)
     {
@@ -19,72 +19,216 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <rocksdb/db.h>
 #include <dsn/tool_api.h>
 #include <dsn/utility/rand.h>
+#include <dsn/utility/string_conv.h>
 #include <rrdb/rrdb_types.h>
 
 #include "base/pegasus_const.h"
 #include "base/pegasus_utils.h"
+#include "key_filter_matcher.h"
 
 namespace pegasus {
 namespace server {
 
+// The memory budget shared by all the prefetched scan batches on one server.
+class scan_prefetch_budget
+{
+public:
+    explicit scan_prefetch_budget(uint64_t limit_bytes) : _limit_bytes(limit_bytes) {}
+
+    bool exhausted() const { return _used_bytes.load() >= _limit_bytes; }
+
+    // acquires `bytes` atomically, fails if the limit would be exceeded.
+    bool try_acquire(uint64_t bytes)
+    {
+        uint64_t used = _used_bytes.load();
+        do {
+            if (used + bytes > _limit_bytes) {
+                return false;
+            }
+        } while (!_used_bytes.compare_exchange_weak(used, used + bytes));
+        return true;
+    }
+
+    void acquire(uint64_t bytes) { _used_bytes.fetch_add(bytes); }
+
+    void release(uint64_t bytes) { _used_bytes.fetch_sub(bytes); }
+
+    uint64_t used_bytes() const { return _used_bytes.load(); }
+
+private:
+    const uint64_t _limit_bytes;
+    std::atomic<uint64_t> _used_bytes{0};
+};
+
+// The bytes acquired from a scan_prefetch_budget, which are released when it's destroyed.
+class scan_prefetch_reservation
+{
+public:
+    scan_prefetch_reservation(std::shared_ptr<scan_prefetch_budget> budget, uint64_t bytes)
+        : _budget(std::move(budget)), _bytes(bytes)
+    {
+    }
+    ~scan_prefetch_reservation() { _budget->release(_bytes); }
+
+    scan_prefetch_reservation(const scan_prefetch_reservation &) = delete;
+    scan_prefetch_reservation &operator=(const scan_prefetch_reservation &) = delete;
+
+private:
+    const std::shared_ptr<scan_prefetch_budget> _budget;
+    const uint64_t _bytes;
+};
+
+// Aggregates the rows of one scan batch, so that only the aggregate is returned to the client
+// instead of the rows.
+class scan_aggregator
+{
+public:
+    explicit scan_aggregator(::dsn::apps::scan_aggregate_type::type type) : _type(type) {}
+
+    // `key` is the raw key stored in rocksdb, `user_value` is the value without the header.
+    void add(dsn::string_view key, dsn::string_view user_value)
+    {
+        _result.row_count++;
+        // the raw key is prefixed by the 2-bytes length of the hash key.
+        _result.key_bytes += key.length() - 2;
+        _result.value_bytes += user_value.length();
+        if (_type != ::dsn::apps::scan_aggregate_type::SA_INT_STATS) {
+            return;
+        }
+
+        int64_t v;
+        if (!dsn::buf2int64(user_value, v)) {
+            return;
+        }
+        if (_result.int_count == 0) {
+            _result.int_min = v;
+            _result.int_max = v;
+        } else {
+            _result.int_min = std::min(_result.int_min, v);
+            _result.int_max = std::max(_result.int_max, v);
+        }
+        _result.int_count++;
+        // the sum wraps around on overflow instead of being undefined.
+        _result.int_sum = static_cast<int64_t>(static_cast<uint64_t>(_result.int_sum) +
+                                               static_cast<uint64_t>(v));
+    }
+
+    const ::dsn::apps::scan_aggregate_result &result() const { return _result; }
+
+private:
+    const ::dsn::apps::scan_aggregate_type::type _type;
+    ::dsn::apps::scan_aggregate_result _result;
+};
+
+// The result of scanning one batch.
+struct scan_batch_result
+{
+    int32_t error{0};
+    // true if the scan is not completed, and the context should be kept for the next batch.
+    bool has_more{false};
+    // the aggregate of the batch, only used if the scan is an aggregation.
+    ::dsn::apps::scan_aggregate_result aggregate;
+};
+
 struct pegasus_scan_context
 {
     pegasus_scan_context(std::unique_ptr<rocksdb::Iterator> &&iterator_,
                          const std::string &&stop_,
                          bool stop_inclusive_,
-                         ::dsn::apps::filter_type::type hash_key_filter_type_,
-                         const std::string &&hash_key_filter_pattern_,
-                         ::dsn::apps::filter_type::type sort_key_filter_type_,
-                         const std::string &&sort_key_filter_pattern_,
+                         key_filter_matcher &&hash_key_filter_,
+                         key_filter_matcher &&sort_key_filter_,
                          int32_t batch_size_,
                          bool no_value_,
                          bool validate_partition_hash_,
-                         bool return_expire_ts_)
+                         bool return_expire_ts_,
+                         ::dsn::apps::scan_aggregate_type::type aggregate_type_)
         : _stop_holder(std::move(stop_)),
-          _hash_key_filter_pattern_holder(std::move(hash_key_filter_pattern_)),
-          _sort_key_filter_pattern_holder(std::move(sort_key_filter_pattern_)),
           iterator(std::move(iterator_)),
           stop(_stop_holder.data(), _stop_holder.size()),
           stop_inclusive(stop_inclusive_),
-          hash_key_filter_type(hash_key_filter_type_),
-          hash_key_filter_pattern(
-              _hash_key_filter_pattern_holder.data(), 0, _hash_key_filter_pattern_holder.length()),
-          sort_key_filter_type(sort_key_filter_type_),
-          sort_key_filter_pattern(
-              _sort_key_filter_pattern_holder.data(), 0, _sort_key_filter_pattern_holder.length()),
+          hash_key_filter(std::move(hash_key_filter_)),
+          sort_key_filter(std::move(sort_key_filter_)),
           batch_size(batch_size_),
           no_value(no_value_),
           validate_partition_hash(validate_partition_hash_),
-          return_expire_ts(return_expire_ts_)
+          return_expire_ts(return_expire_ts_),
+          aggregate_type(aggregate_type_)
+    {
+    }
+
+    ~pegasus_scan_context() { clear_prefetched_batch(); }
+
+    // the next batch is prefetched into `prefetched_kvs` and `prefetched_result`, whose memory
+    // is accounted in `budget` until it's consumed or the context is released.
+    void set_prefetched_batch(std::shared_ptr<scan_prefetch_budget> budget, uint64_t bytes)
+    {
+        has_prefetched_batch = true;
+        _prefetch_budget = std::move(budget);
+        _prefetched_bytes = bytes;
+        _prefetch_budget->acquire(_prefetched_bytes);
+    }
+
+    void clear_prefetched_batch()
     {
+        if (_prefetch_budget != nullptr) {
+            _prefetch_budget->release(_prefetched_bytes);
+            _prefetch_budget = nullptr;
+        }
+        _prefetched_bytes = 0;
+        has_prefetched_batch = false;
+        prefetched_kvs.clear();
     }
 
 private:
     std::string _stop_holder;
-    std::string _hash_key_filter_pattern_holder;
-    std::string _sort_key_filter_pattern_holder;
 
 public:
     std::unique_ptr<rocksdb::Iterator> iterator;
     rocksdb::Slice stop;
     bool stop_inclusive;
-    ::dsn::apps::filter_type::type hash_key_filter_type;
-    dsn::blob hash_key_filter_pattern;
-    ::dsn::apps::filter_type::type sort_key_filter_type;
-    dsn::blob sort_key_filter_pattern;
+    // the filters are compiled once when the scan starts, and reused by all the batches.
+    key_filter_matcher hash_key_filter;
+    key_filter_matcher sort_key_filter;
     int32_t batch_size;
     bool no_value;
     bool validate_partition_hash;
     bool return_expire_ts;
+    // SA_NONE if the scan returns the rows.
+    ::dsn::apps::scan_aggregate_type::type aggregate_type;
+
+    bool has_prefetched_batch{false};
+    std::vector<::dsn::apps::key_value> prefetched_kvs;
+    scan_batch_result prefetched_result;
+
+private:
+    std::shared_ptr<scan_prefetch_budget> _prefetch_budget;
+    uint64_t _prefetched_bytes{0};
 };
 
+// The cache of scan contexts on one replica.
+//
+// It is split into shards by context id, each guarded by its own spin lock, so that concurrent
+// get_scanner/scan/clear_scanner requests seldom contend on the same lock.
+//
+// Each context is stamped with the time it is put into the cache (i.e. the time the last
+// batch of the scan was returned). Contexts of the scans abandoned by clients (which never
+// call clear_scanner) are evicted by evict_idle_contexts(), which is expected to be called
+// periodically, to release the rocksdb iterators which pin memtables and sst files.
 class pegasus_context_cache
 {
 public:
+    static const int kShardCount = 16;
+
     pegasus_context_cache()
     {
         // some comments:
@@ -98,39 +242,235 @@ public:
         //
         // however, currently the implementation is not 100% correct.
         //
-        _counter = dsn::rand::next_u64(0, 2L << 31);
-        _counter <<= 32;
+        int64_t counter = dsn::rand::next_u64(0, 2L << 31);
+        counter <<= 32;
+        _counter.store(counter);
     }
 
+    // 0 means no limit, otherwise the limit of each shard is rounded up, so that a small
+    // `max_count` won't become unlimited.
+    void set_max_count(uint32_t max_count)
+    {
+        _max_count_per_shard =
+            max_count == 0 ? 0 : std::max(1u, (max_count + kShardCount - 1) / kShardCount);
+    }
+
+    // removes all the contexts, and notifies the fetchers parked on them.
     void clear()
     {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        _map.clear();
+        for (auto &shard : _shards) {
+            context_map cleared;
+            std::vector<std::function<void()>> waiters;
+            {
+                ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+                _count.fetch_sub(shard.map.size());
+                cleared.swap(shard.map);
+            }
+            for (auto &kv : cleared) {
+                for (auto &waiter : kv.second.waiters) {
+                    waiters.emplace_back(std::move(waiter));
+                }
+            }
+            // the cleared contexts (and their iterators) are released out of the lock
+            cleared.clear();
+            notify(waiters);
+        }
     }
 
-    int64_t put(std::unique_ptr<pegasus_scan_context> context)
+    // returns the handle of the context.
+    // if the shard is full, the least recently used context in it will be evicted, and
+    // `evicted` will be set to true.
+    int64_t put(std::unique_ptr<pegasus_scan_context> context, uint64_t now_ms, bool &evicted)
     {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        int64_t handle = _counter++;
-        _map[handle] = std::move(context);
+        evicted = false;
+        int64_t handle = _counter.fetch_add(1);
+        std::unique_ptr<pegasus_scan_context> evicted_context;
+        std::vector<std::function<void()>> waiters;
+        {
+            context_shard &shard = get_shard(handle);
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+            if (_max_count_per_shard > 0 && shard.map.size() >= _max_count_per_shard) {
+                // NOTE: the busy context may also be evicted, it will be dropped when released.
+                auto lru = std::min_element(
+                    shard.map.begin(),
+                    shard.map.end(),
+                    [](const context_map::value_type &a, const context_map::value_type &b) {
+                        return a.second.last_access_time_ms < b.second.last_access_time_ms;
+                    });
+                evicted_context = std::move(lru->second.context);
+                waiters = std::move(lru->second.waiters);
+                shard.map.erase(lru);
+                _count.fetch_sub(1);
+                evicted = true;
+            }
+            shard.map.emplace(handle, context_entry{std::move(context), now_ms});
+            _count.fetch_add(1);
+        }
+        // the evicted context (and its iterator) is released out of the lock
+        notify(waiters);
         return handle;
     }
 
-    std::unique_ptr<pegasus_scan_context> fetch(int64_t handle)
+    int64_t put(std::unique_ptr<pegasus_scan_context> context)
     {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        auto kv = _map.find(handle);
-        if (kv == _map.end())
+        bool evicted;
+        return put(std::move(context), dsn_now_ms(), evicted);
+    }
+
+    // fetches and removes the context from the cache.
+    // if the context is acquired by the background prefetch, returns nullptr and sets `busy`
+    // to true, and `on_released` (if any) will be called once the context is given back or
+    // dropped, so that the caller can retry then.
+    std::unique_ptr<pegasus_scan_context>
+    fetch(int64_t handle, bool &busy, std::function<void()> on_released = nullptr)
+    {
+        busy = false;
+        context_shard &shard = get_shard(handle);
+        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+        auto kv = shard.map.find(handle);
+        if (kv == shard.map.end())
+            return nullptr;
+        if (kv->second.busy) {
+            busy = true;
+            if (on_released) {
+                kv->second.waiters.emplace_back(std::move(on_released));
+            }
             return nullptr;
-        std::unique_ptr<pegasus_scan_context> ret = std::move(kv->second);
-        _map.erase(kv);
+        }
+        std::unique_ptr<pegasus_scan_context> ret = std::move(kv->second.context);
+        shard.map.erase(kv);
+        _count.fetch_sub(1);
         return ret;
     }
 
+    std::unique_ptr<pegasus_scan_context> fetch(int64_t handle)
+    {
+        bool busy;
+        return fetch(handle, busy);
+    }
+
+    // removes the context from the cache, no matter whether it's acquired by the background
+    // prefetch.
+    void remove(int64_t handle)
+    {
+        std::unique_ptr<pegasus_scan_context> removed;
+        std::vector<std::function<void()>> waiters;
+        {
+            context_shard &shard = get_shard(handle);
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+            auto kv = shard.map.find(handle);
+            if (kv != shard.map.end()) {
+                removed = std::move(kv->second.context);
+                waiters = std::move(kv->second.waiters);
+                shard.map.erase(kv);
+                _count.fetch_sub(1);
+            }
+        }
+        notify(waiters);
+    }
+
+    // acquires the context for background prefetch, the context is kept in the cache with the
+    // same handle but marked as busy, until it's given back by release().
+    std::unique_ptr<pegasus_scan_context> acquire(int64_t handle)
+    {
+        context_shard &shard = get_shard(handle);
+        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+        auto kv = shard.map.find(handle);
+        if (kv == shard.map.end() || kv->second.busy)
+            return nullptr;
+        kv->second.busy = true;
+        return std::move(kv->second.context);
+    }
+
+    // gives back the context acquired by acquire(), and notifies the fetchers parked on it.
+    // the context will be dropped if it has been removed or evicted in the meantime.
+    void release(int64_t handle, std::unique_ptr<pegasus_scan_context> context, uint64_t now_ms)
+    {
+        std::vector<std::function<void()>> waiters;
+        {
+            context_shard &shard = get_shard(handle);
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+            auto kv = shard.map.find(handle);
+            if (kv != shard.map.end()) {
+                kv->second.context = std::move(context);
+                kv->second.last_access_time_ms = now_ms;
+                kv->second.busy = false;
+                waiters = std::move(kv->second.waiters);
+            }
+        }
+        // the dropped context (and its iterator) is released out of the lock
+        context.reset();
+        notify(waiters);
+    }
+
+    // evicts the contexts which have not been accessed for `idle_timeout_ms`.
+    // returns the count of the evicted contexts.
+    uint64_t evict_idle_contexts(uint64_t now_ms, uint64_t idle_timeout_ms)
+    {
+        uint64_t evicted_count = 0;
+        for (auto &shard : _shards) {
+            std::vector<std::unique_ptr<pegasus_scan_context>> evicted;
+            std::vector<std::function<void()>> waiters;
+            {
+                ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+                for (auto it = shard.map.begin(); it != shard.map.end();) {
+                    if (it->second.last_access_time_ms + idle_timeout_ms <= now_ms) {
+                        evicted.emplace_back(std::move(it->second.context));
+                        for (auto &waiter : it->second.waiters) {
+                            waiters.emplace_back(std::move(waiter));
+                        }
+                        it = shard.map.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                _count.fetch_sub(evicted.size());
+            }
+            // the evicted contexts (and their iterators) are released out of the lock
+            evicted_count += evicted.size();
+            evicted.clear();
+            notify(waiters);
+        }
+        return evicted_count;
+    }
+
+    // returns the count of live contexts.
+    uint64_t size() const { return _count.load(); }
+
 private:
-    int64_t _counter;
-    std::unordered_map<int64_t, std::unique_ptr<pegasus_scan_context>> _map;
-    ::dsn::utils::ex_lock_nr_spin _lock;
+    struct context_entry
+    {
+        std::unique_ptr<pegasus_scan_context> context;
+        uint64_t last_access_time_ms;
+        // the context is acquired by the background prefetch
+        bool busy{false};
+        // the fetchers parked on the busy context
+        std::vector<std::function<void()>> waiters;
+    };
+    typedef std::unordered_map<int64_t, context_entry> context_map;
+
+    struct context_shard
+    {
+        context_map map;
+        ::dsn::utils::ex_lock_nr_spin lock;
+    };
+
+    static void notify(std::vector<std::function<void()>> &waiters)
+    {
+        for (auto &waiter : waiters) {
+            waiter();
+        }
+    }
+
+    context_shard &get_shard(int64_t handle)
+    {
+        return _shards[static_cast<uint64_t>(handle) % kShardCount];
+    }
+
+    std::atomic<int64_t> _counter;
+    std::atomic<uint64_t> _count{0};
+    uint32_t _max_count_per_shard{0};
+    std::array<context_shard, kShardCount> _shards;
 };
 }
 }
@@ -20,8 +20,10 @@
 #include "pegasus_server_impl.h"
 
 #include <algorithm>
+#include <numeric>
 #include <boost/lexical_cast.hpp>
 #include <rocksdb/convenience.h>
+#include <rocksdb/snapshot.h>
 #include <rocksdb/utilities/checkpoint.h>
 #include <rocksdb/utilities/options_util.h>
 #include <dsn/utility/chrono_literals.h>
@@ -39,6 +41,9 @@
 #include "pegasus_server_write.h"
 #include "meta_store.h"
 #include "hotkey_collector.h"
+#include "hotkey_read_cache.h"
+#include "sortkey_count_index.h"
+#include "compaction_scheduler.h"
 
 using namespace dsn::literals::chrono_literals;
 
@@ -52,6 +57,61 @@ DSN_DEFINE_int32("pegasus.server",
                  10,
                  "hotkey analyse interval in seconds");
 
+DSN_DEFINE_bool("pegasus.server",
+                hotkey_read_cache_by_detection,
+                false,
+                "whether to cache the rows of the read hotkey found by hotkey detection");
+DSN_TAG_VARIABLE(hotkey_read_cache_by_detection, FT_MUTABLE);
+
+DSN_DEFINE_uint32("pegasus.server",
+                  sortkey_count_index_min_count,
+                  1000,
+                  "only the hash keys with at least this count of sort keys are indexed by "
+                  "the sort key count index, the smaller ones are cheap to be counted by scan");
+DSN_TAG_VARIABLE(sortkey_count_index_min_count, FT_MUTABLE);
+
+DSN_DEFINE_uint32("pegasus.server",
+                  sortkey_count_sample_count,
+                  1000,
+                  "max count of the rows scanned by an approximate sortkey_count, the count of "
+                  "the rest rows is estimated by their approximate size in rocksdb");
+DSN_TAG_VARIABLE(sortkey_count_sample_count, FT_MUTABLE);
+
+DEFINE_TASK_CODE(LPC_PEGASUS_EVICT_SCAN_CONTEXT, TASK_PRIORITY_COMMON, ::dsn::THREAD_POOL_DEFAULT)
+DEFINE_TASK_CODE(LPC_PEGASUS_SCAN_PREFETCH, TASK_PRIORITY_LOW, ::dsn::THREAD_POOL_DEFAULT)
+
+DSN_DEFINE_uint32("pegasus.server",
+                  scan_context_idle_timeout_s,
+                  300,
+                  "the scan context which is not accessed for this time will be evicted, "
+                  "in seconds");
+DSN_TAG_VARIABLE(scan_context_idle_timeout_s, FT_MUTABLE);
+
+DSN_DEFINE_bool("pegasus.server",
+                scan_prefetch_enabled,
+                false,
+                "whether to prefetch the next batch of a scan in background after replying the "
+                "current batch");
+DSN_TAG_VARIABLE(scan_prefetch_enabled, FT_MUTABLE);
+
+DSN_DEFINE_uint64("pegasus.server",
+                  scan_prefetch_memory_budget_mb,
+                  256,
+                  "max total size of the prefetched scan batches on one server, in MB");
+
+DSN_DEFINE_uint32("pegasus.server",
+                  scan_context_evict_interval_s,
+                  30,
+                  "the interval of checking and evicting idle scan contexts, in seconds");
+
+DSN_DEFINE_uint32("pegasus.server",
+                  rocksdb_multi_get_batch_size,
+                  32,
+                  "max count of the keys read by one rocksdb MultiGet call when multi_get with "
+                  "a sort keys list, the limits of multi_get are checked between the batches");
+DSN_DEFINE_validator(rocksdb_multi_get_batch_size,
+                     [](uint32_t batch_size) -> bool { return batch_size > 0; });
+
 static std::string chkpt_get_dir_name(int64_t decree)
 {
     char buffer[256];
@@ -66,6 +126,8 @@ static bool chkpt_init_from_dir(const char *name, int64_t &decree)
 }
 
 std::shared_ptr<rocksdb::RateLimiter> pegasus_server_impl::_s_rate_limiter;
+std::shared_ptr<scan_prefetch_budget> pegasus_server_impl::_s_scan_prefetch_budget;
+std::shared_ptr<compaction_scheduler> pegasus_server_impl::_s_compaction_scheduler;
 int64_t pegasus_server_impl::_rocksdb_limiter_last_total_through;
 std::shared_ptr<rocksdb::Cache> pegasus_server_impl::_s_block_cache;
 std::shared_ptr<rocksdb::WriteBufferManager> pegasus_server_impl::_s_write_buffer_manager;
@@ -75,6 +137,7 @@ std::shared_ptr<rocksdb::WriteBufferManager> pegasus_server_impl::_s_write_buffe
 const std::string pegasus_server_impl::COMPRESSION_HEADER = "per_level:";
 const std::string pegasus_server_impl::DATA_COLUMN_FAMILY_NAME = "default";
 const std::string pegasus_server_impl::META_COLUMN_FAMILY_NAME = "pegasus_meta_cf";
+const std::string pegasus_server_impl::KEY_COLUMN_FAMILY_NAME = "pegasus_key_cf";
 const std::chrono::seconds pegasus_server_impl::kServerStatUpdateTimeSec = std::chrono::seconds(10);
 
 void pegasus_server_impl::parse_checkpoints()
@@ -274,11 +337,32 @@ void pegasus_server_impl::on_get(get_rpc rpc)
     resp.server = _primary_address;
 
     rocksdb::Slice skey(key.data(), key.length());
-    std::string value;
-    rocksdb::Status status = _db->Get(_data_cf_rd_opts, _data_cf, skey, &value);
+    // the value is pinned in block cache or memtable, and will be referenced by the response
+    // directly to avoid data copy
+    auto value = dsn::make_unique<rocksdb::PinnableSlice>();
+    rocksdb::Status status;
+    // not 0 if the key is hot but not cached, see hotkey_read_cache::get
+    uint64_t cache_version = 0;
+    uint64_t key_hash = 0;
+    bool cache_hit = false;
+    if (_hotkey_read_cache->enabled() && key.length() >= 2) {
+        key_hash = pegasus_key_hash(key);
+        cache_hit = _hotkey_read_cache->get(
+            dsn::string_view(key.data(), key.length()), key_hash, *value->GetSelf(), cache_version);
+        if (cache_hit) {
+            value->PinSelf();
+            _pfc_recent_hotkey_read_cache_hit_count->increment();
+        } else if (cache_version != 0) {
+            _pfc_recent_hotkey_read_cache_miss_count->increment();
+        }
+    }
+    if (!cache_hit) {
+        status = _db->Get(_data_cf_rd_opts, _data_cf, skey, value.get());
+    }
 
     if (status.ok()) {
-        if (check_if_record_expired(utils::epoch_now(), value)) {
+        // the cached value is checked the same as read from rocksdb
+        if (check_if_record_expired(utils::epoch_now(), *value)) {
             _pfc_recent_expire_count->increment();
             if (_verbose_log) {
                 derror("%s: rocksdb data expired for get from %s",
@@ -286,6 +370,11 @@ void pegasus_server_impl::on_get(get_rpc rpc)
                        rpc.remote_address().to_string());
             }
             status = rocksdb::Status::NotFound();
+        } else if (cache_version != 0) {
+            _hotkey_read_cache->fill(dsn::string_view(key.data(), key.length()),
+                                     key_hash,
+                                     utils::to_string_view(*value),
+                                     cache_version);
         }
     }
 
@@ -315,7 +404,7 @@ void pegasus_server_impl::on_get(get_rpc rpc)
 #endif
 
     uint64_t time_used = dsn_now_ns() - start_time;
-    if (is_get_abnormal(time_used, value.size())) {
+    if (is_get_abnormal(time_used, value->size())) {
         ::dsn::blob hash_key, sort_key;
         pegasus_restore_key(key, hash_key, sort_key);
         dwarn_replica("rocksdb abnormal get from {}: "
@@ -325,7 +414,7 @@ void pegasus_server_impl::on_get(get_rpc rpc)
                       ::pegasus::utils::c_escape_string(hash_key),
                       ::pegasus::utils::c_escape_string(sort_key),
                       status.ToString(),
-                      value.size(),
+                      value->size(),
                       time_used);
         _pfc_recent_abnormal_count->increment();
     }
@@ -364,6 +453,20 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
         return;
     }
 
+    const key_filter_matcher sort_key_filter(request.sort_key_filter_type,
+                                             dsn::string_view(request.sort_key_filter_pattern));
+    if (!sort_key_filter.valid()) {
+        derror("%s: invalid argument for multi_get from %s: "
+               "invalid sort key filter pattern \"%s\"",
+               replica_name(),
+               rpc.remote_address().to_string(),
+               ::pegasus::utils::c_escape_string(request.sort_key_filter_pattern).c_str());
+        resp.error = rocksdb::Status::kInvalidArgument;
+        _cu_calculator->add_multi_get_cu(req, resp.error, request.hash_key, resp.kvs);
+        _pfc_multi_get_latency->set(dsn_now_ns() - start_time);
+        return;
+    }
+
     uint32_t max_kv_count = request.max_kv_count > 0 ? request.max_kv_count : INT_MAX;
     uint32_t max_iteration_count =
         std::min(max_kv_count, _rng_rd_opts.multi_get_max_iteration_count);
@@ -452,14 +555,20 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
 
         std::unique_ptr<rocksdb::Iterator> it;
         bool complete = false;
+        // all the kvs of this response are allocated from the arena
+        response_arena arena;
 
         std::unique_ptr<range_read_limiter> limiter =
             dsn::make_unique<range_read_limiter>(max_iteration_count,
                                                  max_iteration_size,
                                                  _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
 
+        bool key_only = is_key_only_read(request.no_value);
+        // the raw key of the last row scanned, from which the caller can resume the read even
+        // if no row is returned.
+        std::string last_scanned_key;
         if (!request.reverse) {
-            it.reset(_db->NewIterator(_data_cf_rd_opts, _data_cf));
+            it.reset(_db->NewIterator(_data_cf_rd_opts, key_only ? _key_cf : _data_cf));
             it->Seek(start);
             bool first_exclusive = !start_inclusive;
             while (limiter->valid() && it->Valid()) {
@@ -482,15 +591,17 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                 }
 
                 limiter->add_count();
+                last_scanned_key.assign(it->key().data(), it->key().size());
 
                 // extract value
                 auto state = append_key_value_for_multi_get(resp.kvs,
+                                                            arena,
                                                             it->key(),
                                                             it->value(),
-                                                            request.sort_key_filter_type,
-                                                            request.sort_key_filter_pattern,
+                                                            sort_key_filter,
                                                             epoch_now,
-                                                            request.no_value);
+                                                            request.no_value,
+                                                            key_only);
 
                 switch (state) {
                 case range_iteration_state::kNormal: {
@@ -530,7 +641,7 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                 rd_opts.total_order_seek = true;
                 rd_opts.prefix_same_as_start = false;
             }
-            it.reset(_db->NewIterator(rd_opts, _data_cf));
+            it.reset(_db->NewIterator(rd_opts, key_only ? _key_cf : _data_cf));
             it->SeekForPrev(stop);
             bool first_exclusive = !stop_inclusive;
             std::vector<::dsn::apps::key_value> reverse_kvs;
@@ -554,15 +665,17 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                 }
 
                 limiter->add_count();
+                last_scanned_key.assign(it->key().data(), it->key().size());
 
                 // extract value
                 auto state = append_key_value_for_multi_get(reverse_kvs,
+                                                            arena,
                                                             it->key(),
                                                             it->value(),
-                                                            request.sort_key_filter_type,
-                                                            request.sort_key_filter_pattern,
+                                                            sort_key_filter,
                                                             epoch_now,
-                                                            request.no_value);
+                                                            request.no_value,
+                                                            key_only);
                 switch (state) {
                 case range_iteration_state::kNormal: {
                     count++;
@@ -630,14 +743,22 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                     limiter->duration_time(),
                     limiter->max_duration_time());
             }
+            if (!last_scanned_key.empty()) {
+                ::dsn::blob raw_key = ::dsn::blob::create_from_bytes(std::move(last_scanned_key));
+                ::dsn::blob hash_key, sort_key;
+                pegasus_restore_key(raw_key, hash_key, sort_key);
+                resp.__set_last_sortkey(sort_key);
+            }
         }
     } else { // condition: !request.sort_keys.empty()
         bool error_occurred = false;
         rocksdb::Status final_status;
         bool exceed_limit = false;
+        // all the kvs of this response are allocated from the arena
+        response_arena arena;
+
         std::vector<::dsn::blob> keys_holder;
         std::vector<rocksdb::Slice> keys;
-        std::vector<std::string> values;
         keys_holder.reserve(request.sort_keys.size());
         keys.reserve(request.sort_keys.size());
         for (auto &sort_key : request.sort_keys) {
@@ -647,31 +768,88 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
             keys_holder.emplace_back(std::move(raw_key));
         }
 
-        std::vector<rocksdb::Status> statuses = _db->MultiGet(_data_cf_rd_opts, keys, &values);
-        for (int i = 0; i < keys.size(); i++) {
-            rocksdb::Status &status = statuses[i];
-            std::string &value = values[i];
-            // print log
-            if (!status.ok()) {
-                if (_verbose_log) {
-                    derror("%s: rocksdb get failed for multi_get from %s: "
-                           "hash_key = \"%s\", sort_key = \"%s\", error = %s",
-                           replica_name(),
-                           rpc.remote_address().to_string(),
-                           ::pegasus::utils::c_escape_string(request.hash_key).c_str(),
-                           ::pegasus::utils::c_escape_string(request.sort_keys[i]).c_str(),
-                           status.ToString().c_str());
-                } else if (!status.IsNotFound()) {
-                    derror("%s: rocksdb get failed for multi_get from %s: error = %s",
-                           replica_name(),
-                           rpc.remote_address().to_string(),
-                           status.ToString().c_str());
-                }
+        // the config level limits of multi_get are also applied to the sort keys list, each
+        // looked up key is counted as one iteration.
+        std::unique_ptr<range_read_limiter> limiter =
+            dsn::make_unique<range_read_limiter>(_rng_rd_opts.multi_get_max_iteration_count,
+                                                 max_iteration_size_config,
+                                                 _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
+
+        // the keys are read batch by batch in the request order, so that the limits can be
+        // checked between batches. a snapshot is only needed if there are several batches, since
+        // one MultiGet reads all its keys from the same implicit snapshot.
+        const size_t batch_size =
+            std::min(keys.size(), static_cast<size_t>(FLAGS_rocksdb_multi_get_batch_size));
+        rocksdb::ReadOptions rd_opts(_data_cf_rd_opts);
+        std::unique_ptr<rocksdb::ManagedSnapshot> snapshot;
+        if (keys.size() > batch_size) {
+            snapshot = dsn::make_unique<rocksdb::ManagedSnapshot>(_db);
+            rd_opts.snapshot = snapshot->snapshot();
+        }
+        bool key_only = is_key_only_read(request.no_value);
+        uint32_t data_version = key_only ? 0 : _pegasus_data_version;
+        // the keys of a batch are passed to MultiGet in sorted order, so that it needn't sort
+        // them again, and the keys in the same data block are looked up together.
+        // `key_order[k]` is the index in the batch of the k-th smallest key, and `result_index[j]`
+        // is the index in `values` and `statuses` of the j-th key in the batch.
+        std::vector<uint32_t> key_order(batch_size);
+        std::vector<uint32_t> result_index(batch_size);
+        std::vector<rocksdb::Slice> sorted_keys(batch_size);
+        std::vector<rocksdb::PinnableSlice> values(batch_size);
+        std::vector<rocksdb::Status> statuses(batch_size);
+        for (size_t batch_start = 0;
+             batch_start < keys.size() && !error_occurred && !exceed_limit;
+             batch_start += batch_size) {
+            size_t key_count = std::min(batch_size, keys.size() - batch_start);
+            const rocksdb::Slice *batch_keys = &keys[batch_start];
+            std::iota(key_order.begin(), key_order.begin() + key_count, 0);
+            std::sort(key_order.begin(),
+                      key_order.begin() + key_count,
+                      [batch_keys](uint32_t l, uint32_t r) {
+                          return batch_keys[l].compare(batch_keys[r]) < 0;
+                      });
+            for (size_t k = 0; k < key_count; k++) {
+                sorted_keys[k] = batch_keys[key_order[k]];
+                result_index[key_order[k]] = k;
             }
-            // check ttl
-            if (status.ok()) {
-                uint32_t expire_ts = pegasus_extract_expire_ts(_pegasus_data_version, value);
-                if (expire_ts > 0 && expire_ts <= epoch_now) {
+            _db->MultiGet(rd_opts,
+                          key_only ? _key_cf : _data_cf,
+                          key_count,
+                          sorted_keys.data(),
+                          values.data(),
+                          statuses.data(),
+                          true /* sorted_input */);
+            // the results are handled in the request order
+            for (size_t j = 0; j < key_count; j++) {
+                const ::dsn::blob &sort_key = request.sort_keys[batch_start + j];
+                rocksdb::Status &status = statuses[result_index[j]];
+                rocksdb::PinnableSlice &value = values[result_index[j]];
+                if (!limiter->valid()) {
+                    exceed_limit = true;
+                    break;
+                }
+                limiter->add_count();
+                // print log
+                if (!status.ok()) {
+                    if (_verbose_log) {
+                        derror("%s: rocksdb get failed for multi_get from %s: "
+                               "hash_key = \"%s\", sort_key = \"%s\", error = %s",
+                               replica_name(),
+                               rpc.remote_address().to_string(),
+                               ::pegasus::utils::c_escape_string(request.hash_key).c_str(),
+                               ::pegasus::utils::c_escape_string(sort_key).c_str(),
+                               status.ToString().c_str());
+                    } else if (!status.IsNotFound()) {
+                        derror("%s: rocksdb get failed for multi_get from %s: error = %s",
+                               replica_name(),
+                               rpc.remote_address().to_string(),
+                               status.ToString().c_str());
+                    }
+                }
+                // check ttl
+                if (status.ok() &&
+                    pegasus::check_if_record_expired(
+                        data_version, epoch_now, dsn::string_view(value.data(), value.size()))) {
                     expire_count++;
                     if (_verbose_log) {
                         derror("%s: rocksdb data expired for multi_get from %s",
@@ -680,36 +858,51 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                     }
                     status = rocksdb::Status::NotFound();
                 }
-            }
-            // extract value
-            if (status.ok()) {
-                // check if exceed limit
-                if (count >= max_kv_count || size >= max_kv_size) {
-                    exceed_limit = true;
-                    break;
+                // extract value
+                if (status.ok()) {
+                    // check if exceed limit
+                    if (count >= max_kv_count || size >= max_kv_size) {
+                        exceed_limit = true;
+                        break;
+                    }
+                    ::dsn::apps::key_value kv;
+                    kv.key = sort_key;
+                    if (!request.no_value) {
+                        kv.value = arena.copy(pegasus_extract_user_data_view(
+                            _pegasus_data_version, dsn::string_view(value.data(), value.size())));
+                    }
+                    count++;
+                    size_t kv_size = kv.key.length() + kv.value.length();
+                    size += kv_size;
+                    limiter->add_size(kv_size);
+                    resp.kvs.emplace_back(std::move(kv));
                 }
-                ::dsn::apps::key_value kv;
-                kv.key = request.sort_keys[i];
-                if (!request.no_value) {
-                    pegasus_extract_user_data(_pegasus_data_version, std::move(value), kv.value);
+                // if error occurred
+                if (!status.ok() && !status.IsNotFound()) {
+                    error_occurred = true;
+                    final_status = status;
+                    break;
                 }
-                count++;
-                size += kv.key.length() + kv.value.length();
-                resp.kvs.emplace_back(std::move(kv));
             }
-            // if error occurred
-            if (!status.ok() && !status.IsNotFound()) {
-                error_occurred = true;
-                final_status = status;
-                break;
+            // release the pinned blocks before reading the next batch
+            for (size_t j = 0; j < key_count; j++) {
+                values[j].Reset();
             }
         }
+        iteration_count = limiter->get_iteration_count();
 
         if (error_occurred) {
             resp.error = final_status.code();
             resp.kvs.clear();
         } else if (exceed_limit) {
             resp.error = rocksdb::Status::kIncomplete;
+            if (limiter->exceed_limit()) {
+                dwarn_replica(
+                    "rocksdb abnormal multi_get from {}: time_used({}ns) VS time_threshold({}ns)",
+                    rpc.remote_address().to_string(),
+                    limiter->duration_time(),
+                    limiter->max_duration_time());
+            }
         } else {
             resp.error = rocksdb::Status::kOk;
         }
@@ -760,18 +953,240 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
     _pfc_multi_get_latency->set(dsn_now_ns() - start_time);
 }
 
+void pegasus_server_impl::on_batch_get(batch_get_rpc rpc)
+{
+    dassert(_is_open, "");
+    _pfc_batch_get_qps->increment();
+    uint64_t start_time = dsn_now_ns();
+
+    const auto &request = rpc.request();
+    auto &resp = rpc.response();
+    resp.app_id = _gpid.get_app_id();
+    resp.partition_index = _gpid.get_partition_index();
+    resp.server = _primary_address;
+
+    if (request.keys.empty()) {
+        derror_replica("invalid argument for batch_get from {}: keys should not be empty",
+                       rpc.remote_address().to_string());
+        resp.error = rocksdb::Status::kInvalidArgument;
+        _cu_calculator->add_batch_get_cu(rpc.dsn_request(), resp.error, resp.data);
+        _pfc_batch_get_latency->set(dsn_now_ns() - start_time);
+        return;
+    }
+
+    std::vector<::dsn::blob> keys_holder;
+    std::vector<rocksdb::Slice> keys;
+    keys_holder.reserve(request.keys.size());
+    keys.reserve(request.keys.size());
+    for (const auto &key : request.keys) {
+        ::dsn::blob raw_key;
+        pegasus_generate_key(raw_key, key.hash_key, key.sort_key);
+        // the keys are grouped by the partition count cached on the client side, reject the
+        // whole batch if some key doesn't belong to this partition (e.g. the partition count is
+        // changed by partition split), so that the client can refresh the partition count and
+        // retry. it's checked regardless of `_validate_partition_hash`, otherwise the keys of
+        // the other partitions would be silently reported as not found.
+        if (_partition_version < 0 || _gpid.get_partition_index() > _partition_version ||
+            !check_pegasus_key_hash(raw_key, _gpid.get_partition_index(), _partition_version)) {
+            derror_replica("invalid argument for batch_get from {}: hash_key = {} doesn't "
+                           "belong to this partition",
+                           rpc.remote_address().to_string(),
+                           ::pegasus::utils::c_escape_string(key.hash_key));
+            resp.error = rocksdb::Status::kInvalidArgument;
+            _cu_calculator->add_batch_get_cu(rpc.dsn_request(), resp.error, resp.data);
+            _pfc_batch_get_latency->set(dsn_now_ns() - start_time);
+            return;
+        }
+        keys.emplace_back(raw_key.data(), raw_key.length());
+        keys_holder.emplace_back(std::move(raw_key));
+    }
+
+    // the config level limits of multi_get are also applied to batch_get, each looked up key is
+    // counted as one iteration.
+    uint32_t max_iteration_size = _rng_rd_opts.multi_get_max_iteration_size > 0
+                                      ? _rng_rd_opts.multi_get_max_iteration_size
+                                      : INT_MAX;
+    std::unique_ptr<range_read_limiter> limiter =
+        dsn::make_unique<range_read_limiter>(_rng_rd_opts.multi_get_max_iteration_count,
+                                             max_iteration_size,
+                                             _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
+
+    // the keys are read batch by batch in the request order by MultiGet, which shares the bloom
+    // filter and index lookups between the keys in the same block, and reads the data blocks in
+    // parallel. the limits are checked between the keys, so that the values pinned at the same
+    // time are bounded. a snapshot is only needed if there are several batches.
+    const size_t batch_size =
+        std::min(keys.size(), static_cast<size_t>(FLAGS_rocksdb_multi_get_batch_size));
+    rocksdb::ReadOptions rd_opts(_data_cf_rd_opts);
+    std::unique_ptr<rocksdb::ManagedSnapshot> snapshot;
+    if (keys.size() > batch_size) {
+        snapshot = dsn::make_unique<rocksdb::ManagedSnapshot>(_db);
+        rd_opts.snapshot = snapshot->snapshot();
+    }
+    std::vector<rocksdb::PinnableSlice> values(batch_size);
+    std::vector<rocksdb::Status> statuses(batch_size);
+
+    uint32_t epoch_now = ::pegasus::utils::epoch_now();
+    uint64_t expire_count = 0;
+    uint64_t size = 0;
+    bool exceed_limit = false;
+    rocksdb::Status final_status;
+    // the values are copied out of the pinned blocks before they are released
+    response_arena arena;
+    for (size_t batch_start = 0; batch_start < keys.size() && final_status.ok() && !exceed_limit;
+         batch_start += batch_size) {
+        size_t key_count = std::min(batch_size, keys.size() - batch_start);
+        _db->MultiGet(rd_opts,
+                      _data_cf,
+                      key_count,
+                      &keys[batch_start],
+                      values.data(),
+                      statuses.data());
+        for (size_t j = 0; j < key_count; ++j) {
+            size_t i = batch_start + j;
+            if (!limiter->valid()) {
+                exceed_limit = true;
+                break;
+            }
+            limiter->add_count();
+
+            rocksdb::Status &status = statuses[j];
+            if (status.ok() && check_if_record_expired(epoch_now, values[j])) {
+                expire_count++;
+                if (_verbose_log) {
+                    derror_replica("rocksdb data expired for batch_get from {}",
+                                   rpc.remote_address().to_string());
+                }
+                status = rocksdb::Status::NotFound();
+            }
+
+            if (status.ok()) {
+                ::dsn::apps::full_data data;
+                data.hash_key = request.keys[i].hash_key;
+                data.sort_key = request.keys[i].sort_key;
+                data.value = arena.copy(pegasus_extract_user_data_view(
+                    _pegasus_data_version, dsn::string_view(values[j].data(), values[j].size())));
+                size_t data_size =
+                    data.hash_key.length() + data.sort_key.length() + data.value.length();
+                size += data_size;
+                limiter->add_size(data_size);
+                resp.data.emplace_back(std::move(data));
+            } else if (!status.IsNotFound()) {
+                if (_verbose_log) {
+                    derror_replica("rocksdb get failed for batch_get from {}: "
+                                   "hash_key = {}, sort_key = {}, error = {}",
+                                   rpc.remote_address().to_string(),
+                                   ::pegasus::utils::c_escape_string(request.keys[i].hash_key),
+                                   ::pegasus::utils::c_escape_string(request.keys[i].sort_key),
+                                   status.ToString());
+                } else {
+                    derror_replica("rocksdb get failed for batch_get from {}: error = {}",
+                                   rpc.remote_address().to_string(),
+                                   status.ToString());
+                }
+                final_status = status;
+                break;
+            }
+        }
+        // release the pinned blocks before reading the next batch
+        for (size_t j = 0; j < key_count; j++) {
+            values[j].Reset();
+        }
+    }
+
+    if (!final_status.ok()) {
+        resp.error = final_status.code();
+        resp.data.clear();
+    } else if (exceed_limit) {
+        // the values got so far are still returned, the whole batch is failed by the client.
+        resp.error = rocksdb::Status::kIncomplete;
+        dwarn_replica("rocksdb abnormal batch_get from {}: key_count = {}, iteration_count = {}, "
+                      "iteration_size = {}, time_used({}ns) VS time_threshold({}ns)",
+                      rpc.remote_address().to_string(),
+                      keys.size(),
+                      limiter->get_iteration_count(),
+                      size,
+                      limiter->duration_time(),
+                      limiter->max_duration_time());
+    } else {
+        resp.error = rocksdb::Status::kOk;
+    }
+
+#ifdef PEGASUS_UNIT_TEST
+    // sleep 10ms for unit test
+    usleep(10 * 1000);
+#endif
+
+    uint64_t time_used = dsn_now_ns() - start_time;
+    if (is_multi_get_abnormal(time_used, size, limiter->get_iteration_count())) {
+        dwarn_replica("rocksdb abnormal batch_get from {}: key_count = {}, result_count = {}, "
+                      "result_size = {}, expire_count = {}, time_used = {} ns",
+                      rpc.remote_address().to_string(),
+                      keys.size(),
+                      resp.data.size(),
+                      size,
+                      expire_count,
+                      time_used);
+        _pfc_recent_abnormal_count->increment();
+    }
+
+    if (expire_count > 0) {
+        _pfc_recent_expire_count->add(expire_count);
+    }
+
+    _cu_calculator->add_batch_get_cu(rpc.dsn_request(), resp.error, resp.data);
+    _pfc_batch_get_latency->set(dsn_now_ns() - start_time);
+}
+
 void pegasus_server_impl::on_sortkey_count(sortkey_count_rpc rpc)
 {
     dassert(_is_open, "");
+    count_sortkeys(rpc.request(), false, rpc.dsn_request(), rpc.response());
+}
+
+void pegasus_server_impl::on_sortkey_count_v2(sortkey_count_v2_rpc rpc)
+{
+    dassert(_is_open, "");
+    const auto &request = rpc.request();
+    count_sortkeys(request.hash_key, request.approximate, rpc.dsn_request(), rpc.response());
+}
 
+void pegasus_server_impl::count_sortkeys(const ::dsn::blob &hash_key,
+                                         bool approximate,
+                                         dsn::message_ex *req,
+                                         ::dsn::apps::count_response &resp)
+{
     _pfc_scan_qps->increment();
     uint64_t start_time = dsn_now_ns();
 
-    const auto &hash_key = rpc.request();
-    auto &resp = rpc.response();
+    const dsn::rpc_address &remote_address = req->header->from_address;
     resp.app_id = _gpid.get_app_id();
     resp.partition_index = _gpid.get_partition_index();
     resp.server = _primary_address;
+    resp.count = 0;
+    uint32_t epoch_now = ::pegasus::utils::epoch_now();
+
+    // the rows of an empty hash key are hashed by their sort keys, which can't be invalidated
+    // by hash key. And the compaction filter sets the TTL of the rows without TTL if the table
+    // has a default TTL, or drops the rows by the user specified compaction, which changes the
+    // count silently.
+    bool use_index = _sortkey_count_index->enabled() && hash_key.length() > 0 &&
+                     _key_ttl_compaction_filter_factory->GetDefaultTTL() == 0 &&
+                     !_has_user_specified_compaction.load();
+    dsn::string_view hash_key_view(hash_key.data(), hash_key.length());
+    uint64_t key_hash = 0;
+    uint64_t index_version = 0;
+    if (use_index) {
+        key_hash = pegasus_hash_key_hash(hash_key);
+        if (_sortkey_count_index->get(
+                hash_key_view, key_hash, epoch_now, resp.count, index_version)) {
+            _pfc_recent_sortkey_count_index_hit_count->increment();
+            resp.error = rocksdb::Status::kOk;
+            _cu_calculator->add_sortkey_count_cu(req, resp.error, hash_key);
+            _pfc_scan_latency->set(dsn_now_ns() - start_time);
+            return;
+        }
+    }
 
     // scan
     ::dsn::blob start_key, stop_key;
@@ -781,28 +1196,48 @@ void pegasus_server_impl::on_sortkey_count(sortkey_count_rpc rpc)
     rocksdb::Slice stop(stop_key.data(), stop_key.length());
     rocksdb::ReadOptions options = _data_cf_rd_opts;
     options.iterate_upper_bound = &stop;
-    std::unique_ptr<rocksdb::Iterator> it(_db->NewIterator(options, _data_cf));
+    // only the expire_ts of the rows are needed.
+    bool key_only = is_key_only_read(true);
+    uint32_t data_version = key_only ? 0 : _pegasus_data_version;
+    std::unique_ptr<rocksdb::Iterator> it(
+        _db->NewIterator(options, key_only ? _key_cf : _data_cf));
     it->Seek(start);
-    resp.count = 0;
-    uint32_t epoch_now = ::pegasus::utils::epoch_now();
     uint64_t expire_count = 0;
+    // the earliest expire time of the counted rows, 0 if none of them has a TTL.
+    uint32_t min_expire_ts = 0;
 
     std::unique_ptr<range_read_limiter> limiter =
         dsn::make_unique<range_read_limiter>(_rng_rd_opts.rocksdb_max_iteration_count,
                                              0,
                                              _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
+    bool sampling = approximate;
+    bool estimated = false;
+    int64_t remaining_count = 0;
     while (limiter->time_check() && it->Valid()) {
+        if (sampling && limiter->get_iteration_count() >= FLAGS_sortkey_count_sample_count) {
+            if (estimate_remaining_count(start, it->key(), stop, resp.count, remaining_count)) {
+                estimated = true;
+                break;
+            }
+            // count the remaining rows exactly if they can't be estimated.
+            sampling = false;
+        }
         limiter->add_count();
 
-        if (check_if_record_expired(epoch_now, it->value())) {
+        uint32_t expire_ts =
+            pegasus_extract_expire_ts(data_version, utils::to_string_view(it->value()));
+        if (check_if_ts_expired(epoch_now, expire_ts)) {
             expire_count++;
             if (_verbose_log) {
                 derror("%s: rocksdb data expired for sortkey_count from %s",
                        replica_name(),
-                       rpc.remote_address().to_string());
+                       remote_address.to_string());
             }
         } else {
             resp.count++;
+            if (expire_ts > 0 && (min_expire_ts == 0 || expire_ts < min_expire_ts)) {
+                min_expire_ts = expire_ts;
+            }
         }
         it->Next();
     }
@@ -811,34 +1246,72 @@ void pegasus_server_impl::on_sortkey_count(sortkey_count_rpc rpc)
     }
 
     resp.error = it->status().code();
+    bool finished = it->status().ok() && !it->Valid();
     if (!it->status().ok()) {
         // error occur
         if (_verbose_log) {
             derror("%s: rocksdb scan failed for sortkey_count from %s: "
                    "hash_key = \"%s\", error = %s",
                    replica_name(),
-                   rpc.remote_address().to_string(),
+                   remote_address.to_string(),
                    ::pegasus::utils::c_escape_string(hash_key).c_str(),
                    it->status().ToString().c_str());
         } else {
             derror("%s: rocksdb scan failed for sortkey_count from %s: error = %s",
                    replica_name(),
-                   rpc.remote_address().to_string(),
+                   remote_address.to_string(),
                    it->status().ToString().c_str());
         }
         resp.count = 0;
+    } else if (estimated) {
+        resp.count += remaining_count;
+        _pfc_recent_approximate_sortkey_count_count->increment();
     } else if (limiter->exceed_limit()) {
         dwarn_replica("rocksdb abnormal scan from {}: time_used({}ns) VS time_threshold({}ns)",
-                      rpc.remote_address().to_string(),
+                      remote_address.to_string(),
                       limiter->duration_time(),
                       limiter->max_duration_time());
         resp.count = -1;
     }
 
-    _cu_calculator->add_sortkey_count_cu(rpc.dsn_request(), resp.error, hash_key);
+    if (index_version != 0) {
+        if (finished && resp.count >= FLAGS_sortkey_count_index_min_count) {
+            _sortkey_count_index->fill(
+                hash_key_view, key_hash, resp.count, min_expire_ts, index_version);
+        } else {
+            _sortkey_count_index->cancel(key_hash);
+        }
+    }
+
+    _cu_calculator->add_sortkey_count_cu(req, resp.error, hash_key);
     _pfc_scan_latency->set(dsn_now_ns() - start_time);
 }
 
+bool pegasus_server_impl::estimate_remaining_count(const rocksdb::Slice &start,
+                                                   const rocksdb::Slice &scanned_stop,
+                                                   const rocksdb::Slice &stop,
+                                                   int64_t scanned_count,
+                                                   /*out*/ int64_t &remaining_count)
+{
+    rocksdb::Range ranges[2] = {rocksdb::Range(start, scanned_stop),
+                                rocksdb::Range(scanned_stop, stop)};
+    uint64_t sizes[2] = {0, 0};
+    // the sizes of the rows in the key column family don't vary with the values.
+    _db->GetApproximateSizes(_key_cf != nullptr ? _key_cf : _data_cf,
+                             ranges,
+                             2,
+                             sizes,
+                             rocksdb::DB::SizeApproximationFlags::INCLUDE_FILES |
+                                 rocksdb::DB::SizeApproximationFlags::INCLUDE_MEMTABLES);
+    if (sizes[0] == 0) {
+        // too few rows are scanned to estimate the size of a row.
+        return false;
+    }
+    remaining_count =
+        static_cast<int64_t>(static_cast<double>(sizes[1]) * scanned_count / sizes[0]);
+    return true;
+}
+
 void pegasus_server_impl::on_ttl(ttl_rpc rpc)
 {
     dassert(_is_open, "");
@@ -938,6 +1411,33 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
         return;
     }
 
+    // the filters are compiled only once, and will be moved into the scan context if the scan
+    // is not completed in this batch.
+    key_filter_matcher hash_key_filter(request.hash_key_filter_type,
+                                       dsn::string_view(request.hash_key_filter_pattern));
+    key_filter_matcher sort_key_filter(request.sort_key_filter_type,
+                                       dsn::string_view(request.sort_key_filter_pattern));
+    if (!hash_key_filter.valid() || !sort_key_filter.valid()) {
+        derror("%s: invalid argument for get_scanner from %s: "
+               "invalid filter pattern, hash_key_filter_pattern = \"%s\", "
+               "sort_key_filter_pattern = \"%s\"",
+               replica_name(),
+               rpc.remote_address().to_string(),
+               ::pegasus::utils::c_escape_string(request.hash_key_filter_pattern).c_str(),
+               ::pegasus::utils::c_escape_string(request.sort_key_filter_pattern).c_str());
+        resp.error = rocksdb::Status::kInvalidArgument;
+        _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
+        _pfc_scan_latency->set(dsn_now_ns() - start_time);
+
+        return;
+    }
+
+    // if the scan is an aggregation, the aggregate is always set in the response with no error,
+    // by which the client knows that the aggregation is supported by the server.
+    ::dsn::apps::scan_aggregate_type::type aggregate_type =
+        request.__isset.aggregate_type ? request.aggregate_type
+                                       : ::dsn::apps::scan_aggregate_type::SA_NONE;
+
     rocksdb::ReadOptions rd_opts(_data_cf_rd_opts);
     if (_data_cf_opts.prefix_extractor) {
         ::dsn::blob start_hash_key, tmp;
@@ -990,13 +1490,19 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
                   request.stop_inclusive ? "inclusive" : "exclusive");
         }
         resp.error = rocksdb::Status::kOk;
+        if (aggregate_type != ::dsn::apps::scan_aggregate_type::SA_NONE) {
+            resp.__set_aggregate(::dsn::apps::scan_aggregate_result());
+        }
         _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
         _pfc_scan_latency->set(dsn_now_ns() - start_time);
 
         return;
     }
 
-    std::unique_ptr<rocksdb::Iterator> it(_db->NewIterator(rd_opts, _data_cf));
+    bool key_only = is_key_only_read(request.no_value &&
+                                     aggregate_type == ::dsn::apps::scan_aggregate_type::SA_NONE);
+    std::unique_ptr<rocksdb::Iterator> it(
+        _db->NewIterator(rd_opts, key_only ? _key_cf : _data_cf));
     it->Seek(start);
     bool complete = false;
     bool first_exclusive = !start_inclusive;
@@ -1007,9 +1513,16 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
 
     uint32_t request_batch_size = request.batch_size > 0 ? request.batch_size : INT_MAX;
     uint32_t batch_count = std::min(request_batch_size, _rng_rd_opts.rocksdb_max_iteration_count);
-    resp.kvs.reserve(batch_count);
 
     bool return_expire_ts = request.__isset.return_expire_ts ? request.return_expire_ts : false;
+    // all the kvs of this response are allocated from the arena
+    response_arena arena;
+    std::unique_ptr<scan_aggregator> aggregator;
+    if (aggregate_type != ::dsn::apps::scan_aggregate_type::SA_NONE) {
+        aggregator = dsn::make_unique<scan_aggregator>(aggregate_type);
+    } else {
+        resp.kvs.reserve(batch_count);
+    }
 
     std::unique_ptr<range_read_limiter> limiter = dsn::make_unique<range_read_limiter>(
         batch_count, 0, _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
@@ -1035,16 +1548,17 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
 
         auto state = append_key_value_for_scan(
             resp.kvs,
+            arena,
             it->key(),
             it->value(),
-            request.hash_key_filter_type,
-            request.hash_key_filter_pattern,
-            request.sort_key_filter_type,
-            request.sort_key_filter_pattern,
+            hash_key_filter,
+            sort_key_filter,
             epoch_now,
             request.no_value,
+            key_only,
             request.__isset.validate_partition_hash ? request.validate_partition_hash : true,
-            return_expire_ts);
+            return_expire_ts,
+            aggregator.get());
         switch (state) {
         case range_iteration_state::kNormal:
             count++;
@@ -1111,26 +1625,15 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
             std::move(it),
             std::string(stop.data(), stop.size()),
             request.stop_inclusive,
-            request.hash_key_filter_type,
-            std::string(request.hash_key_filter_pattern.data(),
-                        request.hash_key_filter_pattern.length()),
-            request.sort_key_filter_type,
-            std::string(request.sort_key_filter_pattern.data(),
-                        request.sort_key_filter_pattern.length()),
+            std::move(hash_key_filter),
+            std::move(sort_key_filter),
             batch_count,
             request.no_value,
             request.__isset.validate_partition_hash ? request.validate_partition_hash : true,
-            return_expire_ts));
-        int64_t handle = _context_cache.put(std::move(context));
-        resp.context_id = handle;
-        // if the context is used, it will be fetched and re-put into cache,
-        // which will change the handle,
-        // then the delayed task will fetch null context by old handle, and do nothing.
-        ::dsn::tasking::enqueue(LPC_PEGASUS_SERVER_DELAY,
-                                &_tracker,
-                                [this, handle]() { _context_cache.fetch(handle); },
-                                0,
-                                std::chrono::minutes(5));
+            return_expire_ts,
+            aggregate_type));
+        resp.context_id = put_scan_context(std::move(context));
+        try_prefetch_scan_batch(resp.context_id, resp.kvs);
     } else {
         // scan completed
         resp.context_id = pegasus::SCAN_CONTEXT_ID_COMPLETED;
@@ -1143,156 +1646,280 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
         _pfc_recent_filter_count->add(filter_count);
     }
 
-    _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
+    if (aggregator != nullptr) {
+        resp.__set_aggregate(aggregator->result());
+        _cu_calculator->add_scan_aggregate_cu(req, resp.error, resp.aggregate);
+    } else {
+        _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
+    }
     _pfc_scan_latency->set(dsn_now_ns() - start_time);
 }
 
 void pegasus_server_impl::on_scan(scan_rpc rpc)
 {
     dassert(_is_open, "");
+    const auto &request = rpc.request();
+    bool busy = false;
+    std::unique_ptr<pegasus_scan_context> context =
+        _context_cache.fetch(request.context_id, busy, [this, rpc]() mutable {
+            // the context may be dropped because the replica is being stopped, in which case
+            // the parked rpc is replied with this error instead of being retried.
+            rpc.response().error = rocksdb::Status::Code::kNotFound;
+            ::dsn::tasking::enqueue(LPC_PEGASUS_SERVER_DELAY, &_tracker, [this, rpc]() {
+                if (_is_open) {
+                    on_scan(rpc);
+                }
+            });
+        });
+    if (busy) {
+        // the next batch of this scan is being prefetched in background, the rpc is parked on
+        // the context and will be retried once the prefetch finished.
+        return;
+    }
+
     _pfc_scan_qps->increment();
     uint64_t start_time = dsn_now_ns();
-    const auto &request = rpc.request();
     dsn::message_ex *req = rpc.dsn_request();
     auto &resp = rpc.response();
     resp.app_id = _gpid.get_app_id();
     resp.partition_index = _gpid.get_partition_index();
     resp.server = _primary_address;
 
-    std::unique_ptr<pegasus_scan_context> context = _context_cache.fetch(request.context_id);
     if (context) {
-        rocksdb::Iterator *it = context->iterator.get();
-        const rocksdb::Slice &stop = context->stop;
-        bool stop_inclusive = context->stop_inclusive;
-        ::dsn::apps::filter_type::type hash_key_filter_type = context->hash_key_filter_type;
-        const ::dsn::blob &hash_key_filter_pattern = context->hash_key_filter_pattern;
-        ::dsn::apps::filter_type::type sort_key_filter_type = context->sort_key_filter_type;
-        const ::dsn::blob &sort_key_filter_pattern = context->sort_key_filter_pattern;
-        bool no_value = context->no_value;
-        bool validate_hash = context->validate_partition_hash;
-        bool return_expire_ts = context->return_expire_ts;
-        bool complete = false;
-        uint32_t epoch_now = ::pegasus::utils::epoch_now();
-        uint64_t expire_count = 0;
-        uint64_t filter_count = 0;
-        int32_t count = 0;
-
-        uint32_t context_batch_size = context->batch_size > 0 ? context->batch_size : INT_MAX;
-        uint32_t batch_count =
-            std::min(context_batch_size, _rng_rd_opts.rocksdb_max_iteration_count);
-
-        std::unique_ptr<range_read_limiter> limiter = dsn::make_unique<range_read_limiter>(
-            batch_count, 0, _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
-
-        while (limiter->valid() && it->Valid()) {
-            int c = it->key().compare(stop);
-            if (c > 0 || (c == 0 && !stop_inclusive)) {
-                // out of range
-                complete = true;
-                break;
-            }
+        scan_batch_result result;
+        if (context->has_prefetched_batch) {
+            resp.kvs = std::move(context->prefetched_kvs);
+            result = context->prefetched_result;
+            context->clear_prefetched_batch();
+        } else {
+            scan_next_batch(context.get(), resp.kvs, result, rpc.remote_address().to_string());
+        }
 
-            limiter->add_count();
+        if (context->aggregate_type != ::dsn::apps::scan_aggregate_type::SA_NONE) {
+            resp.__set_aggregate(result.aggregate);
+        }
+        resp.error = result.error;
+        if (result.has_more) {
+            // scan not completed
+            resp.context_id = put_scan_context(std::move(context));
+            try_prefetch_scan_batch(resp.context_id, resp.kvs);
+        } else if (resp.error == rocksdb::Status::kOk) {
+            // scan completed
+            resp.context_id = pegasus::SCAN_CONTEXT_ID_COMPLETED;
+        }
+    } else {
+        resp.error = rocksdb::Status::Code::kNotFound;
+    }
 
-            auto state = append_key_value_for_scan(resp.kvs,
-                                                   it->key(),
-                                                   it->value(),
-                                                   hash_key_filter_type,
-                                                   hash_key_filter_pattern,
-                                                   sort_key_filter_type,
-                                                   sort_key_filter_pattern,
-                                                   epoch_now,
-                                                   no_value,
-                                                   validate_hash,
-                                                   return_expire_ts);
-            switch (state) {
-            case range_iteration_state::kNormal:
-                count++;
-                break;
-            case range_iteration_state::kExpired:
-                expire_count++;
-                break;
-            case range_iteration_state::kFiltered:
-                filter_count++;
-                break;
-            default:
-                break;
-            }
+    if (resp.__isset.aggregate) {
+        _cu_calculator->add_scan_aggregate_cu(req, resp.error, resp.aggregate);
+    } else {
+        _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
+    }
+    _pfc_scan_latency->set(dsn_now_ns() - start_time);
+}
 
-            if (c == 0) {
-                // seek to the last position
-                complete = true;
-                break;
-            }
+void pegasus_server_impl::scan_next_batch(pegasus_scan_context *context,
+                                          std::vector<::dsn::apps::key_value> &kvs,
+                                          scan_batch_result &result,
+                                          const char *remote_address)
+{
+    rocksdb::Iterator *it = context->iterator.get();
+    const rocksdb::Slice &stop = context->stop;
+    bool stop_inclusive = context->stop_inclusive;
+    const key_filter_matcher &hash_key_filter = context->hash_key_filter;
+    const key_filter_matcher &sort_key_filter = context->sort_key_filter;
+    bool no_value = context->no_value;
+    // the iterator of the context is created on the same column family, see on_get_scanner().
+    bool key_only = is_key_only_read(
+        no_value && context->aggregate_type == ::dsn::apps::scan_aggregate_type::SA_NONE);
+    bool validate_hash = context->validate_partition_hash;
+    bool return_expire_ts = context->return_expire_ts;
+    bool complete = false;
+    uint32_t epoch_now = ::pegasus::utils::epoch_now();
+    uint64_t expire_count = 0;
+    uint64_t filter_count = 0;
+    int32_t count = 0;
+
+    uint32_t context_batch_size = context->batch_size > 0 ? context->batch_size : INT_MAX;
+    uint32_t batch_count = std::min(context_batch_size, _rng_rd_opts.rocksdb_max_iteration_count);
 
-            it->Next();
+    std::unique_ptr<range_read_limiter> limiter = dsn::make_unique<range_read_limiter>(
+        batch_count, 0, _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
+    // all the kvs of this batch are allocated from the arena
+    response_arena arena;
+    std::unique_ptr<scan_aggregator> aggregator;
+    if (context->aggregate_type != ::dsn::apps::scan_aggregate_type::SA_NONE) {
+        aggregator = dsn::make_unique<scan_aggregator>(context->aggregate_type);
+    }
+
+    while (limiter->valid() && it->Valid()) {
+        int c = it->key().compare(stop);
+        if (c > 0 || (c == 0 && !stop_inclusive)) {
+            // out of range
+            complete = true;
+            break;
         }
 
-        // check iteration time whether exceed limit
-        if (!complete) {
-            limiter->time_check_after_incomplete_scan();
+        limiter->add_count();
+
+        auto state = append_key_value_for_scan(kvs,
+                                               arena,
+                                               it->key(),
+                                               it->value(),
+                                               hash_key_filter,
+                                               sort_key_filter,
+                                               epoch_now,
+                                               no_value,
+                                               key_only,
+                                               validate_hash,
+                                               return_expire_ts,
+                                               aggregator.get());
+        switch (state) {
+        case range_iteration_state::kNormal:
+            count++;
+            break;
+        case range_iteration_state::kExpired:
+            expire_count++;
+            break;
+        case range_iteration_state::kFiltered:
+            filter_count++;
+            break;
+        default:
+            break;
         }
 
-        resp.error = it->status().code();
-        if (!it->status().ok()) {
-            // error occur
-            if (_verbose_log) {
-                derror("%s: rocksdb scan failed for scan from %s: "
-                       "context_id= %" PRId64 ", stop_key = \"%s\" (%s), "
-                       "batch_size = %d, read_count = %d, error = %s",
-                       replica_name(),
-                       rpc.remote_address().to_string(),
-                       request.context_id,
-                       ::pegasus::utils::c_escape_string(stop).c_str(),
-                       stop_inclusive ? "inclusive" : "exclusive",
-                       batch_count,
-                       count,
-                       it->status().ToString().c_str());
-            } else {
-                derror("%s: rocksdb scan failed for scan from %s: error = %s",
-                       replica_name(),
-                       rpc.remote_address().to_string(),
-                       it->status().ToString().c_str());
-            }
-            resp.kvs.clear();
-        } else if (limiter->exceed_limit()) {
-            // scan exceed limit time
-            resp.error = rocksdb::Status::kIncomplete;
-            dwarn_replica("rocksdb abnormal scan from {}: batch_count={}, time_used({}ns) VS "
-                          "time_threshold({}ns)",
-                          rpc.remote_address().to_string(),
-                          batch_count,
-                          limiter->duration_time(),
-                          limiter->max_duration_time());
-        } else if (it->Valid() && !complete) {
-            // scan not completed
-            int64_t handle = _context_cache.put(std::move(context));
-            resp.context_id = handle;
-            ::dsn::tasking::enqueue(LPC_PEGASUS_SERVER_DELAY,
-                                    &_tracker,
-                                    [this, handle]() { _context_cache.fetch(handle); },
-                                    0,
-                                    std::chrono::minutes(5));
+        if (c == 0) {
+            // seek to the last position
+            complete = true;
+            break;
+        }
+
+        it->Next();
+    }
+
+    // check iteration time whether exceed limit
+    if (!complete) {
+        limiter->time_check_after_incomplete_scan();
+    }
+
+    result.error = it->status().code();
+    result.has_more = false;
+    if (aggregator != nullptr) {
+        result.aggregate = aggregator->result();
+    }
+    if (!it->status().ok()) {
+        // error occur
+        if (_verbose_log) {
+            derror("%s: rocksdb scan failed for scan from %s: "
+                   "stop_key = \"%s\" (%s), "
+                   "batch_size = %d, read_count = %d, error = %s",
+                   replica_name(),
+                   remote_address,
+                   ::pegasus::utils::c_escape_string(stop).c_str(),
+                   stop_inclusive ? "inclusive" : "exclusive",
+                   batch_count,
+                   count,
+                   it->status().ToString().c_str());
         } else {
-            // scan completed
-            resp.context_id = pegasus::SCAN_CONTEXT_ID_COMPLETED;
+            derror("%s: rocksdb scan failed for scan from %s: error = %s",
+                   replica_name(),
+                   remote_address,
+                   it->status().ToString().c_str());
         }
+        kvs.clear();
+    } else if (limiter->exceed_limit()) {
+        // scan exceed limit time
+        result.error = rocksdb::Status::kIncomplete;
+        dwarn_replica("rocksdb abnormal scan from {}: batch_count={}, time_used({}ns) VS "
+                      "time_threshold({}ns)",
+                      remote_address,
+                      batch_count,
+                      limiter->duration_time(),
+                      limiter->max_duration_time());
+    } else if (it->Valid() && !complete) {
+        // scan not completed
+        result.has_more = true;
+    }
+
+    if (expire_count > 0) {
+        _pfc_recent_expire_count->add(expire_count);
+    }
+    if (filter_count > 0) {
+        _pfc_recent_filter_count->add(filter_count);
+    }
+}
+
+void pegasus_server_impl::try_prefetch_scan_batch(
+    int64_t handle, const std::vector<::dsn::apps::key_value> &last_kvs)
+{
+    if (!FLAGS_scan_prefetch_enabled) {
+        return;
+    }
+    // the budget is reserved before the prefetch is enqueued, so that the concurrent prefetches
+    // can't exceed it together. the reservation is replaced by the actual size of the batch once
+    // it's prefetched, or released if the prefetch is dropped.
+    uint64_t estimated_bytes = 1;
+    for (const auto &kv : last_kvs) {
+        estimated_bytes += kv.key.length() + kv.value.length();
+    }
+    if (!_s_scan_prefetch_budget->try_acquire(estimated_bytes)) {
+        return;
+    }
+    auto reservation =
+        std::make_shared<scan_prefetch_reservation>(_s_scan_prefetch_budget, estimated_bytes);
 
-        if (expire_count > 0) {
-            _pfc_recent_expire_count->add(expire_count);
+    ::dsn::tasking::enqueue(LPC_PEGASUS_SCAN_PREFETCH, &_tracker, [this, handle, reservation]() {
+        if (!_is_open) {
+            return;
         }
-        if (filter_count > 0) {
-            _pfc_recent_filter_count->add(filter_count);
+        // the context has been fetched by the next scan request, or been cleared
+        std::unique_ptr<pegasus_scan_context> context = _context_cache.acquire(handle);
+        if (context == nullptr) {
+            return;
         }
-    } else {
-        resp.error = rocksdb::Status::Code::kNotFound;
-    }
 
-    _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
-    _pfc_scan_latency->set(dsn_now_ns() - start_time);
+        scan_next_batch(
+            context.get(), context->prefetched_kvs, context->prefetched_result, "prefetch");
+        uint64_t bytes = 0;
+        for (const auto &kv : context->prefetched_kvs) {
+            bytes += kv.key.length() + kv.value.length();
+        }
+        context->set_prefetched_batch(_s_scan_prefetch_budget, bytes);
+        _pfc_recent_scan_prefetch_count->increment();
+
+        _context_cache.release(handle, std::move(context), dsn_now_ms());
+    });
+}
+
+void pegasus_server_impl::on_clear_scanner(const int64_t &args)
+{
+    _context_cache.remove(args);
+    _pfc_scan_context_count->set(_context_cache.size());
+}
+
+int64_t pegasus_server_impl::put_scan_context(std::unique_ptr<pegasus_scan_context> context)
+{
+    bool evicted = false;
+    int64_t handle = _context_cache.put(std::move(context), dsn_now_ms(), evicted);
+    if (evicted) {
+        // not logged since it may happen on every scan, the counter is enough.
+        _pfc_recent_scan_context_evict_count->increment();
+    }
+    _pfc_scan_context_count->set(_context_cache.size());
+    return handle;
 }
 
-void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache.fetch(args); }
+void pegasus_server_impl::evict_idle_scan_contexts()
+{
+    uint64_t evicted_count = _context_cache.evict_idle_contexts(
+        dsn_now_ms(), static_cast<uint64_t>(FLAGS_scan_context_idle_timeout_s) * 1000);
+    if (evicted_count > 0) {
+        ddebug_replica("{} idle scan contexts are evicted", evicted_count);
+        _pfc_recent_scan_context_evict_count->add(evicted_count);
+    }
+    _pfc_scan_context_count->set(_context_cache.size());
+}
 
 ::dsn::error_code pegasus_server_impl::start(int argc, char **argv)
 {
@@ -1397,16 +2024,28 @@ void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache
     // will be used elsewhere.
     rocksdb::ColumnFamilyOptions tmp_data_cf_opts = _data_cf_opts;
     bool has_incompatible_db_options = false;
+    // The key column family is only created along with a new DB, the existing DBs keep their
+    // column families. It's specified by the app env rather than the config of the node, so that
+    // all the replicas of a table are created the same.
+    bool has_key_cf = false;
+    auto separate_key_cf = envs.find(ROCKSDB_SEPARATE_KEY_CF);
+    if (separate_key_cf != envs.end() && !dsn::buf2bool(separate_key_cf->second, has_key_cf)) {
+        derror_replica("{}={} is invalid.", separate_key_cf->first, separate_key_cf->second);
+        return ::dsn::ERR_INVALID_PARAMETERS;
+    }
     if (db_exist) {
         // When DB exists, meta CF and data CF must be present.
         bool missing_meta_cf = true;
         bool missing_data_cf = true;
-        if (check_column_families(path, &missing_meta_cf, &missing_data_cf) != ::dsn::ERR_OK) {
+        bool missing_key_cf = true;
+        if (check_column_families(path, &missing_meta_cf, &missing_data_cf, &missing_key_cf) !=
+            ::dsn::ERR_OK) {
             derror_replica("check column families failed");
             return ::dsn::ERR_LOCAL_APP_FAILURE;
         }
         dassert_replica(!missing_meta_cf, "You must upgrade Pegasus server from 2.0");
         dassert_replica(!missing_data_cf, "Missing data column family");
+        has_key_cf = !missing_key_cf;
 
         // Load latest options from option file stored in the db directory.
         rocksdb::DBOptions loaded_db_opt;
@@ -1452,6 +2091,9 @@ void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache
 
     std::vector<rocksdb::ColumnFamilyDescriptor> column_families(
         {{DATA_COLUMN_FAMILY_NAME, tmp_data_cf_opts}, {META_COLUMN_FAMILY_NAME, _meta_cf_opts}});
+    if (has_key_cf) {
+        column_families.emplace_back(KEY_COLUMN_FAMILY_NAME, _key_cf_opts);
+    }
     auto s = rocksdb::CheckOptionsCompatibility(
         path, rocksdb::Env::Default(), _db_opts, column_families, /*ignore_unknown_options=*/true);
     if (!s.ok() && !s.IsNotFound() && !has_incompatible_db_options) {
@@ -1464,11 +2106,21 @@ void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache
         derror_replica("rocksdb::DB::Open failed, error = {}", status.ToString());
         return ::dsn::ERR_LOCAL_APP_FAILURE;
     }
-    dcheck_eq_replica(2, handles_opened.size());
+    dcheck_eq_replica(column_families.size(), handles_opened.size());
     dcheck_eq_replica(handles_opened[0]->GetName(), DATA_COLUMN_FAMILY_NAME);
     dcheck_eq_replica(handles_opened[1]->GetName(), META_COLUMN_FAMILY_NAME);
     _data_cf = handles_opened[0];
     _meta_cf = handles_opened[1];
+    if (has_key_cf) {
+        dcheck_eq_replica(handles_opened[2]->GetName(), KEY_COLUMN_FAMILY_NAME);
+        _key_cf = handles_opened[2];
+        // The rows in the key column family only carry the expire_ts written with them, so the
+        // default TTL is applied on the new writes only, rather than on the old rows during
+        // compaction, which keeps both column families consistent. For the same reason incr
+        // can't be written as a merge operand, see update_incr_merge_enabled().
+        _key_ttl_compaction_filter_factory->SetDefaultTTL(0);
+        _incr_merge_enabled.store(false);
+    }
 
     // Create _meta_store which provide Pegasus meta data read and write.
     _meta_store = dsn::make_unique<meta_store>(this, _db, _meta_cf);
@@ -1500,6 +2152,9 @@ void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache
     _key_ttl_compaction_filter_factory->SetPartitionIndex(_gpid.get_partition_index());
     _key_ttl_compaction_filter_factory->SetPartitionVersion(_gpid.get_partition_index() - 1);
     _key_ttl_compaction_filter_factory->EnableFilter();
+    _key_cf_compaction_filter_factory->SetPartitionIndex(_gpid.get_partition_index());
+    _key_cf_compaction_filter_factory->SetPartitionVersion(_gpid.get_partition_index() - 1);
+    _key_cf_compaction_filter_factory->EnableFilter();
 
     parse_checkpoints();
 
@@ -1550,6 +2205,9 @@ void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache
             nullptr, // TODO: the tracker is nullptr, we will fix it later
             []() { update_server_rocksdb_statistics(); },
             kServerStatUpdateTimeSec);
+
+        _s_scan_prefetch_budget =
+            std::make_shared<scan_prefetch_budget>(FLAGS_scan_prefetch_memory_budget_mb << 20);
     });
 
     // initialize cu calculator and write service after server being initialized.
@@ -1559,7 +2217,10 @@ void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache
 
     ::dsn::tasking::enqueue_timer(LPC_ANALYZE_HOTKEY,
                                   &_tracker,
-                                  [this]() { _read_hotkey_collector->analyse_data(); },
+                                  [this]() {
+                                      _read_hotkey_collector->analyse_data();
+                                      update_hotkey_read_cache_detected_key();
+                                  },
                                   std::chrono::seconds(FLAGS_hotkey_analyse_time_interval_s));
 
     ::dsn::tasking::enqueue_timer(LPC_ANALYZE_HOTKEY,
@@ -1567,6 +2228,17 @@ void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache
                                   [this]() { _write_hotkey_collector->analyse_data(); },
                                   std::chrono::seconds(FLAGS_hotkey_analyse_time_interval_s));
 
+    ::dsn::tasking::enqueue_timer(LPC_PEGASUS_EVICT_SCAN_CONTEXT,
+                                  &_tracker,
+                                  [this]() { evict_idle_scan_contexts(); },
+                                  std::chrono::seconds(FLAGS_scan_context_evict_interval_s));
+
+    _s_compaction_scheduler->register_latency_source(_gpid, [this]() {
+        return static_cast<uint64_t>(
+            std::max(_pfc_get_latency->get_percentile(COUNTER_PERCENTILE_99),
+                     _pfc_multi_get_latency->get_percentile(COUNTER_PERCENTILE_99)));
+    });
+
     return ::dsn::ERR_OK;
 }
 
@@ -1590,6 +2262,9 @@ void pegasus_server_impl::cancel_background_work(bool wait)
         flush_all_family_columns(true);
     }
 
+    _s_compaction_scheduler->unregister_latency_source(_gpid);
+    _manual_compact_svc.cancel_scheduled_compact();
+
     // stop all tracked tasks when pegasus server is stopped.
     if (_update_replica_rdb_stat != nullptr) {
         _update_replica_rdb_stat->cancel(true);
@@ -1598,6 +2273,9 @@ void pegasus_server_impl::cancel_background_work(bool wait)
     _tracker.cancel_outstanding_tasks();
 
     _context_cache.clear();
+    _pfc_scan_context_count->set(0);
+    _hotkey_read_cache->clear();
+    _sortkey_count_index->clear();
 
     _is_open = false;
     release_db();
@@ -2055,50 +2733,23 @@ pegasus_server_impl::storage_apply_checkpoint(chkpt_apply_mode mode,
     return ::dsn::ERR_OK;
 }
 
-bool pegasus_server_impl::validate_filter(::dsn::apps::filter_type::type filter_type,
-                                          const ::dsn::blob &filter_pattern,
-                                          const ::dsn::blob &value)
-{
-    switch (filter_type) {
-    case ::dsn::apps::filter_type::FT_NO_FILTER:
-        return true;
-    case ::dsn::apps::filter_type::FT_MATCH_ANYWHERE:
-    case ::dsn::apps::filter_type::FT_MATCH_PREFIX:
-    case ::dsn::apps::filter_type::FT_MATCH_POSTFIX: {
-        if (filter_pattern.length() == 0)
-            return true;
-        if (value.length() < filter_pattern.length())
-            return false;
-        if (filter_type == ::dsn::apps::filter_type::FT_MATCH_ANYWHERE) {
-            return dsn::string_view(value).find(filter_pattern) != dsn::string_view::npos;
-        } else if (filter_type == ::dsn::apps::filter_type::FT_MATCH_PREFIX) {
-            return ::memcmp(value.data(), filter_pattern.data(), filter_pattern.length()) == 0;
-        } else { // filter_type == ::dsn::apps::filter_type::FT_MATCH_POSTFIX
-            return ::memcmp(value.data() + value.length() - filter_pattern.length(),
-                            filter_pattern.data(),
-                            filter_pattern.length()) == 0;
-        }
-    }
-    default:
-        dassert(false, "unsupported filter type: %d", filter_type);
-    }
-    return false;
-}
-
 range_iteration_state
 pegasus_server_impl::append_key_value_for_scan(std::vector<::dsn::apps::key_value> &kvs,
+                                               response_arena &arena,
                                                const rocksdb::Slice &key,
                                                const rocksdb::Slice &value,
-                                               ::dsn::apps::filter_type::type hash_key_filter_type,
-                                               const ::dsn::blob &hash_key_filter_pattern,
-                                               ::dsn::apps::filter_type::type sort_key_filter_type,
-                                               const ::dsn::blob &sort_key_filter_pattern,
+                                               const key_filter_matcher &hash_key_filter,
+                                               const key_filter_matcher &sort_key_filter,
                                                uint32_t epoch_now,
                                                bool no_value,
+                                               bool key_only,
                                                bool request_validate_hash,
-                                               bool request_expire_ts)
+                                               bool request_expire_ts,
+                                               scan_aggregator *aggregator)
 {
-    if (check_if_record_expired(epoch_now, value)) {
+    // the rows of the key column family carry no user data.
+    uint32_t data_version = key_only ? 0 : _pegasus_data_version;
+    if (pegasus::check_if_record_expired(data_version, epoch_now, utils::to_string_view(value))) {
         if (_verbose_log) {
             derror("%s: rocksdb data expired for scan", replica_name());
         }
@@ -2119,40 +2770,46 @@ pegasus_server_impl::append_key_value_for_scan(std::vector<::dsn::apps::key_valu
 
     // extract raw key
     ::dsn::blob raw_key(key.data(), 0, key.size());
-    if (hash_key_filter_type != ::dsn::apps::filter_type::FT_NO_FILTER ||
-        sort_key_filter_type != ::dsn::apps::filter_type::FT_NO_FILTER) {
+    if (!hash_key_filter.no_filter() || !sort_key_filter.no_filter()) {
         ::dsn::blob hash_key, sort_key;
         pegasus_restore_key(raw_key, hash_key, sort_key);
-        if (hash_key_filter_type != ::dsn::apps::filter_type::FT_NO_FILTER &&
-            !validate_filter(hash_key_filter_type, hash_key_filter_pattern, hash_key)) {
+        if (!hash_key_filter.match(dsn::string_view(hash_key))) {
             if (_verbose_log) {
                 derror("%s: hash key filtered for scan", replica_name());
             }
             return range_iteration_state::kFiltered;
         }
-        if (sort_key_filter_type != ::dsn::apps::filter_type::FT_NO_FILTER &&
-            !validate_filter(sort_key_filter_type, sort_key_filter_pattern, sort_key)) {
+        if (!sort_key_filter.match(dsn::string_view(sort_key))) {
             if (_verbose_log) {
                 derror("%s: sort key filtered for scan", replica_name());
             }
             return range_iteration_state::kFiltered;
         }
     }
-    std::shared_ptr<char> key_buf(::dsn::utils::make_shared_array<char>(raw_key.length()));
-    ::memcpy(key_buf.get(), raw_key.data(), raw_key.length());
-    kv.key.assign(std::move(key_buf), 0, raw_key.length());
+
+    if (aggregator != nullptr) {
+        // nothing is copied for the aggregation
+        aggregator->add(
+            dsn::string_view(key.data(), key.size()),
+            pegasus_extract_user_data_view(_pegasus_data_version, utils::to_string_view(value)));
+        return range_iteration_state::kNormal;
+    }
 
     // extract expire ts if necessary
     if (request_expire_ts) {
         auto expire_ts_seconds =
-            pegasus_extract_expire_ts(_pegasus_data_version, utils::to_string_view(value));
+            pegasus_extract_expire_ts(data_version, utils::to_string_view(value));
         kv.__set_expire_ts_seconds(static_cast<int32_t>(expire_ts_seconds));
     }
 
+    // the data referenced by iterator is only valid before the iterator moves, so we copy the
+    // key and the user data into the arena of this response.
+    kv.key = arena.copy(dsn::string_view(raw_key.data(), raw_key.length()));
+
     // extract value
     if (!no_value) {
-        std::string value_buf(value.data(), value.size());
-        pegasus_extract_user_data(_pegasus_data_version, std::move(value_buf), kv.value);
+        kv.value = arena.copy(
+            pegasus_extract_user_data_view(_pegasus_data_version, utils::to_string_view(value)));
     }
 
     kvs.emplace_back(std::move(kv));
@@ -2161,14 +2818,16 @@ pegasus_server_impl::append_key_value_for_scan(std::vector<::dsn::apps::key_valu
 
 range_iteration_state pegasus_server_impl::append_key_value_for_multi_get(
     std::vector<::dsn::apps::key_value> &kvs,
+    response_arena &arena,
     const rocksdb::Slice &key,
     const rocksdb::Slice &value,
-    ::dsn::apps::filter_type::type sort_key_filter_type,
-    const ::dsn::blob &sort_key_filter_pattern,
+    const key_filter_matcher &sort_key_filter,
     uint32_t epoch_now,
-    bool no_value)
+    bool no_value,
+    bool key_only)
 {
-    if (check_if_record_expired(epoch_now, value)) {
+    uint32_t data_version = key_only ? 0 : _pegasus_data_version;
+    if (pegasus::check_if_record_expired(data_version, epoch_now, utils::to_string_view(value))) {
         if (_verbose_log) {
             derror("%s: rocksdb data expired for multi get", replica_name());
         }
@@ -2181,21 +2840,18 @@ range_iteration_state pegasus_server_impl::append_key_value_for_multi_get(
     ::dsn::blob raw_key(key.data(), 0, key.size());
     ::dsn::blob hash_key, sort_key;
     pegasus_restore_key(raw_key, hash_key, sort_key);
-    if (sort_key_filter_type != ::dsn::apps::filter_type::FT_NO_FILTER &&
-        !validate_filter(sort_key_filter_type, sort_key_filter_pattern, sort_key)) {
+    if (!sort_key_filter.match(dsn::string_view(sort_key))) {
         if (_verbose_log) {
             derror("%s: sort key filtered for multi get", replica_name());
         }
         return range_iteration_state::kFiltered;
     }
-    std::shared_ptr<char> sort_key_buf(::dsn::utils::make_shared_array<char>(sort_key.length()));
-    ::memcpy(sort_key_buf.get(), sort_key.data(), sort_key.length());
-    kv.key.assign(std::move(sort_key_buf), 0, sort_key.length());
+    kv.key = arena.copy(dsn::string_view(sort_key.data(), sort_key.length()));
 
     // extract value
     if (!no_value) {
-        std::string value_buf(value.data(), value.size());
-        pegasus_extract_user_data(_pegasus_data_version, std::move(value_buf), kv.value);
+        kv.value = arena.copy(
+            pegasus_extract_user_data_view(_pegasus_data_version, utils::to_string_view(value)));
     }
 
     kvs.emplace_back(std::move(kv));
@@ -2356,6 +3012,8 @@ void pegasus_server_impl::update_app_envs(const std::map<std::string, std::strin
     update_rocksdb_iteration_threshold(envs);
     update_validate_partition_hash(envs);
     update_user_specified_compaction(envs);
+    update_incr_merge_enabled(envs);
+    update_hotkey_read_cache_hash_keys(envs);
     _manual_compact_svc.start_manual_compact_if_needed(envs);
 }
 
@@ -2374,6 +3032,8 @@ void pegasus_server_impl::update_app_envs_before_open_db(
     update_rocksdb_iteration_threshold(envs);
     update_validate_partition_hash(envs);
     update_user_specified_compaction(envs);
+    update_incr_merge_enabled(envs);
+    update_hotkey_read_cache_hash_keys(envs);
     _manual_compact_svc.start_manual_compact_if_needed(envs);
 }
 
@@ -2415,7 +3075,17 @@ void pegasus_server_impl::update_default_ttl(const std::map<std::string, std::st
             return;
         }
         _server_write->set_default_ttl(static_cast<uint32_t>(ttl));
-        _key_ttl_compaction_filter_factory->SetDefaultTTL(static_cast<uint32_t>(ttl));
+        // the default TTL of the db with the key column family is applied on the new writes
+        // only, see start().
+        if (_key_cf == nullptr) {
+            if (static_cast<uint32_t>(ttl) !=
+                _key_ttl_compaction_filter_factory->GetDefaultTTL()) {
+                // the rows may be expired by the TTL set in compaction, see count_sortkeys.
+                _sortkey_count_index->clear();
+            }
+            _key_ttl_compaction_filter_factory->SetDefaultTTL(static_cast<uint32_t>(ttl));
+        }
+        update_hotkey_read_cache_bypassed();
     }
 }
 
@@ -2518,6 +3188,7 @@ void pegasus_server_impl::update_validate_partition_hash(
             "update '_validate_partition_hash' from {} to {}", _validate_partition_hash, new_value);
         _validate_partition_hash = new_value;
         _key_ttl_compaction_filter_factory->SetValidatePartitionHash(_validate_partition_hash);
+        _key_cf_compaction_filter_factory->SetValidatePartitionHash(_validate_partition_hash);
     }
 }
 
@@ -2527,8 +3198,73 @@ void pegasus_server_impl::update_user_specified_compaction(
     auto iter = envs.find(USER_SPECIFIED_COMPACTION);
     if (dsn_unlikely(iter != envs.end() && iter->second != _user_specified_compaction)) {
         _key_ttl_compaction_filter_factory->extract_user_specified_ops(iter->second);
+        _key_cf_compaction_filter_factory->extract_user_specified_ops(iter->second);
         _user_specified_compaction = iter->second;
+        _has_user_specified_compaction.store(!_user_specified_compaction.empty());
+        // the rows may be dropped by the compaction, see count_sortkeys.
+        _sortkey_count_index->clear();
+        update_hotkey_read_cache_bypassed();
+    }
+}
+
+void pegasus_server_impl::update_incr_merge_enabled(const std::map<std::string, std::string> &envs)
+{
+    bool new_value = false;
+    auto iter = envs.find(INCR_MERGE_ENABLED);
+    if (iter != envs.end()) {
+        if (!dsn::buf2bool(iter->second, new_value)) {
+            derror_replica("{}={} is invalid.", iter->first, iter->second);
+            return;
+        }
+    }
+    if (new_value && _data_cf_opts.merge_operator == nullptr) {
+        dwarn_replica("ignore app env[{}]=true since rocksdb_incr_merge_operator_enabled is off",
+                      INCR_MERGE_ENABLED);
+        new_value = false;
+    }
+    if (new_value && _key_cf != nullptr) {
+        // the merge operands can't be mirrored into the key column family.
+        dwarn_replica("ignore app env[{}]=true since the table has a key column family",
+                      INCR_MERGE_ENABLED);
+        new_value = false;
+    }
+    if (new_value != _incr_merge_enabled.load()) {
+        ddebug_replica("update app env[{}] from \"{}\" to \"{}\" succeed",
+                       INCR_MERGE_ENABLED,
+                       _incr_merge_enabled.load(),
+                       new_value);
+        _incr_merge_enabled.store(new_value);
+    }
+}
+
+void pegasus_server_impl::update_hotkey_read_cache_hash_keys(
+    const std::map<std::string, std::string> &envs)
+{
+    std::vector<std::string> hash_keys;
+    auto iter = envs.find(HOTKEY_READ_CACHE_HASH_KEYS);
+    if (iter != envs.end()) {
+        dsn::utils::split_args(iter->second.c_str(), hash_keys, ',');
+    }
+    _hotkey_read_cache->set_specified_hash_keys(
+        std::set<std::string>(hash_keys.begin(), hash_keys.end()));
+}
+
+void pegasus_server_impl::update_hotkey_read_cache_bypassed()
+{
+    // the default TTL of the db with the key column family is applied on the new writes only,
+    // when the factory keeps no default TTL.
+    _hotkey_read_cache->set_bypassed(_key_ttl_compaction_filter_factory->GetDefaultTTL() != 0 ||
+                                     !_user_specified_compaction.empty());
+}
+
+void pegasus_server_impl::update_hotkey_read_cache_detected_key()
+{
+    std::string hash_key;
+    if (!FLAGS_hotkey_read_cache_by_detection ||
+        !_read_hotkey_collector->get_hot_hash_key(hash_key)) {
+        hash_key.clear();
     }
+    _hotkey_read_cache->set_detected_hash_key(hash_key);
 }
 
 bool pegasus_server_impl::parse_compression_types(
@@ -2731,10 +3467,12 @@ bool pegasus_server_impl::set_options(
 
 ::dsn::error_code pegasus_server_impl::check_column_families(const std::string &path,
                                                              bool *missing_meta_cf,
-                                                             bool *missing_data_cf)
+                                                             bool *missing_data_cf,
+                                                             bool *missing_key_cf)
 {
     *missing_meta_cf = true;
     *missing_data_cf = true;
+    *missing_key_cf = true;
     std::vector<std::string> column_families;
     auto s = rocksdb::DB::ListColumnFamilies(rocksdb::DBOptions(), path, &column_families);
     if (!s.ok()) {
@@ -2747,6 +3485,8 @@ bool pegasus_server_impl::set_options(
             *missing_meta_cf = false;
         } else if (column_family == DATA_COLUMN_FAMILY_NAME) {
             *missing_data_cf = false;
+        } else if (column_family == KEY_COLUMN_FAMILY_NAME) {
+            *missing_key_cf = false;
         } else {
             derror_replica("unknown column family name: {}", column_family);
             return ::dsn::ERR_LOCAL_APP_FAILURE;
@@ -2770,6 +3510,9 @@ uint64_t pegasus_server_impl::do_manual_compact(const rocksdb::CompactRangeOptio
                        : "skip");
     start_time = dsn_now_ms();
     auto status = _db->CompactRange(options, _data_cf, nullptr, nullptr);
+    if (status.ok() && _key_cf != nullptr) {
+        status = _db->CompactRange(options, _key_cf, nullptr, nullptr);
+    }
     auto end_time = dsn_now_ms();
     ddebug_replica("finish CompactRange, status = {}, time_used = {}ms",
                    status.ToString(),
@@ -2844,13 +3587,18 @@ void pegasus_server_impl::set_partition_version(int32_t partition_version)
     ddebug_replica(
         "update partition version from {} to {}", old_partition_version, partition_version);
     _key_ttl_compaction_filter_factory->SetPartitionVersion(partition_version);
+    _key_cf_compaction_filter_factory->SetPartitionVersion(partition_version);
 }
 
 ::dsn::error_code pegasus_server_impl::flush_all_family_columns(bool wait)
 {
     rocksdb::FlushOptions options;
     options.wait = wait;
-    rocksdb::Status status = _db->Flush(options, {_meta_cf, _data_cf});
+    std::vector<rocksdb::ColumnFamilyHandle *> column_families({_meta_cf, _data_cf});
+    if (_key_cf != nullptr) {
+        column_families.push_back(_key_cf);
+    }
+    rocksdb::Status status = _db->Flush(options, column_families);
     if (!status.ok()) {
         derror_replica("flush failed, error = {}", status.ToString());
         return ::dsn::ERR_LOCAL_APP_FAILURE;
@@ -2866,6 +3614,10 @@ void pegasus_server_impl::release_db()
         _data_cf = nullptr;
         _db->DestroyColumnFamilyHandle(_meta_cf);
         _meta_cf = nullptr;
+        if (_key_cf != nullptr) {
+            _db->DestroyColumnFamilyHandle(_key_cf);
+            _key_cf = nullptr;
+        }
         delete _db;
         _db = nullptr;
     }
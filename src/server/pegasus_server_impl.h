@@ -35,6 +35,7 @@
 #include "pegasus_manual_compact_service.h"
 #include "pegasus_write_service.h"
 #include "range_read_limiter.h"
+#include "response_arena.h"
 #include "pegasus_read_service.h"
 
 namespace pegasus {
@@ -44,6 +45,9 @@ class meta_store;
 class capacity_unit_calculator;
 class pegasus_server_write;
 class hotkey_collector;
+class hotkey_read_cache;
+class sortkey_count_index;
+class compaction_scheduler;
 
 enum class range_iteration_state
 {
@@ -69,7 +73,9 @@ public:
     // the following methods may set physical error if internal error occurs
     void on_get(get_rpc rpc) override;
     void on_multi_get(multi_get_rpc rpc) override;
+    void on_batch_get(batch_get_rpc rpc) override;
     void on_sortkey_count(sortkey_count_rpc rpc) override;
+    void on_sortkey_count_v2(sortkey_count_v2_rpc rpc) override;
     void on_ttl(ttl_rpc rpc) override;
     void on_get_scanner(get_scanner_rpc rpc) override;
     void on_scan(scan_rpc rpc) override;
@@ -197,6 +203,14 @@ private:
     FRIEND_TEST(pegasus_server_impl_test, test_open_db_with_app_envs);
     FRIEND_TEST(pegasus_server_impl_test, test_stop_db_twice);
     FRIEND_TEST(pegasus_server_impl_test, test_update_user_specified_compaction);
+    FRIEND_TEST(pegasus_server_impl_test, batch_get);
+    FRIEND_TEST(pegasus_server_impl_test, batch_get_exceed_limit);
+    FRIEND_TEST(pegasus_server_impl_test, multi_get_sort_keys_order);
+    FRIEND_TEST(pegasus_server_impl_test, multi_get_last_sortkey);
+    FRIEND_TEST(pegasus_server_impl_test, hotkey_read_cache);
+    FRIEND_TEST(pegasus_server_impl_test, sortkey_count);
+    FRIEND_TEST(pegasus_server_impl_test, key_column_family);
+    FRIEND_TEST(pegasus_server_impl_test, incr_merge_operator_disabled);
 
     friend class pegasus_manual_compact_service;
     friend class pegasus_write_service;
@@ -212,40 +226,78 @@ private:
 
     void set_last_durable_decree(int64_t decree) { _last_durable_decree.store(decree); }
 
+    // count the sort keys of `hash_key` for sortkey_count and sortkey_count_v2. The count is
+    // estimated if `approximate` is true and there're too many rows to be scanned.
+    void count_sortkeys(const ::dsn::blob &hash_key,
+                        bool approximate,
+                        dsn::message_ex *req,
+                        ::dsn::apps::count_response &resp);
+
+    // estimate the count of the rows in [scanned_stop, stop) by the approximate sizes of it and
+    // [start, scanned_stop), which holds `scanned_count` rows. Return false if it can't be
+    // estimated, e.g. the scanned rows are all in the memtable whose size is unknown yet.
+    bool estimate_remaining_count(const rocksdb::Slice &start,
+                                  const rocksdb::Slice &scanned_stop,
+                                  const rocksdb::Slice &stop,
+                                  int64_t scanned_count,
+                                  /*out*/ int64_t &remaining_count);
+
+    // if `aggregator` is not null, the row is added into it instead of `kvs`.
     range_iteration_state
     append_key_value_for_scan(std::vector<::dsn::apps::key_value> &kvs,
+                              response_arena &arena,
                               const rocksdb::Slice &key,
                               const rocksdb::Slice &value,
-                              ::dsn::apps::filter_type::type hash_key_filter_type,
-                              const ::dsn::blob &hash_key_filter_pattern,
-                              ::dsn::apps::filter_type::type sort_key_filter_type,
-                              const ::dsn::blob &sort_key_filter_pattern,
+                              const key_filter_matcher &hash_key_filter,
+                              const key_filter_matcher &sort_key_filter,
                               uint32_t epoch_now,
                               bool no_value,
+                              bool key_only,
                               bool request_validate_hash,
-                              bool request_expire_ts);
+                              bool request_expire_ts,
+                              scan_aggregator *aggregator);
 
     range_iteration_state
     append_key_value_for_multi_get(std::vector<::dsn::apps::key_value> &kvs,
+                                   response_arena &arena,
                                    const rocksdb::Slice &key,
                                    const rocksdb::Slice &value,
-                                   ::dsn::apps::filter_type::type sort_key_filter_type,
-                                   const ::dsn::blob &sort_key_filter_pattern,
+                                   const key_filter_matcher &sort_key_filter,
                                    uint32_t epoch_now,
-                                   bool no_value);
+                                   bool no_value,
+                                   bool key_only);
+
+    // the reads without values iterate the key column family if the db has it, whose values
+    // are in the format of data version 0, see append_key_value_for_scan().
+    bool is_key_only_read(bool no_value) const { return no_value && _key_cf != nullptr; }
+
+    // scan the next batch of `context` into `kvs`, or into `result.aggregate` if the scan is an
+    // aggregation.
+    void scan_next_batch(pegasus_scan_context *context,
+                         std::vector<::dsn::apps::key_value> &kvs,
+                         scan_batch_result &result,
+                         const char *remote_address);
+
+    // prefetch the next batch of the scan context in background if prefetch is enabled and
+    // the memory budget is not exhausted. the budget is reserved by the size of `last_kvs`,
+    // the batch just replied, which is the estimated size of the next batch.
+    void try_prefetch_scan_batch(int64_t handle,
+                                 const std::vector<::dsn::apps::key_value> &last_kvs);
+
+    // put the context into the scan context cache, and return the handle of it.
+    int64_t put_scan_context(std::unique_ptr<pegasus_scan_context> context);
+
+    void evict_idle_scan_contexts();
 
     // return true if the filter type is supported
     bool is_filter_type_supported(::dsn::apps::filter_type::type filter_type)
     {
-        return filter_type >= ::dsn::apps::filter_type::FT_NO_FILTER &&
-               filter_type <= ::dsn::apps::filter_type::FT_MATCH_POSTFIX;
+        return (filter_type >= ::dsn::apps::filter_type::FT_NO_FILTER &&
+                filter_type <= ::dsn::apps::filter_type::FT_MATCH_POSTFIX) ||
+               filter_type == ::dsn::apps::filter_type::FT_MATCH_REGEX ||
+               filter_type == ::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN;
     }
 
-    // return true if the data is valid for the filter
-    bool validate_filter(::dsn::apps::filter_type::type filter_type,
-                         const ::dsn::blob &filter_pattern,
-                         const ::dsn::blob &value);
-
     void update_replica_rocksdb_statistics();
 
     static void update_server_rocksdb_statistics();
@@ -273,6 +325,16 @@ private:
 
     void update_user_specified_compaction(const std::map<std::string, std::string> &envs);
 
+    void update_incr_merge_enabled(const std::map<std::string, std::string> &envs);
+
+    void update_hotkey_read_cache_hash_keys(const std::map<std::string, std::string> &envs);
+
+    // bypass the hotkey read cache if the compaction may drop or rewrite the rows.
+    void update_hotkey_read_cache_bypassed();
+
+    // cache the rows of the read hotkey if it's found and hotkey_read_cache_by_detection is set.
+    void update_hotkey_read_cache_detected_key();
+
     // return true if parse compression types 'config' success, otherwise return false.
     // 'compression_per_level' will not be changed if parse failed.
     bool parse_compression_types(const std::string &config,
@@ -342,8 +404,10 @@ private:
         return false;
     }
 
-    ::dsn::error_code
-    check_column_families(const std::string &path, bool *missing_meta_cf, bool *miss_data_cf);
+    ::dsn::error_code check_column_families(const std::string &path,
+                                            bool *missing_meta_cf,
+                                            bool *miss_data_cf,
+                                            bool *missing_key_cf);
 
     void release_db();
 
@@ -360,6 +424,7 @@ private:
     // Column family names.
     static const std::string DATA_COLUMN_FAMILY_NAME;
     static const std::string META_COLUMN_FAMILY_NAME;
+    static const std::string KEY_COLUMN_FAMILY_NAME;
 
     dsn::gpid _gpid;
     std::string _primary_address;
@@ -378,16 +443,26 @@ private:
     rocksdb::DBOptions _db_opts;
     rocksdb::ColumnFamilyOptions _data_cf_opts;
     rocksdb::ColumnFamilyOptions _meta_cf_opts;
+    rocksdb::ColumnFamilyOptions _key_cf_opts;
     rocksdb::ReadOptions _data_cf_rd_opts;
     std::string _usage_scenario;
     std::string _user_specified_compaction;
+    // whether _user_specified_compaction is not empty, which is read by the read threads.
+    std::atomic_bool _has_user_specified_compaction{false};
 
     rocksdb::DB *_db;
     rocksdb::ColumnFamilyHandle *_data_cf;
     rocksdb::ColumnFamilyHandle *_meta_cf;
+    // the key column family holds the expire_ts of each row in the data column family, so that
+    // the reads without values needn't load the values. It's null if the db is created without
+    // it, see ROCKSDB_SEPARATE_KEY_CF.
+    rocksdb::ColumnFamilyHandle *_key_cf;
+    std::shared_ptr<KeyWithTTLCompactionFilterFactory> _key_cf_compaction_filter_factory;
     static std::shared_ptr<rocksdb::Cache> _s_block_cache;
     static std::shared_ptr<rocksdb::WriteBufferManager> _s_write_buffer_manager;
     static std::shared_ptr<rocksdb::RateLimiter> _s_rate_limiter;
+    static std::shared_ptr<scan_prefetch_budget> _s_scan_prefetch_budget;
+    static std::shared_ptr<compaction_scheduler> _s_compaction_scheduler;
     static int64_t _rocksdb_limiter_last_total_through;
     volatile bool _is_open;
     uint32_t _pegasus_data_version;
@@ -415,6 +490,8 @@ private:
 
     std::atomic<int32_t> _partition_version;
     bool _validate_partition_hash{false};
+    // incr is written as a merge operand if true, see IncrMergeOperator.
+    std::atomic_bool _incr_merge_enabled{false};
 
     dsn::replication::ingestion_status::type _ingestion_status{
         dsn::replication::ingestion_status::IS_INVALID};
@@ -423,19 +500,31 @@ private:
 
     std::shared_ptr<hotkey_collector> _read_hotkey_collector;
     std::shared_ptr<hotkey_collector> _write_hotkey_collector;
+    std::unique_ptr<hotkey_read_cache> _hotkey_read_cache;
+    std::unique_ptr<sortkey_count_index> _sortkey_count_index;
 
     // perf counters
     ::dsn::perf_counter_wrapper _pfc_get_qps;
     ::dsn::perf_counter_wrapper _pfc_multi_get_qps;
+    ::dsn::perf_counter_wrapper _pfc_batch_get_qps;
     ::dsn::perf_counter_wrapper _pfc_scan_qps;
 
     ::dsn::perf_counter_wrapper _pfc_get_latency;
     ::dsn::perf_counter_wrapper _pfc_multi_get_latency;
+    ::dsn::perf_counter_wrapper _pfc_batch_get_latency;
     ::dsn::perf_counter_wrapper _pfc_scan_latency;
 
     ::dsn::perf_counter_wrapper _pfc_recent_expire_count;
     ::dsn::perf_counter_wrapper _pfc_recent_filter_count;
     ::dsn::perf_counter_wrapper _pfc_recent_abnormal_count;
+    ::dsn::perf_counter_wrapper _pfc_recent_hotkey_read_cache_hit_count;
+    ::dsn::perf_counter_wrapper _pfc_recent_hotkey_read_cache_miss_count;
+    ::dsn::perf_counter_wrapper _pfc_recent_sortkey_count_index_hit_count;
+    ::dsn::perf_counter_wrapper _pfc_recent_approximate_sortkey_count_count;
+
+    ::dsn::perf_counter_wrapper _pfc_scan_context_count;
+    ::dsn::perf_counter_wrapper _pfc_recent_scan_context_evict_count;
+    ::dsn::perf_counter_wrapper _pfc_recent_scan_prefetch_count;
 
     // rocksdb internal statistics
     // server level
@@ -25,10 +25,14 @@
 
 #include "capacity_unit_calculator.h"
 #include "hashkey_transform.h"
+#include "incr_merge_operator.h"
 #include "meta_store.h"
 #include "pegasus_event_listener.h"
 #include "pegasus_server_write.h"
 #include "hotkey_collector.h"
+#include "hotkey_read_cache.h"
+#include "sortkey_count_index.h"
+#include "compaction_scheduler.h"
 
 namespace pegasus {
 namespace server {
@@ -44,6 +48,32 @@ DSN_DEFINE_bool("pegasus.server",
                 false,
                 "whether to enable write rate auto tune when open rocksdb write limit");
 
+DSN_DEFINE_bool("pegasus.server",
+                rocksdb_incr_merge_operator_enabled,
+                false,
+                "whether to install the merge operator of incr, which is required by the app env "
+                "replica.incr_merge_enabled. once some incr is written as a merge operand, it "
+                "can't be turned off nor the server be rolled back to a version without it, "
+                "until the env is turned off and the data is fully compacted");
+
+DSN_DEFINE_uint32("pegasus.server",
+                  scan_context_max_count_per_replica,
+                  10000,
+                  "max count of live scan contexts on one replica, the least recently used "
+                  "context will be evicted if exceeded, 0 means no limit");
+
+DSN_DEFINE_uint32("pegasus.server",
+                  hotkey_read_cache_capacity_kb,
+                  4096,
+                  "max total size in KB of the keys and values of the rows of hot hash keys "
+                  "cached on one replica");
+
+DSN_DEFINE_uint32("pegasus.server",
+                  sortkey_count_index_capacity,
+                  10000,
+                  "max count of the hash keys whose sort key counts are indexed on one replica, "
+                  "0 means disable the index");
+
 static const std::unordered_map<std::string, rocksdb::BlockBasedTableOptions::IndexType>
     INDEX_TYPE_STRING_MAP = {
         {"binary_search", rocksdb::BlockBasedTableOptions::IndexType::kBinarySearch},
@@ -58,6 +88,7 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
       _db(nullptr),
       _data_cf(nullptr),
       _meta_cf(nullptr),
+      _key_cf(nullptr),
       _is_open(false),
       _pegasus_data_version(PEGASUS_DATA_VERSION_MAX),
       _last_durable_decree(0),
@@ -72,6 +103,12 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
         std::make_shared<hotkey_collector>(dsn::replication::hotkey_type::READ, this);
     _write_hotkey_collector =
         std::make_shared<hotkey_collector>(dsn::replication::hotkey_type::WRITE, this);
+    _hotkey_read_cache = dsn::make_unique<hotkey_read_cache>(
+        static_cast<uint64_t>(FLAGS_hotkey_read_cache_capacity_kb) << 10);
+    _sortkey_count_index =
+        dsn::make_unique<sortkey_count_index>(FLAGS_sortkey_count_index_capacity);
+
+    _context_cache.set_max_count(FLAGS_scan_context_max_count_per_replica);
 
     _verbose_log = dsn_config_get_value_bool("pegasus.server",
                                              "rocksdb_verbose_log",
@@ -164,8 +201,6 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
     _statistics->set_stats_level(rocksdb::kExceptDetailedTimers);
     _db_opts.statistics = _statistics;
 
-    _db_opts.listeners.emplace_back(new pegasus_event_listener(this));
-
     // flush threads are shared among all rocksdb instances in one process.
     _db_opts.max_background_flushes =
         (int)dsn_config_get_value_int64("pegasus.server",
@@ -196,6 +231,8 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
     _data_cf_opts.num_levels = (int)dsn_config_get_value_int64(
         "pegasus.server", "rocksdb_num_levels", 6, "rocksdb options.num_levels");
 
+    _db_opts.listeners.emplace_back(new pegasus_event_listener(this, _data_cf_opts.num_levels));
+
     _data_cf_opts.target_file_size_base =
         dsn_config_get_value_uint64("pegasus.server",
                                     "rocksdb_target_file_size_base",
@@ -309,6 +346,16 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
         _db_opts.rate_limiter = _s_rate_limiter;
     }
 
+    // the manual compactions of all replicas on this server are scheduled by one scheduler.
+    static std::once_flag scheduler_flag;
+    std::call_once(scheduler_flag, [&]() {
+        // the rate of an auto tuned rate limiter can't be set by the scheduler.
+        _s_compaction_scheduler = std::make_shared<compaction_scheduler>(
+            FLAGS_rocksdb_limiter_enable_auto_tune ? nullptr : _s_rate_limiter,
+            FLAGS_rocksdb_limiter_max_write_megabytes_per_sec << 20);
+        _s_compaction_scheduler->start();
+    });
+
     bool enable_write_buffer_manager =
         dsn_config_get_value_bool("pegasus.server",
                                   "rocksdb_enable_write_buffer_manager",
@@ -488,6 +535,21 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
 
     _key_ttl_compaction_filter_factory = std::make_shared<KeyWithTTLCompactionFilterFactory>();
     _data_cf_opts.compaction_filter_factory = _key_ttl_compaction_filter_factory;
+    // the merge operator is set regardless of the env "replica.incr_merge_enabled", because the
+    // incr operands are still to be merged after the env is turned off. it's not installed by
+    // default, so that the data of a server which never enabled it can be read by the older
+    // versions.
+    if (FLAGS_rocksdb_incr_merge_operator_enabled) {
+        _data_cf_opts.merge_operator = std::make_shared<IncrMergeOperator>();
+    }
+
+    // the key column family shares the table options of the data column family, its values are
+    // always in the format of data version 0 which carries the expire_ts only.
+    _key_cf_opts = _data_cf_opts;
+    _key_cf_opts.merge_operator = nullptr;
+    _key_cf_compaction_filter_factory = std::make_shared<KeyWithTTLCompactionFilterFactory>();
+    _key_cf_compaction_filter_factory->SetPegasusDataVersion(0);
+    _key_cf_opts.compaction_filter_factory = _key_cf_compaction_filter_factory;
 
     // get the checkpoint reserve options.
     _checkpoint_reserve_min_count_in_config = (uint32_t)dsn_config_get_value_uint64(
@@ -516,6 +578,10 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
     _pfc_multi_get_qps.init_app_counter(
         "app.pegasus", name, COUNTER_TYPE_RATE, "statistic the qps of MULTI_GET request");
 
+    snprintf(name, 255, "batch_get_qps@%s", str_gpid.c_str());
+    _pfc_batch_get_qps.init_app_counter(
+        "app.pegasus", name, COUNTER_TYPE_RATE, "statistic the qps of BATCH_GET request");
+
     snprintf(name, 255, "scan_qps@%s", str_gpid.c_str());
     _pfc_scan_qps.init_app_counter(
         "app.pegasus", name, COUNTER_TYPE_RATE, "statistic the qps of SCAN request");
@@ -532,6 +598,12 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
                                             COUNTER_TYPE_NUMBER_PERCENTILES,
                                             "statistic the latency of MULTI_GET request");
 
+    snprintf(name, 255, "batch_get_latency@%s", str_gpid.c_str());
+    _pfc_batch_get_latency.init_app_counter("app.pegasus",
+                                            name,
+                                            COUNTER_TYPE_NUMBER_PERCENTILES,
+                                            "statistic the latency of BATCH_GET request");
+
     snprintf(name, 255, "scan_latency@%s", str_gpid.c_str());
     _pfc_scan_latency.init_app_counter("app.pegasus",
                                        name,
@@ -556,6 +628,52 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
                                                 COUNTER_TYPE_VOLATILE_NUMBER,
                                                 "statistic the recent abnormal read count");
 
+    snprintf(name, 255, "recent.hotkey_read_cache.hit.count@%s", str_gpid.c_str());
+    _pfc_recent_hotkey_read_cache_hit_count.init_app_counter(
+        "app.pegasus",
+        name,
+        COUNTER_TYPE_VOLATILE_NUMBER,
+        "statistic the recent get count served by the hotkey read cache");
+
+    snprintf(name, 255, "recent.hotkey_read_cache.miss.count@%s", str_gpid.c_str());
+    _pfc_recent_hotkey_read_cache_miss_count.init_app_counter(
+        "app.pegasus",
+        name,
+        COUNTER_TYPE_VOLATILE_NUMBER,
+        "statistic the recent get count of the hot hash keys missing the hotkey read cache");
+
+    snprintf(name, 255, "recent.sortkey_count_index.hit.count@%s", str_gpid.c_str());
+    _pfc_recent_sortkey_count_index_hit_count.init_app_counter(
+        "app.pegasus",
+        name,
+        COUNTER_TYPE_VOLATILE_NUMBER,
+        "statistic the recent sortkey_count count served by the sort key count index");
+
+    snprintf(name, 255, "recent.sortkey_count.approximate.count@%s", str_gpid.c_str());
+    _pfc_recent_approximate_sortkey_count_count.init_app_counter(
+        "app.pegasus",
+        name,
+        COUNTER_TYPE_VOLATILE_NUMBER,
+        "statistic the recent sortkey_count count whose results are estimated");
+
+    snprintf(name, 255, "scan_context.count@%s", str_gpid.c_str());
+    _pfc_scan_context_count.init_app_counter(
+        "app.pegasus", name, COUNTER_TYPE_NUMBER, "statistic the count of live scan contexts");
+
+    snprintf(name, 255, "recent.scan_context.evict.count@%s", str_gpid.c_str());
+    _pfc_recent_scan_context_evict_count.init_app_counter(
+        "app.pegasus",
+        name,
+        COUNTER_TYPE_VOLATILE_NUMBER,
+        "statistic the recent evicted scan context count");
+
+    snprintf(name, 255, "recent.scan_prefetch.count@%s", str_gpid.c_str());
+    _pfc_recent_scan_prefetch_count.init_app_counter("app.pegasus",
+                                                     name,
+                                                     COUNTER_TYPE_VOLATILE_NUMBER,
+                                                     "statistic the recent prefetched scan batch "
+                                                     "count");
+
     snprintf(name, 255, "disk.storage.sst.count@%s", str_gpid.c_str());
     _pfc_rdb_sst_count.init_app_counter(
         "app.pegasus", name, COUNTER_TYPE_NUMBER, "statistic the count of sstable files");
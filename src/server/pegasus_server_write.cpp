@@ -149,6 +149,11 @@ void pegasus_server_write::init_non_batch_write_handlers()
              auto rpc = multi_remove_rpc::auto_reply(request);
              return _write_svc->multi_remove(_decree, rpc.request(), rpc.response());
          }},
+        {dsn::apps::RPC_RRDB_RRDB_BATCH_WRITE,
+         [this](dsn::message_ex *request) -> int {
+             auto rpc = batch_write_rpc::auto_reply(request);
+             return _write_svc->batch_write(_write_ctx, rpc.request(), rpc.response());
+         }},
         {dsn::apps::RPC_RRDB_RRDB_INCR,
          [this](dsn::message_ex *request) -> int {
              auto rpc = incr_rpc::auto_reply(request);
@@ -60,6 +60,12 @@ pegasus_write_service::pegasus_write_service(pegasus_server_impl *server)
                                            COUNTER_TYPE_RATE,
                                            "statistic the qps of MULTI_REMOVE request");
 
+    name = fmt::format("batch_write_qps@{}", str_gpid);
+    _pfc_batch_write_qps.init_app_counter("app.pegasus",
+                                          name.c_str(),
+                                          COUNTER_TYPE_RATE,
+                                          "statistic the qps of BATCH_WRITE request");
+
     name = fmt::format("incr_qps@{}", str_gpid);
     _pfc_incr_qps.init_app_counter(
         "app.pegasus", name.c_str(), COUNTER_TYPE_RATE, "statistic the qps of INCR request");
@@ -100,6 +106,12 @@ pegasus_write_service::pegasus_write_service(pegasus_server_impl *server)
                                                COUNTER_TYPE_NUMBER_PERCENTILES,
                                                "statistic the latency of MULTI_REMOVE request");
 
+    name = fmt::format("batch_write_latency@{}", str_gpid);
+    _pfc_batch_write_latency.init_app_counter("app.pegasus",
+                                              name.c_str(),
+                                              COUNTER_TYPE_NUMBER_PERCENTILES,
+                                              "statistic the latency of BATCH_WRITE request");
+
     name = fmt::format("incr_latency@{}", str_gpid);
     _pfc_incr_latency.init_app_counter("app.pegasus",
                                        name.c_str(),
@@ -179,6 +191,28 @@ int pegasus_write_service::multi_remove(int64_t decree,
     return err;
 }
 
+int pegasus_write_service::batch_write(const db_write_context &ctx,
+                                       const dsn::apps::batch_write_request &update,
+                                       dsn::apps::update_response &resp)
+{
+    uint64_t start_time = dsn_now_ns();
+    _pfc_batch_write_qps->increment();
+    int err = _impl->batch_write(ctx, update, resp);
+
+    if (_server->is_primary()) {
+        for (const auto &op : update.operations) {
+            if (op.operation == dsn::apps::mutate_operation::MO_PUT) {
+                _cu_calculator->add_put_cu(resp.error, op.key, op.value);
+            } else {
+                _cu_calculator->add_remove_cu(resp.error, op.key);
+            }
+        }
+    }
+
+    _pfc_batch_write_latency->set(dsn_now_ns() - start_time);
+    return err;
+}
+
 int pegasus_write_service::incr(int64_t decree,
                                 const dsn::apps::incr_request &update,
                                 dsn::apps::incr_response &resp)
@@ -342,6 +376,11 @@ int pegasus_write_service::duplicate(int64_t decree,
         resp.__set_error(_impl->multi_put(ctx, rpc.request(), rpc.response()));
         return resp.error;
     }
+    if (request.task_code == dsn::apps::RPC_RRDB_RRDB_BATCH_WRITE) {
+        batch_write_rpc rpc(write);
+        resp.__set_error(_impl->batch_write(ctx, rpc.request(), rpc.response()));
+        return resp.error;
+    }
     if (request.task_code == dsn::apps::RPC_RRDB_RRDB_MULTI_REMOVE) {
         multi_remove_rpc rpc(write);
         resp.__set_error(_impl->multi_remove(ctx.decree, rpc.request(), rpc.response()));
@@ -123,6 +123,11 @@ public:
                      const dsn::apps::multi_remove_request &update,
                      dsn::apps::multi_remove_response &resp);
 
+    // Write BATCH_WRITE record, the puts and removes of different keys are applied atomically.
+    int batch_write(const db_write_context &ctx,
+                    const dsn::apps::batch_write_request &update,
+                    dsn::apps::update_response &resp);
+
     // Write INCR record.
     int incr(int64_t decree, const dsn::apps::incr_request &update, dsn::apps::incr_response &resp);
 
@@ -196,6 +201,7 @@ private:
     ::dsn::perf_counter_wrapper _pfc_multi_put_qps;
     ::dsn::perf_counter_wrapper _pfc_remove_qps;
     ::dsn::perf_counter_wrapper _pfc_multi_remove_qps;
+    ::dsn::perf_counter_wrapper _pfc_batch_write_qps;
     ::dsn::perf_counter_wrapper _pfc_incr_qps;
     ::dsn::perf_counter_wrapper _pfc_check_and_set_qps;
     ::dsn::perf_counter_wrapper _pfc_check_and_mutate_qps;
@@ -207,6 +213,7 @@ private:
     ::dsn::perf_counter_wrapper _pfc_multi_put_latency;
     ::dsn::perf_counter_wrapper _pfc_remove_latency;
     ::dsn::perf_counter_wrapper _pfc_multi_remove_latency;
+    ::dsn::perf_counter_wrapper _pfc_batch_write_latency;
     ::dsn::perf_counter_wrapper _pfc_incr_latency;
     ::dsn::perf_counter_wrapper _pfc_check_and_set_latency;
     ::dsn::perf_counter_wrapper _pfc_check_and_mutate_latency;
@@ -40,6 +40,7 @@ static constexpr int FAIL_DB_WRITE_BATCH_PUT = -101;
 static constexpr int FAIL_DB_WRITE_BATCH_DELETE = -102;
 static constexpr int FAIL_DB_WRITE = -103;
 static constexpr int FAIL_DB_GET = -104;
+static constexpr int FAIL_DB_WRITE_BATCH_MERGE = -105;
 
 struct db_get_context
 {
@@ -89,6 +90,8 @@ public:
         : replica_base(server),
           _primary_address(server->_primary_address),
           _pegasus_data_version(server->_pegasus_data_version),
+          _incr_merge_enabled(server->_incr_merge_enabled),
+          _partition_version(server->_partition_version),
           _pfc_recent_expire_count(server->_pfc_recent_expire_count)
     {
         _rocksdb_wrapper = dsn::make_unique<rocksdb_wrapper>(server);
@@ -176,6 +179,61 @@ public:
         return resp.error;
     }
 
+    int batch_write(const db_write_context &ctx,
+                    const dsn::apps::batch_write_request &update,
+                    dsn::apps::update_response &resp)
+    {
+        int64_t decree = ctx.decree;
+        resp.app_id = get_gpid().get_app_id();
+        resp.partition_index = get_gpid().get_partition_index();
+        resp.decree = decree;
+        resp.server = _primary_address;
+
+        if (update.operations.empty()) {
+            derror_replica("invalid argument for batch_write: decree = {}, error = {}",
+                           decree,
+                           "request.operations is empty");
+            resp.error = rocksdb::Status::kInvalidArgument;
+            // we should write empty record to update rocksdb's last flushed decree
+            return empty_put(decree);
+        }
+
+        // the operations are grouped by partition on the client side, reject the whole batch if
+        // some key doesn't belong to this partition (e.g. the partition count is changed by
+        // partition split), so that the client can retry them one by one.
+        int32_t partition_version = _partition_version.load();
+        for (const auto &op : update.operations) {
+            if (op.key.size() < 2 ||
+                (op.operation != dsn::apps::mutate_operation::MO_PUT &&
+                 op.operation != dsn::apps::mutate_operation::MO_DELETE) ||
+                (partition_version >= 0 &&
+                 !check_pegasus_key_hash(
+                     op.key, get_gpid().get_partition_index(), partition_version))) {
+                derror_replica("invalid argument for batch_write: decree = {}, error = {}",
+                               decree,
+                               "invalid operation or the key doesn't belong to this partition");
+                resp.error = rocksdb::Status::kInvalidArgument;
+                return empty_put(decree);
+            }
+        }
+
+        auto cleanup = dsn::defer([this]() { _rocksdb_wrapper->clear_up_write_batch(); });
+        for (const auto &op : update.operations) {
+            if (op.operation == dsn::apps::mutate_operation::MO_PUT) {
+                resp.error = _rocksdb_wrapper->write_batch_put_ctx(
+                    ctx, op.key, op.value, static_cast<uint32_t>(op.expire_ts_seconds));
+            } else {
+                resp.error = _rocksdb_wrapper->write_batch_delete(decree, op.key);
+            }
+            if (resp.error) {
+                return resp.error;
+            }
+        }
+
+        resp.error = _rocksdb_wrapper->write(decree);
+        return resp.error;
+    }
+
     int incr(int64_t decree, const dsn::apps::incr_request &update, dsn::apps::incr_response &resp)
     {
         resp.app_id = get_gpid().get_app_id();
@@ -184,6 +242,19 @@ public:
         resp.server = _primary_address;
 
         dsn::string_view raw_key(update.key.data(), update.key.length());
+        if (_incr_merge_enabled.load()) {
+            // the old value is not read, but merged with the increment by IncrMergeOperator
+            // later, so the new value is unknown and not returned by 'new_value'.
+            auto cleanup = dsn::defer([this]() { _rocksdb_wrapper->clear_up_write_batch(); });
+            resp.error = _rocksdb_wrapper->write_batch_merge(
+                decree, raw_key, update.increment, update.expire_ts_seconds);
+            if (resp.error) {
+                return resp.error;
+            }
+            resp.error = _rocksdb_wrapper->write(decree);
+            return resp.error;
+        }
+
         int64_t new_value = 0;
         uint32_t new_expire_ts = 0;
         db_get_context get_ctx;
@@ -674,6 +745,8 @@ private:
 
     const std::string _primary_address;
     const uint32_t _pegasus_data_version;
+    const std::atomic_bool &_incr_merge_enabled;
+    const std::atomic<int32_t> &_partition_version;
 
     ::dsn::perf_counter_wrapper &_pfc_recent_expire_count;
 
@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <string.h>
+
+#include <dsn/utility/blob.h>
+#include <dsn/utility/string_view.h>
+#include <dsn/utility/utils.h>
+
+namespace pegasus {
+namespace server {
+
+// A bump allocator used to build the key/value blobs of one read response (scan_response,
+// multi_get_response, ...).
+//
+// The memory is allocated by chunks, all blobs carved from a chunk share the ownership of it,
+// so the chunks are released only after the response holding these blobs is serialized and
+// destroyed. The arena itself can be destroyed at any time.
+//
+// Not thread-safe.
+class response_arena
+{
+public:
+    static const size_t kDefaultChunkSize = 16 * 1024;
+
+    explicit response_arena(size_t chunk_size = kDefaultChunkSize) : _chunk_size(chunk_size) {}
+
+    // copy `data` into the arena, and return the blob referencing the copied data.
+    dsn::blob copy(dsn::string_view data)
+    {
+        if (data.length() == 0) {
+            return dsn::blob();
+        }
+
+        if (data.length() > _chunk_size / 2) {
+            // large data is allocated separately, to avoid wasting the rest of current chunk.
+            std::shared_ptr<char> buf(::dsn::utils::make_shared_array<char>(data.length()));
+            ::memcpy(buf.get(), data.data(), data.length());
+            _allocation_count++;
+            return dsn::blob(std::move(buf), 0, data.length());
+        }
+
+        if (_current_chunk == nullptr || _chunk_used + data.length() > _chunk_size) {
+            _current_chunk = ::dsn::utils::make_shared_array<char>(_chunk_size);
+            _chunk_used = 0;
+            _allocation_count++;
+        }
+
+        ::memcpy(_current_chunk.get() + _chunk_used, data.data(), data.length());
+        dsn::blob result(_current_chunk, _chunk_used, data.length());
+        _chunk_used += data.length();
+        return result;
+    }
+
+    // the count of heap allocations made by this arena.
+    uint64_t allocation_count() const { return _allocation_count; }
+
+private:
+    const size_t _chunk_size;
+    std::shared_ptr<char> _current_chunk;
+    size_t _chunk_used{0};
+    uint64_t _allocation_count{0};
+};
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,147 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rocksdb_event_timeline.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include <dsn/utility/flags.h>
+#include <dsn/utility/string_conv.h>
+#include <dsn/utils/time_utils.h>
+
+namespace pegasus {
+namespace server {
+
+DSN_DEFINE_uint32("pegasus.server",
+                  rocksdb_event_timeline_capacity,
+                  1000,
+                  "max count of the recent rocksdb flush, compaction and write stall events kept "
+                  "on one server, 0 means not to record the events");
+
+std::string rocksdb_event::to_string() const
+{
+    char time_str[24];
+    dsn::utils::time_ms_to_string(time_ms, time_str);
+    std::ostringstream oss;
+    oss << "[" << time_str << "] " << pid.get_app_id() << "." << pid.get_partition_index() << " "
+        << cf_name << " ";
+    if (event_type == type::STALL) {
+        oss << "stall: " << prev_condition << " -> " << cur_condition;
+        if (stall_duration_ms > 0) {
+            oss << ", lasted " << stall_duration_ms << " ms";
+        }
+        return oss.str();
+    }
+
+    oss << (event_type == type::FLUSH ? "flush" : "compaction") << ": job_id = " << job_id
+        << ", reason = " << reason << ", level = L" << input_level << " -> L" << output_level
+        << ", input = " << input_files << " files " << input_bytes << " bytes"
+        << ", output = " << output_files << " files " << output_bytes << " bytes"
+        << ", duration = " << duration_ms << " ms";
+    if (event_type == type::COMPACTION) {
+        oss << std::fixed << std::setprecision(2)
+            << ", write_amplification = " << write_amplification
+            << ", read_amplification = " << read_amplification;
+    }
+    return oss.str();
+}
+
+/*static*/ rocksdb_event_timeline &rocksdb_event_timeline::instance()
+{
+    static rocksdb_event_timeline timeline(FLAGS_rocksdb_event_timeline_capacity);
+    return timeline;
+}
+
+rocksdb_event_timeline::rocksdb_event_timeline(size_t capacity) : _capacity(capacity) {}
+
+void rocksdb_event_timeline::add(rocksdb_event event)
+{
+    if (_capacity == 0) {
+        return;
+    }
+
+    ::dsn::zauto_lock l(_lock);
+    if (_events.size() >= _capacity) {
+        _events.pop_front();
+    }
+    _events.emplace_back(std::move(event));
+}
+
+std::vector<rocksdb_event>
+rocksdb_event_timeline::query(size_t count, int32_t app_id, int32_t partition_index) const
+{
+    std::vector<rocksdb_event> events;
+    ::dsn::zauto_lock l(_lock);
+    for (auto it = _events.rbegin(); it != _events.rend() && events.size() < count; ++it) {
+        if (app_id != 0 && it->pid.get_app_id() != app_id) {
+            continue;
+        }
+        if (partition_index >= 0 && it->pid.get_partition_index() != partition_index) {
+            continue;
+        }
+        events.push_back(*it);
+    }
+    std::reverse(events.begin(), events.end());
+    return events;
+}
+
+std::string rocksdb_event_timeline::query_command(const std::vector<std::string> &args) const
+{
+    static const std::string usage = "usage: rocksdb-events [app_id[.partition_index]] [count]";
+    if (args.size() > 2) {
+        return usage;
+    }
+
+    int32_t app_id = 0;
+    int32_t partition_index = -1;
+    if (!args.empty()) {
+        std::string app_str = args[0];
+        std::string::size_type pos = app_str.find('.');
+        if (pos != std::string::npos) {
+            if (!dsn::buf2int32(app_str.substr(pos + 1), partition_index) ||
+                partition_index < 0) {
+                return usage;
+            }
+            app_str = app_str.substr(0, pos);
+        }
+        // app_id 0 means all the apps
+        if (!dsn::buf2int32(app_str, app_id) || app_id < 0 ||
+            (app_id == 0 && partition_index >= 0)) {
+            return usage;
+        }
+    }
+
+    int32_t count = 100;
+    if (args.size() == 2 && (!dsn::buf2int32(args[1], count) || count <= 0)) {
+        return usage;
+    }
+
+    std::vector<rocksdb_event> events = query(count, app_id, partition_index);
+    std::ostringstream oss;
+    oss << events.size() << " events";
+    for (const auto &event : events) {
+        oss << std::endl << event.to_string();
+    }
+    return oss.str();
+}
+
+} // namespace server
+} // namespace pegasus
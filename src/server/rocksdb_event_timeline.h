@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <dsn/tool-api/gpid.h>
+#include <dsn/tool-api/zlocks.h>
+
+namespace pegasus {
+namespace server {
+
+struct rocksdb_event
+{
+    enum class type
+    {
+        FLUSH,
+        COMPACTION,
+        STALL,
+    };
+
+    type event_type;
+    dsn::gpid pid;
+    // the time when the job is completed or the stall condition is changed
+    uint64_t time_ms = 0;
+    std::string cf_name;
+
+    // flush and compaction
+    int job_id = 0;
+    std::string reason;
+    // the level of a flush is always 0
+    int input_level = 0;
+    int output_level = 0;
+    uint64_t input_files = 0;
+    uint64_t output_files = 0;
+    uint64_t input_bytes = 0;
+    uint64_t output_bytes = 0;
+    uint64_t duration_ms = 0;
+    // the bytes written into the output level per byte coming from the input level
+    double write_amplification = 0;
+    // the bytes read per byte written
+    double read_amplification = 0;
+
+    // stall, "normal", "delayed" or "stopped"
+    std::string prev_condition;
+    std::string cur_condition;
+    // for a stall which is changed back to normal, the time it lasted
+    uint64_t stall_duration_ms = 0;
+
+    std::string to_string() const;
+};
+
+// A bounded ring buffer of the recent flush, compaction and write stall events of the rocksdb
+// instances on one server, so that the latency spikes can be correlated with the background jobs
+// without parsing the LOG of rocksdb. The oldest event is dropped when the buffer is full.
+class rocksdb_event_timeline
+{
+public:
+    // the timeline shared by all the replicas on this server
+    static rocksdb_event_timeline &instance();
+
+    explicit rocksdb_event_timeline(size_t capacity);
+
+    void add(rocksdb_event event);
+
+    // return at most `count` latest events in time order, of all the replicas if `app_id` is 0,
+    // or of the app if `partition_index` is negative, or of the replica.
+    std::vector<rocksdb_event>
+    query(size_t count, int32_t app_id = 0, int32_t partition_index = -1) const;
+
+    // the handler of remote command "rocksdb-events [app_id[.partition_index]] [count]", where
+    // app_id 0 means all the apps.
+    std::string query_command(const std::vector<std::string> &args) const;
+
+private:
+    const size_t _capacity;
+
+    mutable ::dsn::zlock _lock;
+    std::deque<rocksdb_event> _events; // protected by _lock
+};
+
+} // namespace server
+} // namespace pegasus
@@ -23,6 +23,9 @@
 #include <rocksdb/db.h>
 #include "pegasus_write_service_impl.h"
 #include "base/pegasus_value_schema.h"
+#include "incr_merge_operator.h"
+#include "hotkey_read_cache.h"
+#include "sortkey_count_index.h"
 
 namespace pegasus {
 namespace server {
@@ -32,9 +35,12 @@ rocksdb_wrapper::rocksdb_wrapper(pegasus_server_impl *server)
       _db(server->_db),
       _rd_opts(server->_data_cf_rd_opts),
       _meta_cf(server->_meta_cf),
+      _key_cf(server->_key_cf),
       _pegasus_data_version(server->_pegasus_data_version),
       _pfc_recent_expire_count(server->_pfc_recent_expire_count),
-      _default_ttl(0)
+      _default_ttl(0),
+      _read_cache(server->_hotkey_read_cache.get()),
+      _sortkey_count_index(server->_sortkey_count_index.get())
 {
     _write_batch = dsn::make_unique<rocksdb::WriteBatch>();
     _value_generator = dsn::make_unique<pegasus_value_generator>();
@@ -90,6 +96,8 @@ int rocksdb_wrapper::write_batch_put_ctx(const db_write_context &ctx,
     FAIL_POINT_INJECT_F("db_write_batch_put",
                         [](dsn::string_view) -> int { return FAIL_DB_WRITE_BATCH_PUT; });
 
+    record_written_key(raw_key);
+
     uint64_t new_timetag = ctx.remote_timetag;
     if (!ctx.is_duplicated_write()) { // local write
         new_timetag = generate_timetag(ctx.timestamp, get_cluster_id_if_exists(), false);
@@ -119,9 +127,15 @@ int rocksdb_wrapper::write_batch_put_ctx(const db_write_context &ctx,
 
     rocksdb::Slice skey = utils::to_rocksdb_slice(raw_key);
     rocksdb::SliceParts skey_parts(&skey, 1);
-    rocksdb::SliceParts svalue = _value_generator->generate_value(
-        _pegasus_data_version, value, db_expire_ts(expire_sec), new_timetag);
+    uint32_t expire_ts = db_expire_ts(expire_sec);
+    rocksdb::SliceParts svalue =
+        _value_generator->generate_value(_pegasus_data_version, value, expire_ts, new_timetag);
     rocksdb::Status s = _write_batch->Put(skey_parts, svalue);
+    if (s.ok() && _key_cf != nullptr && !raw_key.empty()) {
+        // the key column family only keeps the expire_ts, in the format of data version 0.
+        svalue = _value_generator->generate_value(0, dsn::string_view(), expire_ts, 0);
+        s = _write_batch->Put(_key_cf, skey_parts, svalue);
+    }
     if (dsn_unlikely(!s.ok())) {
         ::dsn::blob hash_key, sort_key;
         pegasus_restore_key(::dsn::blob(raw_key.data(), 0, raw_key.size()), hash_key, sort_key);
@@ -136,6 +150,39 @@ int rocksdb_wrapper::write_batch_put_ctx(const db_write_context &ctx,
     return s.code();
 }
 
+int rocksdb_wrapper::write_batch_merge(int64_t decree,
+                                       dsn::string_view raw_key,
+                                       int64_t increment,
+                                       int32_t expire_ts_seconds)
+{
+    FAIL_POINT_INJECT_F("db_write_batch_merge",
+                        [](dsn::string_view) -> int { return FAIL_DB_WRITE_BATCH_MERGE; });
+
+    record_written_key(raw_key);
+
+    incr_operand op;
+    op.data_version = _pegasus_data_version;
+    op.increment = increment;
+    op.expire_ts_seconds = expire_ts_seconds;
+    op.default_expire_ts = db_expire_ts(0);
+    op.write_ts = utils::epoch_now();
+    op.timetag = generate_timetag(0, get_cluster_id_if_exists(), false);
+
+    rocksdb::Status s = _write_batch->Merge(utils::to_rocksdb_slice(raw_key), op.encode());
+    if (dsn_unlikely(!s.ok())) {
+        dsn::blob hash_key, sort_key;
+        pegasus_restore_key(dsn::blob(raw_key.data(), 0, raw_key.size()), hash_key, sort_key);
+        derror_rocksdb("WriteBatchMerge",
+                       s.ToString(),
+                       "decree: {}, hash_key: {}, sort_key: {}, increment: {}",
+                       decree,
+                       utils::c_escape_string(hash_key),
+                       utils::c_escape_string(sort_key),
+                       increment);
+    }
+    return s.code();
+}
+
 int rocksdb_wrapper::write(int64_t decree)
 {
     dassert(_write_batch->Count() != 0, "the number of updates in the batch is 0");
@@ -156,6 +203,15 @@ int rocksdb_wrapper::write(int64_t decree)
     if (dsn_unlikely(!status.ok())) {
         derror_rocksdb("Write", status.ToString(), "write rocksdb error, decree: {}", decree);
     }
+    // the cached rows and counts are invalidated after the new values are visible in rocksdb,
+    // see hotkey_read_cache for the details.
+    if (_read_cache->enabled()) {
+        _read_cache->invalidate(_written_key_hashes);
+    }
+    if (_sortkey_count_index->enabled()) {
+        _sortkey_count_index->invalidate(_written_key_hashes);
+    }
+    _written_key_hashes.clear();
     return status.code();
 }
 
@@ -164,7 +220,12 @@ int rocksdb_wrapper::write_batch_delete(int64_t decree, dsn::string_view raw_key
     FAIL_POINT_INJECT_F("db_write_batch_delete",
                         [](dsn::string_view) -> int { return FAIL_DB_WRITE_BATCH_DELETE; });
 
+    record_written_key(raw_key);
+
     rocksdb::Status s = _write_batch->Delete(utils::to_rocksdb_slice(raw_key));
+    if (s.ok() && _key_cf != nullptr) {
+        s = _write_batch->Delete(_key_cf, utils::to_rocksdb_slice(raw_key));
+    }
     if (dsn_unlikely(!s.ok())) {
         dsn::blob hash_key, sort_key;
         pegasus_restore_key(dsn::blob(raw_key.data(), 0, raw_key.size()), hash_key, sort_key);
@@ -178,16 +239,29 @@ int rocksdb_wrapper::write_batch_delete(int64_t decree, dsn::string_view raw_key
     return s.code();
 }
 
-void rocksdb_wrapper::clear_up_write_batch() { _write_batch->Clear(); }
+void rocksdb_wrapper::clear_up_write_batch()
+{
+    _write_batch->Clear();
+    _written_key_hashes.clear();
+}
 
 int rocksdb_wrapper::ingestion_files(int64_t decree, const std::vector<std::string> &sst_file_list)
 {
+    if (_key_cf != nullptr) {
+        // the ingested files only contain the data column family.
+        derror_replica("can't ingest files into a db with the key column family, decree = {}",
+                       decree);
+        return rocksdb::Status::kNotSupported;
+    }
+
     rocksdb::IngestExternalFileOptions ifo;
     rocksdb::Status s = _db->IngestExternalFile(sst_file_list, ifo);
     if (dsn_unlikely(!s.ok())) {
         derror_rocksdb("IngestExternalFile", s.ToString(), "decree = {}", decree);
     } else {
         ddebug_rocksdb("IngestExternalFile", "Ingest files succeed, decree = {}", decree);
+        _read_cache->clear();
+        _sortkey_count_index->clear();
     }
     return s.code();
 }
@@ -200,6 +274,15 @@ void rocksdb_wrapper::set_default_ttl(uint32_t ttl)
     }
 }
 
+void rocksdb_wrapper::record_written_key(dsn::string_view raw_key)
+{
+    // the hashes are always recorded, even if the read cache is disabled now, since it may be
+    // enabled before the batch is written.
+    if (raw_key.size() >= 2) {
+        _written_key_hashes.push_back(pegasus_key_hash(raw_key));
+    }
+}
+
 uint32_t rocksdb_wrapper::db_expire_ts(uint32_t expire_ts)
 {
     // use '_default_ttl' when ttl is not set for this write operation.
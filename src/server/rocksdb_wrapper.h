@@ -41,6 +41,8 @@ namespace server {
 struct db_get_context;
 struct db_write_context;
 class pegasus_server_impl;
+class hotkey_read_cache;
+class sortkey_count_index;
 
 class rocksdb_wrapper : public dsn::replication::replica_base
 {
@@ -61,6 +63,12 @@ public:
                             dsn::string_view raw_key,
                             dsn::string_view value,
                             uint32_t expire_sec);
+    /// Puts the merge operand of an incr into the write batch, which is applied on the old value
+    /// by IncrMergeOperator when the key is read or compacted.
+    int write_batch_merge(int64_t decree,
+                          dsn::string_view raw_key,
+                          int64_t increment,
+                          int32_t expire_ts_seconds);
     int write(int64_t decree);
     int write_batch_delete(int64_t decree, dsn::string_view raw_key);
     void clear_up_write_batch();
@@ -71,17 +79,28 @@ public:
 private:
     uint32_t db_expire_ts(uint32_t expire_ts);
 
+    // record the key written into the batch, whose cached rows and sort key count are
+    // invalidated after the batch is written.
+    void record_written_key(dsn::string_view raw_key);
+
     rocksdb::DB *_db;
     rocksdb::ReadOptions &_rd_opts;
     std::unique_ptr<pegasus_value_generator> _value_generator;
     std::unique_ptr<rocksdb::WriteBatch> _write_batch;
     std::unique_ptr<rocksdb::WriteOptions> _wt_opts;
     rocksdb::ColumnFamilyHandle *_meta_cf;
+    // null if the db has no key column family
+    rocksdb::ColumnFamilyHandle *_key_cf;
 
     const uint32_t _pegasus_data_version;
     dsn::perf_counter_wrapper &_pfc_recent_expire_count;
     volatile uint32_t _default_ttl;
 
+    hotkey_read_cache *_read_cache;
+    sortkey_count_index *_sortkey_count_index;
+    // pegasus_key_hash of the keys in _write_batch
+    std::vector<uint64_t> _written_key_hashes;
+
     friend class rocksdb_wrapper_test;
     friend class pegasus_write_service_test;
     friend class pegasus_server_write_test;
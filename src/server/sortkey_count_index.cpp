@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "sortkey_count_index.h"
+
+#include <algorithm>
+
+#include "base/pegasus_value_schema.h"
+
+namespace pegasus {
+namespace server {
+
+sortkey_count_index::sortkey_count_index(uint32_t capacity) : _capacity(capacity) {}
+
+bool sortkey_count_index::get(dsn::string_view hash_key,
+                              uint64_t key_hash,
+                              uint32_t epoch_now,
+                              /*out*/ int64_t &count,
+                              /*out*/ uint64_t &version)
+{
+    ::dsn::zauto_write_lock l(_lock);
+    auto entries = _entries.find(key_hash);
+    if (entries != _entries.end()) {
+        auto iter = entries->second.find(std::string(hash_key.data(), hash_key.length()));
+        if (iter != entries->second.end()) {
+            if (!check_if_ts_expired(epoch_now, iter->second.min_expire_ts)) {
+                count = iter->second.count;
+                return true;
+            }
+            // some of the counted rows are expired, count them again.
+            entries->second.erase(iter);
+            --_size;
+            if (entries->second.empty()) {
+                _entries.erase(entries);
+            }
+        }
+    }
+
+    ++_scanning[key_hash];
+    _tracked_count.store(_entries.size() + _scanning.size());
+    version = _version;
+    return false;
+}
+
+void sortkey_count_index::fill(dsn::string_view hash_key,
+                               uint64_t key_hash,
+                               int64_t count,
+                               uint32_t min_expire_ts,
+                               uint64_t version)
+{
+    ::dsn::zauto_write_lock l(_lock);
+    finish_scan(key_hash);
+    if (version != _version) {
+        return;
+    }
+    if (_size >= _capacity && !_entries.empty()) {
+        // evict the hash keys of an arbitrary key hash to make room.
+        auto victim = _entries.begin();
+        _size -= victim->second.size();
+        _entries.erase(victim);
+    }
+    auto result = _entries[key_hash].emplace(std::string(hash_key.data(), hash_key.length()),
+                                             entry{count, min_expire_ts});
+    if (result.second) {
+        ++_size;
+    } else {
+        result.first->second = entry{count, min_expire_ts};
+    }
+    _tracked_count.store(_entries.size() + _scanning.size());
+}
+
+void sortkey_count_index::cancel(uint64_t key_hash)
+{
+    ::dsn::zauto_write_lock l(_lock);
+    finish_scan(key_hash);
+    _tracked_count.store(_entries.size() + _scanning.size());
+}
+
+void sortkey_count_index::finish_scan(uint64_t key_hash)
+{
+    auto iter = _scanning.find(key_hash);
+    if (iter != _scanning.end() && --iter->second == 0) {
+        _scanning.erase(iter);
+    }
+}
+
+void sortkey_count_index::invalidate(const std::vector<uint64_t> &key_hashes)
+{
+    if (_tracked_count.load() == 0) {
+        return;
+    }
+
+    auto tracked = [this](uint64_t key_hash) {
+        return _entries.count(key_hash) > 0 || _scanning.count(key_hash) > 0;
+    };
+    {
+        // most of the writes are not on the indexed hash keys, which needn't the write lock.
+        ::dsn::zauto_read_lock l(_lock);
+        if (std::none_of(key_hashes.begin(), key_hashes.end(), tracked)) {
+            return;
+        }
+    }
+
+    ::dsn::zauto_write_lock l(_lock);
+    bool invalidated = false;
+    for (uint64_t key_hash : key_hashes) {
+        if (!tracked(key_hash)) {
+            continue;
+        }
+        invalidated = true;
+        auto entries = _entries.find(key_hash);
+        if (entries != _entries.end()) {
+            _size -= entries->second.size();
+            _entries.erase(entries);
+        }
+    }
+    if (invalidated) {
+        ++_version;
+        _tracked_count.store(_entries.size() + _scanning.size());
+    }
+}
+
+void sortkey_count_index::clear()
+{
+    ::dsn::zauto_write_lock l(_lock);
+    _entries.clear();
+    _size = 0;
+    ++_version;
+    _tracked_count.store(_scanning.size());
+}
+
+size_t sortkey_count_index::size() const
+{
+    ::dsn::zauto_read_lock l(_lock);
+    return _size;
+}
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dsn/tool-api/zlocks.h>
+#include <dsn/utility/string_view.h>
+
+namespace pegasus {
+namespace server {
+
+/// An index of the sort key counts of the large hash keys in a replica, so that sortkey_count
+/// of them needn't scan all the rows again.
+///
+/// A count is filled after a full scan of the hash key, and stays valid until:
+/// - any row of the hash key is written, which is reported by rocksdb_wrapper after the write
+///   batch is applied to rocksdb;
+/// - the earliest expire time of the counted rows is reached.
+///
+/// Like hotkey_read_cache, a scan which misses the index gets a version, and its count is
+/// filled only if the hash key was not written since then. The hash keys being scanned are
+/// tracked, so that the writes on the other hash keys needn't the write lock.
+class sortkey_count_index
+{
+public:
+    // `capacity` is the max number of the indexed hash keys, 0 to disable the index.
+    explicit sortkey_count_index(uint32_t capacity);
+
+    bool enabled() const { return _capacity > 0; }
+
+    // return true and the count of `hash_key` if it's indexed and not expired. Otherwise
+    // `version` is set, and either fill() or cancel() must be called after the scan.
+    bool get(dsn::string_view hash_key,
+             uint64_t key_hash,
+             uint32_t epoch_now,
+             /*out*/ int64_t &count,
+             /*out*/ uint64_t &version);
+    // `min_expire_ts` is the earliest expire time of the counted rows, 0 if none of them has
+    // a TTL.
+    void fill(dsn::string_view hash_key,
+              uint64_t key_hash,
+              int64_t count,
+              uint32_t min_expire_ts,
+              uint64_t version);
+    // the scan is not finished, e.g. it failed or exceeded the limit.
+    void cancel(uint64_t key_hash);
+
+    // drop the counts of the hash keys, which are just written.
+    void invalidate(const std::vector<uint64_t> &key_hashes);
+    // drop all the counts, e.g. after files are ingested.
+    void clear();
+
+    size_t size() const;
+
+private:
+    struct entry
+    {
+        int64_t count;
+        uint32_t min_expire_ts;
+    };
+
+    // should be called with _lock held in write mode.
+    void finish_scan(uint64_t key_hash);
+
+    const uint32_t _capacity;
+    // the number of the indexed and scanning key hashes, invalidate() returns soon if it's 0.
+    std::atomic<size_t> _tracked_count{0};
+
+    mutable ::dsn::zrwlock_nr _lock;
+    // key hash -> hash key -> count, the hash keys of the same key hash are invalidated together.
+    std::unordered_map<uint64_t, std::unordered_map<std::string, entry>> _entries;
+    size_t _size{0};
+    // key hash -> the number of the scans in progress
+    std::unordered_map<uint64_t, uint32_t> _scanning;
+    // increased on every invalidation of the indexed or scanning hash keys.
+    uint64_t _version{1};
+};
+
+} // namespace server
+} // namespace pegasus
@@ -203,6 +203,38 @@ TEST_F(capacity_unit_calculator_test, multi_get)
     _cal->reset();
 }
 
+TEST_F(capacity_unit_calculator_test, batch_get)
+{
+    dsn::message_ptr msg = dsn::message_ex::create_request(RPC_TEST, static_cast<int>(1000), 1, 1);
+    msg->header->context.u.is_backup_request = false;
+
+    std::vector<::dsn::apps::full_data> datas;
+    for (int i = 0; i < 500; i++) {
+        dsn::apps::full_data data;
+        data.hash_key = dsn::blob::create_from_bytes("hash_key_" + std::to_string(i));
+        data.sort_key = dsn::blob::create_from_bytes("sort_key_" + std::to_string(i));
+        data.value = dsn::blob::create_from_bytes("value_" + std::to_string(i));
+        datas.emplace_back(std::move(data));
+    }
+    _cal->add_batch_get_cu(msg, rocksdb::Status::kOk, datas);
+    ASSERT_GT(_cal->read_cu, 1);
+    ASSERT_EQ(_cal->write_cu, 0);
+    _cal->reset();
+
+    datas.clear();
+    _cal->add_batch_get_cu(msg, rocksdb::Status::kOk, datas);
+    ASSERT_EQ(_cal->read_cu, 1);
+    _cal->reset();
+
+    _cal->add_batch_get_cu(msg, rocksdb::Status::kInvalidArgument, datas);
+    ASSERT_EQ(_cal->read_cu, 1);
+    _cal->reset();
+
+    _cal->add_batch_get_cu(msg, rocksdb::Status::kCorruption, datas);
+    ASSERT_EQ(_cal->read_cu, 0);
+    _cal->reset();
+}
+
 TEST_F(capacity_unit_calculator_test, scan)
 {
     dsn::message_ptr msg = dsn::message_ex::create_request(RPC_TEST, static_cast<int>(1000), 1, 1);
@@ -238,6 +270,34 @@ TEST_F(capacity_unit_calculator_test, scan)
     _cal->reset();
 }
 
+TEST_F(capacity_unit_calculator_test, scan_aggregate)
+{
+    dsn::message_ptr msg = dsn::message_ex::create_request(RPC_TEST, static_cast<int>(1000), 1, 1);
+    msg->header->context.u.is_backup_request = false;
+    ::dsn::apps::scan_aggregate_result aggregate;
+
+    _cal->add_scan_aggregate_cu(msg, rocksdb::Status::kOk, aggregate);
+    ASSERT_EQ(_cal->read_cu, 1);
+    _cal->reset();
+
+    // charged by the size of the aggregated rows, although they are not returned
+    aggregate.row_count = 500;
+    aggregate.key_bytes = 5000;
+    aggregate.value_bytes = 5000;
+    _cal->add_scan_aggregate_cu(msg, rocksdb::Status::kIncomplete, aggregate);
+    ASSERT_GT(_cal->read_cu, 1);
+    ASSERT_EQ(_cal->write_cu, 0);
+    _cal->reset();
+
+    _cal->add_scan_aggregate_cu(msg, rocksdb::Status::kNotFound, aggregate);
+    ASSERT_EQ(_cal->read_cu, 1);
+    _cal->reset();
+
+    _cal->add_scan_aggregate_cu(msg, rocksdb::Status::kCorruption, aggregate);
+    ASSERT_EQ(_cal->read_cu, 0);
+    _cal->reset();
+}
+
 TEST_F(capacity_unit_calculator_test, sortkey_count)
 {
     dsn::message_ptr msg = dsn::message_ex::create_request(RPC_TEST, static_cast<int>(1000), 1, 1);
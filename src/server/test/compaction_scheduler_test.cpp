@@ -0,0 +1,175 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "server/compaction_scheduler.h"
+
+#include <dsn/utility/flags.h>
+#include <gtest/gtest.h>
+
+namespace pegasus {
+namespace server {
+
+DSN_DECLARE_uint32(manual_compact_stagger_interval_s);
+DSN_DECLARE_uint32(manual_compact_server_max_running_count);
+DSN_DECLARE_uint32(manual_compact_rate_limit_mb_per_sec);
+DSN_DECLARE_uint32(manual_compact_pause_p99_latency_ms);
+
+class compaction_scheduler_test : public ::testing::Test
+{
+public:
+    compaction_scheduler_test()
+    {
+        _old_stagger_interval_s = FLAGS_manual_compact_stagger_interval_s;
+        _old_max_running_count = FLAGS_manual_compact_server_max_running_count;
+        _old_rate_limit_mb = FLAGS_manual_compact_rate_limit_mb_per_sec;
+        _old_pause_latency_ms = FLAGS_manual_compact_pause_p99_latency_ms;
+        FLAGS_manual_compact_stagger_interval_s = 0;
+        FLAGS_manual_compact_server_max_running_count = 0;
+        FLAGS_manual_compact_rate_limit_mb_per_sec = 0;
+        FLAGS_manual_compact_pause_p99_latency_ms = 0;
+
+        _rate_limiter.reset(rocksdb::NewGenericRateLimiter(500 << 20));
+        _scheduler = dsn::make_unique<compaction_scheduler>(_rate_limiter, 500 << 20);
+    }
+
+    ~compaction_scheduler_test() override
+    {
+        FLAGS_manual_compact_stagger_interval_s = _old_stagger_interval_s;
+        FLAGS_manual_compact_server_max_running_count = _old_max_running_count;
+        FLAGS_manual_compact_rate_limit_mb_per_sec = _old_rate_limit_mb;
+        FLAGS_manual_compact_pause_p99_latency_ms = _old_pause_latency_ms;
+    }
+
+    void enqueue(int partition_index)
+    {
+        ASSERT_TRUE(_scheduler->enqueue(dsn::gpid(1, partition_index),
+                                        [this, partition_index]() {
+                                            _started.push_back(partition_index);
+                                        }));
+    }
+
+    size_t queue_size() const { return _scheduler->_queue.size(); }
+
+protected:
+    std::shared_ptr<rocksdb::RateLimiter> _rate_limiter;
+    std::unique_ptr<compaction_scheduler> _scheduler;
+    std::vector<int> _started;
+
+    uint32_t _old_stagger_interval_s;
+    uint32_t _old_max_running_count;
+    uint32_t _old_rate_limit_mb;
+    uint32_t _old_pause_latency_ms;
+};
+
+TEST_F(compaction_scheduler_test, stagger)
+{
+    FLAGS_manual_compact_stagger_interval_s = 10;
+    for (int i = 0; i < 3; ++i) {
+        enqueue(i);
+    }
+    // a replica is queued only once
+    ASSERT_FALSE(_scheduler->enqueue(dsn::gpid(1, 0), []() {}));
+
+    uint64_t now_ms = 1000000;
+    _scheduler->dispatch(now_ms);
+    ASSERT_EQ(std::vector<int>({0}), _started);
+    // the next one is started after the stagger interval
+    _scheduler->dispatch(now_ms + 5000);
+    ASSERT_EQ(1, _started.size());
+    _scheduler->dispatch(now_ms + 10000);
+    ASSERT_EQ(std::vector<int>({0, 1}), _started);
+
+    // a running replica can't be queued until it's finished
+    ASSERT_FALSE(_scheduler->enqueue(dsn::gpid(1, 0), []() {}));
+    _scheduler->finish(dsn::gpid(1, 0));
+    enqueue(0);
+
+    ASSERT_EQ("queued in scheduler at 1/2, 1 running on this server",
+              _scheduler->query_state(dsn::gpid(1, 2)));
+    ASSERT_EQ("running in scheduler, 1 running on this server",
+              _scheduler->query_state(dsn::gpid(1, 1)));
+    ASSERT_EQ("", _scheduler->query_state(dsn::gpid(1, 3)));
+
+    // the removed replica is never started
+    ASSERT_TRUE(_scheduler->remove(dsn::gpid(1, 2)));
+    ASSERT_FALSE(_scheduler->remove(dsn::gpid(1, 2)));
+    _scheduler->dispatch(now_ms + 20000);
+    ASSERT_EQ(std::vector<int>({0, 1, 0}), _started);
+    ASSERT_EQ(0, queue_size());
+}
+
+TEST_F(compaction_scheduler_test, max_running_count)
+{
+    FLAGS_manual_compact_server_max_running_count = 2;
+    for (int i = 0; i < 3; ++i) {
+        enqueue(i);
+    }
+    _scheduler->dispatch(1000);
+    ASSERT_EQ(std::vector<int>({0, 1}), _started);
+    _scheduler->dispatch(2000);
+    ASSERT_EQ(2, _started.size());
+
+    _scheduler->finish(dsn::gpid(1, 1));
+    _scheduler->dispatch(3000);
+    ASSERT_EQ(std::vector<int>({0, 1, 2}), _started);
+}
+
+TEST_F(compaction_scheduler_test, pause_by_latency)
+{
+    FLAGS_manual_compact_pause_p99_latency_ms = 10;
+    uint64_t latency_ns = 20 * 1000000;
+    _scheduler->register_latency_source(dsn::gpid(1, 0), [&latency_ns]() { return latency_ns; });
+    enqueue(1);
+
+    _scheduler->dispatch(1000);
+    ASSERT_TRUE(_started.empty());
+    ASSERT_EQ("queued in scheduler at 1/1, 0 running on this server, paused by p99 latency 20ms",
+              _scheduler->query_state(dsn::gpid(1, 1)));
+
+    latency_ns = 5 * 1000000;
+    _scheduler->dispatch(2000);
+    ASSERT_EQ(std::vector<int>({1}), _started);
+
+    // the latency of an unregistered replica is not checked
+    latency_ns = 20 * 1000000;
+    _scheduler->unregister_latency_source(dsn::gpid(1, 0));
+    enqueue(2);
+    _scheduler->dispatch(3000);
+    ASSERT_EQ(std::vector<int>({1, 2}), _started);
+}
+
+TEST_F(compaction_scheduler_test, rate_limit)
+{
+    FLAGS_manual_compact_rate_limit_mb_per_sec = 100;
+    enqueue(0);
+    enqueue(1);
+    ASSERT_EQ(500 << 20, _rate_limiter->GetBytesPerSecond());
+
+    _scheduler->dispatch(1000);
+    ASSERT_EQ(100 << 20, _rate_limiter->GetBytesPerSecond());
+
+    // the rate is restored after all the compactions are finished
+    _scheduler->finish(dsn::gpid(1, 0));
+    ASSERT_EQ(100 << 20, _rate_limiter->GetBytesPerSecond());
+    ASSERT_FALSE(_scheduler->remove(dsn::gpid(1, 1)));
+    ASSERT_EQ(500 << 20, _rate_limiter->GetBytesPerSecond());
+}
+
+} // namespace server
+} // namespace pegasus
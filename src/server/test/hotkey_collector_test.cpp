@@ -29,6 +29,7 @@ namespace pegasus {
 namespace server {
 
 DSN_DECLARE_uint32(hotkey_buckets_num);
+DSN_DECLARE_bool(hotkey_detect_by_sketch);
 
 static std::string generate_hash_key_by_random(bool is_hotkey, int probability = 100)
 {
@@ -198,6 +199,85 @@ TEST_F(fine_collector_test, fine_collector)
     ASSERT_LT(now_queue_size(), max_queue_size * 2);
 }
 
+class sketch_collector_test : public pegasus_server_test_base
+{
+public:
+    int top_k = 10;
+    hotkey_sketch_data_collector sketch_collector;
+    sketch_collector_test() : sketch_collector(_server.get(), top_k) {}
+
+    size_t top_keys_size() { return sketch_collector._top_keys.size(); }
+
+    bool empty()
+    {
+        for (const auto &iter : sketch_collector._sketch) {
+            if (iter.load() != 0) {
+                return false;
+            }
+        }
+        return sketch_collector._top_keys.empty();
+    }
+
+    dsn::task_tracker _tracker;
+};
+
+TEST_F(sketch_collector_test, sketch_collector)
+{
+    detect_hotkey_result result;
+
+    for (int i = 0; i < 1000; i++) {
+        dsn::tasking::enqueue(RPC_REPLICATION_WRITE_EMPTY, &_tracker, [&] {
+            dsn::blob hash_key =
+                dsn::blob::create_from_bytes(generate_hash_key_by_random(true, 80));
+            sketch_collector.capture_data(hash_key, 1);
+        });
+    }
+    _tracker.wait_outstanding_tasks();
+    sketch_collector.analyse_data(result);
+    ASSERT_EQ(result.hot_hash_key, "ThisisahotkeyThisisahotkey");
+    ASSERT_EQ(result.top_hash_keys.size(), top_k);
+    ASSERT_EQ(result.top_hash_keys.front().first, "ThisisahotkeyThisisahotkey");
+    // the estimated weight of a key is never less than its real weight
+    ASSERT_GE(result.top_hash_keys.front().second, 700);
+    for (int i = 1; i < result.top_hash_keys.size(); i++) {
+        ASSERT_GE(result.top_hash_keys[i - 1].second, result.top_hash_keys[i].second);
+    }
+
+    sketch_collector.clear();
+    ASSERT_TRUE(empty());
+
+    detect_hotkey_result no_hot_result;
+    for (int i = 0; i < 1000; i++) {
+        dsn::tasking::enqueue(RPC_REPLICATION_WRITE_EMPTY, &_tracker, [&] {
+            dsn::blob hash_key = dsn::blob::create_from_bytes(generate_hash_key_by_random(false));
+            sketch_collector.capture_data(hash_key, 1);
+        });
+    }
+    _tracker.wait_outstanding_tasks();
+    sketch_collector.analyse_data(no_hot_result);
+    ASSERT_TRUE(no_hot_result.hot_hash_key.empty());
+    ASSERT_EQ(no_hot_result.top_hash_keys.size(), top_k);
+
+    // the memory is bounded however many keys are captured
+    for (int i = 0; i < 10000; i++) {
+        sketch_collector.capture_data(
+            dsn::blob::create_from_bytes(generate_hash_key_by_random(false)), 1);
+    }
+    ASSERT_EQ(top_keys_size(), top_k);
+}
+
+TEST_F(sketch_collector_test, weight)
+{
+    detect_hotkey_result result;
+    for (int i = 0; i < 100; i++) {
+        sketch_collector.capture_data(dsn::blob::create_from_bytes(std::to_string(i)), 1);
+    }
+    sketch_collector.capture_data(dsn::blob::create_from_bytes(std::string("heavy")), 10000);
+    sketch_collector.analyse_data(result);
+    ASSERT_EQ(result.hot_hash_key, "heavy");
+    ASSERT_GE(result.top_hash_keys.front().second, 10000);
+}
+
 class hotkey_collector_test : public pegasus_server_test_base
 {
 public:
@@ -338,6 +418,76 @@ TEST_F(hotkey_collector_test, state_transform)
     _tracker.wait_outstanding_tasks();
 }
 
+TEST_F(hotkey_collector_test, sketch_state_transform)
+{
+    FLAGS_hotkey_detect_by_sketch = true;
+    auto cleanup = dsn::defer([]() { FLAGS_hotkey_detect_by_sketch = false; });
+
+    auto collector = get_read_collector();
+    ASSERT_EQ(get_collector_stat(collector), hotkey_collector_state::STOPPED);
+
+    dsn::replication::detect_hotkey_response resp;
+    on_detect_hotkey(generate_control_rpc(dsn::replication::hotkey_type::READ,
+                                          dsn::replication::detect_action::START),
+                     resp);
+    ASSERT_EQ(resp.err, dsn::ERR_OK);
+    ASSERT_EQ(get_collector_stat(collector), hotkey_collector_state::SKETCH_DETECTING);
+
+    on_detect_hotkey(generate_control_rpc(dsn::replication::hotkey_type::READ,
+                                          dsn::replication::detect_action::START),
+                     resp);
+    ASSERT_EQ(resp.err, dsn::ERR_BUSY);
+
+    for (int i = 0; i < 100; i++) {
+        dsn::tasking::enqueue(LPC_WRITE, &_tracker, [&] {
+            _server->on_get(generate_get_rpc(generate_hash_key_by_random(true, 80)));
+        });
+    }
+    _tracker.wait_outstanding_tasks();
+    collector->analyse_data();
+    ASSERT_EQ(get_collector_stat(collector), hotkey_collector_state::FINISHED);
+
+    auto result = get_result(collector);
+    ASSERT_TRUE(result->if_find_result);
+    ASSERT_EQ(result->hot_hash_key, "ThisisahotkeyThisisahotkey");
+
+    on_detect_hotkey(generate_control_rpc(dsn::replication::hotkey_type::READ,
+                                          dsn::replication::detect_action::QUERY),
+                     resp);
+    ASSERT_EQ(resp.err, dsn::ERR_OK);
+    ASSERT_EQ(resp.hotkey_result, "ThisisahotkeyThisisahotkey");
+    ASSERT_NE(resp.err_hint.find("ThisisahotkeyThisisahotkey"), std::string::npos);
+
+    on_detect_hotkey(generate_control_rpc(dsn::replication::hotkey_type::READ,
+                                          dsn::replication::detect_action::STOP),
+                     resp);
+    ASSERT_EQ(resp.err, dsn::ERR_OK);
+    ASSERT_EQ(get_collector_stat(collector), hotkey_collector_state::STOPPED);
+
+    on_detect_hotkey(generate_control_rpc(dsn::replication::hotkey_type::READ,
+                                          dsn::replication::detect_action::START),
+                     resp);
+    ASSERT_EQ(resp.err, dsn::ERR_OK);
+    ASSERT_EQ(get_collector_stat(collector), hotkey_collector_state::SKETCH_DETECTING);
+    ASSERT_TRUE(result->hot_hash_key.empty());
+    ASSERT_TRUE(result->top_hash_keys.empty());
+
+    for (int i = 0; i < 1000; i++) {
+        dsn::tasking::enqueue(LPC_WRITE, &_tracker, [&] {
+            _server->on_get(generate_get_rpc(generate_hash_key_by_random(false)));
+        });
+    }
+    _tracker.wait_outstanding_tasks();
+    collector->analyse_data();
+    ASSERT_EQ(get_collector_stat(collector), hotkey_collector_state::SKETCH_DETECTING);
+
+    on_detect_hotkey(generate_control_rpc(dsn::replication::hotkey_type::READ,
+                                          dsn::replication::detect_action::STOP),
+                     resp);
+    ASSERT_EQ(resp.err, dsn::ERR_OK);
+    ASSERT_EQ(get_collector_stat(collector), hotkey_collector_state::STOPPED);
+}
+
 TEST_F(hotkey_collector_test, data_completeness)
 {
     dsn::replication::detect_hotkey_response resp;
@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "server/hotkey_read_cache.h"
+
+#include <gtest/gtest.h>
+#include "base/pegasus_key_schema.h"
+
+namespace pegasus {
+namespace server {
+
+class hotkey_read_cache_test : public ::testing::Test
+{
+public:
+    // the rows of the capacity test take 7 bytes each, so 4 of them are cached.
+    hotkey_read_cache_test() : _cache(28) {}
+
+    std::string raw_key(const std::string &hash_key, const std::string &sort_key)
+    {
+        dsn::blob key;
+        pegasus_generate_key(key, hash_key, sort_key);
+        return key.to_string();
+    }
+
+    uint64_t key_hash(const std::string &raw_key) { return pegasus_key_hash(raw_key); }
+
+    // return true if `key` is got from the cache, otherwise fill it with `value`.
+    bool get_or_fill(const std::string &key, const std::string &value, std::string &cached)
+    {
+        uint64_t version = 0;
+        if (_cache.get(key, key_hash(key), cached, version)) {
+            return true;
+        }
+        if (version != 0) {
+            _cache.fill(key, key_hash(key), value, version);
+        }
+        return false;
+    }
+
+    hotkey_read_cache _cache;
+};
+
+TEST_F(hotkey_read_cache_test, only_hot_keys_cached)
+{
+    ASSERT_FALSE(_cache.enabled());
+
+    const std::string hot = raw_key("hot", "s");
+    const std::string cold = raw_key("cold", "s");
+    std::string value;
+    uint64_t version = 0;
+    ASSERT_FALSE(_cache.get(hot, key_hash(hot), value, version));
+    ASSERT_EQ(0, version);
+
+    _cache.set_specified_hash_keys({"hot"});
+    ASSERT_TRUE(_cache.enabled());
+    ASSERT_FALSE(get_or_fill(hot, "v1", value));
+    ASSERT_TRUE(get_or_fill(hot, "v2", value));
+    ASSERT_EQ("v1", value);
+
+    ASSERT_FALSE(_cache.get(cold, key_hash(cold), value, version));
+    ASSERT_EQ(0, version);
+    ASSERT_EQ(1, _cache.row_count());
+
+    // the detected hash key is cached along with the specified ones
+    _cache.set_detected_hash_key("cold");
+    ASSERT_FALSE(get_or_fill(cold, "v3", value));
+    ASSERT_TRUE(get_or_fill(cold, "v4", value));
+    ASSERT_EQ("v3", value);
+    ASSERT_EQ(2, _cache.row_count());
+
+    // the rows of the hash keys no longer hot are evicted
+    _cache.set_specified_hash_keys({});
+    ASSERT_EQ(1, _cache.row_count());
+    ASSERT_FALSE(_cache.get(hot, key_hash(hot), value, version));
+    ASSERT_EQ(0, version);
+
+    _cache.set_detected_hash_key("");
+    ASSERT_FALSE(_cache.enabled());
+    ASSERT_EQ(0, _cache.row_count());
+}
+
+TEST_F(hotkey_read_cache_test, invalidate)
+{
+    _cache.set_specified_hash_keys({"hot"});
+    const std::string key1 = raw_key("hot", "s1");
+    const std::string key2 = raw_key("hot", "s2");
+    std::string value;
+    get_or_fill(key1, "v1", value);
+    get_or_fill(key2, "v2", value);
+    ASSERT_EQ(2, _cache.row_count());
+
+    // the writes on the other keys don't invalidate the cache
+    _cache.invalidate({key_hash(raw_key("cold", "s1"))});
+    ASSERT_EQ(2, _cache.row_count());
+
+    // a write invalidates all the rows of its hash key
+    _cache.invalidate({key_hash(key1)});
+    ASSERT_EQ(0, _cache.row_count());
+
+    // a value read before the invalidation can't be filled
+    uint64_t version = 0;
+    ASSERT_FALSE(_cache.get(key1, key_hash(key1), value, version));
+    ASSERT_NE(0, version);
+    _cache.invalidate({key_hash(key1)});
+    _cache.fill(key1, key_hash(key1), "stale", version);
+    ASSERT_EQ(0, _cache.row_count());
+
+    get_or_fill(key1, "v1", value);
+    ASSERT_EQ(1, _cache.row_count());
+    _cache.clear();
+    ASSERT_EQ(0, _cache.row_count());
+    ASSERT_TRUE(_cache.enabled());
+}
+
+TEST_F(hotkey_read_cache_test, capacity)
+{
+    _cache.set_specified_hash_keys({"hot"});
+    std::string value;
+    for (int i = 0; i < 10; i++) {
+        get_or_fill(raw_key("hot", std::to_string(i)), std::to_string(i), value);
+    }
+    ASSERT_EQ(4, _cache.row_count());
+    ASSERT_EQ(28, _cache.size());
+    ASSERT_TRUE(get_or_fill(raw_key("hot", "0"), "", value));
+    ASSERT_FALSE(get_or_fill(raw_key("hot", "9"), "", value));
+
+    // the capacity is counted in bytes, so a large value isn't cached
+    _cache.clear();
+    ASSERT_EQ(0, _cache.size());
+    ASSERT_FALSE(get_or_fill(raw_key("hot", "0"), std::string(100, 'v'), value));
+    ASSERT_FALSE(get_or_fill(raw_key("hot", "0"), "", value));
+    ASSERT_EQ(0, _cache.row_count());
+}
+
+TEST_F(hotkey_read_cache_test, bypassed)
+{
+    _cache.set_specified_hash_keys({"hot"});
+    const std::string key = raw_key("hot", "s");
+    std::string value;
+    get_or_fill(key, "v1", value);
+    ASSERT_EQ(1, _cache.row_count());
+
+    // the cached rows are evicted, and a read before the bypass can't be filled
+    uint64_t version = 0;
+    ASSERT_FALSE(_cache.get(raw_key("hot", "s2"), key_hash(key), value, version));
+    _cache.set_bypassed(true);
+    ASSERT_FALSE(_cache.enabled());
+    ASSERT_EQ(0, _cache.row_count());
+    _cache.fill(raw_key("hot", "s2"), key_hash(key), "v2", version);
+    ASSERT_EQ(0, _cache.row_count());
+
+    // the hot keys are kept while bypassed
+    _cache.set_bypassed(false);
+    ASSERT_TRUE(_cache.enabled());
+    ASSERT_FALSE(get_or_fill(key, "v3", value));
+    ASSERT_TRUE(get_or_fill(key, "v4", value));
+    ASSERT_EQ("v3", value);
+}
+
+} // namespace server
+} // namespace pegasus
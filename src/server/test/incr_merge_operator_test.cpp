@@ -0,0 +1,205 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "server/incr_merge_operator.h"
+
+#include <gtest/gtest.h>
+
+namespace pegasus {
+namespace server {
+
+class incr_merge_operator_test : public ::testing::Test
+{
+public:
+    std::string generate_value(uint32_t version, const std::string &user_data, uint32_t expire_ts)
+    {
+        pegasus_value_generator gen;
+        rocksdb::SliceParts parts = gen.generate_value(version, user_data, expire_ts, 0);
+        std::string value;
+        for (int i = 0; i < parts.num_parts; i++) {
+            value += parts.parts[i].ToString();
+        }
+        return value;
+    }
+
+    incr_operand operand(int64_t increment, int32_t expire_ts_seconds, uint32_t write_ts)
+    {
+        incr_operand op;
+        op.data_version = _version;
+        op.increment = increment;
+        op.expire_ts_seconds = expire_ts_seconds;
+        op.write_ts = write_ts;
+        op.timetag = 1000 + write_ts;
+        return op;
+    }
+
+    // merge `ops` on `existing_value`, and return the merged user data and expire_ts.
+    bool merge(const std::string *existing_value,
+               const std::vector<incr_operand> &ops,
+               std::string &user_data,
+               uint32_t &expire_ts)
+    {
+        std::vector<std::string> encoded;
+        std::vector<rocksdb::Slice> operand_list;
+        for (const auto &op : ops) {
+            encoded.emplace_back(op.encode());
+        }
+        for (const auto &e : encoded) {
+            operand_list.emplace_back(e);
+        }
+        rocksdb::Slice existing;
+        if (existing_value != nullptr) {
+            existing = *existing_value;
+        }
+        rocksdb::MergeOperator::MergeOperationInput merge_in(
+            rocksdb::Slice("key"),
+            existing_value == nullptr ? nullptr : &existing,
+            operand_list,
+            nullptr);
+        std::string new_value;
+        rocksdb::Slice existing_operand(nullptr, 0);
+        rocksdb::MergeOperator::MergeOperationOutput merge_out(new_value, existing_operand);
+        if (!_op.FullMergeV2(merge_in, &merge_out)) {
+            return false;
+        }
+
+        dsn::string_view result = existing_operand.data() != nullptr
+                                      ? utils::to_string_view(existing_operand)
+                                      : dsn::string_view(new_value);
+        user_data = pegasus_extract_user_data_view(_version, result).to_string();
+        expire_ts = pegasus_extract_expire_ts(_version, result);
+        return true;
+    }
+
+    uint32_t _version{1};
+    IncrMergeOperator _op;
+};
+
+TEST_F(incr_merge_operator_test, encode_and_decode)
+{
+    incr_operand op = operand(-100, -1, 12345);
+    op.default_expire_ts = 6789;
+    std::string encoded = op.encode();
+    size_t encoded_size = incr_operand::kEncodedSize;
+    ASSERT_EQ(encoded_size, encoded.size());
+
+    incr_operand decoded;
+    ASSERT_TRUE(decoded.decode(encoded));
+    ASSERT_EQ(op.data_version, decoded.data_version);
+    ASSERT_EQ(op.increment, decoded.increment);
+    ASSERT_EQ(op.expire_ts_seconds, decoded.expire_ts_seconds);
+    ASSERT_EQ(op.default_expire_ts, decoded.default_expire_ts);
+    ASSERT_EQ(op.write_ts, decoded.write_ts);
+    ASSERT_EQ(op.timetag, decoded.timetag);
+
+    ASSERT_FALSE(decoded.decode(encoded.substr(1)));
+    encoded[0] = 1;
+    ASSERT_FALSE(decoded.decode(encoded));
+}
+
+TEST_F(incr_merge_operator_test, full_merge)
+{
+    const uint32_t now = 10000;
+    std::string user_data;
+    uint32_t expire_ts = 0;
+
+    for (uint32_t version : {0, 1}) {
+        _version = version;
+
+        // the absent value is treated as 0.
+        ASSERT_TRUE(merge(nullptr, {operand(1, 0, now), operand(2, 0, now)}, user_data, expire_ts));
+        ASSERT_EQ("3", user_data);
+        ASSERT_EQ(0u, expire_ts);
+
+        // the empty value is treated as 0.
+        std::string value = generate_value(version, "", 0);
+        ASSERT_TRUE(merge(&value, {operand(-5, 0, now)}, user_data, expire_ts));
+        ASSERT_EQ("-5", user_data);
+
+        // the increment is ignored if the old value is not an integer.
+        value = generate_value(version, "abc", now + 100);
+        ASSERT_TRUE(merge(&value, {operand(1, 0, now)}, user_data, expire_ts));
+        ASSERT_EQ("abc", user_data);
+        ASSERT_EQ(now + 100, expire_ts);
+
+        // the increment is ignored if the new value is out of range.
+        value = generate_value(version, "10", 0);
+        ASSERT_TRUE(merge(&value,
+                          {operand(std::numeric_limits<int64_t>::max(), 0, now), operand(1, 0, now)},
+                          user_data,
+                          expire_ts));
+        ASSERT_EQ("11", user_data);
+
+        // the ttl is kept, cleared or updated according to expire_ts_seconds.
+        value = generate_value(version, "10", now + 100);
+        ASSERT_TRUE(merge(&value, {operand(1, 0, now)}, user_data, expire_ts));
+        ASSERT_EQ("11", user_data);
+        ASSERT_EQ(now + 100, expire_ts);
+        ASSERT_TRUE(merge(&value, {operand(1, now + 200, now)}, user_data, expire_ts));
+        ASSERT_EQ(now + 200, expire_ts);
+        ASSERT_TRUE(merge(&value, {operand(1, -1, now)}, user_data, expire_ts));
+        ASSERT_EQ(0u, expire_ts);
+
+        // the old value is treated as 0 if it's expired when the operand is written.
+        ASSERT_TRUE(merge(&value,
+                          {operand(1, 0, now + 50), operand(1, 0, now + 150), operand(1, 0, now)},
+                          user_data,
+                          expire_ts));
+        ASSERT_EQ("2", user_data);
+        ASSERT_EQ(0u, expire_ts);
+
+        // the default ttl is used if the new value has no ttl.
+        incr_operand op = operand(1, 0, now);
+        op.default_expire_ts = now + 300;
+        ASSERT_TRUE(merge(nullptr, {op}, user_data, expire_ts));
+        ASSERT_EQ(now + 300, expire_ts);
+        value = generate_value(version, "10", now + 100);
+        ASSERT_TRUE(merge(&value, {op}, user_data, expire_ts));
+        ASSERT_EQ(now + 100, expire_ts);
+    }
+
+    // the merge fails on an invalid operand.
+    std::string invalid("invalid operand");
+    std::vector<rocksdb::Slice> operand_list = {invalid};
+    std::string new_value;
+    rocksdb::Slice existing_operand(nullptr, 0);
+    rocksdb::MergeOperator::MergeOperationInput merge_in(
+        rocksdb::Slice("key"), nullptr, operand_list, nullptr);
+    rocksdb::MergeOperator::MergeOperationOutput merge_out(new_value, existing_operand);
+    ASSERT_FALSE(_op.FullMergeV2(merge_in, &merge_out));
+}
+
+TEST_F(incr_merge_operator_test, timetag)
+{
+    std::vector<incr_operand> ops = {operand(1, 0, 100), operand(1, 0, 200)};
+    std::vector<std::string> encoded = {ops[0].encode(), ops[1].encode()};
+    std::vector<rocksdb::Slice> operand_list = {encoded[0], encoded[1]};
+    std::string new_value;
+    rocksdb::Slice existing_operand(nullptr, 0);
+    rocksdb::MergeOperator::MergeOperationInput merge_in(
+        rocksdb::Slice("key"), nullptr, operand_list, nullptr);
+    rocksdb::MergeOperator::MergeOperationOutput merge_out(new_value, existing_operand);
+    ASSERT_TRUE(_op.FullMergeV2(merge_in, &merge_out));
+
+    // the timetag of the merged value is that of the last operand.
+    ASSERT_EQ(ops[1].timetag, pegasus_extract_timetag(1, new_value));
+}
+
+} // namespace server
+} // namespace pegasus
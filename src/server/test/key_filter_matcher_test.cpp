@@ -0,0 +1,176 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "server/key_filter_matcher.h"
+
+#include <gtest/gtest.h>
+#include <dsn/utility/rand.h>
+
+namespace pegasus {
+namespace server {
+
+TEST(key_filter_matcher_test, match)
+{
+    struct test_case
+    {
+        ::dsn::apps::filter_type::type type;
+        std::string pattern;
+        std::string value;
+        bool expect;
+    } tests[] = {
+        {::dsn::apps::filter_type::FT_NO_FILTER, "abc", "xyz", true},
+        {::dsn::apps::filter_type::FT_MATCH_ANYWHERE, "", "xyz", true},
+        {::dsn::apps::filter_type::FT_MATCH_ANYWHERE, "abc", "", false},
+        {::dsn::apps::filter_type::FT_MATCH_ANYWHERE, "abc", "ab", false},
+        {::dsn::apps::filter_type::FT_MATCH_ANYWHERE, "abc", "abc", true},
+        {::dsn::apps::filter_type::FT_MATCH_ANYWHERE, "abc", "xxabcxx", true},
+        {::dsn::apps::filter_type::FT_MATCH_ANYWHERE, "abc", "xxabxcxx", false},
+        {::dsn::apps::filter_type::FT_MATCH_PREFIX, "abc", "abcxx", true},
+        {::dsn::apps::filter_type::FT_MATCH_PREFIX, "abc", "xabcx", false},
+        {::dsn::apps::filter_type::FT_MATCH_POSTFIX, "abc", "xxabc", true},
+        {::dsn::apps::filter_type::FT_MATCH_POSTFIX, "abc", "xabcx", false},
+        {::dsn::apps::filter_type::FT_MATCH_POSTFIX, "abc", "ab", false},
+        {::dsn::apps::filter_type::FT_MATCH_REGEX, "", "xyz", true},
+        {::dsn::apps::filter_type::FT_MATCH_REGEX, "a.c", "xxabcxx", true},
+        {::dsn::apps::filter_type::FT_MATCH_REGEX, "^a.c$", "xxabcxx", false},
+        {::dsn::apps::filter_type::FT_MATCH_REGEX, "^user_[0-9]+$", "user_123", true},
+        {::dsn::apps::filter_type::FT_MATCH_REGEX, "^user_[0-9]+$", "user_12a", false},
+        {::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN, "", "xyz", true},
+        {::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN, "abc\nxyz", "xxxyzxx", true},
+        {::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN, "abc\nxyz", "xxabcxx", true},
+        {::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN, "abc\nxyz", "xxabxyxx", false},
+        {::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN, "abc\n", "xxabxyxx", false},
+        {::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN, std::string("a\0c", 3), "abc", false},
+        {::dsn::apps::filter_type::FT_MATCH_MULTI_PATTERN,
+         std::string("a\0c", 3),
+         std::string("xa\0cx", 5),
+         true},
+    };
+
+    for (const auto &test : tests) {
+        key_filter_matcher matcher(test.type, test.pattern);
+        ASSERT_EQ(test.expect, matcher.match(test.value))
+            << "type = " << test.type << ", pattern = " << test.pattern
+            << ", value = " << test.value;
+    }
+
+    ASSERT_TRUE(key_filter_matcher().no_filter());
+    ASSERT_TRUE(key_filter_matcher().match("anything"));
+}
+
+TEST(key_filter_matcher_test, invalid_pattern)
+{
+    ASSERT_TRUE(key_filter_matcher(::dsn::apps::filter_type::FT_MATCH_REGEX, "^a+$").valid());
+    ASSERT_FALSE(key_filter_matcher(::dsn::apps::filter_type::FT_MATCH_REGEX, "a(").valid());
+    ASSERT_FALSE(key_filter_matcher(::dsn::apps::filter_type::FT_MATCH_REGEX, "[a").valid());
+    ASSERT_TRUE(key_filter_matcher(::dsn::apps::filter_type::FT_MATCH_ANYWHERE, "a(").valid());
+
+    // too long regular expression
+    std::string long_pattern(key_filter_matcher::kMaxRegexLength + 1, 'a');
+    ASSERT_FALSE(
+        key_filter_matcher(::dsn::apps::filter_type::FT_MATCH_REGEX, long_pattern).valid());
+    long_pattern.pop_back();
+    ASSERT_TRUE(key_filter_matcher(::dsn::apps::filter_type::FT_MATCH_REGEX, long_pattern).valid());
+}
+
+// a catastrophic backtracking pattern must not throw out of match().
+TEST(key_filter_matcher_test, catastrophic_regex)
+{
+    key_filter_matcher matcher(::dsn::apps::filter_type::FT_MATCH_REGEX, "(a+)+$");
+    ASSERT_TRUE(matcher.valid());
+    ASSERT_TRUE(matcher.match("aaaa"));
+
+    std::string value(10000, 'a');
+    value.push_back('b');
+    ASSERT_FALSE(matcher.match(value));
+}
+
+// the automaton must give the same results as searching the patterns one by one.
+TEST(key_filter_matcher_test, aho_corasick)
+{
+    auto random_string = [](size_t len) {
+        // a small alphabet makes partial matches and overlapped patterns frequent
+        std::string s(len, 'a');
+        for (auto &c : s) {
+            c = static_cast<char>('a' + dsn::rand::next_u32(0, 2));
+        }
+        return s;
+    };
+
+    for (int round = 0; round < 1000; ++round) {
+        std::vector<std::string> patterns;
+        int pattern_count = dsn::rand::next_u32(1, 10);
+        for (int i = 0; i < pattern_count; ++i) {
+            patterns.emplace_back(random_string(dsn::rand::next_u32(1, 6)));
+        }
+        aho_corasick_matcher matcher(patterns);
+
+        for (int i = 0; i < 10; ++i) {
+            std::string text = random_string(dsn::rand::next_u32(0, 30));
+            bool expect = false;
+            for (const auto &pattern : patterns) {
+                expect = expect || text.find(pattern) != std::string::npos;
+            }
+            ASSERT_EQ(expect, matcher.match(text)) << "text = " << text;
+        }
+    }
+}
+
+// the vectorized implementations must give the same results as the scalar one, for the
+// patterns located at any position of the blocks, including the unaligned tails.
+TEST(key_filter_matcher_test, match_anywhere_impls)
+{
+    std::vector<key_filter_impl::match_anywhere_func> impls = {
+        key_filter_impl::match_anywhere_scalar, key_filter_impl::best_match_anywhere()};
+#if defined(__x86_64__)
+    impls.push_back(key_filter_impl::match_anywhere_sse2);
+    if (__builtin_cpu_supports("avx2")) {
+        impls.push_back(key_filter_impl::match_anywhere_avx2);
+    }
+#endif
+
+    for (int round = 0; round < 10000; ++round) {
+        // a small alphabet makes partial matches frequent
+        std::string value(dsn::rand::next_u32(1, 100), 'a');
+        for (auto &c : value) {
+            c = static_cast<char>('a' + dsn::rand::next_u32(0, 2));
+        }
+        std::string pattern;
+        if (dsn::rand::next_u32(0, 1) == 0) {
+            size_t pos = dsn::rand::next_u32(0, value.length() - 1);
+            pattern = value.substr(pos, dsn::rand::next_u32(1, value.length() - pos));
+        } else {
+            pattern.assign(dsn::rand::next_u32(1, 8), 'a');
+            for (auto &c : pattern) {
+                c = static_cast<char>('a' + dsn::rand::next_u32(0, 2));
+            }
+        }
+        if (pattern.length() > value.length()) {
+            continue;
+        }
+
+        bool expect = value.find(pattern) != std::string::npos;
+        for (auto impl : impls) {
+            ASSERT_EQ(expect, impl(value, pattern)) << "value = " << value
+                                                    << ", pattern = " << pattern;
+        }
+    }
+}
+
+} // namespace server
+} // namespace pegasus
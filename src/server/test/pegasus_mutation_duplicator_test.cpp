@@ -297,6 +297,43 @@ TEST_F(pegasus_mutation_duplicator_test, read_after_get_hash_key)
     ASSERT_EQ(rpc.request().key.to_string(), raw_key.to_string());
 }
 
+TEST_F(pegasus_mutation_duplicator_test, split_batch_write)
+{
+    dsn::apps::batch_write_request request;
+    for (const std::string hash_key : {"hash_1", "hash_2", "hash_1"}) {
+        dsn::apps::batch_write_operation op;
+        op.operation = request.operations.size() == 2 ? dsn::apps::mutate_operation::MO_DELETE
+                                                      : dsn::apps::mutate_operation::MO_PUT;
+        pegasus::pegasus_generate_key(op.key, hash_key, std::string("sort"));
+        if (op.operation == dsn::apps::mutate_operation::MO_PUT) {
+            op.value = dsn::blob::create_from_bytes("value_" + hash_key);
+            op.expire_ts_seconds = 100;
+        }
+        request.operations.emplace_back(std::move(op));
+    }
+    dsn::message_ptr msg = dsn::from_thrift_request_to_received_message(
+        request, dsn::apps::RPC_RRDB_RRDB_BATCH_WRITE);
+    auto data = dsn::move_message_to_blob(msg.get());
+
+    // each write is routed by its own key, in the order of the batch
+    auto writes = split_batch_write(data);
+    ASSERT_EQ(3, writes.size());
+    for (size_t i = 0; i < writes.size(); ++i) {
+        ASSERT_EQ(pegasus_key_hash(request.operations[i].key),
+                  get_hash_from_request(writes[i].first, writes[i].second));
+    }
+    ASSERT_EQ(dsn::apps::RPC_RRDB_RRDB_PUT, writes[1].first);
+    dsn::apps::update_request put;
+    dsn::from_blob_to_thrift(writes[1].second, put);
+    ASSERT_EQ(request.operations[1].key.to_string(), put.key.to_string());
+    ASSERT_EQ("value_hash_2", put.value.to_string());
+    ASSERT_EQ(100, put.expire_ts_seconds);
+    ASSERT_EQ(dsn::apps::RPC_RRDB_RRDB_REMOVE, writes[2].first);
+    dsn::blob removed_key;
+    dsn::from_blob_to_thrift(writes[2].second, removed_key);
+    ASSERT_EQ(request.operations[2].key.to_string(), removed_key.to_string());
+}
+
 TEST_F(pegasus_mutation_duplicator_test, duplicate) { test_duplicate(); }
 
 TEST_F(pegasus_mutation_duplicator_test, duplicate_failed) { test_duplicate_failed(); }
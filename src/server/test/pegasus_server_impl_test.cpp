@@ -18,11 +18,20 @@
  */
 
 #include <base/pegasus_key_schema.h>
+#include <base/pegasus_value_schema.h>
+#include <rocksdb/write_batch.h>
 #include "pegasus_server_test_base.h"
+#include "message_utils.h"
+#include "server/hotkey_read_cache.h"
+#include "server/sortkey_count_index.h"
 
 namespace pegasus {
 namespace server {
 
+DSN_DECLARE_uint32(sortkey_count_index_min_count);
+DSN_DECLARE_uint32(sortkey_count_sample_count);
+DSN_DECLARE_bool(rocksdb_incr_merge_operator_enabled);
+
 class pegasus_server_impl_test : public pegasus_server_test_base
 {
 public:
@@ -80,6 +89,481 @@ TEST_F(pegasus_server_impl_test, test_table_level_slow_query)
     test_table_level_slow_query();
 }
 
+TEST_F(pegasus_server_impl_test, batch_get)
+{
+    start();
+    // 2 partitions, the keys of this partition (1) are those whose hash is odd.
+    _server->set_partition_version(1);
+    std::vector<std::string> hash_keys;
+    for (int i = 0; hash_keys.size() < 4; i++) {
+        dsn::blob raw_key;
+        std::string hash_key = "hash_key_" + std::to_string(i);
+        pegasus_generate_key(raw_key, hash_key, std::string("sort_key"));
+        if ((pegasus_key_hash(raw_key) & 1) == (hash_keys.size() < 3 ? 1 : 0)) {
+            hash_keys.emplace_back(std::move(hash_key));
+        }
+    }
+
+    // put "hash_keys[i] : sort_key => value_i" directly into rocksdb
+    pegasus_value_generator value_generator;
+    for (int i = 0; i < 2; i++) {
+        dsn::blob raw_key;
+        pegasus_generate_key(raw_key, hash_keys[i], std::string("sort_key"));
+        rocksdb::Slice raw_key_slice(raw_key.data(), raw_key.length());
+        std::string value = "value_" + std::to_string(i);
+        rocksdb::WriteBatch batch;
+        batch.Put(_server->_data_cf,
+                  rocksdb::SliceParts(&raw_key_slice, 1),
+                  value_generator.generate_value(_server->_pegasus_data_version, value, 0, 0));
+        ASSERT_TRUE(_server->_db->Write(rocksdb::WriteOptions(), &batch).ok());
+    }
+
+    ::dsn::apps::batch_get_request request;
+    for (int i = 0; i < 3; i++) {
+        ::dsn::apps::full_key key;
+        key.hash_key = dsn::blob::create_from_bytes(std::string(hash_keys[i]));
+        key.sort_key = dsn::blob::create_from_bytes("sort_key");
+        request.keys.emplace_back(std::move(key));
+    }
+    batch_get_rpc rpc(dsn::make_unique<::dsn::apps::batch_get_request>(request),
+                      dsn::apps::RPC_RRDB_RRDB_BATCH_GET);
+    _server->on_batch_get(rpc);
+
+    // the last key is not found
+    const auto &resp = rpc.response();
+    ASSERT_EQ(rocksdb::Status::kOk, resp.error);
+    ASSERT_EQ(2, resp.data.size());
+    for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(hash_keys[i], resp.data[i].hash_key.to_string());
+        ASSERT_EQ("sort_key", resp.data[i].sort_key.to_string());
+        ASSERT_EQ("value_" + std::to_string(i), resp.data[i].value.to_string());
+    }
+
+    // the key of the other partition is rejected, even if the partition hash is not validated
+    _server->_validate_partition_hash = false;
+    request.keys[2].hash_key = dsn::blob::create_from_bytes(std::string(hash_keys[3]));
+    batch_get_rpc misrouted_rpc(dsn::make_unique<::dsn::apps::batch_get_request>(request),
+                                dsn::apps::RPC_RRDB_RRDB_BATCH_GET);
+    _server->on_batch_get(misrouted_rpc);
+    ASSERT_EQ(rocksdb::Status::kInvalidArgument, misrouted_rpc.response().error);
+    ASSERT_TRUE(misrouted_rpc.response().data.empty());
+
+    // empty keys
+    batch_get_rpc empty_rpc(dsn::make_unique<::dsn::apps::batch_get_request>(),
+                            dsn::apps::RPC_RRDB_RRDB_BATCH_GET);
+    _server->on_batch_get(empty_rpc);
+    ASSERT_EQ(rocksdb::Status::kInvalidArgument, empty_rpc.response().error);
+}
+
+TEST_F(pegasus_server_impl_test, batch_get_exceed_limit)
+{
+    start();
+    // 2 partitions, the keys of this partition (1) are those whose hash is odd.
+    _server->set_partition_version(1);
+    pegasus_value_generator value_generator;
+    ::dsn::apps::batch_get_request request;
+    std::vector<std::string> hash_keys;
+    for (int i = 0; hash_keys.size() < 10; i++) {
+        std::string hash_key = "hash_key_" + std::to_string(i);
+        dsn::blob raw_key;
+        pegasus_generate_key(raw_key, hash_key, std::string("sort_key"));
+        if ((pegasus_key_hash(raw_key) & 1) == 0) {
+            continue;
+        }
+        hash_keys.emplace_back(hash_key);
+        rocksdb::Slice raw_key_slice(raw_key.data(), raw_key.length());
+        rocksdb::WriteBatch batch;
+        batch.Put(_server->_data_cf,
+                  rocksdb::SliceParts(&raw_key_slice, 1),
+                  value_generator.generate_value(_server->_pegasus_data_version, "value", 0, 0));
+        ASSERT_TRUE(_server->_db->Write(rocksdb::WriteOptions(), &batch).ok());
+
+        ::dsn::apps::full_key key;
+        key.hash_key = dsn::blob::create_from_bytes(std::move(hash_key));
+        key.sort_key = dsn::blob::create_from_bytes("sort_key");
+        request.keys.emplace_back(std::move(key));
+    }
+
+    // the keys are read batch by batch, and the iteration count is bounded like multi_get.
+    _server->_rng_rd_opts.multi_get_max_iteration_count = 3;
+    batch_get_rpc count_rpc(dsn::make_unique<::dsn::apps::batch_get_request>(request),
+                            dsn::apps::RPC_RRDB_RRDB_BATCH_GET);
+    _server->on_batch_get(count_rpc);
+    ASSERT_EQ(rocksdb::Status::kIncomplete, count_rpc.response().error);
+    ASSERT_EQ(3, count_rpc.response().data.size());
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(hash_keys[i], count_rpc.response().data[i].hash_key.to_string());
+    }
+
+    // and so is the iteration size.
+    _server->_rng_rd_opts.multi_get_max_iteration_count = 1000;
+    _server->_rng_rd_opts.multi_get_max_iteration_size = 1;
+    batch_get_rpc size_rpc(dsn::make_unique<::dsn::apps::batch_get_request>(request),
+                           dsn::apps::RPC_RRDB_RRDB_BATCH_GET);
+    _server->on_batch_get(size_rpc);
+    ASSERT_EQ(rocksdb::Status::kIncomplete, size_rpc.response().error);
+    ASSERT_EQ(1, size_rpc.response().data.size());
+
+    _server->_rng_rd_opts.multi_get_max_iteration_size = 0;
+    batch_get_rpc rpc(dsn::make_unique<::dsn::apps::batch_get_request>(request),
+                      dsn::apps::RPC_RRDB_RRDB_BATCH_GET);
+    _server->on_batch_get(rpc);
+    ASSERT_EQ(rocksdb::Status::kOk, rpc.response().error);
+    ASSERT_EQ(10, rpc.response().data.size());
+}
+
+TEST_F(pegasus_server_impl_test, multi_get_sort_keys_order)
+{
+    start();
+
+    // put the even sort keys directly into rocksdb
+    const int key_count = 100;
+    std::string hash_key = "hash_key";
+    pegasus_value_generator value_generator;
+    for (int i = 0; i < key_count; i += 2) {
+        dsn::blob raw_key;
+        pegasus_generate_key(raw_key, hash_key, "sort_key_" + std::to_string(i));
+        rocksdb::Slice raw_key_slice(raw_key.data(), raw_key.length());
+        rocksdb::WriteBatch batch;
+        batch.Put(_server->_data_cf,
+                  rocksdb::SliceParts(&raw_key_slice, 1),
+                  value_generator.generate_value(
+                      _server->_pegasus_data_version, "value_" + std::to_string(i), 0, 0));
+        ASSERT_TRUE(_server->_db->Write(rocksdb::WriteOptions(), &batch).ok());
+    }
+
+    // the sort keys are requested in the reverse order, which spans several MultiGet batches
+    ::dsn::apps::multi_get_request request;
+    request.__set_hash_key(dsn::blob::create_from_bytes(std::string(hash_key)));
+    std::vector<dsn::blob> sort_keys;
+    for (int i = key_count - 1; i >= 0; --i) {
+        sort_keys.emplace_back(dsn::blob::create_from_bytes("sort_key_" + std::to_string(i)));
+    }
+    request.__set_sort_keys(sort_keys);
+    multi_get_rpc rpc(dsn::make_unique<::dsn::apps::multi_get_request>(request),
+                      dsn::apps::RPC_RRDB_RRDB_MULTI_GET);
+    _server->on_multi_get(rpc);
+
+    // the found kvs are returned in the request order
+    const auto &resp = rpc.response();
+    ASSERT_EQ(rocksdb::Status::kOk, resp.error);
+    ASSERT_EQ(key_count / 2, resp.kvs.size());
+    for (int i = 0; i < key_count / 2; ++i) {
+        int id = key_count - 2 - 2 * i;
+        ASSERT_EQ("sort_key_" + std::to_string(id), resp.kvs[i].key.to_string());
+        ASSERT_EQ("value_" + std::to_string(id), resp.kvs[i].value.to_string());
+    }
+}
+
+TEST_F(pegasus_server_impl_test, multi_get_last_sortkey)
+{
+    start();
+
+    std::string hash_key = "hash_key";
+    for (int i = 0; i < 10; ++i) {
+        dsn::blob raw_key;
+        pegasus_generate_key(raw_key, hash_key, "sort_key_" + std::to_string(i));
+        rocksdb::Slice raw_key_slice(raw_key.data(), raw_key.length());
+        rocksdb::WriteBatch batch;
+        pegasus_value_generator value_generator;
+        batch.Put(_server->_data_cf,
+                  rocksdb::SliceParts(&raw_key_slice, 1),
+                  value_generator.generate_value(_server->_pegasus_data_version, "value", 0, 0));
+        ASSERT_TRUE(_server->_db->Write(rocksdb::WriteOptions(), &batch).ok());
+    }
+    _server->_rng_rd_opts.multi_get_max_iteration_count = 3;
+
+    // all the scanned rows are filtered out, but the read can still be resumed
+    ::dsn::apps::multi_get_request request;
+    request.__set_hash_key(dsn::blob::create_from_bytes(std::string(hash_key)));
+    request.__set_sort_key_filter_type(::dsn::apps::filter_type::FT_MATCH_POSTFIX);
+    request.__set_sort_key_filter_pattern(dsn::blob::create_from_bytes("no_such_postfix"));
+    multi_get_rpc rpc(dsn::make_unique<::dsn::apps::multi_get_request>(request),
+                      dsn::apps::RPC_RRDB_RRDB_MULTI_GET);
+    _server->on_multi_get(rpc);
+    ASSERT_EQ(rocksdb::Status::kIncomplete, rpc.response().error);
+    ASSERT_TRUE(rpc.response().kvs.empty());
+    ASSERT_TRUE(rpc.response().__isset.last_sortkey);
+    ASSERT_EQ("sort_key_2", rpc.response().last_sortkey.to_string());
+
+    // the reverse read stops at the last scanned row too
+    request.__set_reverse(true);
+    multi_get_rpc reverse_rpc(dsn::make_unique<::dsn::apps::multi_get_request>(request),
+                              dsn::apps::RPC_RRDB_RRDB_MULTI_GET);
+    _server->on_multi_get(reverse_rpc);
+    ASSERT_EQ(rocksdb::Status::kIncomplete, reverse_rpc.response().error);
+    ASSERT_TRUE(reverse_rpc.response().__isset.last_sortkey);
+    ASSERT_EQ("sort_key_7", reverse_rpc.response().last_sortkey.to_string());
+}
+
+TEST_F(pegasus_server_impl_test, hotkey_read_cache)
+{
+    start();
+
+    dsn::blob raw_key;
+    pegasus_generate_key(raw_key, std::string("hot_hash_key"), std::string("sort_key"));
+    auto put = [&](const std::string &value, int64_t decree) {
+        dsn::apps::update_request req;
+        req.key = raw_key;
+        req.value = dsn::blob::create_from_bytes(std::string(value));
+        dsn::message_ex *writes[] = {create_put_request(req)};
+        ASSERT_EQ(0, _server->on_batched_write_requests(decree, 0, writes, 1));
+    };
+    auto get = [&](int expect_error, const std::string &expect_value) {
+        get_rpc rpc(dsn::make_unique<dsn::blob>(raw_key), dsn::apps::RPC_RRDB_RRDB_GET);
+        _server->on_get(rpc);
+        ASSERT_EQ(expect_error, rpc.response().error);
+        ASSERT_EQ(expect_value, rpc.response().value.to_string());
+    };
+
+    put("value_1", 1);
+    std::map<std::string, std::string> envs;
+    envs[HOTKEY_READ_CACHE_HASH_KEYS] = "hot_hash_key,another_hot_hash_key";
+    _server->update_app_envs(envs);
+    ASSERT_TRUE(_server->_hotkey_read_cache->enabled());
+
+    // the first get fills the cache, and the second one hits
+    long before_hit_count = _server->_pfc_recent_hotkey_read_cache_hit_count->get_integer_value();
+    long before_miss_count =
+        _server->_pfc_recent_hotkey_read_cache_miss_count->get_integer_value();
+    get(rocksdb::Status::kOk, "value_1");
+    ASSERT_EQ(1, _server->_hotkey_read_cache->row_count());
+    get(rocksdb::Status::kOk, "value_1");
+    ASSERT_EQ(before_hit_count + 1,
+              _server->_pfc_recent_hotkey_read_cache_hit_count->get_integer_value());
+    ASSERT_EQ(before_miss_count + 1,
+              _server->_pfc_recent_hotkey_read_cache_miss_count->get_integer_value());
+
+    // the write invalidates the cached value
+    put("value_2", 2);
+    ASSERT_EQ(0, _server->_hotkey_read_cache->row_count());
+    get(rocksdb::Status::kOk, "value_2");
+    get(rocksdb::Status::kOk, "value_2");
+
+    // the ttl of a cached value is checked the same as read from rocksdb
+    _server->_hotkey_read_cache->clear();
+    pegasus_value_generator value_generator;
+    rocksdb::SliceParts parts = value_generator.generate_value(
+        _server->_pegasus_data_version, "value_3", utils::epoch_now() - 1, 0);
+    std::string expired_value;
+    for (int i = 0; i < parts.num_parts; i++) {
+        expired_value += parts.parts[i].ToString();
+    }
+    const std::string key(raw_key.data(), raw_key.length());
+    const uint64_t key_hash = pegasus_key_hash(key);
+    std::string cached_value;
+    uint64_t version = 0;
+    ASSERT_FALSE(_server->_hotkey_read_cache->get(key, key_hash, cached_value, version));
+    _server->_hotkey_read_cache->fill(key, key_hash, expired_value, version);
+    ASSERT_EQ(1, _server->_hotkey_read_cache->row_count());
+    get(rocksdb::Status::kNotFound, "");
+
+    // the cache is bypassed while the compaction may rewrite the rows
+    envs[TABLE_LEVEL_DEFAULT_TTL] = "3600";
+    _server->update_app_envs(envs);
+    ASSERT_FALSE(_server->_hotkey_read_cache->enabled());
+    ASSERT_EQ(0, _server->_hotkey_read_cache->row_count());
+    get(rocksdb::Status::kOk, "value_2");
+    ASSERT_EQ(0, _server->_hotkey_read_cache->row_count());
+    envs[TABLE_LEVEL_DEFAULT_TTL] = "0";
+    _server->update_app_envs(envs);
+    ASSERT_TRUE(_server->_hotkey_read_cache->enabled());
+
+    envs.erase(HOTKEY_READ_CACHE_HASH_KEYS);
+    _server->update_app_envs(envs);
+    ASSERT_FALSE(_server->_hotkey_read_cache->enabled());
+    get(rocksdb::Status::kOk, "value_2");
+}
+
+TEST_F(pegasus_server_impl_test, sortkey_count)
+{
+    start();
+    uint32_t old_index_min_count = FLAGS_sortkey_count_index_min_count;
+    FLAGS_sortkey_count_index_min_count = 3;
+
+    auto put = [&](const std::string &hash_key, int sort_key_count, int64_t decree) {
+        std::vector<dsn::message_ex *> writes;
+        for (int i = 0; i < sort_key_count; i++) {
+            dsn::apps::update_request req;
+            pegasus_generate_key(req.key, hash_key, "sort_key_" + std::to_string(i));
+            req.value = dsn::blob::create_from_bytes("value_" + std::to_string(i));
+            writes.push_back(create_put_request(req));
+        }
+        ASSERT_EQ(0, _server->on_batched_write_requests(decree, 0, writes.data(), sort_key_count));
+    };
+    auto count = [&](const std::string &hash_key, bool approximate) -> int64_t {
+        dsn::apps::sortkey_count_request req;
+        req.hash_key = dsn::blob::create_from_bytes(std::string(hash_key));
+        req.approximate = approximate;
+        sortkey_count_v2_rpc rpc(dsn::make_unique<dsn::apps::sortkey_count_request>(req),
+                                 dsn::apps::RPC_RRDB_RRDB_SORTKEY_COUNT_V2);
+        _server->on_sortkey_count_v2(rpc);
+        EXPECT_EQ(rocksdb::Status::kOk, rpc.response().error);
+        return rpc.response().count;
+    };
+
+    put("large_hash_key", 10, 1);
+    put("small_hash_key", 2, 2);
+
+    // the first count fills the index, and the second one hits
+    long before_hit_count =
+        _server->_pfc_recent_sortkey_count_index_hit_count->get_integer_value();
+    ASSERT_EQ(10, count("large_hash_key", false));
+    ASSERT_EQ(1, _server->_sortkey_count_index->size());
+    ASSERT_EQ(10, count("large_hash_key", false));
+    ASSERT_EQ(before_hit_count + 1,
+              _server->_pfc_recent_sortkey_count_index_hit_count->get_integer_value());
+
+    // the old rpc is served by the index too
+    dsn::blob hash_key = dsn::blob::create_from_bytes(std::string("large_hash_key"));
+    sortkey_count_rpc old_rpc(dsn::make_unique<dsn::blob>(hash_key),
+                              dsn::apps::RPC_RRDB_RRDB_SORTKEY_COUNT);
+    _server->on_sortkey_count(old_rpc);
+    ASSERT_EQ(10, old_rpc.response().count);
+    ASSERT_EQ(before_hit_count + 2,
+              _server->_pfc_recent_sortkey_count_index_hit_count->get_integer_value());
+
+    // the small hash keys are not indexed
+    ASSERT_EQ(2, count("small_hash_key", false));
+    ASSERT_EQ(1, _server->_sortkey_count_index->size());
+
+    // a write on the hash key drops the count
+    dsn::blob removed_key;
+    pegasus_generate_key(removed_key, std::string("large_hash_key"), std::string("sort_key_0"));
+    dsn::message_ex *removes[] = {create_remove_request(removed_key)};
+    ASSERT_EQ(0, _server->on_batched_write_requests(3, 0, removes, 1));
+    ASSERT_EQ(0, _server->_sortkey_count_index->size());
+    ASSERT_EQ(9, count("large_hash_key", false));
+    ASSERT_EQ(1, _server->_sortkey_count_index->size());
+
+    // the index is not used if the table has a default ttl
+    std::map<std::string, std::string> envs;
+    envs[TABLE_LEVEL_DEFAULT_TTL] = "1000";
+    _server->update_app_envs(envs);
+    ASSERT_EQ(0, _server->_sortkey_count_index->size());
+    ASSERT_EQ(9, count("large_hash_key", false));
+    ASSERT_EQ(0, _server->_sortkey_count_index->size());
+    envs[TABLE_LEVEL_DEFAULT_TTL] = "0";
+    _server->update_app_envs(envs);
+
+    // nor if the table has a user specified compaction, which drops the counts when it's set
+    ASSERT_EQ(9, count("large_hash_key", false));
+    ASSERT_EQ(1, _server->_sortkey_count_index->size());
+    envs[USER_SPECIFIED_COMPACTION] = "test";
+    _server->update_app_envs(envs);
+    ASSERT_EQ(0, _server->_sortkey_count_index->size());
+    ASSERT_EQ(9, count("large_hash_key", false));
+    ASSERT_EQ(0, _server->_sortkey_count_index->size());
+    envs[USER_SPECIFIED_COMPACTION] = "";
+    _server->update_app_envs(envs);
+
+    // the approximate count scans the sample rows only, and estimates the rest. The rows are
+    // counted exactly if the sizes of the sample rows are unknown yet.
+    uint32_t old_sample_count = FLAGS_sortkey_count_sample_count;
+    FLAGS_sortkey_count_sample_count = 4;
+    _server->_sortkey_count_index->clear();
+    long before_approximate_count =
+        _server->_pfc_recent_approximate_sortkey_count_count->get_integer_value();
+    int64_t approximate_count = count("large_hash_key", true);
+    if (_server->_pfc_recent_approximate_sortkey_count_count->get_integer_value() ==
+        before_approximate_count) {
+        ASSERT_EQ(9, approximate_count);
+        ASSERT_EQ(1, _server->_sortkey_count_index->size());
+    } else {
+        ASSERT_LE(4, approximate_count);
+        ASSERT_EQ(0, _server->_sortkey_count_index->size());
+    }
+    // the small hash keys are still counted exactly
+    ASSERT_EQ(2, count("small_hash_key", true));
+    FLAGS_sortkey_count_sample_count = old_sample_count;
+    FLAGS_sortkey_count_index_min_count = old_index_min_count;
+}
+
+TEST_F(pegasus_server_impl_test, key_column_family)
+{
+    ASSERT_EQ(dsn::ERR_INVALID_PARAMETERS, start({{ROCKSDB_SEPARATE_KEY_CF, "invalid"}}));
+    start({{ROCKSDB_SEPARATE_KEY_CF, "true"}});
+    ASSERT_NE(nullptr, _server->_key_cf);
+
+    const std::string hash_key = "hash_key";
+    std::vector<dsn::message_ex *> writes;
+    for (int i = 0; i < 5; i++) {
+        dsn::apps::update_request req;
+        pegasus_generate_key(req.key, hash_key, "sort_key_" + std::to_string(i));
+        req.value = dsn::blob::create_from_bytes(std::string(1024, 'v'));
+        if (i == 4) {
+            // an expired row
+            req.expire_ts_seconds = utils::epoch_now() - 10;
+        }
+        writes.push_back(create_put_request(req));
+    }
+    ASSERT_EQ(0, _server->on_batched_write_requests(1, 0, writes.data(), writes.size()));
+    dsn::blob removed_key;
+    pegasus_generate_key(removed_key, hash_key, std::string("sort_key_0"));
+    dsn::message_ex *removes[] = {create_remove_request(removed_key)};
+    ASSERT_EQ(0, _server->on_batched_write_requests(2, 0, removes, 1));
+
+    auto scan = [&](bool no_value) -> std::vector<::dsn::apps::key_value> {
+        ::dsn::apps::get_scanner_request request;
+        pegasus_generate_key(request.start_key, hash_key, std::string());
+        pegasus_generate_next_blob(request.stop_key, hash_key);
+        request.start_inclusive = true;
+        request.stop_inclusive = false;
+        request.batch_size = 100;
+        request.no_value = no_value;
+        request.__set_validate_partition_hash(false);
+        get_scanner_rpc rpc(dsn::make_unique<::dsn::apps::get_scanner_request>(request),
+                            dsn::apps::RPC_RRDB_RRDB_GET_SCANNER);
+        _server->on_get_scanner(rpc);
+        EXPECT_EQ(rocksdb::Status::kOk, rpc.response().error);
+        return rpc.response().kvs;
+    };
+
+    // the scan without values reads the key column family
+    auto kvs = scan(true);
+    ASSERT_EQ(3, kvs.size());
+    for (const auto &kv : kvs) {
+        ASSERT_EQ(0, kv.value.length());
+    }
+    kvs = scan(false);
+    ASSERT_EQ(3, kvs.size());
+    for (const auto &kv : kvs) {
+        ASSERT_EQ(1024, kv.value.length());
+    }
+
+    dsn::blob count_key = dsn::blob::create_from_bytes(std::string(hash_key));
+    sortkey_count_rpc count_rpc(dsn::make_unique<dsn::blob>(count_key),
+                                dsn::apps::RPC_RRDB_RRDB_SORTKEY_COUNT);
+    _server->on_sortkey_count(count_rpc);
+    ASSERT_EQ(3, count_rpc.response().count);
+
+    // incr can't be written as a merge operand
+    std::map<std::string, std::string> envs;
+    envs[INCR_MERGE_ENABLED] = "true";
+    _server->update_app_envs(envs);
+    ASSERT_FALSE(_server->_incr_merge_enabled.load());
+
+    // the key column family is kept after reopen, no matter what the env is
+    _server->stop(false);
+    start({{ROCKSDB_SEPARATE_KEY_CF, "false"}});
+    ASSERT_NE(nullptr, _server->_key_cf);
+    ASSERT_EQ(3, scan(true).size());
+}
+
+TEST_F(pegasus_server_impl_test, incr_merge_operator_disabled)
+{
+    FLAGS_rocksdb_incr_merge_operator_enabled = false;
+    start();
+    FLAGS_rocksdb_incr_merge_operator_enabled = true;
+    ASSERT_EQ(nullptr, _server->_data_cf_opts.merge_operator);
+
+    // incr can't be written as a merge operand without the merge operator
+    std::map<std::string, std::string> envs;
+    envs[INCR_MERGE_ENABLED] = "true";
+    _server->update_app_envs(envs);
+    ASSERT_FALSE(_server->_incr_merge_enabled.load());
+}
+
 TEST_F(pegasus_server_impl_test, default_data_version)
 {
     start();
@@ -142,6 +626,7 @@ TEST_F(pegasus_server_impl_test, test_update_user_specified_compaction)
     envs[USER_SPECIFIED_COMPACTION] = user_specified_compaction;
     _server->update_user_specified_compaction(envs);
     ASSERT_EQ(user_specified_compaction, _server->_user_specified_compaction);
+    ASSERT_TRUE(_server->_has_user_specified_compaction.load());
 }
 } // namespace server
 } // namespace pegasus
@@ -64,3 +64,36 @@ TEST(value_schema, generate_and_extract_v1_v0)
         ASSERT_EQ(t.user_data, user_data.to_string());
     }
 }
+
+TEST(value_schema, extract_user_data_without_copy)
+{
+    struct test_case
+    {
+        int value_schema_version;
+        std::string user_data;
+    } tests[] = {
+        {1, ""}, {1, "pegasus"}, {0, ""}, {0, "pegasus"},
+    };
+
+    for (auto &t : tests) {
+        pegasus_value_generator gen;
+        rocksdb::SliceParts sparts = gen.generate_value(t.value_schema_version, t.user_data, 0, 0);
+
+        std::string raw_value;
+        for (int i = 0; i < sparts.num_parts; i++) {
+            raw_value += sparts.parts[i].ToString();
+        }
+
+        dsn::string_view view = pegasus_extract_user_data_view(t.value_schema_version, raw_value);
+        ASSERT_EQ(t.user_data, std::string(view.data(), view.length()));
+        ASSERT_EQ(raw_value.data() + raw_value.size() - t.user_data.size(), view.data());
+
+        auto pinned = dsn::make_unique<rocksdb::PinnableSlice>();
+        pinned->PinSelf(raw_value);
+        const char *pinned_data = pinned->data();
+        dsn::blob user_data;
+        pegasus_extract_user_data(t.value_schema_version, std::move(pinned), user_data);
+        ASSERT_EQ(t.user_data, user_data.to_string());
+        ASSERT_EQ(pinned_data + raw_value.size() - t.user_data.size(), user_data.data());
+    }
+}
@@ -166,5 +166,125 @@ TEST_F(incr_test, incr_on_expire_record)
     db_get(req.key, &get_ctx);
     ASSERT_TRUE(get_ctx.found);
 }
+
+TEST_F(incr_test, incr_by_merge)
+{
+    _server->update_app_envs({{INCR_MERGE_ENABLED, "true"}});
+
+    // the new value is not returned when incr by merge.
+    req.increment = 100;
+    ASSERT_EQ(0, _write_impl->incr(0, req, resp));
+    ASSERT_EQ(resp.new_value, 0);
+    req.increment = -1;
+    ASSERT_EQ(0, _write_impl->incr(0, req, resp));
+
+    db_get_context get_ctx;
+    db_get(req.key, &get_ctx);
+    ASSERT_TRUE(get_ctx.found);
+    ASSERT_FALSE(get_ctx.expired);
+    dsn::blob user_data;
+    pegasus_extract_user_data(
+        _write_impl->_pegasus_data_version, std::move(get_ctx.raw_value), user_data);
+    ASSERT_EQ(user_data.to_string(), "99");
+
+    // the increment is ignored if the old value is not an integer.
+    single_set(req.key, dsn::blob::create_from_bytes("abc"));
+    req.increment = 10;
+    ASSERT_EQ(0, _write_impl->incr(1, req, resp));
+    db_get_context get_ctx2;
+    db_get(req.key, &get_ctx2);
+    pegasus_extract_user_data(
+        _write_impl->_pegasus_data_version, std::move(get_ctx2.raw_value), user_data);
+    ASSERT_EQ(user_data.to_string(), "abc");
+
+    // the operands written by merge are still applied after the env is turned off.
+    single_set(req.key, dsn::blob::create_from_bytes("100"));
+    ASSERT_EQ(0, _write_impl->incr(1, req, resp));
+    _server->update_app_envs({{INCR_MERGE_ENABLED, "false"}});
+    req.increment = 1;
+    ASSERT_EQ(0, _write_impl->incr(1, req, resp));
+    ASSERT_EQ(resp.new_value, 111);
+}
+
+class batch_write_test : public pegasus_write_service_impl_test
+{
+public:
+    void SetUp() override
+    {
+        pegasus_write_service_impl_test::SetUp();
+        // 2 partitions, the keys of partition 1 are those whose hash is odd.
+        _server->set_partition_version(1);
+    }
+
+    // generate a key of the given partition
+    dsn::blob generate_key(int partition_index, const std::string &prefix)
+    {
+        for (int i = 0;; ++i) {
+            dsn::blob key;
+            pegasus_generate_key(key, prefix + std::to_string(i), std::string("sort_key"));
+            if (static_cast<int>(pegasus_key_hash(key) & 1) == partition_index) {
+                return key;
+            }
+        }
+    }
+
+    void add_operation(dsn::apps::mutate_operation::type type,
+                       const dsn::blob &key,
+                       const std::string &value)
+    {
+        dsn::apps::batch_write_operation op;
+        op.operation = type;
+        op.key = key;
+        op.value = dsn::blob::create_from_bytes(std::string(value));
+        req.operations.emplace_back(std::move(op));
+    }
+
+    dsn::apps::batch_write_request req;
+    dsn::apps::update_response resp;
+};
+
+TEST_F(batch_write_test, put_and_delete)
+{
+    dsn::blob key1 = generate_key(_gpid.get_partition_index(), "hash_key_a");
+    dsn::blob key2 = generate_key(_gpid.get_partition_index(), "hash_key_b");
+    single_set(key2, dsn::blob::create_from_bytes("old"));
+
+    add_operation(dsn::apps::mutate_operation::MO_PUT, key1, "value1");
+    add_operation(dsn::apps::mutate_operation::MO_DELETE, key2, "");
+    ASSERT_EQ(0, _write_impl->batch_write(db_write_context::empty(1), req, resp));
+    ASSERT_EQ(0, resp.error);
+    ASSERT_EQ(1, resp.decree);
+
+    db_get_context get_ctx1;
+    db_get(key1, &get_ctx1);
+    ASSERT_TRUE(get_ctx1.found);
+    dsn::blob user_data;
+    pegasus_extract_user_data(
+        _write_impl->_pegasus_data_version, std::move(get_ctx1.raw_value), user_data);
+    ASSERT_EQ("value1", user_data.to_string());
+
+    db_get_context get_ctx2;
+    db_get(key2, &get_ctx2);
+    ASSERT_FALSE(get_ctx2.found);
+}
+
+TEST_F(batch_write_test, invalid_batch)
+{
+    // an empty batch is rejected.
+    ASSERT_EQ(0, _write_impl->batch_write(db_write_context::empty(1), req, resp));
+    ASSERT_EQ(rocksdb::Status::kInvalidArgument, resp.error);
+
+    // the whole batch is rejected if any key doesn't belong to this partition.
+    dsn::blob key1 = generate_key(_gpid.get_partition_index(), "hash_key_a");
+    dsn::blob key2 = generate_key(1 - _gpid.get_partition_index(), "hash_key_b");
+    add_operation(dsn::apps::mutate_operation::MO_PUT, key1, "value1");
+    add_operation(dsn::apps::mutate_operation::MO_PUT, key2, "value2");
+    ASSERT_EQ(0, _write_impl->batch_write(db_write_context::empty(2), req, resp));
+    ASSERT_EQ(rocksdb::Status::kInvalidArgument, resp.error);
+
+    db_get_context get_ctx;
+    db_get(key1, &get_ctx);
+    ASSERT_FALSE(get_ctx.found);
+}
 } // namespace server
 } // namespace pegasus
@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "server/response_arena.h"
+
+#include <gtest/gtest.h>
+
+namespace pegasus {
+namespace server {
+
+TEST(response_arena_test, copy)
+{
+    response_arena arena(64);
+    ASSERT_EQ(0, arena.allocation_count());
+
+    // empty data never allocates
+    dsn::blob empty = arena.copy("");
+    ASSERT_EQ(0, empty.length());
+    ASSERT_EQ(0, arena.allocation_count());
+
+    // small data are carved from the same chunk
+    dsn::blob a = arena.copy("hash_key");
+    dsn::blob b = arena.copy("sort_key");
+    ASSERT_EQ("hash_key", a.to_string());
+    ASSERT_EQ("sort_key", b.to_string());
+    ASSERT_EQ(a.data() + a.length(), b.data());
+    ASSERT_EQ(1, arena.allocation_count());
+
+    // large data is allocated separately, and doesn't break the current chunk
+    std::string large(33, 'x');
+    dsn::blob c = arena.copy(large);
+    ASSERT_EQ(large, c.to_string());
+    ASSERT_EQ(2, arena.allocation_count());
+    dsn::blob d = arena.copy("value");
+    ASSERT_EQ(b.data() + b.length(), d.data());
+    ASSERT_EQ(2, arena.allocation_count());
+
+    // a new chunk is allocated when the current one is full
+    std::string medium(32, 'y');
+    dsn::blob e = arena.copy(medium);
+    ASSERT_EQ(d.data() + d.length(), e.data());
+    ASSERT_EQ(2, arena.allocation_count());
+    dsn::blob f = arena.copy(medium);
+    ASSERT_EQ(medium, f.to_string());
+    ASSERT_EQ(3, arena.allocation_count());
+
+    // all blobs are still valid
+    ASSERT_EQ("hash_key", a.to_string());
+    ASSERT_EQ(large, c.to_string());
+    ASSERT_EQ(medium, e.to_string());
+}
+
+TEST(response_arena_test, blobs_outlive_arena)
+{
+    std::vector<dsn::blob> blobs;
+    {
+        response_arena arena;
+        for (int i = 0; i < 1000; ++i) {
+            blobs.emplace_back(arena.copy("key_" + std::to_string(i)));
+        }
+        ASSERT_EQ(1, arena.allocation_count());
+    }
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ("key_" + std::to_string(i), blobs[i].to_string());
+    }
+}
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,178 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "server/rocksdb_event_timeline.h"
+#include "server/pegasus_event_listener.h"
+#include "pegasus_server_test_base.h"
+
+#include <gtest/gtest.h>
+
+namespace pegasus {
+namespace server {
+
+static rocksdb_event make_compaction_event(int32_t app_id, int32_t partition_index, int job_id)
+{
+    rocksdb_event event;
+    event.event_type = rocksdb_event::type::COMPACTION;
+    event.pid = dsn::gpid(app_id, partition_index);
+    event.job_id = job_id;
+    return event;
+}
+
+TEST(rocksdb_event_timeline_test, bounded)
+{
+    rocksdb_event_timeline timeline(3);
+    for (int i = 0; i < 5; ++i) {
+        timeline.add(make_compaction_event(1, 0, i));
+    }
+
+    std::vector<rocksdb_event> events = timeline.query(10);
+    ASSERT_EQ(3, events.size());
+    // the oldest events are dropped, and the others are returned in time order.
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(i + 2, events[i].job_id);
+    }
+
+    events = timeline.query(2);
+    ASSERT_EQ(2, events.size());
+    ASSERT_EQ(3, events[0].job_id);
+    ASSERT_EQ(4, events[1].job_id);
+
+    rocksdb_event_timeline disabled(0);
+    disabled.add(make_compaction_event(1, 0, 0));
+    ASSERT_TRUE(disabled.query(10).empty());
+}
+
+TEST(rocksdb_event_timeline_test, query_by_replica)
+{
+    rocksdb_event_timeline timeline(10);
+    timeline.add(make_compaction_event(1, 0, 0));
+    timeline.add(make_compaction_event(1, 1, 1));
+    timeline.add(make_compaction_event(2, 0, 2));
+
+    ASSERT_EQ(3, timeline.query(10).size());
+    ASSERT_EQ(2, timeline.query(10, 1).size());
+    std::vector<rocksdb_event> events = timeline.query(10, 1, 1);
+    ASSERT_EQ(1, events.size());
+    ASSERT_EQ(1, events[0].job_id);
+    ASSERT_TRUE(timeline.query(10, 3).empty());
+}
+
+TEST(rocksdb_event_timeline_test, query_command)
+{
+    rocksdb_event_timeline timeline(10);
+    timeline.add(make_compaction_event(1, 0, 0));
+    timeline.add(make_compaction_event(1, 1, 1));
+    timeline.add(make_compaction_event(2, 0, 2));
+
+    ASSERT_EQ(0, timeline.query_command({}).find("3 events"));
+    ASSERT_EQ(0, timeline.query_command({"1"}).find("2 events"));
+    ASSERT_EQ(0, timeline.query_command({"1.1"}).find("1 events"));
+    ASSERT_EQ(0, timeline.query_command({"1", "1"}).find("1 events"));
+    ASSERT_EQ(0, timeline.query_command({"0", "2"}).find("2 events"));
+
+    for (const auto &args : std::vector<std::vector<std::string>>{
+             {"a"}, {"-1"}, {"0.1"}, {"1.a"}, {"1.-1"}, {"1", "0"}, {"1", "1", "1"}}) {
+        ASSERT_EQ(0, timeline.query_command(args).find("usage"));
+    }
+}
+
+class pegasus_event_listener_test : public pegasus_server_test_base
+{
+public:
+    int64_t level_write_amplification(const pegasus_event_listener &listener, int level)
+    {
+        return listener._pfc_level_write_amplification[level]->get_integer_value();
+    }
+};
+
+TEST_F(pegasus_event_listener_test, record_events)
+{
+    pegasus_event_listener listener(_server.get(), 3);
+
+    rocksdb::FlushJobInfo flush_info;
+    flush_info.cf_name = rocksdb::kDefaultColumnFamilyName;
+    flush_info.job_id = 1;
+    flush_info.flush_reason = rocksdb::FlushReason::kWriteBufferFull;
+    flush_info.table_properties.data_size = 1000;
+    listener.OnFlushBegin(nullptr, flush_info);
+    listener.OnFlushCompleted(nullptr, flush_info);
+    ASSERT_EQ(100, level_write_amplification(listener, 0));
+    ASSERT_EQ(0, level_write_amplification(listener, 1));
+
+    rocksdb::CompactionJobInfo compaction_info;
+    compaction_info.cf_name = rocksdb::kDefaultColumnFamilyName;
+    compaction_info.job_id = 2;
+    compaction_info.compaction_reason = rocksdb::CompactionReason::kLevelL0FilesNum;
+    compaction_info.base_input_level = 0;
+    compaction_info.output_level = 1;
+    compaction_info.stats.num_input_files = 4;
+    compaction_info.stats.num_input_files_at_output_level = 2;
+    compaction_info.stats.num_output_files = 2;
+    compaction_info.stats.total_input_bytes = 4000;
+    compaction_info.stats.total_output_bytes = 3000;
+    compaction_info.stats.elapsed_micros = 5000;
+    listener.OnCompactionCompleted(nullptr, compaction_info);
+    ASSERT_EQ(100, level_write_amplification(listener, 0));
+    ASSERT_EQ(300, level_write_amplification(listener, 1));
+
+    // the column families other than the data one are not counted in the amplification.
+    compaction_info.cf_name = "pegasus_meta_cf";
+    listener.OnCompactionCompleted(nullptr, compaction_info);
+    ASSERT_EQ(300, level_write_amplification(listener, 1));
+
+    rocksdb::WriteStallInfo stall_info;
+    stall_info.cf_name = rocksdb::kDefaultColumnFamilyName;
+    stall_info.condition.prev = rocksdb::WriteStallCondition::kNormal;
+    stall_info.condition.cur = rocksdb::WriteStallCondition::kDelayed;
+    listener.OnStallConditionsChanged(stall_info);
+    stall_info.condition.prev = rocksdb::WriteStallCondition::kDelayed;
+    stall_info.condition.cur = rocksdb::WriteStallCondition::kNormal;
+    listener.OnStallConditionsChanged(stall_info);
+
+    std::vector<rocksdb_event> events = rocksdb_event_timeline::instance().query(
+        5, _gpid.get_app_id(), _gpid.get_partition_index());
+    ASSERT_EQ(5, events.size());
+
+    ASSERT_EQ(rocksdb_event::type::FLUSH, events[0].event_type);
+    ASSERT_EQ(1, events[0].job_id);
+    ASSERT_EQ("WriteBufferFull", events[0].reason);
+    ASSERT_EQ(1000, events[0].output_bytes);
+
+    ASSERT_EQ(rocksdb_event::type::COMPACTION, events[1].event_type);
+    ASSERT_EQ(2, events[1].job_id);
+    ASSERT_EQ("LevelL0FilesNum", events[1].reason);
+    ASSERT_EQ(0, events[1].input_level);
+    ASSERT_EQ(1, events[1].output_level);
+    ASSERT_EQ(4, events[1].input_files);
+    ASSERT_EQ(2, events[1].output_files);
+    ASSERT_EQ(5, events[1].duration_ms);
+    // half of the 4000 input bytes are estimated to come from level 0.
+    ASSERT_DOUBLE_EQ(1.5, events[1].write_amplification);
+    ASSERT_DOUBLE_EQ(4000.0 / 3000, events[1].read_amplification);
+
+    ASSERT_EQ(rocksdb_event::type::STALL, events[3].event_type);
+    ASSERT_EQ("normal", events[3].prev_condition);
+    ASSERT_EQ("delayed", events[3].cur_condition);
+    ASSERT_EQ("delayed", events[4].prev_condition);
+    ASSERT_EQ("normal", events[4].cur_condition);
+}
+
+} // namespace server
+} // namespace pegasus
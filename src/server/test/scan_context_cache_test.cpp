@@ -0,0 +1,242 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "server/pegasus_scan_context.h"
+
+#include <gtest/gtest.h>
+
+namespace pegasus {
+namespace server {
+
+static std::unique_ptr<pegasus_scan_context> create_test_context()
+{
+    return dsn::make_unique<pegasus_scan_context>(nullptr,
+                                                  std::string("stop"),
+                                                  false,
+                                                  key_filter_matcher(),
+                                                  key_filter_matcher(),
+                                                  100,
+                                                  false,
+                                                  false,
+                                                  false,
+                                                  ::dsn::apps::scan_aggregate_type::SA_NONE);
+}
+
+TEST(scan_context_cache_test, put_and_fetch)
+{
+    pegasus_context_cache cache;
+    bool evicted = false;
+    std::vector<int64_t> handles;
+    for (int i = 0; i < 100; ++i) {
+        handles.push_back(cache.put(create_test_context(), 1000, evicted));
+        ASSERT_FALSE(evicted);
+    }
+    ASSERT_EQ(100, cache.size());
+
+    for (int64_t handle : handles) {
+        ASSERT_NE(nullptr, cache.fetch(handle));
+        // a context can only be fetched once
+        ASSERT_EQ(nullptr, cache.fetch(handle));
+    }
+    ASSERT_EQ(0, cache.size());
+}
+
+TEST(scan_context_cache_test, evict_idle_contexts)
+{
+    pegasus_context_cache cache;
+    bool evicted = false;
+    int64_t old_handle = cache.put(create_test_context(), 1000, evicted);
+    int64_t new_handle = cache.put(create_test_context(), 5000, evicted);
+    ASSERT_EQ(2, cache.size());
+
+    ASSERT_EQ(0, cache.evict_idle_contexts(3000, 3000));
+    ASSERT_EQ(1, cache.evict_idle_contexts(4000, 3000));
+    ASSERT_EQ(1, cache.size());
+    ASSERT_EQ(nullptr, cache.fetch(old_handle));
+    ASSERT_NE(nullptr, cache.fetch(new_handle));
+}
+
+TEST(scan_context_cache_test, max_count)
+{
+    pegasus_context_cache cache;
+    cache.set_max_count(pegasus_context_cache::kShardCount);
+
+    // the contexts of sequential handles are put into different shards
+    bool evicted = false;
+    std::vector<int64_t> handles;
+    for (int i = 0; i < pegasus_context_cache::kShardCount; ++i) {
+        handles.push_back(cache.put(create_test_context(), 1000 + i, evicted));
+        ASSERT_FALSE(evicted);
+    }
+    ASSERT_EQ(pegasus_context_cache::kShardCount, cache.size());
+
+    // the shard is full, so the least recently used context of the shard is evicted
+    cache.put(create_test_context(), 2000, evicted);
+    ASSERT_TRUE(evicted);
+    ASSERT_EQ(pegasus_context_cache::kShardCount, cache.size());
+    ASSERT_EQ(nullptr, cache.fetch(handles[0]));
+}
+
+TEST(scan_context_cache_test, small_max_count)
+{
+    pegasus_context_cache cache;
+    // less than one per shard, which should still be limited
+    cache.set_max_count(1);
+
+    bool evicted = false;
+    int64_t first_handle = cache.put(create_test_context(), 1000, evicted);
+    ASSERT_FALSE(evicted);
+    // fill the other shards, then the next context is put into the shard of the first one
+    for (int i = 1; i < pegasus_context_cache::kShardCount; ++i) {
+        cache.put(create_test_context(), 1000 + i, evicted);
+        ASSERT_FALSE(evicted);
+    }
+    cache.put(create_test_context(), 2000, evicted);
+    ASSERT_TRUE(evicted);
+    ASSERT_EQ(nullptr, cache.fetch(first_handle));
+}
+
+TEST(scan_context_cache_test, acquire_and_release)
+{
+    pegasus_context_cache cache;
+    bool evicted = false;
+    int64_t handle = cache.put(create_test_context(), 1000, evicted);
+
+    std::unique_ptr<pegasus_scan_context> context = cache.acquire(handle);
+    ASSERT_NE(nullptr, context);
+    // the acquired context is still counted, but can't be fetched or acquired again
+    ASSERT_EQ(1, cache.size());
+    ASSERT_EQ(nullptr, cache.acquire(handle));
+    bool busy = false;
+    ASSERT_EQ(nullptr, cache.fetch(handle, busy));
+    ASSERT_TRUE(busy);
+
+    cache.release(handle, std::move(context), 2000);
+    ASSERT_NE(nullptr, cache.fetch(handle, busy));
+    ASSERT_FALSE(busy);
+    ASSERT_EQ(0, cache.size());
+
+    // the fetcher parked on the busy context is notified when it's released
+    int notified = 0;
+    handle = cache.put(create_test_context(), 1000, evicted);
+    context = cache.acquire(handle);
+    ASSERT_EQ(nullptr, cache.fetch(handle, busy, [&notified]() { ++notified; }));
+    ASSERT_TRUE(busy);
+    ASSERT_EQ(0, notified);
+    cache.release(handle, std::move(context), 2000);
+    ASSERT_EQ(1, notified);
+    ASSERT_NE(nullptr, cache.fetch(handle, busy));
+
+    // or when it's removed
+    handle = cache.put(create_test_context(), 1000, evicted);
+    context = cache.acquire(handle);
+    ASSERT_EQ(nullptr, cache.fetch(handle, busy, [&notified]() { ++notified; }));
+    cache.remove(handle);
+    ASSERT_EQ(2, notified);
+    cache.release(handle, std::move(context), 2000);
+    ASSERT_EQ(2, notified);
+
+    // the context is dropped if it's removed while acquired
+    handle = cache.put(create_test_context(), 1000, evicted);
+    context = cache.acquire(handle);
+    cache.remove(handle);
+    ASSERT_EQ(0, cache.size());
+    cache.release(handle, std::move(context), 2000);
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(nullptr, cache.fetch(handle, busy));
+    ASSERT_FALSE(busy);
+
+    // the fetchers parked on the busy contexts are notified when the cache is cleared
+    handle = cache.put(create_test_context(), 1000, evicted);
+    context = cache.acquire(handle);
+    ASSERT_EQ(nullptr, cache.fetch(handle, busy, [&notified]() { ++notified; }));
+    cache.clear();
+    ASSERT_EQ(3, notified);
+    ASSERT_EQ(0, cache.size());
+    cache.release(handle, std::move(context), 2000);
+    ASSERT_EQ(nullptr, cache.fetch(handle, busy));
+}
+
+TEST(scan_context_cache_test, prefetch_budget)
+{
+    auto budget = std::make_shared<scan_prefetch_budget>(100);
+    {
+        std::unique_ptr<pegasus_scan_context> context = create_test_context();
+        context->set_prefetched_batch(budget, 60);
+        ASSERT_EQ(60, budget->used_bytes());
+        ASSERT_FALSE(budget->exhausted());
+
+        context->clear_prefetched_batch();
+        ASSERT_EQ(0, budget->used_bytes());
+        ASSERT_FALSE(context->has_prefetched_batch);
+
+        context->set_prefetched_batch(budget, 100);
+        ASSERT_TRUE(budget->exhausted());
+    }
+    // the budget is released when the context is destroyed
+    ASSERT_EQ(0, budget->used_bytes());
+
+    // the reservations can't exceed the budget together
+    {
+        ASSERT_TRUE(budget->try_acquire(60));
+        scan_prefetch_reservation reservation(budget, 60);
+        ASSERT_FALSE(budget->try_acquire(41));
+        ASSERT_TRUE(budget->try_acquire(40));
+        budget->release(40);
+        ASSERT_EQ(60, budget->used_bytes());
+    }
+    ASSERT_EQ(0, budget->used_bytes());
+}
+
+TEST(scan_context_cache_test, scan_aggregator)
+{
+    // raw keys with the 2-bytes hash key length prefix
+    const std::string key1("\0\x02h1s1", 6);
+    const std::string key2("\0\x02h1s22", 7);
+    const std::string key3("\0\x02h2s3", 6);
+
+    scan_aggregator count(::dsn::apps::scan_aggregate_type::SA_COUNT);
+    count.add(key1, "10");
+    count.add(key2, "abc");
+    ASSERT_EQ(2, count.result().row_count);
+    ASSERT_EQ(9, count.result().key_bytes);
+    ASSERT_EQ(5, count.result().value_bytes);
+    ASSERT_EQ(0, count.result().int_count);
+
+    scan_aggregator stats(::dsn::apps::scan_aggregate_type::SA_INT_STATS);
+    stats.add(key1, "10");
+    stats.add(key2, "abc");
+    stats.add(key3, "-7");
+    stats.add(key3, "");
+    ASSERT_EQ(4, stats.result().row_count);
+    ASSERT_EQ(2, stats.result().int_count);
+    ASSERT_EQ(3, stats.result().int_sum);
+    ASSERT_EQ(-7, stats.result().int_min);
+    ASSERT_EQ(10, stats.result().int_max);
+
+    // the sum wraps around on overflow
+    scan_aggregator overflow(::dsn::apps::scan_aggregate_type::SA_INT_STATS);
+    overflow.add(key1, std::to_string(INT64_MAX));
+    overflow.add(key1, "1");
+    ASSERT_EQ(INT64_MIN, overflow.result().int_sum);
+    ASSERT_EQ(1, overflow.result().int_min);
+    ASSERT_EQ(INT64_MAX, overflow.result().int_max);
+}
+
+} // namespace server
+} // namespace pegasus
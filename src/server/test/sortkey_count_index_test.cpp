@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "server/sortkey_count_index.h"
+
+#include <gtest/gtest.h>
+#include "base/pegasus_key_schema.h"
+
+namespace pegasus {
+namespace server {
+
+class sortkey_count_index_test : public ::testing::Test
+{
+public:
+    sortkey_count_index_test() : _index(4) {}
+
+    uint64_t key_hash(const std::string &hash_key)
+    {
+        return pegasus_hash_key_hash(dsn::blob(hash_key.data(), 0, hash_key.length()));
+    }
+
+    // return the indexed count of `hash_key`, or -1 if it's not indexed.
+    int64_t get(const std::string &hash_key, uint32_t epoch_now = 100)
+    {
+        int64_t count = 0;
+        uint64_t version = 0;
+        if (_index.get(hash_key, key_hash(hash_key), epoch_now, count, version)) {
+            return count;
+        }
+        _index.cancel(key_hash(hash_key));
+        return -1;
+    }
+
+    void fill(const std::string &hash_key, int64_t count, uint32_t min_expire_ts = 0)
+    {
+        int64_t indexed_count = 0;
+        uint64_t version = 0;
+        ASSERT_FALSE(_index.get(hash_key, key_hash(hash_key), 100, indexed_count, version));
+        _index.fill(hash_key, key_hash(hash_key), count, min_expire_ts, version);
+    }
+
+    sortkey_count_index _index;
+};
+
+TEST_F(sortkey_count_index_test, fill_and_get)
+{
+    ASSERT_TRUE(_index.enabled());
+    ASSERT_FALSE(sortkey_count_index(0).enabled());
+
+    ASSERT_EQ(-1, get("hash_key"));
+    fill("hash_key", 10);
+    ASSERT_EQ(10, get("hash_key"));
+    ASSERT_EQ(-1, get("another_hash_key"));
+
+    // the count is dropped once any of the counted rows is expired
+    fill("hash_key_with_ttl", 20, 200);
+    ASSERT_EQ(20, get("hash_key_with_ttl", 199));
+    ASSERT_EQ(-1, get("hash_key_with_ttl", 200));
+    ASSERT_EQ(1, _index.size());
+
+    _index.clear();
+    ASSERT_EQ(0, _index.size());
+    ASSERT_EQ(-1, get("hash_key"));
+}
+
+TEST_F(sortkey_count_index_test, invalidate)
+{
+    fill("hash_key", 10);
+    fill("another_hash_key", 20);
+
+    // the writes on the other hash keys don't invalidate the counts
+    _index.invalidate({key_hash("cold_hash_key")});
+    ASSERT_EQ(2, _index.size());
+
+    _index.invalidate({key_hash("hash_key")});
+    ASSERT_EQ(1, _index.size());
+    ASSERT_EQ(-1, get("hash_key"));
+    ASSERT_EQ(20, get("another_hash_key"));
+
+    // a count scanned before a write on the hash key can't be filled
+    int64_t count = 0;
+    uint64_t version = 0;
+    ASSERT_FALSE(_index.get("hash_key", key_hash("hash_key"), 100, count, version));
+    _index.invalidate({key_hash("hash_key")});
+    _index.fill("hash_key", key_hash("hash_key"), 10, 0, version);
+    ASSERT_EQ(-1, get("hash_key"));
+
+    // while a write on the other hash keys doesn't matter
+    ASSERT_FALSE(_index.get("hash_key", key_hash("hash_key"), 100, count, version));
+    _index.invalidate({key_hash("cold_hash_key")});
+    _index.fill("hash_key", key_hash("hash_key"), 11, 0, version);
+    ASSERT_EQ(11, get("hash_key"));
+
+    // neither does a write after the scan is cancelled
+    ASSERT_FALSE(_index.get("cold_hash_key", key_hash("cold_hash_key"), 100, count, version));
+    _index.cancel(key_hash("cold_hash_key"));
+    _index.invalidate({key_hash("cold_hash_key")});
+    ASSERT_EQ(11, get("hash_key"));
+    ASSERT_EQ(20, get("another_hash_key"));
+}
+
+TEST_F(sortkey_count_index_test, capacity)
+{
+    for (int i = 0; i < 10; i++) {
+        fill("hash_key_" + std::to_string(i), i);
+    }
+    ASSERT_EQ(4, _index.size());
+    ASSERT_EQ(9, get("hash_key_9"));
+}
+
+} // namespace server
+} // namespace pegasus
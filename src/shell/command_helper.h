@@ -126,6 +126,8 @@ struct scan_data_context
     scan_data_operator op;
     int split_id;
     int max_batch_count;
+    // the batch_size of the scan options which the scanner is created with
+    int batch_size;
     int timeout_ms;
     bool no_overwrite; // if set true, then use check_and_set() instead of set()
                        // when inserting data to destination table for copy_data,
@@ -151,6 +153,7 @@ struct scan_data_context
     scan_data_context(scan_data_operator op_,
                       int split_id_,
                       int max_batch_count_,
+                      int batch_size_,
                       int timeout_ms_,
                       pegasus::pegasus_client::pegasus_scanner_wrapper scanner_,
                       pegasus::pegasus_client *client_,
@@ -163,6 +166,7 @@ struct scan_data_context
         : op(op_),
           split_id(split_id_),
           max_batch_count(max_batch_count_),
+          batch_size(batch_size_),
           timeout_ms(timeout_ms_),
           no_overwrite(false),
           sort_key_filter_type(pegasus::pegasus_client::FT_NO_FILTER),
@@ -217,6 +221,16 @@ inline pegasus::pegasus_client::filter_type parse_filter_type(const std::string
             std::string("ft_match_") + name,
             ::dsn::apps::filter_type::FT_NO_FILTER);
 }
+// value filters are resolved by the shell itself, which doesn't support the filter types
+// that are only resolved on the server side.
+inline pegasus::pegasus_client::filter_type parse_value_filter_type(const std::string &name)
+{
+    pegasus::pegasus_client::filter_type type = parse_filter_type(name, true);
+    if (type == pegasus::pegasus_client::FT_MATCH_REGEX ||
+        type == pegasus::pegasus_client::FT_MATCH_MULTI_PATTERN)
+        return pegasus::pegasus_client::FT_NO_FILTER;
+    return type;
+}
 // return true if the data is valid for the filter
 inline bool validate_filter(pegasus::pegasus_client::filter_type filter_type,
                             const std::string &filter_pattern,
@@ -271,206 +285,229 @@ inline int compute_ttl_seconds(uint32_t expire_ts_seconds, bool &ts_expired)
     return 0;
 }
 
+// the rows of a batch got by scan, which is released once all the rows are processed.
+struct scan_data_batch
+{
+    // starts from 1, which is removed after all the rows of the batch are issued, so that the
+    // batch won't be released in the middle.
+    std::atomic_int pending_count{1};
+    std::function<void()> release;
+    void done()
+    {
+        if (--pending_count == 0) {
+            release();
+        }
+    }
+};
+
+inline void
+scan_data_write_done(scan_data_context *context, int err, const char *op_name, bool written)
+{
+    if (err != pegasus::PERR_OK) {
+        if (!context->split_completed.exchange(true)) {
+            fprintf(stderr,
+                    "ERROR: split[%d] async %s failed: %s\n",
+                    context->split_id,
+                    op_name,
+                    context->client->get_error_string(err));
+            context->error_occurred->store(true);
+        }
+    } else if (written) {
+        context->split_rows++;
+    }
+}
+
+inline void scan_data_count_row(scan_data_context *context,
+                                std::string &&hash_key,
+                                std::string &&sort_key,
+                                const std::string &value)
+{
+    context->split_rows++;
+    if (context->count_hash_key) {
+        // the batches of a split are delivered one by one in order, so the rows of the same
+        // hash key are adjacent.
+        if (hash_key != context->last_hash_key) {
+            context->split_hash_key_count++;
+            // copied since the hash key may be moved to the top rows below.
+            context->last_hash_key = hash_key;
+        }
+    }
+    if (context->stat_size && context->statistics) {
+        long hash_key_size = hash_key.size();
+        context->statistics->measureTime(static_cast<uint32_t>(histogram_type::HASH_KEY_SIZE),
+                                         hash_key_size);
+
+        long sort_key_size = sort_key.size();
+        context->statistics->measureTime(static_cast<uint32_t>(histogram_type::SORT_KEY_SIZE),
+                                         sort_key_size);
+
+        long value_size = value.size();
+        context->statistics->measureTime(static_cast<uint32_t>(histogram_type::VALUE_SIZE),
+                                         value_size);
+
+        long row_size = hash_key_size + sort_key_size + value_size;
+        context->statistics->measureTime(static_cast<uint32_t>(histogram_type::ROW_SIZE),
+                                         row_size);
+
+        if (context->top_count > 0) {
+            context->top_rows.push(std::move(hash_key), std::move(sort_key), row_size);
+        }
+    }
+}
+
+inline void scan_data_process_batch(scan_data_context *context,
+                                    pegasus::pegasus_client::scan_batch &&rows,
+                                    std::function<void()> &&release)
+{
+    auto batch = std::make_shared<scan_data_batch>();
+    batch->release = std::move(release);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (context->error_occurred->load()) {
+            break;
+        }
+        std::string hash_key = rows.hash_key(i).to_string();
+        std::string sort_key = rows.sort_key(i).to_string();
+        std::string value = rows.value(i).to_string();
+        if (!validate_filter(context, sort_key, value)) {
+            continue;
+        }
+        bool ts_expired = false;
+        int ttl_seconds = 0;
+        switch (context->op) {
+        case SCAN_COPY:
+            ttl_seconds = compute_ttl_seconds(rows.expire_ts_seconds(i), ts_expired);
+            if (ts_expired) {
+                break;
+            }
+            batch->pending_count++;
+            if (context->no_overwrite) {
+                pegasus::pegasus_client::check_and_set_options options;
+                options.set_value_ttl_seconds = ttl_seconds;
+                context->client->async_check_and_set(
+                    hash_key,
+                    sort_key,
+                    pegasus::pegasus_client::cas_check_type::CT_VALUE_NOT_EXIST,
+                    "",
+                    sort_key,
+                    value,
+                    options,
+                    [context, batch](int err,
+                                     pegasus::pegasus_client::check_and_set_results &&results,
+                                     pegasus::pegasus_client::internal_info &&info) {
+                        scan_data_write_done(context, err, "check and set", results.set_succeed);
+                        batch->done();
+                    },
+                    context->timeout_ms);
+            } else {
+                context->client->async_set(
+                    hash_key,
+                    sort_key,
+                    value,
+                    [context, batch](int err, pegasus::pegasus_client::internal_info &&info) {
+                        scan_data_write_done(context, err, "set", true);
+                        batch->done();
+                    },
+                    context->timeout_ms,
+                    ttl_seconds);
+            }
+            break;
+        case SCAN_CLEAR:
+            batch->pending_count++;
+            context->client->async_del(
+                hash_key,
+                sort_key,
+                [context, batch](int err, pegasus::pegasus_client::internal_info &&info) {
+                    scan_data_write_done(context, err, "del", true);
+                    batch->done();
+                },
+                context->timeout_ms);
+            break;
+        case SCAN_COUNT:
+            scan_data_count_row(context, std::move(hash_key), std::move(sort_key), value);
+            break;
+        case SCAN_GEN_GEO:
+            ttl_seconds = compute_ttl_seconds(rows.expire_ts_seconds(i), ts_expired);
+            if (ts_expired) {
+                break;
+            }
+            batch->pending_count++;
+            context->geoclient->async_set(
+                hash_key,
+                sort_key,
+                value,
+                [context, batch](int err, pegasus::pegasus_client::internal_info &&info) {
+                    scan_data_write_done(context, err, "set", true);
+                    batch->done();
+                },
+                context->timeout_ms,
+                ttl_seconds);
+            break;
+        default:
+            dassert(false, "op = %d", context->op);
+            break;
+        }
+    }
+    batch->done();
+}
+
 inline void scan_data_next(scan_data_context *context)
 {
-    while (!context->split_completed.load() && !context->error_occurred->load() &&
-           context->split_request_count.load() < context->max_batch_count) {
-        context->split_request_count++;
-        context->scanner->async_next([context](int ret,
-                                               std::string &&hash_key,
-                                               std::string &&sort_key,
-                                               std::string &&value,
-                                               pegasus::pegasus_client::internal_info &&info,
-                                               uint32_t expire_ts_seconds) {
+    // the rows of the pending batches are processed concurrently, the number of them is limited
+    // so that the concurrent requests of the split are still bounded by max_batch_count.
+    int max_pending_batches =
+        std::max(1, context->max_batch_count / std::max(1, context->batch_size));
+
+    // split_request_count keeps 1 until the scan of the split is completed
+    context->split_request_count++;
+    context->scanner->async_scan_batches(
+        1,
+        max_pending_batches,
+        [context](int ret,
+                  pegasus::pegasus_client::scan_batch &&rows,
+                  pegasus::pegasus_client::internal_info &&info,
+                  std::function<void()> &&release) {
             if (ret == pegasus::PERR_OK) {
-                if (validate_filter(context, sort_key, value)) {
-                    bool ts_expired = false;
-                    int ttl_seconds = 0;
-                    switch (context->op) {
-                    case SCAN_COPY:
-                        context->split_request_count++;
-                        ttl_seconds = compute_ttl_seconds(expire_ts_seconds, ts_expired);
-                        if (ts_expired) {
-                            scan_data_next(context);
-                        } else if (context->no_overwrite) {
-                            auto callback = [context](
-                                int err,
-                                pegasus::pegasus_client::check_and_set_results &&results,
-                                pegasus::pegasus_client::internal_info &&info) {
-                                if (err != pegasus::PERR_OK) {
-                                    if (!context->split_completed.exchange(true)) {
-                                        fprintf(stderr,
-                                                "ERROR: split[%d] async check and set failed: %s\n",
-                                                context->split_id,
-                                                context->client->get_error_string(err));
-                                        context->error_occurred->store(true);
-                                    }
-                                } else {
-                                    if (results.set_succeed) {
-                                        context->split_rows++;
-                                    }
-                                    scan_data_next(context);
-                                }
-                                // should put "split_request_count--" at end of the scope,
-                                // to prevent that split_request_count becomes 0 in the middle.
-                                context->split_request_count--;
-                            };
-                            pegasus::pegasus_client::check_and_set_options options;
-                            options.set_value_ttl_seconds = ttl_seconds;
-                            context->client->async_check_and_set(
-                                hash_key,
-                                sort_key,
-                                pegasus::pegasus_client::cas_check_type::CT_VALUE_NOT_EXIST,
-                                "",
-                                sort_key,
-                                value,
-                                options,
-                                std::move(callback),
-                                context->timeout_ms);
-                        } else {
-                            auto callback =
-                                [context](int err, pegasus::pegasus_client::internal_info &&info) {
-                                    if (err != pegasus::PERR_OK) {
-                                        if (!context->split_completed.exchange(true)) {
-                                            fprintf(stderr,
-                                                    "ERROR: split[%d] async set failed: %s\n",
-                                                    context->split_id,
-                                                    context->client->get_error_string(err));
-                                            context->error_occurred->store(true);
-                                        }
-                                    } else {
-                                        context->split_rows++;
-                                        scan_data_next(context);
-                                    }
-                                    // should put "split_request_count--" at end of the scope,
-                                    // to prevent that split_request_count becomes 0 in the middle.
-                                    context->split_request_count--;
-                                };
-                            context->client->async_set(hash_key,
-                                                       sort_key,
-                                                       value,
-                                                       std::move(callback),
-                                                       context->timeout_ms,
-                                                       ttl_seconds);
-                        }
-                        break;
-                    case SCAN_CLEAR:
-                        context->split_request_count++;
-                        context->client->async_del(
-                            hash_key,
-                            sort_key,
-                            [context](int err, pegasus::pegasus_client::internal_info &&info) {
-                                if (err != pegasus::PERR_OK) {
-                                    if (!context->split_completed.exchange(true)) {
-                                        fprintf(stderr,
-                                                "ERROR: split[%d] async del failed: %s\n",
-                                                context->split_id,
-                                                context->client->get_error_string(err));
-                                        context->error_occurred->store(true);
-                                    }
-                                } else {
-                                    context->split_rows++;
-                                    scan_data_next(context);
-                                }
-                                // should put "split_request_count--" at end of the scope,
-                                // to prevent that split_request_count becomes 0 in the middle.
-                                context->split_request_count--;
-                            },
-                            context->timeout_ms);
-                        break;
-                    case SCAN_COUNT:
-                        context->split_rows++;
-                        if (context->stat_size && context->statistics) {
-                            long hash_key_size = hash_key.size();
-                            context->statistics->measureTime(
-                                static_cast<uint32_t>(histogram_type::HASH_KEY_SIZE),
-                                hash_key_size);
-
-                            long sort_key_size = sort_key.size();
-                            context->statistics->measureTime(
-                                static_cast<uint32_t>(histogram_type::SORT_KEY_SIZE),
-                                sort_key_size);
-
-                            long value_size = value.size();
-                            context->statistics->measureTime(
-                                static_cast<uint32_t>(histogram_type::VALUE_SIZE), value_size);
-
-                            long row_size = hash_key_size + sort_key_size + value_size;
-                            context->statistics->measureTime(
-                                static_cast<uint32_t>(histogram_type::ROW_SIZE), row_size);
-
-                            if (context->top_count > 0) {
-                                context->top_rows.push(
-                                    std::move(hash_key), std::move(sort_key), row_size);
-                            }
-                        }
-                        if (context->count_hash_key) {
-                            if (hash_key != context->last_hash_key) {
-                                context->split_hash_key_count++;
-                                context->last_hash_key = std::move(hash_key);
-                            }
-                        }
-                        scan_data_next(context);
-                        break;
-                    case SCAN_GEN_GEO:
-                        context->split_request_count++;
-                        ttl_seconds = compute_ttl_seconds(expire_ts_seconds, ts_expired);
-                        if (ts_expired) {
-                            scan_data_next(context);
-                        } else {
-                            context->geoclient->async_set(
-                                hash_key,
-                                sort_key,
-                                value,
-                                [context](int err, pegasus::pegasus_client::internal_info &&info) {
-                                    if (err != pegasus::PERR_OK) {
-                                        if (!context->split_completed.exchange(true)) {
-                                            fprintf(stderr,
-                                                    "ERROR: split[%d] async set failed: %s\n",
-                                                    context->split_id,
-                                                    context->client->get_error_string(err));
-                                            context->error_occurred->store(true);
-                                        }
-                                    } else {
-                                        context->split_rows++;
-                                        scan_data_next(context);
-                                    }
-                                    // should put "split_request_count--" at end of the scope,
-                                    // to prevent that split_request_count becomes 0 in the middle.
-                                    context->split_request_count--;
-                                },
-                                context->timeout_ms,
-                                ttl_seconds);
-                        }
-                        break;
-                    default:
-                        dassert(false, "op = %d", context->op);
-                        break;
-                    }
-                } else {
-                    scan_data_next(context);
-                }
-            } else if (ret == pegasus::PERR_SCAN_COMPLETE) {
+                scan_data_process_batch(context, std::move(rows), std::move(release));
+                return !context->error_occurred->load();
+            }
+            if (ret == pegasus::PERR_SCAN_COMPLETE) {
                 context->split_completed.store(true);
-            } else {
-                if (!context->split_completed.exchange(true)) {
-                    fprintf(stderr,
-                            "ERROR: split[%d] scan next failed: %s\n",
-                            context->split_id,
-                            context->client->get_error_string(ret));
-                    context->error_occurred->store(true);
-                }
+            } else if (!context->split_completed.exchange(true)) {
+                fprintf(stderr,
+                        "ERROR: split[%d] scan next failed: %s\n",
+                        context->split_id,
+                        context->client->get_error_string(ret));
+                context->error_occurred->store(true);
             }
-            // should put "split_request_count--" at end of the scope,
-            // to prevent that split_request_count becomes 0 in the middle.
             context->split_request_count--;
+            return false;
         });
+}
 
-        if (context->count_hash_key) {
-            // disable parallel scan if count_hash_key == true
-            break;
-        }
-    }
+// count the rows of the split on the server side, used by count_data when the rows need not
+// be checked by the shell.
+inline void scan_data_aggregate(scan_data_context *context)
+{
+    // split_request_count keeps 1 until the aggregation is completed
+    context->split_request_count++;
+    context->scanner->async_aggregate(
+        pegasus::pegasus_client::SA_COUNT,
+        [context](int ret, pegasus::pegasus_client::scan_aggregate_result &&batch_result) {
+            if (ret == pegasus::PERR_OK) {
+                context->split_rows += batch_result.row_count;
+                return;
+            }
+            if (ret == pegasus::PERR_SCAN_COMPLETE) {
+                context->split_completed.store(true);
+            } else if (!context->split_completed.exchange(true)) {
+                fprintf(stderr,
+                        "ERROR: split[%d] scan aggregate failed: %s\n",
+                        context->split_id,
+                        context->client->get_error_string(ret));
+                context->error_occurred->store(true);
+            }
+            context->split_request_count--;
+        });
 }
 
 struct node_desc
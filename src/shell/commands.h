@@ -123,6 +123,8 @@ bool server_info(command_executor *e, shell_context *sc, arguments args);
 
 bool server_stat(command_executor *e, shell_context *sc, arguments args);
 
+bool rocksdb_events(command_executor *e, shell_context *sc, arguments args);
+
 bool remote_command(command_executor *e, shell_context *sc, arguments args);
 
 bool flush_log(command_executor *e, shell_context *sc, arguments args);
@@ -1018,14 +1018,36 @@ bool exist(command_executor *e, shell_context *sc, arguments args)
 
 bool sortkey_count(command_executor *e, shell_context *sc, arguments args)
 {
-    if (args.argc != 2) {
+    if (args.argc < 2) {
         return false;
     }
 
     std::string hash_key = sds_to_string(args.argv[1]);
+    bool approximate = false;
+
+    static struct option long_options[] = {{"approximate", no_argument, 0, 'a'}, {0, 0, 0, 0}};
+
+    optind = 0;
+    while (true) {
+        int option_index = 0;
+        int c;
+        c = getopt_long(args.argc, args.argv, "a", long_options, &option_index);
+        if (c == -1)
+            break;
+        switch (c) {
+        case 'a':
+            approximate = true;
+            break;
+        default:
+            return false;
+        }
+    }
+
     int64_t count;
     pegasus::pegasus_client::internal_info info;
-    int ret = sc->pg_client->sortkey_count(hash_key, count, sc->timeout_ms, &info);
+    int ret = approximate
+                  ? sc->pg_client->approximate_sortkey_count(hash_key, count, sc->timeout_ms, &info)
+                  : sc->pg_client->sortkey_count(hash_key, count, sc->timeout_ms, &info);
     if (ret != pegasus::PERR_OK) {
         fprintf(stderr, "ERROR: %s\n", sc->pg_client->get_error_string(ret));
     } else if (count == -1) {
@@ -1162,7 +1184,7 @@ bool hash_scan(command_executor *e, shell_context *sc, arguments args)
             options.sort_key_filter_pattern = unescape_str(optarg);
             break;
         case 'v':
-            value_filter_type = parse_filter_type(optarg, true);
+            value_filter_type = parse_value_filter_type(optarg);
             if (value_filter_type == pegasus::pegasus_client::FT_NO_FILTER) {
                 fprintf(stderr, "ERROR: invalid value_filter_type param\n");
                 return false;
@@ -1296,9 +1318,11 @@ bool full_scan(command_executor *e, shell_context *sc, arguments args)
                                            {"value_filter_type", required_argument, 0, 'v'},
                                            {"value_filter_pattern", required_argument, 0, 'z'},
                                            {"no_value", no_argument, 0, 'i'},
+                                           {"partition_concurrency", required_argument, 0, 'c'},
                                            {0, 0, 0, 0}};
 
     int32_t max_count = -1;
+    int32_t partition_concurrency = 8;
     bool detailed = false;
     FILE *file = stderr;
     int32_t timeout_ms = sc->timeout_ms;
@@ -1319,7 +1343,7 @@ bool full_scan(command_executor *e, shell_context *sc, arguments args)
         int option_index = 0;
         int c;
         c = getopt_long(
-            args.argc, args.argv, "dn:p:t:o:h:x:s:y:v:z:i", long_options, &option_index);
+            args.argc, args.argv, "dn:p:t:o:h:x:s:y:v:z:ic:", long_options, &option_index);
         if (c == -1)
             break;
         switch (c) {
@@ -1378,7 +1402,7 @@ bool full_scan(command_executor *e, shell_context *sc, arguments args)
             sort_key_filter_pattern = unescape_str(optarg);
             break;
         case 'v':
-            value_filter_type = parse_filter_type(optarg, true);
+            value_filter_type = parse_value_filter_type(optarg);
             if (value_filter_type == pegasus::pegasus_client::FT_NO_FILTER) {
                 fprintf(stderr, "ERROR: invalid value_filter_type param\n");
                 return false;
@@ -1391,6 +1415,12 @@ bool full_scan(command_executor *e, shell_context *sc, arguments args)
         case 'i':
             options.no_value = true;
             break;
+        case 'c':
+            if (!dsn::buf2int32(optarg, partition_concurrency) || partition_concurrency <= 0) {
+                fprintf(stderr, "ERROR: parse %s as partition_concurrency failed\n", optarg);
+                return false;
+            }
+            break;
         default:
             return false;
         }
@@ -1426,6 +1456,7 @@ bool full_scan(command_executor *e, shell_context *sc, arguments args)
     fprintf(stderr, "timout_ms: %d\n", timeout_ms);
     fprintf(stderr, "detailed: %s\n", detailed ? "true" : "false");
     fprintf(stderr, "no_value: %s\n", options.no_value ? "true" : "false");
+    fprintf(stderr, "partition_concurrency: %d\n", partition_concurrency);
     fprintf(stderr, "\n");
 
     int count = 0;
@@ -1438,7 +1469,9 @@ bool full_scan(command_executor *e, shell_context *sc, arguments args)
             options.sort_key_filter_type = sort_key_filter_type;
         options.sort_key_filter_pattern = sort_key_filter_pattern;
     }
-    int ret = sc->pg_client->get_unordered_scanners(10000, options, scanners);
+    // all the partitions are scanned by one scanner, unless a partition is specified, in which
+    // case each scanner has one partition.
+    int ret = sc->pg_client->get_unordered_scanners(partition >= 0 ? 10000 : 1, options, scanners);
     if (ret != pegasus::PERR_OK) {
         fprintf(file, "ERROR: %s\n", sc->pg_client->get_error_string(ret));
         if (file != stderr) {
@@ -1456,55 +1489,73 @@ bool full_scan(command_executor *e, shell_context *sc, arguments args)
                     (int)scanners.size() - 1);
         }
     } else {
-        for (int i = 0; i < scanners.size(); i++) {
-            if (partition >= 0 && partition != i)
-                continue;
-            std::string hash_key;
-            std::string sort_key;
-            std::string value;
-            pegasus::pegasus_client::internal_info info;
-            pegasus::pegasus_client::pegasus_scanner *scanner = scanners[i];
-            while ((max_count <= 0 || count < max_count) &&
-                   !(ret = scanner->next(hash_key, sort_key, value, &info))) {
-                if (sort_key_filter_type == pegasus::pegasus_client::FT_MATCH_EXACT &&
-                    sort_key.length() > sort_key_filter_pattern.length())
-                    continue;
-                if (!validate_filter(value_filter_type, value_filter_pattern, value))
-                    continue;
-                fprintf(file,
-                        "\"%s\" : \"%s\"",
-                        pegasus::utils::c_escape_string(hash_key, sc->escape_all).c_str(),
-                        pegasus::utils::c_escape_string(sort_key, sc->escape_all).c_str());
-                if (!options.no_value) {
-                    fprintf(file,
-                            " => \"%s\"",
-                            pegasus::utils::c_escape_string(value, sc->escape_all).c_str());
+        pegasus::pegasus_client::pegasus_scanner *scanner =
+            scanners[partition >= 0 ? partition : 0];
+        ::dsn::utils::notify_event scan_completed;
+        pegasus::pegasus_client::internal_info error_info;
+        // the batches are printed in the callback, which is never called concurrently.
+        scanner->async_scan_batches(
+            partition_concurrency,
+            partition_concurrency * 2,
+            [&](int err,
+                pegasus::pegasus_client::scan_batch &&batch,
+                pegasus::pegasus_client::internal_info &&info,
+                std::function<void()> &&release) {
+                if (err != pegasus::PERR_OK) {
+                    ret = err;
+                    error_info = std::move(info);
+                    scan_completed.notify();
+                    return false;
                 }
-                if (detailed) {
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    if (max_count > 0 && count >= max_count) {
+                        break;
+                    }
+                    std::string hash_key = batch.hash_key(i).to_string();
+                    std::string sort_key = batch.sort_key(i).to_string();
+                    std::string value = batch.value(i).to_string();
+                    if (sort_key_filter_type == pegasus::pegasus_client::FT_MATCH_EXACT &&
+                        sort_key.length() > sort_key_filter_pattern.length())
+                        continue;
+                    if (!validate_filter(value_filter_type, value_filter_pattern, value))
+                        continue;
                     fprintf(file,
-                            " {app_id=%d, partition_index=%d, server=%s}",
-                            info.app_id,
-                            info.partition_index,
-                            info.server.c_str());
+                            "\"%s\" : \"%s\"",
+                            pegasus::utils::c_escape_string(hash_key, sc->escape_all).c_str(),
+                            pegasus::utils::c_escape_string(sort_key, sc->escape_all).c_str());
+                    if (!options.no_value) {
+                        fprintf(file,
+                                " => \"%s\"",
+                                pegasus::utils::c_escape_string(value, sc->escape_all).c_str());
+                    }
+                    if (detailed) {
+                        fprintf(file,
+                                " {app_id=%d, partition_index=%d, server=%s}",
+                                info.app_id,
+                                info.partition_index,
+                                info.server.c_str());
+                    }
+                    fprintf(file, "\n");
+                    count++;
                 }
-                fprintf(file, "\n");
-                count++;
-            }
-            if (ret != pegasus::PERR_SCAN_COMPLETE && ret != pegasus::PERR_OK) {
-                fprintf(file,
+                release();
+                return max_count <= 0 || count < max_count;
+            });
+        scan_completed.wait();
+        if (ret != pegasus::PERR_SCAN_COMPLETE) {
+            fprintf(file,
+                    "ERROR: %s {app_id=%d, partition_index=%d, server=%s}\n",
+                    sc->pg_client->get_error_string(ret),
+                    error_info.app_id,
+                    error_info.partition_index,
+                    error_info.server.c_str());
+            if (file != stderr) {
+                fprintf(stderr,
                         "ERROR: %s {app_id=%d, partition_index=%d, server=%s}\n",
                         sc->pg_client->get_error_string(ret),
-                        info.app_id,
-                        info.partition_index,
-                        info.server.c_str());
-                if (file != stderr) {
-                    fprintf(stderr,
-                            "ERROR: %s {app_id=%d, partition_index=%d, server=%s}\n",
-                            sc->pg_client->get_error_string(ret),
-                            info.app_id,
-                            info.partition_index,
-                            info.server.c_str());
-                }
+                        error_info.app_id,
+                        error_info.partition_index,
+                        error_info.server.c_str());
             }
         }
     }
@@ -1623,7 +1674,7 @@ bool copy_data(command_executor *e, shell_context *sc, arguments args)
             sort_key_filter_pattern = unescape_str(optarg);
             break;
         case 'v':
-            value_filter_type = parse_filter_type(optarg, true);
+            value_filter_type = parse_value_filter_type(optarg);
             if (value_filter_type == pegasus::pegasus_client::FT_NO_FILTER) {
                 fprintf(stderr, "ERROR: invalid value_filter_type param\n");
                 return false;
@@ -1779,6 +1830,7 @@ bool copy_data(command_executor *e, shell_context *sc, arguments args)
         scan_data_context *context = new scan_data_context(is_geo_data ? SCAN_GEN_GEO : SCAN_COPY,
                                                            i,
                                                            max_batch_count,
+                                                           options.batch_size,
                                                            timeout_ms,
                                                            scanners[i],
                                                            target_client,
@@ -1928,7 +1980,7 @@ bool clear_data(command_executor *e, shell_context *sc, arguments args)
             sort_key_filter_pattern = unescape_str(optarg);
             break;
         case 'v':
-            value_filter_type = parse_filter_type(optarg, true);
+            value_filter_type = parse_value_filter_type(optarg);
             if (value_filter_type == pegasus::pegasus_client::FT_NO_FILTER) {
                 fprintf(stderr, "ERROR: invalid value_filter_type param\n");
                 return false;
@@ -2035,6 +2087,7 @@ bool clear_data(command_executor *e, shell_context *sc, arguments args)
         scan_data_context *context = new scan_data_context(SCAN_CLEAR,
                                                            i,
                                                            max_batch_count,
+                                                           options.batch_size,
                                                            timeout_ms,
                                                            scanners[i],
                                                            sc->pg_client,
@@ -2199,7 +2252,7 @@ bool count_data(command_executor *e, shell_context *sc, arguments args)
             sort_key_filter_pattern = unescape_str(optarg);
             break;
         case 'v':
-            value_filter_type = parse_filter_type(optarg, true);
+            value_filter_type = parse_value_filter_type(optarg);
             if (value_filter_type == pegasus::pegasus_client::FT_NO_FILTER) {
                 fprintf(stderr, "ERROR: invalid value_filter_type param\n");
                 return false;
@@ -2318,6 +2371,13 @@ bool count_data(command_executor *e, shell_context *sc, arguments args)
     fprintf(stderr, "INFO: top_count = %d\n", top_count);
     fprintf(stderr, "INFO: run_seconds = %d\n", run_seconds);
 
+    // the rows are counted on the server side if none of them need to be checked by the shell,
+    // which can't be terminated by run_seconds.
+    bool count_on_server = !stat_size && !diff_hash_key && run_seconds == 0 &&
+                           value_filter_type == pegasus::pegasus_client::FT_NO_FILTER &&
+                           sort_key_filter_type != pegasus::pegasus_client::FT_MATCH_EXACT;
+    fprintf(stderr, "INFO: count_on_server = %s\n", count_on_server ? "true" : "false");
+
     std::vector<pegasus::pegasus_client::pegasus_scanner *> raw_scanners;
     options.timeout_ms = timeout_ms;
     if (sort_key_filter_type != pegasus::pegasus_client::FT_NO_FILTER) {
@@ -2364,6 +2424,7 @@ bool count_data(command_executor *e, shell_context *sc, arguments args)
         scan_data_context *context = new scan_data_context(SCAN_COUNT,
                                                            i,
                                                            max_batch_count,
+                                                           options.batch_size,
                                                            timeout_ms,
                                                            scanners[i],
                                                            sc->pg_client,
@@ -2376,7 +2437,11 @@ bool count_data(command_executor *e, shell_context *sc, arguments args)
         context->set_sort_key_filter(sort_key_filter_type, sort_key_filter_pattern);
         context->set_value_filter(value_filter_type, value_filter_pattern);
         contexts.emplace_back(context);
-        dsn::tasking::enqueue(LPC_SCAN_DATA, nullptr, std::bind(scan_data_next, context));
+        if (count_on_server) {
+            dsn::tasking::enqueue(LPC_SCAN_DATA, nullptr, std::bind(scan_data_aggregate, context));
+        } else {
+            dsn::tasking::enqueue(LPC_SCAN_DATA, nullptr, std::bind(scan_data_next, context));
+        }
     }
 
     int sleep_seconds = 0;
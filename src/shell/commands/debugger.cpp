@@ -136,6 +136,29 @@ bool mlog_dump(command_executor *e, shell_context *sc, arguments args)
                            << "\" : \"" << pegasus::utils::c_escape_string(sort_key, sc->escape_all)
                            << "\"" << std::endl;
                     }
+                } else if (msg->local_rpc_code == ::dsn::apps::RPC_RRDB_RRDB_BATCH_WRITE) {
+                    ::dsn::apps::batch_write_request update;
+                    ::dsn::unmarshall(request, update);
+                    os << INDENT << "[BATCH_WRITE] " << update.operations.size() << std::endl;
+                    for (::dsn::apps::batch_write_operation &op : update.operations) {
+                        std::string hash_key, sort_key;
+                        pegasus::pegasus_restore_key(op.key, hash_key, sort_key);
+                        if (op.operation == ::dsn::apps::mutate_operation::MO_PUT) {
+                            os << INDENT << INDENT << "[PUT] \""
+                               << pegasus::utils::c_escape_string(hash_key, sc->escape_all)
+                               << "\" : \""
+                               << pegasus::utils::c_escape_string(sort_key, sc->escape_all)
+                               << "\" => " << op.expire_ts_seconds << " : \""
+                               << pegasus::utils::c_escape_string(op.value, sc->escape_all) << "\""
+                               << std::endl;
+                        } else {
+                            os << INDENT << INDENT << "[REMOVE] \""
+                               << pegasus::utils::c_escape_string(hash_key, sc->escape_all)
+                               << "\" : \""
+                               << pegasus::utils::c_escape_string(sort_key, sc->escape_all) << "\""
+                               << std::endl;
+                        }
+                    }
                 } else if (msg->local_rpc_code == ::dsn::apps::RPC_RRDB_RRDB_INCR) {
                     ::dsn::apps::incr_request update;
                     ::dsn::unmarshall(request, update);
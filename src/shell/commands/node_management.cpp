@@ -468,6 +468,112 @@ bool server_stat(command_executor *e, shell_context *sc, arguments args)
     return remote_command(e, sc, new_args);
 }
 
+bool rocksdb_events(command_executor *e, shell_context *sc, arguments args)
+{
+    static struct option long_options[] = {{"app_name", required_argument, 0, 'a'},
+                                           {"partition_index", required_argument, 0, 'i'},
+                                           {"count", required_argument, 0, 'c'},
+                                           {"node_list", required_argument, 0, 'l'},
+                                           {"resolve_ip", no_argument, 0, 'r'},
+                                           {0, 0, 0, 0}};
+
+    std::string app_name;
+    int32_t partition_index = -1;
+    int32_t count = 0;
+    std::string nodes;
+    bool resolve_ip = false;
+    optind = 0;
+    while (true) {
+        int option_index = 0;
+        int c;
+        c = getopt_long(args.argc, args.argv, "a:i:c:l:r", long_options, &option_index);
+        if (c == -1)
+            break;
+        switch (c) {
+        case 'a':
+            app_name = optarg;
+            break;
+        case 'i':
+            if (!dsn::buf2int32(optarg, partition_index) || partition_index < 0) {
+                fprintf(stderr, "parse %s as partition_index failed\n", optarg);
+                return false;
+            }
+            break;
+        case 'c':
+            if (!dsn::buf2int32(optarg, count) || count <= 0) {
+                fprintf(stderr, "parse %s as count failed\n", optarg);
+                return false;
+            }
+            break;
+        case 'l':
+            nodes = optarg;
+            break;
+        case 'r':
+            resolve_ip = true;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if (app_name.empty() && partition_index >= 0) {
+        fprintf(stderr, "partition_index should be specified with app_name\n");
+        return false;
+    }
+
+    std::vector<std::string> command_args = {args.argv[0]};
+    if (nodes.empty()) {
+        command_args.insert(command_args.end(), {"-t", "replica-server"});
+    } else {
+        command_args.insert(command_args.end(), {"-l", nodes});
+    }
+    if (resolve_ip) {
+        command_args.emplace_back("-r");
+    }
+    command_args.emplace_back("rocksdb-events");
+
+    if (!app_name.empty()) {
+        int32_t app_id = 0;
+        int32_t partition_count = 0;
+        std::vector<dsn::partition_configuration> partitions;
+        dsn::error_code err =
+            sc->ddl_client->list_app(app_name, app_id, partition_count, partitions);
+        if (err != dsn::ERR_OK) {
+            fprintf(stderr,
+                    "list app %s failed, error = %s\n",
+                    app_name.c_str(),
+                    err.to_string());
+            return true;
+        }
+        if (partition_index >= partition_count) {
+            fprintf(stderr,
+                    "invalid partition_index %d, partition_count = %d\n",
+                    partition_index,
+                    partition_count);
+            return false;
+        }
+        command_args.emplace_back(partition_index >= 0
+                                      ? fmt::format("{}.{}", app_id, partition_index)
+                                      : std::to_string(app_id));
+    }
+    if (count > 0) {
+        if (app_name.empty()) {
+            // app_id 0 means all the apps
+            command_args.emplace_back("0");
+        }
+        command_args.emplace_back(std::to_string(count));
+    }
+
+    std::vector<char *> argv;
+    for (auto &arg : command_args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    arguments new_args;
+    new_args.argc = argv.size();
+    new_args.argv = argv.data();
+    return remote_command(e, sc, new_args);
+}
+
 bool remote_command(command_executor *e, shell_context *sc, arguments args)
 {
     static struct option long_options[] = {{"node_type", required_argument, 0, 't'},
@@ -165,7 +165,7 @@ static command_executor commands[] = {
         "get multiple values under sort key range for a single hash key",
         "<hash_key> <start_sort_key> <stop_sort_key> "
         "[-a|--start_inclusive true|false] [-b|--stop_inclusive true|false] "
-        "[-s|--sort_key_filter_type anywhere|prefix|postfix] "
+        "[-s|--sort_key_filter_type anywhere|prefix|postfix|regex|multi_pattern] "
         "[-y|--sort_key_filter_pattern str] "
         "[-n|--max_count num] [-i|--no_value] [-r|--reverse]",
         data_operations,
@@ -190,7 +190,7 @@ static command_executor commands[] = {
         "delete multiple values under sort key range for a single hash key",
         "<hash_key> <start_sort_key> <stop_sort_key> "
         "[-a|--start_inclusive true|false] [-b|--stop_inclusive true|false] "
-        "[-s|--sort_key_filter_type anywhere|prefix|postfix] "
+        "[-s|--sort_key_filter_type anywhere|prefix|postfix|regex|multi_pattern] "
         "[-y|--sort_key_filter_pattern str] "
         "[-o|--output file_name] [-i|--silent]",
         data_operations,
@@ -234,7 +234,11 @@ static command_executor commands[] = {
         "exist", "check value exist", "<hash_key> <sort_key>", data_operations,
     },
     {
-        "count", "get sort key count for a single hash key", "<hash_key>", data_operations,
+        "count",
+        "get sort key count for a single hash key, which is estimated if it's too large and "
+        "approximate is set",
+        "<hash_key> [-a|--approximate]",
+        data_operations,
     },
     {
         "ttl", "query ttl for a specific key", "<hash_key> <sort_key>", data_operations,
@@ -244,7 +248,7 @@ static command_executor commands[] = {
         "scan all sorted keys for a single hash key",
         "<hash_key> <start_sort_key> <stop_sort_key> "
         "[-a|--start_inclusive true|false] [-b|--stop_inclusive true|false] "
-        "[-s|--sort_key_filter_type anywhere|prefix|postfix] "
+        "[-s|--sort_key_filter_type anywhere|prefix|postfix|regex|multi_pattern] "
         "[-y|--sort_key_filter_pattern str] "
         "[-v|--value_filter_type anywhere|prefix|postfix|exact] "
         "[-z|--value_filter_pattern str] "
@@ -255,14 +259,15 @@ static command_executor commands[] = {
     {
         "full_scan",
         "scan all hash keys",
-        "[-h|--hash_key_filter_type anywhere|prefix|postfix] "
+        "[-h|--hash_key_filter_type anywhere|prefix|postfix|regex|multi_pattern] "
         "[-x|--hash_key_filter_pattern str] "
-        "[-s|--sort_key_filter_type anywhere|prefix|postfix|exact] "
+        "[-s|--sort_key_filter_type anywhere|prefix|postfix|regex|multi_pattern|exact] "
         "[-y|--sort_key_filter_pattern str] "
         "[-v|--value_filter_type anywhere|prefix|postfix|exact] "
         "[-z|--value_filter_pattern str] "
         "[-o|--output file_name] [-n|--max_count num] [-t|--timeout_ms num] "
-        "[-d|--detailed] [-i|--no_value] [-p|--partition num]",
+        "[-d|--detailed] [-i|--no_value] [-p|--partition num] "
+        "[-c|--partition_concurrency num]",
         data_operations,
     },
     {
@@ -270,9 +275,9 @@ static command_executor commands[] = {
         "copy app data",
         "<-c|--target_cluster_name str> <-a|--target_app_name str> "
         "[-p|--partition num] [-b|--max_batch_count num] [-t|--timeout_ms num] "
-        "[-h|--hash_key_filter_type anywhere|prefix|postfix] "
+        "[-h|--hash_key_filter_type anywhere|prefix|postfix|regex|multi_pattern] "
         "[-x|--hash_key_filter_pattern str] "
-        "[-s|--sort_key_filter_type anywhere|prefix|postfix|exact] "
+        "[-s|--sort_key_filter_type anywhere|prefix|postfix|regex|multi_pattern|exact] "
         "[-y|--sort_key_filter_pattern str] "
         "[-v|--value_filter_type anywhere|prefix|postfix|exact] "
         "[-z|--value_filter_pattern str] "
@@ -284,9 +289,9 @@ static command_executor commands[] = {
         "clear_data",
         "clear app data",
         "[-p|--partition num] [-b|--max_batch_count num] [-t|--timeout_ms num] "
-        "[-h|--hash_key_filter_type anywhere|prefix|postfix] "
+        "[-h|--hash_key_filter_type anywhere|prefix|postfix|regex|multi_pattern] "
         "[-x|--hash_key_filter_pattern str] "
-        "[-s|--sort_key_filter_type anywhere|prefix|postfix|exact] "
+        "[-s|--sort_key_filter_type anywhere|prefix|postfix|regex|multi_pattern|exact] "
         "[-y|--sort_key_filter_pattern str] "
         "[-v|--value_filter_type anywhere|prefix|postfix|exact] "
         "[-z|--value_filter_pattern str] "
@@ -298,9 +303,9 @@ static command_executor commands[] = {
         "get app row count",
         "[-c|--precise][-p|--partition num] "
         "[-b|--max_batch_count num][-t|--timeout_ms num] "
-        "[-h|--hash_key_filter_type anywhere|prefix|postfix] "
+        "[-h|--hash_key_filter_type anywhere|prefix|postfix|regex|multi_pattern] "
         "[-x|--hash_key_filter_pattern str] "
-        "[-s|--sort_key_filter_type anywhere|prefix|postfix|exact] "
+        "[-s|--sort_key_filter_type anywhere|prefix|postfix|regex|multi_pattern|exact] "
         "[-y|--sort_key_filter_pattern str] "
         "[-v|--value_filter_type anywhere|prefix|postfix|exact] "
         "[-z|--value_filter_pattern str][-d|--diff_hash_key] "
@@ -326,6 +331,13 @@ static command_executor commands[] = {
         "[-t all|meta-server|replica-server] [-l ip:port,ip:port...] [-r|--resolve_ip]",
         server_stat,
     },
+    {
+        "rocksdb_events",
+        "get the recent flush, compaction and write stall events of rocksdb on replica servers",
+        "[-a|--app_name str] [-i|--partition_index num] [-c|--count num] "
+        "[-l ip:port,ip:port...] [-r|--resolve_ip]",
+        rocksdb_events,
+    },
     {
         "app_stat",
         "get stat of apps",
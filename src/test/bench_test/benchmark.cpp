@@ -17,6 +17,8 @@
  * under the License.
  */
 
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
 #include <pegasus/client.h>
 #include <dsn/dist/fmt_logging.h>
@@ -36,7 +38,8 @@ benchmark::benchmark()
     _operation_method = {{kUnknown, nullptr},
                          {kRead, &benchmark::read_random},
                          {kWrite, &benchmark::write_random},
-                         {kDelete, &benchmark::delete_random}};
+                         {kDelete, &benchmark::delete_random},
+                         {kAsyncWrite, &benchmark::async_write_random}};
 }
 
 void benchmark::run()
@@ -197,6 +200,58 @@ void benchmark::delete_random(thread_arg *thread)
     }
 }
 
+void benchmark::async_write_random(thread_arg *thread)
+{
+    // keep at most `async_concurrency` writes in flight, so that the writes can be batched by
+    // the client if [pegasus.client] write_batch_delay_ms is set.
+    std::mutex mtx;
+    std::condition_variable cv;
+    uint32_t in_flight = 0;
+    uint64_t finished = 0;
+    uint64_t reported = 0;
+    for (int i = 0; i < config::instance().num; i++) {
+        std::string hashkey, sortkey, value;
+        generate_kv_pair(hashkey, sortkey, value);
+
+        {
+            std::unique_lock<std::mutex> l(mtx);
+            cv.wait(l, [&]() { return in_flight < config::instance().async_concurrency; });
+            in_flight++;
+            if (finished > reported) {
+                thread->stats.finished_ops(finished - reported, kAsyncWrite);
+                reported = finished;
+            }
+        }
+
+        _client->async_set(hashkey,
+                           sortkey,
+                           value,
+                           [&](int ret, pegasus_client::internal_info &&info) {
+                               if (ret != ::pegasus::PERR_OK) {
+                                   fmt::print(stderr,
+                                              "Async set returned an error: {}\n",
+                                              _client->get_error_string(ret));
+                                   exit(1);
+                               }
+                               std::lock_guard<std::mutex> l(mtx);
+                               in_flight--;
+                               finished++;
+                               cv.notify_one();
+                           },
+                           config::instance().pegasus_timeout_ms);
+    }
+
+    // wait all writes are done
+    std::unique_lock<std::mutex> l(mtx);
+    cv.wait(l, [&]() { return in_flight == 0; });
+    if (finished > reported) {
+        thread->stats.finished_ops(finished - reported, kAsyncWrite);
+    }
+    thread->stats.add_bytes(finished * (config::instance().value_size +
+                                        config::instance().hashkey_size +
+                                        config::instance().sortkey_size));
+}
+
 void benchmark::generate_kv_pair(std::string &hashkey, std::string &sortkey, std::string &value)
 {
     hashkey = generate_string(config::instance().hashkey_size);
@@ -213,6 +268,8 @@ operation_type benchmark::get_operation_type(const std::string &name)
         op_type = kRead;
     } else if (name == "deleterandom_pegasus") {
         op_type = kDelete;
+    } else if (name == "fillrandom_async_pegasus") {
+        op_type = kAsyncWrite;
     } else if (!name.empty()) { // No error message for empty name
         fmt::print(stderr, "unknown benchmark '{}'\n", name);
         exit(1);
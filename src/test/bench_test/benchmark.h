@@ -63,6 +63,7 @@ private:
     void write_random(thread_arg *thread);
     void read_random(thread_arg *thread);
     void delete_random(thread_arg *thread);
+    void async_write_random(thread_arg *thread);
 
     /**  generate hash/sort key and value */
     void generate_kv_pair(std::string &hashkey, std::string &sortkey, std::string &value);
@@ -41,11 +41,17 @@ config::config()
         "Comma-separated list of operations to run in the specified order. Available benchmarks:\n"
         "\tfillrandom_pegasus       -- pegasus write N values in random key order\n"
         "\treadrandom_pegasus       -- pegasus read N times in random order\n"
-        "\tdeleterandom_pegasus     -- pegasus delete N keys in random order\n");
+        "\tdeleterandom_pegasus     -- pegasus delete N keys in random order\n"
+        "\tfillrandom_async_pegasus -- pegasus async write N values in random key order\n");
     num = dsn_config_get_value_uint64(
         "pegasus.benchmark", "num", 10000, "Number of key/values to place in database");
     threads = (int32_t)dsn_config_get_value_uint64(
         "pegasus.benchmark", "threads", 1, "Number of concurrent threads to run");
+    async_concurrency = (int32_t)dsn_config_get_value_uint64(
+        "pegasus.benchmark",
+        "async_concurrency",
+        100,
+        "Max number of in-flight writes of each thread for fillrandom_async_pegasus");
     hashkey_size = (int32_t)dsn_config_get_value_uint64(
         "pegasus.benchmark", "hashkey_size", 16, "size of each hashkey");
     sortkey_size = (int32_t)dsn_config_get_value_uint64(
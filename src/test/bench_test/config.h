@@ -40,6 +40,8 @@ struct config : public ::dsn::utils::singleton<config>
     uint64_t num;
     // Number of concurrent threads to run
     uint32_t threads;
+    // Max number of in-flight writes of each thread for fillrandom_async_pegasus
+    uint32_t async_concurrency;
     // size of each value
     uint32_t value_size;
     // size of each hashkey
@@ -26,7 +26,11 @@
 namespace pegasus {
 namespace test {
 std::unordered_map<operation_type, std::string, std::hash<unsigned char>> operation_type_string = {
-    {kUnknown, "unKnown"}, {kRead, "read"}, {kWrite, "write"}, {kDelete, "delete"}};
+    {kUnknown, "unKnown"},
+    {kRead, "read"},
+    {kWrite, "write"},
+    {kDelete, "delete"},
+    {kAsyncWrite, "async_write"}};
 
 statistics::statistics(std::shared_ptr<rocksdb::Statistics> hist_stats)
 {
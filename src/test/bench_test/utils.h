@@ -26,7 +26,8 @@ enum operation_type
     kUnknown = 0,
     kRead,
     kWrite,
-    kDelete
+    kDelete,
+    kAsyncWrite
 };
 } // namespace test
 } // namespace pegasus
@@ -82,6 +82,40 @@ TEST(basic, set_get_del)
     ASSERT_EQ(PERR_NOT_FOUND, ret);
 }
 
+TEST(basic, batch_get)
+{
+    // set the keys of different hash keys, which are distributed in different partitions
+    std::vector<std::pair<std::string, std::string>> keys;
+    for (int i = 0; i < 100; i++) {
+        std::string hash_key = "basic_test_batch_get_" + std::to_string(i);
+        std::string sort_key = "sort_key_" + std::to_string(i);
+        int ret = client->set(hash_key, sort_key, "value_" + std::to_string(i));
+        ASSERT_EQ(PERR_OK, ret);
+        keys.emplace_back(hash_key, sort_key);
+    }
+    // a key not existed
+    keys.emplace_back("basic_test_batch_get_not_exist", "sort_key");
+
+    std::map<std::pair<std::string, std::string>, std::string> values;
+    int ret = client->batch_get(keys, values);
+    ASSERT_EQ(PERR_OK, ret);
+    ASSERT_EQ(100, values.size());
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ("value_" + std::to_string(i), values[keys[i]]);
+    }
+
+    // empty keys
+    values.clear();
+    ret = client->batch_get({}, values);
+    ASSERT_EQ(PERR_OK, ret);
+    ASSERT_TRUE(values.empty());
+
+    for (int i = 0; i < 100; i++) {
+        ret = client->del(keys[i].first, keys[i].second);
+        ASSERT_EQ(PERR_OK, ret);
+    }
+}
+
 TEST(basic, multi_get)
 {
     // multi_set
@@ -1735,6 +1769,79 @@ TEST(basic, scan_with_filter)
         ASSERT_EQ(kvs, data);
     }
 
+    // scan with regex sort key filter and batch_size = 2
+    {
+        pegasus_client::scan_options options;
+        options.sort_key_filter_type = pegasus_client::FT_MATCH_REGEX;
+        options.sort_key_filter_pattern = "_[13]$";
+        options.batch_size = 2;
+        pegasus_client::pegasus_scanner *scanner = nullptr;
+        ret = client->get_scanner("xyz", "", "", options, scanner);
+        ASSERT_EQ(PERR_OK, ret);
+        ASSERT_NE(nullptr, scanner);
+        std::set<std::string> sort_keys;
+        std::string hash_key;
+        std::string sort_key;
+        std::string value;
+        while (!(ret = (scanner->next(hash_key, sort_key, value)))) {
+            ASSERT_EQ("xyz", hash_key);
+            sort_keys.insert(sort_key);
+        }
+        delete scanner;
+        ASSERT_EQ(std::set<std::string>({"m_1", "m_3", "n_1", "n_3"}), sort_keys);
+    }
+
+    // scan with multi-pattern sort key filter
+    {
+        pegasus_client::scan_options options;
+        options.sort_key_filter_type = pegasus_client::FT_MATCH_MULTI_PATTERN;
+        options.sort_key_filter_pattern = "m_2\nn_3\nx_1";
+        pegasus_client::pegasus_scanner *scanner = nullptr;
+        ret = client->get_scanner("xyz", "", "", options, scanner);
+        ASSERT_EQ(PERR_OK, ret);
+        ASSERT_NE(nullptr, scanner);
+        std::set<std::string> sort_keys;
+        std::string hash_key;
+        std::string sort_key;
+        std::string value;
+        while (!(ret = (scanner->next(hash_key, sort_key, value)))) {
+            ASSERT_EQ("xyz", hash_key);
+            sort_keys.insert(sort_key);
+        }
+        delete scanner;
+        ASSERT_EQ(std::set<std::string>({"m_2", "n_3"}), sort_keys);
+    }
+
+    // scan with invalid regex
+    {
+        pegasus_client::scan_options options;
+        options.sort_key_filter_type = pegasus_client::FT_MATCH_REGEX;
+        options.sort_key_filter_pattern = "m_(";
+        pegasus_client::pegasus_scanner *scanner = nullptr;
+        ret = client->get_scanner("xyz", "", "", options, scanner);
+        ASSERT_EQ(PERR_OK, ret);
+        ASSERT_NE(nullptr, scanner);
+        std::string hash_key;
+        std::string sort_key;
+        std::string value;
+        ASSERT_EQ(PERR_INVALID_ARGUMENT, scanner->next(hash_key, sort_key, value));
+        delete scanner;
+    }
+
+    // multi_get with regex sort key filter
+    {
+        pegasus::pegasus_client::multi_get_options options;
+        options.sort_key_filter_type = pegasus_client::FT_MATCH_REGEX;
+        options.sort_key_filter_pattern = "^n_";
+        std::map<std::string, std::string> values;
+        ret = client->multi_get("xyz", "", "", options, values);
+        ASSERT_EQ(PERR_OK, ret);
+        ASSERT_EQ(3, values.size());
+        ASSERT_EQ("b", values["n_1"]);
+        ASSERT_EQ("b", values["n_2"]);
+        ASSERT_EQ("b", values["n_3"]);
+    }
+
     // multi_del
     std::set<std::string> sortkeys;
     for (auto kv : kvs) {
@@ -0,0 +1,131 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include <pegasus/client.h>
+#include <pegasus/future.h>
+#include <gtest/gtest.h>
+
+using namespace ::pegasus;
+
+extern pegasus_client *client;
+
+TEST(future, set_get_multi_get)
+{
+    const std::string hash_key = "future_test_hash_key";
+    std::vector<pegasus_future<pegasus_client::set_result>> set_futures;
+    for (int i = 0; i < 10; ++i) {
+        set_futures.emplace_back(client->future_set(
+            hash_key, "sort_key_" + std::to_string(i), "value_" + std::to_string(i)));
+    }
+    auto set_results = when_all(std::move(set_futures)).get();
+    ASSERT_EQ(PERR_OK, set_results.error);
+    ASSERT_EQ(10, set_results.results.size());
+
+    std::vector<pegasus_future<pegasus_client::get_result>> get_futures;
+    for (int i = 0; i < 10; ++i) {
+        get_futures.emplace_back(client->future_get(hash_key, "sort_key_" + std::to_string(i)));
+    }
+    get_futures.emplace_back(client->future_get(hash_key, "sort_key_absent"));
+    auto get_results = when_all(std::move(get_futures)).get();
+    ASSERT_EQ(PERR_NOT_FOUND, get_results.error);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(PERR_OK, get_results.results[i].error);
+        ASSERT_EQ("value_" + std::to_string(i), get_results.results[i].value);
+    }
+    ASSERT_EQ(PERR_NOT_FOUND, get_results.results[10].error);
+
+    // the result is delivered to the continuation in the rpc callback thread.
+    pegasus_promise<pegasus_client::multi_get_result> promise;
+    auto continued = promise.get_future();
+    client->future_multi_get(hash_key, {"sort_key_1", "sort_key_2"})
+        .then([promise](pegasus_client::multi_get_result &&result) {
+            promise.set_value(std::move(result));
+        });
+    auto multi_get_result = continued.get();
+    ASSERT_EQ(PERR_OK, multi_get_result.error);
+    ASSERT_EQ(2, multi_get_result.values.size());
+    ASSERT_EQ("value_2", multi_get_result.values["sort_key_2"]);
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(PERR_OK, client->del(hash_key, "sort_key_" + std::to_string(i)));
+    }
+}
+
+TEST(future, scan)
+{
+    const std::string hash_key = "future_test_scan_hash_key";
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(PERR_OK, client->set(hash_key, "sort_key_" + std::to_string(i), "value"));
+    }
+
+    pegasus_client::scan_options options;
+    auto scanners_result = client->future_get_unordered_scanners(3, options).get();
+    ASSERT_EQ(PERR_OK, scanners_result.error);
+    ASSERT_FALSE(scanners_result.scanners.empty());
+
+    int count = 0;
+    for (auto scanner : scanners_result.scanners) {
+        while (true) {
+            auto result = scanner->future_next().get();
+            if (result.error == PERR_SCAN_COMPLETE) {
+                break;
+            }
+            ASSERT_EQ(PERR_OK, result.error);
+            if (result.hashkey == hash_key) {
+                ++count;
+            }
+        }
+        delete scanner;
+    }
+    ASSERT_EQ(10, count);
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(PERR_OK, client->del(hash_key, "sort_key_" + std::to_string(i)));
+    }
+}
+
+TEST(future, cancel)
+{
+    pegasus_promise<pegasus_client::get_result> promise1;
+    pegasus_promise<pegasus_client::get_result> promise2;
+    std::vector<pegasus_future<pegasus_client::get_result>> futures;
+    futures.emplace_back(promise1.get_future());
+    futures.emplace_back(promise2.get_future());
+    auto all = when_all(std::move(futures));
+
+    pegasus_client::get_result result;
+    result.value = "value";
+    ASSERT_TRUE(promise1.set_value(std::move(result)));
+    ASSERT_FALSE(all.ready());
+
+    // the futures which are not completed are cancelled along with the aggregated future.
+    all.cancel();
+    ASSERT_TRUE(all.ready());
+    auto all_result = all.get();
+    ASSERT_EQ(PERR_CANCELLED, all_result.error);
+    ASSERT_EQ(PERR_OK, all_result.results[0].error);
+    ASSERT_EQ("value", all_result.results[0].value);
+    ASSERT_EQ(PERR_CANCELLED, all_result.results[1].error);
+
+    // the result which arrives after the cancellation is dropped.
+    ASSERT_FALSE(promise2.set_value(pegasus_client::get_result()));
+}
@@ -17,8 +17,10 @@
  * under the License.
  */
 
+#include <atomic>
 #include <cstdlib>
 #include <string>
+#include <thread>
 #include <vector>
 #include <map>
 
@@ -496,6 +498,125 @@ TEST_F(scan, OVERALL)
     compare(data, base);
 }
 
+TEST_F(scan, SCAN_BATCHES)
+{
+    ddebug("TEST SCAN_BATCHES...");
+    pegasus_client::scan_options options;
+    options.batch_size = 10;
+    std::vector<pegasus_client::pegasus_scanner *> scanners;
+    int ret = client->get_unordered_scanners(1, options, scanners);
+    ASSERT_EQ(PERR_OK, ret) << "Error occurred when getting scanner. error="
+                            << client->get_error_string(ret);
+    ASSERT_EQ(1, scanners.size());
+
+    std::map<std::string, std::map<std::string, std::string>> data;
+    std::atomic_int unreleased_batches(0);
+    std::atomic_int max_unreleased_batches(0);
+    int final_error = PERR_OK;
+    dsn::utils::notify_event completed;
+    scanners[0]->async_scan_batches(
+        4,
+        3,
+        [&](int err,
+            pegasus_client::scan_batch &&batch,
+            pegasus_client::internal_info &&info,
+            std::function<void()> &&release) {
+            if (err != PERR_OK) {
+                final_error = err;
+                completed.notify();
+                return false;
+            }
+            for (size_t i = 0; i < batch.size(); ++i) {
+                check_and_put(data,
+                              batch.hash_key(i).to_string(),
+                              batch.sort_key(i).to_string(),
+                              batch.value(i).to_string());
+            }
+            max_unreleased_batches.store(std::max(max_unreleased_batches.load(),
+                                                  ++unreleased_batches));
+            // release the batches in another thread after a while, to check the backpressure.
+            std::thread([&unreleased_batches, release = std::move(release) ]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                unreleased_batches--;
+                release();
+            }).detach();
+            return true;
+        });
+    completed.wait();
+    ASSERT_EQ(PERR_SCAN_COMPLETE, final_error) << "Error occurred when scan. error="
+                                               << client->get_error_string(final_error);
+    ASSERT_LE(max_unreleased_batches.load(), 3);
+    ASSERT_EQ(0, unreleased_batches.load());
+    delete scanners[0];
+    compare(data, base);
+
+    // the scan is stopped if the callback returns false.
+    ret = client->get_unordered_scanners(1, options, scanners);
+    ASSERT_EQ(PERR_OK, ret);
+    int batch_count = 0;
+    dsn::utils::notify_event stopped;
+    scanners[0]->async_scan_batches(
+        4,
+        3,
+        [&](int err,
+            pegasus_client::scan_batch &&batch,
+            pegasus_client::internal_info &&info,
+            std::function<void()> &&release) {
+            if (err != PERR_OK) {
+                final_error = err;
+                stopped.notify();
+                return false;
+            }
+            batch_count++;
+            release();
+            return false;
+        });
+    stopped.wait();
+    ASSERT_EQ(PERR_SCAN_COMPLETE, final_error);
+    ASSERT_EQ(1, batch_count);
+    delete scanners[0];
+}
+
+TEST_F(scan, NEXT_BATCH)
+{
+    ddebug("TEST NEXT_BATCH...");
+    pegasus_client::scan_options options;
+    options.batch_size = 10;
+    std::vector<pegasus_client::pegasus_scanner *> scanners;
+    int ret = client->get_unordered_scanners(3, options, scanners);
+    ASSERT_EQ(PERR_OK, ret) << "Error occurred when getting scanner. error="
+                            << client->get_error_string(ret);
+    ASSERT_LE(scanners.size(), 3);
+
+    std::string hash_key;
+    std::string sort_key;
+    std::string value;
+    std::map<std::string, std::map<std::string, std::string>> data;
+    for (auto scanner : scanners) {
+        ASSERT_NE(nullptr, scanner);
+        // next_batch() returns the rest of the batch which is partially got by next().
+        ret = scanner->next(hash_key, sort_key, value);
+        if (ret == PERR_OK) {
+            check_and_put(data, hash_key, sort_key, value);
+        }
+        pegasus_client::scan_batch batch;
+        while (PERR_OK == (ret = scanner->next_batch(batch))) {
+            ASSERT_FALSE(batch.empty());
+            ASSERT_LE(batch.size(), static_cast<size_t>(options.batch_size));
+            for (size_t i = 0; i < batch.size(); ++i) {
+                check_and_put(data,
+                              batch.hash_key(i).to_string(),
+                              batch.sort_key(i).to_string(),
+                              batch.value(i).to_string());
+            }
+        }
+        ASSERT_EQ(PERR_SCAN_COMPLETE, ret) << "Error occurred when scan. error="
+                                           << client->get_error_string(ret);
+        delete scanner;
+    }
+    compare(data, base);
+}
+
 TEST_F(scan, REQUEST_EXPIRE_TS)
 {
     ddebug("TEST REQUEST_EXPIRE_TS...");
@@ -548,6 +669,110 @@ TEST_F(scan, REQUEST_EXPIRE_TS)
     compare(ttl_data, ttl_base);
 }
 
+TEST_F(scan, AGGREGATE)
+{
+    ddebug("TEST AGGREGATE...");
+
+    // count all the rows on the server side
+    pegasus_client::scan_options options;
+    std::vector<pegasus_client::pegasus_scanner *> scanners;
+    int ret = client->get_unordered_scanners(3, options, scanners);
+    ASSERT_EQ(PERR_OK, ret) << "Error occurred when getting scanner. error="
+                            << client->get_error_string(ret);
+    pegasus_client::scan_aggregate_result total;
+    for (auto scanner : scanners) {
+        ASSERT_NE(nullptr, scanner);
+        pegasus_client::scan_aggregate_result result;
+        ret = scanner->aggregate(pegasus_client::SA_COUNT, result);
+        ASSERT_EQ(PERR_OK, ret) << "Error occurred when aggregate. error="
+                                << client->get_error_string(ret);
+        ASSERT_TRUE(scanner->safe_destructible());
+        total.merge(result);
+        delete scanner;
+    }
+    int64_t row_count = 0;
+    int64_t key_bytes = 0;
+    int64_t value_bytes = 0;
+    for (const auto &kv : base) {
+        for (const auto &skv : kv.second) {
+            row_count++;
+            key_bytes += kv.first.size() + skv.first.size();
+            value_bytes += skv.second.size();
+        }
+    }
+    ASSERT_EQ(row_count, total.row_count);
+    ASSERT_EQ(key_bytes, total.key_bytes);
+    ASSERT_EQ(value_bytes, total.value_bytes);
+    ASSERT_EQ(0, total.int_count);
+
+    // the filters are applied before the aggregation
+    options.sort_key_filter_type = pegasus_client::FT_MATCH_PREFIX;
+    options.sort_key_filter_pattern = "a";
+    pegasus_client::pegasus_scanner *scanner = nullptr;
+    ret = client->get_scanner(expected_hash_key, "", "", options, scanner);
+    ASSERT_EQ(PERR_OK, ret);
+    pegasus_client::scan_aggregate_result result;
+    ret = scanner->aggregate(pegasus_client::SA_COUNT, result);
+    ASSERT_EQ(PERR_OK, ret);
+    delete scanner;
+    int64_t prefix_count = 0;
+    for (const auto &kv : base[expected_hash_key]) {
+        if (kv.first[0] == 'a') {
+            prefix_count++;
+        }
+    }
+    ASSERT_EQ(prefix_count, result.row_count);
+
+    // integer stats, the values which are not integers are ignored
+    const std::string int_hash_key = "scan_aggregate_int_hash_key";
+    const std::map<std::string, std::string> int_kvs = {
+        {"k1", "100"}, {"k2", "-20"}, {"k3", "7"}, {"k4", "not_a_number"}};
+    for (const auto &kv : int_kvs) {
+        ASSERT_EQ(PERR_OK, client->set(int_hash_key, kv.first, kv.second));
+    }
+    options = pegasus_client::scan_options();
+    options.batch_size = 2;
+    ret = client->get_scanner(int_hash_key, "", "", options, scanner);
+    ASSERT_EQ(PERR_OK, ret);
+    std::atomic_int batch_count(0);
+    int final_error = PERR_OK;
+    dsn::utils::notify_event op_completed;
+    result = pegasus_client::scan_aggregate_result();
+    scanner->get_smart_wrapper()->async_aggregate(
+        pegasus_client::SA_INT_STATS,
+        [&](int err, pegasus_client::scan_aggregate_result &&batch_result) {
+            if (err == PERR_OK) {
+                batch_count++;
+                result.merge(batch_result);
+                return;
+            }
+            final_error = err;
+            op_completed.notify();
+        });
+    op_completed.wait();
+    ASSERT_EQ(PERR_SCAN_COMPLETE, final_error) << "Error occurred when aggregate. error="
+                                               << client->get_error_string(final_error);
+    ASSERT_LE(2, batch_count.load());
+    ASSERT_EQ(4, result.row_count);
+    ASSERT_EQ(3, result.int_count);
+    ASSERT_EQ(87, result.int_sum);
+    ASSERT_EQ(-20, result.int_min);
+    ASSERT_EQ(100, result.int_max);
+
+    // the scanner which has been iterated can't be aggregated
+    ret = client->get_scanner(int_hash_key, "", "", options, scanner);
+    ASSERT_EQ(PERR_OK, ret);
+    std::string hash_key, sort_key, value;
+    ASSERT_EQ(PERR_OK, scanner->next(hash_key, sort_key, value));
+    ASSERT_EQ(PERR_INVALID_ARGUMENT, scanner->aggregate(pegasus_client::SA_COUNT, result));
+    ASSERT_EQ(PERR_INVALID_ARGUMENT, scanner->aggregate(pegasus_client::SA_NONE, result));
+    delete scanner;
+
+    for (const auto &kv : int_kvs) {
+        ASSERT_EQ(PERR_OK, client->del(int_hash_key, kv.first));
+    }
+}
+
 TEST_F(scan, ITERATION_TIME_LIMIT)
 {
     // update iteration threshold to 1ms